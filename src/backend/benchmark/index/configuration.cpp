@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// configuration.cpp
+//
+// Identification: benchmark/index/configuration.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <iomanip>
+#include <algorithm>
+
+#include "backend/benchmark/index/configuration.h"
+
+namespace peloton {
+namespace benchmark {
+namespace index_bench {
+
+void Usage(FILE *out) {
+  fprintf(out,
+          "Command line options : index_bench <options> \n"
+          "   -h --help              :  Print help message \n"
+          "   -i --index-type        :  Index type (1 btree, 2 bwtree, 4 olc btree, 5 art) \n"
+          "   -y --key-type          :  Key type (1 ints, 2 generic, 3 tuple) \n"
+          "   -c --column-count      :  # of key columns (1 to 4) \n"
+          "   -k --key-count         :  # of keys \n"
+          "   -b --thread-count      :  # of threads \n"
+          "   -w --write-ratio       :  Fraction of inserts/deletes \n"
+          "   -s --scan-ratio        :  Fraction of scans \n"
+          "   -z --theta             :  Zipf skew, 0 for uniform \n"
+          "   -d --duration          :  Seconds to run \n"
+          "   -m --maintenance       :  BWTree background maintenance (0 or 1) \n");
+  exit(EXIT_FAILURE);
+}
+
+static struct option opts[] = {
+    {"index-type", optional_argument, NULL, 'i'},
+    {"key-type", optional_argument, NULL, 'y'},
+    {"column-count", optional_argument, NULL, 'c'},
+    {"key-count", optional_argument, NULL, 'k'},
+    {"thread-count", optional_argument, NULL, 'b'},
+    {"write-ratio", optional_argument, NULL, 'w'},
+    {"scan-ratio", optional_argument, NULL, 's'},
+    {"theta", optional_argument, NULL, 'z'},
+    {"duration", optional_argument, NULL, 'd'},
+    {"maintenance", optional_argument, NULL, 'm'},
+    {NULL, 0, NULL, 0}};
+
+static void ValidateIndexType(const configuration &state) {
+  switch (state.index_type) {
+    case INDEX_TYPE_INVALID:
+      std::cout << std::setw(20) << std::left << "index_type "
+                << " : "
+                << "ALL" << std::endl;
+      break;
+    case INDEX_TYPE_BTREE:
+    case INDEX_TYPE_BWTREE:
+    case INDEX_TYPE_OLC_BTREE:
+    case INDEX_TYPE_ART:
+      std::cout << std::setw(20) << std::left << "index_type "
+                << " : " << IndexTypeToString(state.index_type) << std::endl;
+      break;
+    default:
+      std::cout << "Invalid index_type :: " << state.index_type << std::endl;
+      exit(EXIT_FAILURE);
+  }
+}
+
+static void ValidateKeyType(const configuration &state) {
+  switch (state.key_type) {
+    case KEY_TYPE_INTS:
+      std::cout << std::setw(20) << std::left << "key_type "
+                << " : "
+                << "INTS" << std::endl;
+      break;
+    case KEY_TYPE_GENERIC:
+      std::cout << std::setw(20) << std::left << "key_type "
+                << " : "
+                << "GENERIC" << std::endl;
+      break;
+    case KEY_TYPE_TUPLE:
+      std::cout << std::setw(20) << std::left << "key_type "
+                << " : "
+                << "TUPLE" << std::endl;
+      break;
+    default:
+      std::cout << "Invalid key_type :: " << state.key_type << std::endl;
+      exit(EXIT_FAILURE);
+  }
+}
+
+static void ValidateColumnCount(const configuration &state) {
+  if (state.column_count < 1 || state.column_count > 4) {
+    std::cout << "Invalid column_count :: " << state.column_count << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::cout << std::setw(20) << std::left << "column_count "
+            << " : " << state.column_count << std::endl;
+}
+
+static void ValidateKeyCount(const configuration &state) {
+  if (state.key_count <= 0) {
+    std::cout << "Invalid key_count :: " << state.key_count << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::cout << std::setw(20) << std::left << "key_count "
+            << " : " << state.key_count << std::endl;
+}
+
+static void ValidateThreadCount(const configuration &state) {
+  if (state.thread_count <= 0) {
+    std::cout << "Invalid thread_count :: " << state.thread_count << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::cout << std::setw(20) << std::left << "thread_count "
+            << " : " << state.thread_count << std::endl;
+}
+
+static void ValidateMix(const configuration &state) {
+  if (state.write_ratio < 0 || state.scan_ratio < 0 ||
+      state.write_ratio + state.scan_ratio > 1) {
+    std::cout << "Invalid write_ratio/scan_ratio :: " << state.write_ratio
+              << "/" << state.scan_ratio << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // IntsKey can not be turned back into a tuple, which scans need
+  if (state.key_type == KEY_TYPE_INTS && state.scan_ratio > 0) {
+    std::cout << "Scans are not supported with INTS keys" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::cout << std::setw(20) << std::left << "write_ratio "
+            << " : " << state.write_ratio << std::endl;
+  std::cout << std::setw(20) << std::left << "scan_ratio "
+            << " : " << state.scan_ratio << std::endl;
+}
+
+static void ValidateTheta(const configuration &state) {
+  if (state.theta < 0 || state.theta >= 1) {
+    std::cout << "Invalid theta :: " << state.theta << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::cout << std::setw(20) << std::left << "theta "
+            << " : " << state.theta << std::endl;
+}
+
+static void ValidateDuration(const configuration &state) {
+  if (state.duration <= 0) {
+    std::cout << "Invalid duration :: " << state.duration << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::cout << std::setw(20) << std::left << "duration "
+            << " : " << state.duration << std::endl;
+}
+
+void ParseArguments(int argc, char *argv[], configuration &state) {
+  // Default Values
+  state.index_type = INDEX_TYPE_INVALID;
+  state.key_type = KEY_TYPE_GENERIC;
+  state.column_count = 1;
+  state.key_count = 1000000;
+  state.thread_count = 1;
+  state.write_ratio = 0.0;
+  state.scan_ratio = 0.0;
+  state.theta = 0.0;
+  state.duration = 10;
+  state.background_maintenance = false;
+
+  // Parse args
+  while (1) {
+    int idx = 0;
+    int c = getopt_long(argc, argv, "hi:y:c:k:b:w:s:z:d:m:", opts, &idx);
+
+    if (c == -1) break;
+
+    switch (c) {
+      case 'i':
+        state.index_type = (IndexType)atoi(optarg);
+        break;
+      case 'y':
+        state.key_type = (KeyType)atoi(optarg);
+        break;
+      case 'c':
+        state.column_count = atoi(optarg);
+        break;
+      case 'k':
+        state.key_count = atoi(optarg);
+        break;
+      case 'b':
+        state.thread_count = atoi(optarg);
+        break;
+      case 'w':
+        state.write_ratio = atof(optarg);
+        break;
+      case 's':
+        state.scan_ratio = atof(optarg);
+        break;
+      case 'z':
+        state.theta = atof(optarg);
+        break;
+      case 'd':
+        state.duration = atoi(optarg);
+        break;
+      case 'm':
+        state.background_maintenance = atoi(optarg) != 0;
+        break;
+      case 'h':
+        Usage(stderr);
+        break;
+
+      default:
+        fprintf(stderr, "\nUnknown option: -%c-\n", c);
+        Usage(stderr);
+    }
+  }
+
+  // Print configuration
+  ValidateIndexType(state);
+  ValidateKeyType(state);
+  ValidateColumnCount(state);
+  ValidateKeyCount(state);
+  ValidateThreadCount(state);
+  ValidateMix(state);
+  ValidateTheta(state);
+  ValidateDuration(state);
+
+  std::cout << std::setw(20) << std::left << "maintenance "
+            << " : " << (state.background_maintenance ? "BACKGROUND" : "INLINE")
+            << std::endl;
+}
+
+}  // namespace index_bench
+}  // namespace benchmark
+}  // namespace peloton
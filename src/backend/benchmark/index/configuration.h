@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// configuration.h
+//
+// Identification: benchmark/index/configuration.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <getopt.h>
+#include <vector>
+#include <sys/time.h>
+#include <iostream>
+
+#include "backend/common/types.h"
+
+namespace peloton {
+namespace benchmark {
+namespace index_bench {
+
+enum KeyType {
+  KEY_TYPE_INVALID = 0,
+
+  KEY_TYPE_INTS = 1,
+  KEY_TYPE_GENERIC = 2,
+  KEY_TYPE_TUPLE = 3
+
+};
+
+class configuration {
+ public:
+  // index to benchmark, INVALID runs all tree indexes one after the other
+  IndexType index_type;
+
+  // key representation used inside the index
+  KeyType key_type;
+
+  // # of BIGINT key columns
+  int column_count;
+
+  // # of distinct keys in the index
+  int key_count;
+
+  // # of worker threads
+  int thread_count;
+
+  // fraction of inserts/deletes
+  double write_ratio;
+
+  // fraction of prefix scans, the rest are point lookups
+  double scan_ratio;
+
+  // zipf skew of the accessed keys, 0 for uniform
+  double theta;
+
+  // seconds to run the workload for
+  int duration;
+
+  // leave BWTree consolidations, splits and merges to a background thread
+  bool background_maintenance;
+};
+
+void Usage(FILE *out);
+
+void ParseArguments(int argc, char *argv[], configuration &state);
+
+}  // namespace index_bench
+}  // namespace benchmark
+}  // namespace peloton
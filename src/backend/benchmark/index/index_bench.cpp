@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// index_bench.cpp
+//
+// Identification: benchmark/index/index_bench.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <iostream>
+
+#include "backend/benchmark/index/index_bench.h"
+#include "backend/benchmark/index/configuration.h"
+#include "backend/benchmark/index/workload.h"
+
+namespace peloton {
+namespace benchmark {
+namespace index_bench {
+
+configuration state;
+
+// Main Entry Point
+void RunBenchmark() {
+  if (state.index_type == INDEX_TYPE_INVALID) {
+    RunWorkload(INDEX_TYPE_BTREE);
+    RunWorkload(INDEX_TYPE_BWTREE);
+    RunWorkload(INDEX_TYPE_OLC_BTREE);
+    RunWorkload(INDEX_TYPE_ART);
+  } else {
+    RunWorkload(state.index_type);
+  }
+}
+
+}  // namespace index_bench
+}  // namespace benchmark
+}  // namespace peloton
+
+int main(int argc, char **argv) {
+  peloton::benchmark::index_bench::ParseArguments(
+      argc, argv, peloton::benchmark::index_bench::state);
+
+  peloton::benchmark::index_bench::RunBenchmark();
+
+  return 0;
+}
@@ -0,0 +1,25 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// index_bench.h
+//
+// Identification: benchmark/index/index_bench.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "backend/benchmark/index/configuration.h"
+
+namespace peloton {
+namespace benchmark {
+namespace index_bench {
+
+extern configuration state;
+
+}  // namespace index_bench
+}  // namespace benchmark
+}  // namespace peloton
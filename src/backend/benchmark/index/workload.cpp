@@ -0,0 +1,389 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// workload.cpp
+//
+// Identification: benchmark/index/workload.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "backend/benchmark/index/workload.h"
+
+#include "backend/catalog/schema.h"
+#include "backend/common/types.h"
+#include "backend/common/value_factory.h"
+#include "backend/index/btree_index.h"
+#include "backend/index/bwtree_index.h"
+#include "backend/index/index_factory.h"
+#include "backend/index/index_key.h"
+#include "backend/index/olc_btree_index.h"
+#include "backend/storage/tuple.h"
+
+namespace peloton {
+namespace benchmark {
+namespace index_bench {
+
+// # of consecutive keys that share the leading column when the key has more
+// than one column. A scan fetches one such group.
+#define SCAN_GROUP_SIZE 16
+
+namespace {
+
+// Latencies in ns, with 16 linear buckets per power of two
+class LatencyHistogram {
+ public:
+  LatencyHistogram() : buckets(BUCKET_COUNT, 0), count(0) {}
+
+  inline void Add(uint64_t latency) {
+    buckets[BucketIndex(latency)]++;
+    count++;
+  }
+
+  void Merge(const LatencyHistogram &other) {
+    for (size_t bucket_itr = 0; bucket_itr < BUCKET_COUNT; bucket_itr++) {
+      buckets[bucket_itr] += other.buckets[bucket_itr];
+    }
+    count += other.count;
+  }
+
+  // Upper bound of the bucket that holds the given percentile
+  uint64_t GetPercentile(double percentile) const {
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile * count));
+    uint64_t seen = 0;
+    for (size_t bucket_itr = 0; bucket_itr < BUCKET_COUNT; bucket_itr++) {
+      seen += buckets[bucket_itr];
+      if (seen >= rank && seen > 0) return BucketUpperBound(bucket_itr);
+    }
+    return 0;
+  }
+
+ private:
+  static const size_t SUB_BUCKET_COUNT = 16;
+  static const size_t BUCKET_COUNT = 64 * SUB_BUCKET_COUNT;
+
+  static inline size_t BucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) return value;
+    int shift = 63 - __builtin_clzll(value) - 4;
+    return (shift + 1) * SUB_BUCKET_COUNT +
+           ((value >> shift) & (SUB_BUCKET_COUNT - 1));
+  }
+
+  static inline uint64_t BucketUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKET_COUNT) return bucket;
+    int shift = bucket / SUB_BUCKET_COUNT - 1;
+    uint64_t sub_bucket = bucket % SUB_BUCKET_COUNT;
+    return ((SUB_BUCKET_COUNT + sub_bucket) << shift) + ((1UL << shift) - 1);
+  }
+
+  std::vector<uint64_t> buckets;
+
+  uint64_t count;
+};
+
+// Picks key ids, either uniformly or zipfian (Gray et al., "Quickly
+// generating billion-record synthetic databases") with key 0 the hottest
+class KeyGenerator {
+ public:
+  KeyGenerator(uint64_t key_count, double theta)
+      : key_count(key_count), theta(theta) {
+    if (theta == 0) return;
+
+    zetan = Zeta(key_count, theta);
+    alpha = 1.0 / (1.0 - theta);
+    eta = (1 - std::pow(2.0 / key_count, 1 - theta)) /
+          (1 - Zeta(2, theta) / zetan);
+    half_pow_theta = 1.0 + std::pow(0.5, theta);
+  }
+
+  inline uint64_t operator()(std::mt19937_64 &generator) const {
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    double u = distribution(generator);
+
+    if (theta == 0) return static_cast<uint64_t>(u * key_count) % key_count;
+
+    double uz = u * zetan;
+    if (uz < 1.0) return 0;
+    if (uz < half_pow_theta) return 1 % key_count;
+
+    uint64_t key_id = static_cast<uint64_t>(
+        key_count * std::pow(eta * u - eta + 1, alpha));
+    return std::min(key_id, key_count - 1);
+  }
+
+ private:
+  static double Zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) sum += 1.0 / std::pow(i, theta);
+    return sum;
+  }
+
+  uint64_t key_count;
+  double theta;
+
+  double zetan = 0;
+  double alpha = 0;
+  double eta = 0;
+  double half_pow_theta = 0;
+};
+
+struct WorkerResult {
+  uint64_t read_count = 0;
+  uint64_t write_count = 0;
+  uint64_t scan_count = 0;
+
+  LatencyHistogram latencies;
+};
+
+inline int64_t GetLeadingColumn(uint64_t key_id) {
+  if (state.column_count == 1) return key_id;
+  return key_id / SCAN_GROUP_SIZE;
+}
+
+// One tuple per key, kept for the whole run since TupleKey points into them
+std::vector<std::unique_ptr<storage::Tuple>> BuildKeys(
+    const catalog::Schema *key_schema) {
+  std::vector<std::unique_ptr<storage::Tuple>> keys;
+  keys.reserve(state.key_count);
+
+  for (int key_itr = 0; key_itr < state.key_count; key_itr++) {
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    key->SetValue(0, ValueFactory::GetBigIntValue(GetLeadingColumn(key_itr)),
+                  nullptr);
+    for (int column_itr = 1; column_itr < state.column_count; column_itr++) {
+      key->SetValue(column_itr, ValueFactory::GetBigIntValue(key_itr), nullptr);
+    }
+    keys.push_back(std::move(key));
+  }
+
+  return keys;
+}
+
+void RunWorker(index::Index *index,
+               const std::vector<std::unique_ptr<storage::Tuple>> &keys,
+               const KeyGenerator &key_generator, int thread_id,
+               const std::atomic<bool> &start, const std::atomic<bool> &done,
+               WorkerResult &result) {
+  std::mt19937_64 generator(thread_id);
+  std::uniform_real_distribution<double> op_distribution(0.0, 1.0);
+
+  // Every thread writes its own locations, so a write either adds or
+  // removes one entry of the chosen key
+  std::vector<bool> inserted(keys.size(), false);
+
+  std::vector<oid_t> key_column_ids = {0};
+  std::vector<ExpressionType> expr_types = {EXPRESSION_TYPE_COMPARE_EQUAL};
+
+  while (start.load() == false) std::this_thread::yield();
+
+  while (done.load(std::memory_order_relaxed) == false) {
+    uint64_t key_id = key_generator(generator);
+    double op = op_distribution(generator);
+
+    auto op_start = std::chrono::steady_clock::now();
+
+    if (op < state.write_ratio) {
+      ItemPointer location(key_id, thread_id + 1);
+      if (inserted[key_id]) {
+        index->DeleteEntry(keys[key_id].get(), location);
+      } else {
+        index->InsertEntry(keys[key_id].get(), location);
+      }
+      inserted[key_id] = !inserted[key_id];
+      result.write_count++;
+    } else if (op < state.write_ratio + state.scan_ratio) {
+      std::vector<Value> values = {
+          ValueFactory::GetBigIntValue(GetLeadingColumn(key_id))};
+      index->Scan(values, key_column_ids, expr_types,
+                  SCAN_DIRECTION_TYPE_FORWARD);
+      result.scan_count++;
+    } else {
+      index->ScanKey(keys[key_id].get());
+      result.read_count++;
+    }
+
+    auto op_end = std::chrono::steady_clock::now();
+    result.latencies.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             op_end - op_start).count());
+  }
+}
+
+template <typename IndexKey, class KeyComparator, class KeyEqualityChecker>
+void RunIndex(IndexType index_type) {
+  typedef index::BWTreeIndex<IndexKey, ItemPointer, KeyComparator,
+                             KeyEqualityChecker> BWTreeIndexType;
+
+  // Build tuple and key schema
+  std::vector<catalog::Column> columns;
+  for (int column_itr = 0; column_itr < state.column_count; column_itr++) {
+    columns.push_back(catalog::Column(VALUE_TYPE_BIGINT,
+                                      GetTypeSize(VALUE_TYPE_BIGINT),
+                                      "key_" + std::to_string(column_itr),
+                                      true));
+  }
+
+  std::vector<oid_t> indexed_columns;
+  for (int column_itr = 0; column_itr < state.column_count; column_itr++) {
+    indexed_columns.push_back(column_itr);
+  }
+
+  std::unique_ptr<catalog::Schema> tuple_schema(new catalog::Schema(columns));
+  catalog::Schema *key_schema = new catalog::Schema(columns);
+  key_schema->SetIndexedColumns(indexed_columns);
+
+  index::IndexMetadata *index_metadata = new index::IndexMetadata(
+      "benchmark_index", 1000, index_type, INDEX_CONSTRAINT_TYPE_DEFAULT,
+      tuple_schema.get(), key_schema, false);
+
+  std::unique_ptr<index::Index> index;
+  if (index_type == INDEX_TYPE_BTREE) {
+    index.reset(new index::BTreeIndex<IndexKey, ItemPointer, KeyComparator,
+                                      KeyEqualityChecker>(index_metadata));
+  } else if (index_type == INDEX_TYPE_OLC_BTREE) {
+    index.reset(new index::OLCBTreeIndex<IndexKey, ItemPointer, KeyComparator,
+                                         KeyEqualityChecker>(index_metadata));
+  } else if (index_type == INDEX_TYPE_ART) {
+    // Always keyed by IntsKey, since the key columns are integers
+    index.reset(index::IndexFactory::GetInstance(index_metadata));
+  } else {
+    auto bwtree_index = new BWTreeIndexType(index_metadata);
+    bwtree_index->SetBackgroundMaintenance(state.background_maintenance);
+    index.reset(bwtree_index);
+  }
+
+  auto keys = BuildKeys(key_schema);
+
+  // Load phase
+  auto load_start = std::chrono::steady_clock::now();
+  for (int key_itr = 0; key_itr < state.key_count; key_itr++) {
+    index->InsertEntry(keys[key_itr].get(), ItemPointer(key_itr, 0));
+  }
+  auto load_end = std::chrono::steady_clock::now();
+  double load_duration =
+      std::chrono::duration<double>(load_end - load_start).count();
+
+  // Run phase
+  KeyGenerator key_generator(state.key_count, state.theta);
+  std::atomic<bool> start(false);
+  std::atomic<bool> done(false);
+  std::vector<WorkerResult> results(state.thread_count);
+  std::vector<std::thread> threads;
+
+  for (int thread_itr = 0; thread_itr < state.thread_count; thread_itr++) {
+    threads.push_back(std::thread(RunWorker, index.get(), std::cref(keys),
+                                  std::cref(key_generator), thread_itr,
+                                  std::cref(start), std::cref(done),
+                                  std::ref(results[thread_itr])));
+  }
+
+  auto run_start = std::chrono::steady_clock::now();
+  start = true;
+  std::this_thread::sleep_for(std::chrono::seconds(state.duration));
+  done = true;
+  for (auto &thread : threads) thread.join();
+  auto run_end = std::chrono::steady_clock::now();
+  double run_duration =
+      std::chrono::duration<double>(run_end - run_start).count();
+
+  WorkerResult total;
+  for (auto &result : results) {
+    total.read_count += result.read_count;
+    total.write_count += result.write_count;
+    total.scan_count += result.scan_count;
+    total.latencies.Merge(result.latencies);
+  }
+  uint64_t op_count = total.read_count + total.write_count + total.scan_count;
+
+  std::cout << "----------------------------------------------------------\n";
+  std::cout << std::setw(20) << std::left << "index "
+            << " : " << index->GetTypeName() << std::endl;
+  std::cout << std::setw(20) << std::left << "load ops/sec "
+            << " : " << state.key_count / load_duration << std::endl;
+  std::cout << std::setw(20) << std::left << "ops/sec "
+            << " : " << op_count / run_duration << std::endl;
+  std::cout << std::setw(20) << std::left << "reads/writes/scans "
+            << " : " << total.read_count << "/" << total.write_count << "/"
+            << total.scan_count << std::endl;
+  std::cout << std::setw(20) << std::left << "latency p50 (ns) "
+            << " : " << total.latencies.GetPercentile(0.50) << std::endl;
+  std::cout << std::setw(20) << std::left << "latency p99 (ns) "
+            << " : " << total.latencies.GetPercentile(0.99) << std::endl;
+  std::cout << std::setw(20) << std::left << "latency p999 (ns) "
+            << " : " << total.latencies.GetPercentile(0.999) << std::endl;
+
+  // Memory footprint and whatever else the index counts
+  std::cout << index->GetStatistics();
+}
+
+}  // End anonymous namespace
+
+void RunWorkload(IndexType index_type) {
+  switch (state.key_type) {
+    case KEY_TYPE_INTS:
+      switch (state.column_count) {
+        case 1:
+          RunIndex<index::IntsKey<1>, index::IntsComparator<1>,
+                   index::IntsEqualityChecker<1>>(index_type);
+          break;
+        case 2:
+          RunIndex<index::IntsKey<2>, index::IntsComparator<2>,
+                   index::IntsEqualityChecker<2>>(index_type);
+          break;
+        case 3:
+          RunIndex<index::IntsKey<3>, index::IntsComparator<3>,
+                   index::IntsEqualityChecker<3>>(index_type);
+          break;
+        case 4:
+          RunIndex<index::IntsKey<4>, index::IntsComparator<4>,
+                   index::IntsEqualityChecker<4>>(index_type);
+          break;
+      }
+      break;
+
+    case KEY_TYPE_GENERIC:
+      switch (state.column_count) {
+        case 1:
+          RunIndex<index::GenericKey<8>, index::GenericComparator<8>,
+                   index::GenericEqualityChecker<8>>(index_type);
+          break;
+        case 2:
+          RunIndex<index::GenericKey<16>, index::GenericComparator<16>,
+                   index::GenericEqualityChecker<16>>(index_type);
+          break;
+        case 3:
+          RunIndex<index::GenericKey<24>, index::GenericComparator<24>,
+                   index::GenericEqualityChecker<24>>(index_type);
+          break;
+        case 4:
+          RunIndex<index::GenericKey<32>, index::GenericComparator<32>,
+                   index::GenericEqualityChecker<32>>(index_type);
+          break;
+      }
+      break;
+
+    case KEY_TYPE_TUPLE:
+      RunIndex<index::TupleKey, index::TupleKeyComparator,
+               index::TupleKeyEqualityChecker>(index_type);
+      break;
+
+    default:
+      std::cout << "Unsupported key type : " << state.key_type << "\n";
+      break;
+  }
+}
+
+}  // namespace index_bench
+}  // namespace benchmark
+}  // namespace peloton
@@ -0,0 +1,27 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// workload.h
+//
+// Identification: benchmark/index/workload.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "backend/benchmark/index/index_bench.h"
+
+namespace peloton {
+namespace benchmark {
+namespace index_bench {
+
+// Loads the keys into a fresh index of the given type, runs the configured
+// mix against it and prints throughput, latency and index statistics
+void RunWorkload(IndexType index_type);
+
+}  // namespace index_bench
+}  // namespace benchmark
+}  // namespace peloton
@@ -53,8 +53,7 @@ bool DDLIndex::ExecIndexStmt(Node *parsetree,
 
   IndexInfo *index_info = DDLIndex::ConstructIndexInfoByParsingIndexStmt(Istmt);
 
-  DDLIndex::CreateIndex(*index_info);
-  return true;
+  return DDLIndex::CreateIndex(*index_info);
 }
 
 /**
@@ -79,9 +78,7 @@ bool DDLIndex::CreateIndex(IndexInfo index_info) {
   if (table_name.empty()) return false;
   if (key_column_names.size() <= 0) return false;
 
-  // TODO: We currently only support btree as our index implementation
-  // TODO : Support other types based on "type" argument
-  IndexType our_index_type = INDEX_TYPE_BTREE;
+  IndexType our_index_type = index_info.GetMethodType();
 
   // Get the database oid and table oid
   oid_t database_oid = Bridge::GetCurrentDatabaseOid();
@@ -136,8 +133,13 @@ bool DDLIndex::CreateIndex(IndexInfo index_info) {
       key_schema, unique_keys);
   index::Index *index = index::IndexFactory::GetInstance(metadata);
 
-  // Record the built index in the table
-  data_table->AddIndex(index);
+  // Load the tuples that are already in the table and add the index to it
+  if (data_table->PopulateIndex(index) == false) {
+    LOG_WARN("Could not create index(%lu) %s on %s.", index_oid,
+             index_name.c_str(), table_name.c_str());
+    delete index;
+    return false;
+  }
 
   LOG_INFO("Created index(%lu)  %s on %s.", index_oid, index_name.c_str(),
            table_name.c_str());
@@ -195,9 +197,13 @@ IndexInfo *DDLIndex::ConstructIndexInfoByParsingIndexStmt(IndexStmt *Istmt) {
     index_name = Istmt->idxname;
   }
 
-  // Index method type
+  // Index method type, hash indexes come from CREATE INDEX ... USING hash
   // TODO :: More access method types need
-  method_type = INDEX_TYPE_BTREE;
+  if (Istmt->accessMethod != NULL && strcmp(Istmt->accessMethod, "hash") == 0) {
+    method_type = INDEX_TYPE_HASH;
+  } else {
+    method_type = INDEX_TYPE_BTREE;
+  }
 
   IndexInfo *index_info =
       new IndexInfo(index_name, index_oid, table_name, method_type, type,
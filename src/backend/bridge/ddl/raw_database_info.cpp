@@ -3,6 +3,7 @@
 #include "backend/bridge/ddl/format_transformer.h"
 #include "backend/common/exception.h"
 
+#include "catalog/pg_am.h"
 #include "catalog/pg_class.h"
 #include "access/heapam.h"
 #include "access/htup_details.h"
@@ -89,7 +90,10 @@ void raw_database_info::CollectRawTableAndIndex(void) {
       }
 
       case 'i': {
-        AddRawIndex(relation_oid, relation_name, raw_columns);
+        IndexType method_type =
+            (pg_class->relam == HASH_AM_OID) ? INDEX_TYPE_HASH
+                                             : INDEX_TYPE_BTREE;
+        AddRawIndex(relation_oid, relation_name, raw_columns, method_type);
         break;
       }
 
@@ -280,7 +284,8 @@ void raw_database_info::AddRawTable(oid_t table_oid, std::string table_name,
 }
 
 void raw_database_info::AddRawIndex(oid_t index_oid, std::string index_name,
-                                    std::vector<raw_column_info> raw_columns) {
+                                    std::vector<raw_column_info> raw_columns,
+                                    IndexType method_type) {
   Relation pg_index_rel;
   HeapScanDesc pg_index_scan;
   HeapTuple pg_index_tuple;
@@ -306,7 +311,6 @@ void raw_database_info::AddRawIndex(oid_t index_oid, std::string index_name,
         key_column_names.push_back(raw_column.GetColName());
       }
 
-      IndexType method_type = INDEX_TYPE_BTREE;
       IndexConstraintType type;
 
       if (pg_index->indisprimary) {
@@ -40,7 +40,8 @@ class raw_database_info {
                    std::vector<raw_column_info> raw_columns);
 
   void AddRawIndex(oid_t index_oid, std::string index_name,
-                   std::vector<raw_column_info> raw_columns);
+                   std::vector<raw_column_info> raw_columns,
+                   IndexType method_type);
 
   void AddRawForeignKey(raw_foreign_key_info raw_foreign_key);
 
@@ -610,6 +610,15 @@ std::string IndexTypeToString(IndexType type) {
     case INDEX_TYPE_BWTREE: {
       return "BWTREE";
     }
+    case INDEX_TYPE_HASH: {
+      return "HASH";
+    }
+    case INDEX_TYPE_OLC_BTREE: {
+      return "OLC_BTREE";
+    }
+    case INDEX_TYPE_ART: {
+      return "ART";
+    }
   }
   return "INVALID";
 }
@@ -621,6 +630,12 @@ IndexType StringToIndexType(std::string str) {
     return INDEX_TYPE_BTREE;
   }  else if (str == "BWTREE") {
     return INDEX_TYPE_BWTREE;
+  } else if (str == "HASH") {
+    return INDEX_TYPE_HASH;
+  } else if (str == "OLC_BTREE") {
+    return INDEX_TYPE_OLC_BTREE;
+  } else if (str == "ART") {
+    return INDEX_TYPE_ART;
   }
   return INDEX_TYPE_INVALID;
 }
@@ -342,7 +342,10 @@ enum IndexType {
   INDEX_TYPE_INVALID = 0,  // invalid index type
 
   INDEX_TYPE_BTREE = 1,  // btree
-  INDEX_TYPE_BWTREE = 2  // bwtree
+  INDEX_TYPE_BWTREE = 2,  // bwtree
+  INDEX_TYPE_HASH = 3,    // hash
+  INDEX_TYPE_OLC_BTREE = 4,  // btree with optimistic lock coupling
+  INDEX_TYPE_ART = 5         // adaptive radix tree, integer keys only
 };
 
 enum IndexConstraintType {
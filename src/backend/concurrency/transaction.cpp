@@ -51,12 +51,6 @@ const std::string Transaction::GetInfo() const{
      << " Last Commit ID : " << std::setw(4) << last_cid
      << " Result : " << result_;
 
-  if (next == nullptr) {
-    os << " Next : " << std::setw(4) << next;
-  } else {
-    os << " Next : " << std::setw(4) << next->txn_id;
-  }
-
   os << " Ref count : " << std::setw(4) << ref_count << "\n";
   return os.str();
 }
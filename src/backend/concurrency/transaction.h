@@ -38,23 +38,13 @@ class Transaction : public Printable {
       : txn_id(INVALID_TXN_ID),
         cid(INVALID_CID),
         last_cid(INVALID_CID),
-        ref_count(BASE_REF_COUNT),
-        waiting_to_commit(false),
-        next(nullptr) {}
+        ref_count(BASE_REF_COUNT) {}
 
   Transaction(txn_id_t txn_id, cid_t last_cid)
       : txn_id(txn_id),
         cid(INVALID_CID),
         last_cid(last_cid),
-        ref_count(BASE_REF_COUNT),
-        waiting_to_commit(false),
-        next(nullptr) {}
-
-  ~Transaction() {
-    if (next != nullptr) {
-      next->DecrementRefCount();
-    }
-  }
+        ref_count(BASE_REF_COUNT) {}
 
   //===--------------------------------------------------------------------===//
   // Mutators and Accessors
@@ -111,12 +101,6 @@ class Transaction : public Printable {
   // references
   std::atomic<size_t> ref_count;
 
-  // waiting for commit ?
-  std::atomic<bool> waiting_to_commit;
-
-  // cid context
-  Transaction *next __attribute__((aligned(16)));
-
   // inserted tuples
   std::map<oid_t, std::vector<oid_t>> inserted_tuples;
 
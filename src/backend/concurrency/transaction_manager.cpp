@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <iomanip>
@@ -38,14 +39,17 @@ TransactionManager::TransactionManager() {
 
   // BASE transaction
   // All transactions are based on this transaction
-  last_txn = new Transaction(START_TXN_ID, START_CID);
-  last_txn->cid = START_CID;
+  Transaction *base_txn = new Transaction(START_TXN_ID, START_CID);
+  base_txn->cid = START_CID;
+  last_txn = base_txn;
   last_cid = START_CID;
+
+  for (auto &committed_cid : committed_cids) committed_cid = INVALID_CID;
 }
 
 TransactionManager::~TransactionManager() {
-  // delete BASE txn
-  delete last_txn;
+  // drop the last committed txn
+  last_txn.load()->DecrementRefCount();
 }
 
 txn_id_t TransactionManager::GetNextTransactionId() {
@@ -58,8 +62,15 @@ txn_id_t TransactionManager::GetNextTransactionId() {
 
 // Begin a new transaction
 Transaction *TransactionManager::BeginTransaction() {
-  Transaction *next_txn =
-      new Transaction(GetNextTransactionId(), GetLastCommitId());
+  Transaction *next_txn = new Transaction(GetNextTransactionId(), INVALID_CID);
+  auto &partition = txn_table[next_txn->txn_id % TXN_TABLE_PARTITIONS];
+
+  // Take the snapshot and register it in one go, so that the vacuum never
+  // misses a snapshot older than the one it computed
+  partition.lock.Lock();
+  next_txn->last_cid = GetLastCommitId();
+  partition.txns[next_txn->txn_id] = next_txn;
+  partition.lock.Unlock();
 
   // Log the BEGIN TXN record
   {
@@ -78,6 +89,44 @@ Transaction *TransactionManager::BeginTransaction() {
   return next_txn;
 }
 
+Transaction *TransactionManager::GetTransaction(txn_id_t txn_id) {
+  Transaction *txn = nullptr;
+  auto &partition = txn_table[txn_id % TXN_TABLE_PARTITIONS];
+
+  partition.lock.Lock();
+  auto entry = partition.txns.find(txn_id);
+  if (entry != partition.txns.end()) txn = entry->second;
+  partition.lock.Unlock();
+
+  return txn;
+}
+
+std::vector<Transaction *> TransactionManager::GetCurrentTransactions() {
+  std::vector<Transaction *> txns;
+  for (auto &partition : txn_table) {
+    partition.lock.Lock();
+    for (auto entry : partition.txns) txns.push_back(entry.second);
+    partition.lock.Unlock();
+  }
+  return txns;
+}
+
+cid_t TransactionManager::GetOldestActiveCommitId() {
+  // Read before going over the partitions. A transaction that registers in
+  // a partition after we looked at it reads at this commit id or later.
+  cid_t oldest_cid = GetLastCommitId();
+
+  for (auto &partition : txn_table) {
+    partition.lock.Lock();
+    for (auto entry : partition.txns) {
+      oldest_cid = std::min(oldest_cid, entry.second->GetLastCommitId());
+    }
+    partition.lock.Unlock();
+  }
+
+  return oldest_cid;
+}
+
 bool TransactionManager::IsValid(txn_id_t txn_id) {
   return (txn_id < next_txn_id);
 }
@@ -88,20 +137,30 @@ void TransactionManager::ResetStates(void) {
 
   // BASE transaction
   // All transactions are based on this transaction
-  delete last_txn;
-  last_txn = new Transaction(START_TXN_ID, START_CID);
-  last_txn->cid = START_CID;
+  Transaction *base_txn = new Transaction(START_TXN_ID, START_CID);
+  base_txn->cid = START_CID;
+  last_txn.exchange(base_txn)->DecrementRefCount();
   last_cid = START_CID;
 
-  for (auto txn : txn_table) {
-    auto curr_txn = txn.second;
-    delete curr_txn;
+  for (auto &committed_cid : committed_cids) committed_cid = INVALID_CID;
+
+  // the transactions themselves are reference counted
+  for (auto &partition : txn_table) {
+    partition.lock.Lock();
+    partition.txns.clear();
+    partition.lock.Unlock();
   }
-  txn_table.clear();
 }
 
 void TransactionManager::EndTransaction(Transaction *txn,
                                         bool sync __attribute__((unused))) {
+  {
+    auto &partition = txn_table[txn->txn_id % TXN_TABLE_PARTITIONS];
+    partition.lock.Lock();
+    partition.txns.erase(txn->txn_id);
+    partition.lock.Unlock();
+  }
+
   // Log the END TXN record
   {
     auto &log_manager = logging::LogManager::GetInstance();
@@ -130,26 +189,13 @@ TransactionManager &TransactionManager::GetInstance() {
 }
 
 void TransactionManager::BeginCommitPhase(Transaction *txn) {
-  // successor in the transaction list will point to us
-  txn->IncrementRefCount();
+  // commit ids are handed out in order, without a lock
+  txn->cid = ++next_cid;
 
-  {
-    std::lock_guard<std::mutex> lock(txn_table_mutex);
-
-    // append to the pending transaction list
-    last_txn->next = txn;
-
-    // the last transaction pointer also points to us
-    txn->IncrementRefCount();
-
-    // assign cid to the txn
-    txn->cid = last_txn->cid + 1;
-
-    auto tmp = last_txn;
-    last_txn = txn;
-
-    // drop a reference to previous last transaction pointer
-    tmp->DecrementRefCount();
+  // the queue slot of the commit id must not be taken by an older one that
+  // is not published yet
+  while (txn->cid - GetLastCommitId() > COMMIT_QUEUE_SIZE) {
+    std::this_thread::yield();
   }
 }
 
@@ -187,67 +233,44 @@ void TransactionManager::CommitModifications(Transaction *txn, bool sync
   }
 }
 
-void TransactionManager::CommitPendingTransactions(
-    std::vector<Transaction *> &pending_txns, Transaction *txn) {
-  // add ourself to the list
-  pending_txns.push_back(txn);
-
-  // commit all pending transactions
-  auto next_txn = txn->next;
-
-  while (next_txn != nullptr && next_txn->waiting_to_commit == true) {
-    // try to increment last finished cid
-    if (atomic_cas(&last_cid, next_txn->cid - 1, next_txn->cid)) {
-      // if that worked, add transaction to list
-      pending_txns.push_back(next_txn);
-      LOG_TRACE("Pending Txn  : %lu ", next_txn->txn_id);
-
-      next_txn = next_txn->next;
-      continue;
+void TransactionManager::PublishCommitIds() {
+  while (true) {
+    // Somebody else is publishing. They check the queue again after letting
+    // go of the lock, so they also publish the ids that are done by now.
+    if (publish_lock.TryLock() == false) return;
+
+    // Publish the whole run of done commit ids with one store
+    cid_t published_cid = last_cid;
+    while (committed_cids[(published_cid + 1) % COMMIT_QUEUE_SIZE] ==
+           published_cid + 1) {
+      published_cid++;
     }
-    // it did not work, so some other txn must have squeezed in
-    // so, stop processing commit dependencies
-    else {
-      break;
-    }
-  }
-}
+    last_cid = published_cid;
+    LOG_TRACE("Published commit ids up to %lu", published_cid);
 
-std::vector<Transaction *> TransactionManager::EndCommitPhase(Transaction *txn,
-                                                              bool sync) {
-  std::vector<Transaction *> txn_list;
+    publish_lock.Unlock();
 
-  // try to increment last commit id
-  if (atomic_cas(&last_cid, txn->cid - 1, txn->cid)) {
-    LOG_TRACE("update lcid worked : %lu ", txn->txn_id);
-
-    // everything went fine and the txn was committed
-    // if that worked, commit all pending transactions
-    CommitPendingTransactions(txn_list, txn);
+    // The unlock is only a release store, which a later load may pass. The
+    // fence keeps us from missing a commit id that was marked by a thread
+    // that still found the lock taken.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 
+    // A commit id may have been marked while we held the lock
+    if (committed_cids[(published_cid + 1) % COMMIT_QUEUE_SIZE] !=
+        published_cid + 1)
+      return;
   }
-  // it did not work, so add to waiting list
-  // some other transaction with lower commit id will commit us later
-  else {
-    LOG_TRACE("add to wait list : %lu ", txn->txn_id);
-
-    txn->waiting_to_commit = true;
+}
 
-    // make sure that the transaction we are waiting for has not finished
-    // before we could add ourselves to the list of pending transactions
-    // we try incrementing the last finished cid again
-    if (atomic_cas(&last_cid, txn->cid - 1, txn->cid)) {
-      // it worked on the second try
-      txn->waiting_to_commit = false;
+void TransactionManager::EndCommitPhase(Transaction *txn, bool sync) {
+  // Mark the commit id as done. If an older commit is still in progress,
+  // whoever finishes it publishes ours too.
+  committed_cids[txn->cid % COMMIT_QUEUE_SIZE] = txn->cid;
 
-      CommitPendingTransactions(txn_list, txn);
-    }
-  }
+  PublishCommitIds();
 
   // clear txn entry in txn table
   EndTransaction(txn, sync);
-
-  return std::move(txn_list);
 }
 
 void TransactionManager::CommitTransaction(bool sync) {
@@ -258,11 +281,11 @@ void TransactionManager::CommitTransaction(bool sync) {
   // commit all modifications
   CommitModifications(current_txn, sync);
 
-  // end commit phase : increment last_cid and process pending txns if needed
-  std::vector<Transaction *> committed_txns = EndCommitPhase(current_txn, sync);
+  // end commit phase : publish the commit id, maybe along with others
+  EndCommitPhase(current_txn, sync);
 
-  // process all committed txns
-  for (auto committed_txn : committed_txns) committed_txn->DecrementRefCount();
+  // keep the txn around until the next commit, drop the previous one
+  last_txn.exchange(current_txn)->DecrementRefCount();
 
   // XXX LOG : group commit entry
   // we already record commit entry in CommitModifications, isn't it?
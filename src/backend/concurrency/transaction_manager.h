@@ -17,9 +17,14 @@
 #include <vector>
 #include <map>
 #include <mutex>
+#include <unordered_map>
 
+#include "backend/common/platform.h"
 #include "backend/common/types.h"
 
+#define TXN_TABLE_PARTITIONS 16  // # of separately locked txn table parts
+#define COMMIT_QUEUE_SIZE 4096   // # of commit ids that may wait for publishing
+
 namespace peloton {
 namespace concurrency {
 
@@ -43,7 +48,14 @@ class TransactionManager {
   txn_id_t GetNextTransactionId();
 
   // Get last commit id for visibility checks
-  cid_t GetLastCommitId() { return last_cid; }
+  cid_t GetLastCommitId() { return last_cid.load(); }
+
+  // Commit id the next committing transaction gets
+  cid_t GetNextCommitId() { return next_cid.load() + 1; }
+
+  // Oldest last commit id any running transaction reads at. Versions that
+  // were deleted at or before it are invisible to all of them.
+  cid_t GetOldestActiveCommitId();
 
   //===--------------------------------------------------------------------===//
   // Transaction processing
@@ -71,14 +83,13 @@ class TransactionManager {
 
   // COMMIT
 
+  // assign the commit id
   void BeginCommitPhase(Transaction *txn);
 
   void CommitModifications(Transaction *txn, bool sync = true);
 
-  void CommitPendingTransactions(std::vector<Transaction *> &txns,
-                                 Transaction *txn);
-
-  std::vector<Transaction *> EndCommitPhase(Transaction *txn, bool sync = true);
+  // mark the commit id as done and publish what can be published
+  void EndCommitPhase(Transaction *txn, bool sync = true);
 
   void CommitTransaction(bool sync = true);
 
@@ -87,24 +98,40 @@ class TransactionManager {
   void AbortTransaction();
 
  private:
+  // Move last_cid past all commit ids that are done, up to the first one
+  // that is still in progress
+  void PublishCommitIds();
+
   //===--------------------------------------------------------------------===//
   // MEMBERS
   //===--------------------------------------------------------------------===//
 
   std::atomic<txn_id_t> next_txn_id;
 
+  // last commit id handed out
   std::atomic<cid_t> next_cid;
 
-  cid_t last_cid __attribute__((aligned(16)));
+  // all commit ids up to this one are done and visible
+  std::atomic<cid_t> last_cid;
 
-  Transaction *last_txn;
+  // last committed transaction, kept alive until the next commit
+  std::atomic<Transaction *> last_txn;
 
-  // Table tracking all active transactions
+  // Table tracking all active transactions, from begin to end, split by
+  // transaction id so that concurrent begins and ends rarely share a lock
   // Our transaction id -> our transaction
-  // Sync access with txn_table_mutex
-  std::map<txn_id_t, Transaction *> txn_table;
+  struct alignas(64) TransactionTablePartition {
+    Spinlock lock;
+    std::unordered_map<txn_id_t, Transaction *> txns;
+  };
+
+  TransactionTablePartition txn_table[TXN_TABLE_PARTITIONS];
+
+  // Commit ids that are done, at commit id % COMMIT_QUEUE_SIZE. Whoever gets
+  // publish_lock moves last_cid past a whole run of them at once.
+  std::atomic<cid_t> committed_cids[COMMIT_QUEUE_SIZE];
 
-  std::mutex txn_table_mutex;
+  Spinlock publish_lock;
 };
 
 }  // End concurrency namespace
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// vacuum.cpp
+//
+// Identification: src/backend/concurrency/vacuum.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>
+
+#include "backend/concurrency/vacuum.h"
+
+#include "backend/catalog/manager.h"
+#include "backend/common/logger.h"
+#include "backend/concurrency/transaction_manager.h"
+#include "backend/storage/data_table.h"
+#include "backend/storage/database.h"
+
+namespace peloton {
+namespace concurrency {
+
+Vacuum &Vacuum::GetInstance() {
+  static Vacuum vacuum;
+  return vacuum;
+}
+
+Vacuum::~Vacuum() { SetBackgroundVacuum(false); }
+
+size_t Vacuum::VacuumDatabases() {
+  auto &manager = catalog::Manager::GetInstance();
+  auto &txn_manager = TransactionManager::GetInstance();
+
+  // Transactions that begin from here on read at a later commit id
+  cid_t oldest_cid = txn_manager.GetOldestActiveCommitId();
+  size_t reclaimed_count = 0;
+
+  oid_t database_count = manager.GetDatabaseCount();
+  for (oid_t database_itr = 0; database_itr < database_count;
+       database_itr++) {
+    auto database = manager.GetDatabase(database_itr);
+
+    oid_t table_count = database->GetTableCount();
+    for (oid_t table_itr = 0; table_itr < table_count; table_itr++) {
+      auto table = database->GetTable(table_itr);
+      reclaimed_count += table->Vacuum(oldest_cid);
+    }
+  }
+
+  LOG_TRACE("Vacuumed %lu slots below cid %lu", reclaimed_count, oldest_cid);
+  return reclaimed_count;
+}
+
+void Vacuum::SetBackgroundVacuum(bool enabled) {
+  std::unique_lock<std::mutex> lock(vacuum_mutex);
+  if (enabled == !vacuum_stopped) return;
+
+  if (enabled) {
+    vacuum_stopped = false;
+    vacuum_thread = std::thread(&Vacuum::RunVacuum, this);
+    return;
+  }
+
+  vacuum_stopped = true;
+  lock.unlock();
+  vacuum_cv.notify_one();
+  vacuum_thread.join();
+}
+
+bool Vacuum::IsBackgroundVacuumEnabled() {
+  std::lock_guard<std::mutex> lock(vacuum_mutex);
+  return !vacuum_stopped;
+}
+
+void Vacuum::RunVacuum() {
+  std::unique_lock<std::mutex> lock(vacuum_mutex);
+  while (true) {
+    vacuum_cv.wait_for(lock, std::chrono::milliseconds(VACUUM_INTERVAL_MS),
+                       [this] { return vacuum_stopped; });
+    if (vacuum_stopped) break;
+
+    lock.unlock();
+    VacuumDatabases();
+    lock.lock();
+  }
+  LOG_DEBUG("Vacuum thread exiting...");
+}
+
+}  // End concurrency namespace
+}  // End peloton namespace
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// vacuum.h
+//
+// Identification: src/backend/concurrency/vacuum.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "backend/common/types.h"
+
+#define VACUUM_INTERVAL_MS 100  // pause between background vacuum passes
+
+namespace peloton {
+namespace concurrency {
+
+//===--------------------------------------------------------------------===//
+// Vacuum
+//===--------------------------------------------------------------------===//
+
+/**
+ * Reclaims the slots of tuple versions that no transaction can see anymore,
+ * i.e. that were deleted at or before the oldest snapshot of the running
+ * transactions. See DataTable::Vacuum for the per table work.
+ */
+class Vacuum {
+ public:
+  Vacuum(Vacuum const &) = delete;
+
+  ~Vacuum();
+
+  static Vacuum &GetInstance();
+
+  // Vacuum all tables in the catalog once
+  // Returns the # of slots reclaimed
+  size_t VacuumDatabases();
+
+  // Start or stop the background thread that vacuums every interval
+  void SetBackgroundVacuum(bool enabled);
+
+  bool IsBackgroundVacuumEnabled();
+
+ private:
+  Vacuum() {}
+
+  void RunVacuum();
+
+  //===--------------------------------------------------------------------===//
+  // MEMBERS
+  //===--------------------------------------------------------------------===//
+
+  std::thread vacuum_thread;
+
+  bool vacuum_stopped = true;
+
+  std::mutex vacuum_mutex;
+
+  // wakes up the thread when it is stopped
+  std::condition_variable vacuum_cv;
+};
+
+}  // End concurrency namespace
+}  // End peloton namespace
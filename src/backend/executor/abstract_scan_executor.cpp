@@ -20,6 +20,7 @@
 #include "backend/executor/logical_tile.h"
 #include "backend/executor/logical_tile_factory.h"
 #include "backend/expression/abstract_expression.h"
+#include "backend/expression/container_batch.h"
 #include "backend/expression/container_tuple.h"
 #include "backend/storage/data_table.h"
 #include "backend/storage/tile_group.h"
@@ -56,5 +57,29 @@ bool AbstractScanExecutor::DInit() {
   return true;
 }
 
+oid_t AbstractScanExecutor::ApplyPredicate(LogicalTile *tile) {
+  assert(predicate_ != nullptr);
+
+  expression::SelectionVector visible_rows;
+  for (oid_t tuple_id : *tile) visible_rows.push_back(tuple_id);
+
+  // Rows for which the predicate is null stay visible
+  expression::SelectionVector kept_rows(visible_rows);
+  expression::ContainerBatch<LogicalTile> batch(tile);
+  predicate_->FilterBatch(batch, kept_rows, executor_context_, true);
+
+  oid_t removed_count = 0;
+  auto kept_itr = kept_rows.begin();
+  for (oid_t tuple_id : visible_rows) {
+    if (kept_itr != kept_rows.end() && *kept_itr == tuple_id) {
+      kept_itr++;
+      continue;
+    }
+    tile->RemoveVisibility(tuple_id);
+    removed_count++;
+  }
+  return removed_count;
+}
+
 }  // namespace executor
 }  // namespace peloton
@@ -39,6 +39,10 @@ class AbstractScanExecutor : public AbstractExecutor {
 
   bool DExecute() = 0;
 
+  // Removes the rows of the tile for which the predicate is false
+  // Returns the # of removed rows
+  oid_t ApplyPredicate(LogicalTile *tile);
+
  protected:
   //===--------------------------------------------------------------------===//
   // Plan Info
@@ -12,10 +12,14 @@
 
 #include "backend/executor/index_scan_executor.h"
 
+#include <algorithm>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
+#include "backend/catalog/manager.h"
+#include "backend/catalog/schema.h"
 #include "backend/common/types.h"
 #include "backend/executor/logical_tile.h"
 #include "backend/executor/logical_tile_factory.h"
@@ -24,7 +28,10 @@
 #include "backend/expression/container_tuple.h"
 #include "backend/index/index.h"
 #include "backend/storage/data_table.h"
+#include "backend/storage/tile.h"
 #include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
+#include "backend/storage/tuple.h"
 #include "backend/common/logger.h"
 
 namespace peloton {
@@ -38,9 +45,7 @@ IndexScanExecutor::IndexScanExecutor(const planner::AbstractPlan *node,
                                      ExecutorContext *executor_context)
     : AbstractScanExecutor(node, executor_context) {}
 
-IndexScanExecutor::~IndexScanExecutor() {
-  // Nothing to do here
-}
+IndexScanExecutor::~IndexScanExecutor() { ClearResult(); }
 
 /**
  * @brief Let base class Dinit() first, then do my job.
@@ -59,7 +64,8 @@ bool IndexScanExecutor::DInit() {
   index_ = node.GetIndex();
   assert(index_ != nullptr);
 
-  result_itr = START_OID;
+  ClearResult();
+  cursor_.Reset();
   done_ = false;
 
   column_ids_ = node.GetColumnIds();
@@ -68,6 +74,7 @@ bool IndexScanExecutor::DInit() {
   values_ = node.GetValues();
   runtime_keys_ = node.GetRunTimeKeys();
   predicate_ = node.GetPredicate();
+  output_key_columns_ = node.GetOutputKeyColumns();
 
   if (runtime_keys_.size() != 0) {
     assert(runtime_keys_.size() == values_.size());
@@ -102,42 +109,51 @@ bool IndexScanExecutor::DInit() {
 bool IndexScanExecutor::DExecute() {
   LOG_INFO("Index Scan executor :: 0 child");
 
-  if (!done_) {
-    auto status = ExecIndexLookup();
-    if (status == false) return false;
-    ExecPredication();
-    ExecProjection();
-  }
+  while (true) {
+    while (result_itr < result.size()) {  // Avoid returning empty tiles
+      std::unique_ptr<LogicalTile> tile(result[result_itr]);
+      result[result_itr] = nullptr;
+      result_itr++;
+
+      if (tile->GetTupleCount() > 0) {
+        SetOutput(tile.release());
+        return true;
+      }
+    }
 
-  // Already performed the index lookup
-  assert(done_);
+    // Only go back to the index once the last batch has been consumed, so
+    // that a parent that stops early saves the rest of the scan
+    if (done_) return false;
 
-  while (result_itr < result.size()) {  // Avoid returning empty tiles
-    if (result[result_itr]->GetTupleCount() == 0) {
-      result_itr++;
-      continue;
+    ClearResult();
+
+    // Index-only scans build their output from the key columns directly
+    bool index_only = false;
+    if (HasProbeBatch()) {
+      ExecIndexProbes();
     } else {
-      SetOutput(result[result_itr]);
-      result_itr++;
-      return true;
+      ExecIndexLookup();
+      index_only = !output_key_columns_.empty();
     }
 
-  }  // end while
+    if (!index_only) {
+      ExecPredication();
+      ExecProjection();
+    }
+  }
+}
 
-  return false;
+void IndexScanExecutor::ClearResult() {
+  for (auto tile : result) delete tile;
+  result.clear();
+  result_itr = START_OID;
 }
 
 void IndexScanExecutor::ExecPredication() {
   if (nullptr == predicate_) return;
   unsigned int removed_count = 0;
   for (auto tile : result) {
-    for (auto tuple_id : *tile) {
-      expression::ContainerTuple<LogicalTile> tuple(tile, tuple_id);
-      if (predicate_->Evaluate(&tuple, nullptr, executor_context_).IsFalse()) {
-        removed_count++;
-        tile->RemoveVisibility(tuple_id);
-      }
-    }
+    removed_count += ApplyPredicate(tile);
   }
   LOG_INFO("predicate removed %d row", removed_count);
 }
@@ -150,7 +166,7 @@ void IndexScanExecutor::ExecProjection() {
   }
 }
 
-bool IndexScanExecutor::ExecIndexLookup() {
+void IndexScanExecutor::ExecIndexLookup() {
   assert(!done_);
 
   /*
@@ -160,7 +176,7 @@ bool IndexScanExecutor::ExecIndexLookup() {
    * We can add more cases in future
    */
   //TODO: we probably need to add more for other cases in future
-  if (executor_context_->GetParamsExec() == 1) {
+  if (cursor_.key == nullptr && executor_context_->GetParamsExec() == 1) {
 	  values_.clear();
 	  std::vector<Value> vecValue = executor_context_->GetParams();
 
@@ -169,18 +185,24 @@ bool IndexScanExecutor::ExecIndexLookup() {
 	  }
   }
 
-  std::vector<ItemPointer> tuple_locations;
+  if (!output_key_columns_.empty()) {
+    ExecIndexOnlyLookup();
+    done_ = cursor_.done;
 
-  if (0 == key_column_ids_.size()) {
-    tuple_locations = index_->ScanAllKeys();
-  } else {
-    tuple_locations = index_->Scan(values_, key_column_ids_, expr_types_,
-                                   SCAN_DIRECTION_TYPE_FORWARD);
+    LOG_INFO("Index-only result tiles : %lu", result.size());
+    return;
   }
 
+  // Next batch of the scan
+  std::vector<ItemPointer> tuple_locations =
+      index_->ScanBatch(values_, key_column_ids_, expr_types_,
+                        SCAN_DIRECTION_TYPE_FORWARD, INDEX_SCAN_BATCH_SIZE,
+                        cursor_);
+  done_ = cursor_.done;
+
   LOG_INFO("Tuple_locations.size(): %lu", tuple_locations.size());
 
-  if (tuple_locations.size() == 0) return false;
+  if (tuple_locations.size() == 0) return;
 
   auto transaction_ = executor_context_->GetTransaction();
   txn_id_t txn_id = transaction_->GetTransactionId();
@@ -190,11 +212,176 @@ bool IndexScanExecutor::ExecIndexLookup() {
   result = LogicalTileFactory::WrapTileGroups(tuple_locations, full_column_ids_,
                                               txn_id, commit_id);
 
+  LOG_TRACE("Result tiles : %lu", result.size());
+}
+
+/**
+ * @brief Whether a nested loop join handed over the join keys of an outer
+ * tile, one set of values for the key columns per outer row.
+ */
+bool IndexScanExecutor::HasProbeBatch() {
+  if (executor_context_->GetParamsExec() != 1 || key_column_ids_.empty())
+    return false;
+
+  return executor_context_->GetParams().size() % key_column_ids_.size() == 0;
+}
+
+/**
+ * @brief Looks up the locations matching any of the probes in the batch.
+ * Probes that fix the whole key are looked up with a single call to the
+ * index, the others are scanned one by one.
+ */
+void IndexScanExecutor::ExecIndexProbes() {
+  const std::vector<Value> &params = executor_context_->GetParams();
+  const size_t key_count = key_column_ids_.size();
+  const size_t probe_count = params.size() / key_count;
+
+  // Every key column has to be compared for equality exactly once
+  bool full_key_probes = (key_count == index_->GetColumnCount());
+  std::vector<bool> key_column_seen(key_count, false);
+  for (oid_t key_itr = 0; full_key_probes && key_itr < key_count; key_itr++) {
+    oid_t key_column_id = key_column_ids_[key_itr];
+    if (expr_types_[key_itr] != EXPRESSION_TYPE_COMPARE_EQUAL ||
+        key_column_id >= key_count || key_column_seen[key_column_id]) {
+      full_key_probes = false;
+    } else {
+      key_column_seen[key_column_id] = true;
+    }
+  }
+
+  std::vector<ItemPointer> tuple_locations;
+
+  if (full_key_probes) {
+    auto key_schema = index_->GetKeySchema();
+    auto pool = executor_context_->GetExecutorContextPool();
+
+    std::vector<std::unique_ptr<storage::Tuple>> key_tuples;
+    std::vector<const storage::Tuple *> keys;
+    for (size_t probe_itr = 0; probe_itr < probe_count; probe_itr++) {
+      std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+      for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+        key->SetValue(key_column_ids_[key_itr],
+                      params[probe_itr * key_count + key_itr], pool);
+      }
+      keys.push_back(key.get());
+      key_tuples.push_back(std::move(key));
+    }
+
+    for (auto &locations : index_->ScanKeys(keys)) {
+      tuple_locations.insert(tuple_locations.end(), locations.begin(),
+                             locations.end());
+    }
+  } else {
+    for (size_t probe_itr = 0; probe_itr < probe_count; probe_itr++) {
+      std::vector<Value> probe_values(
+          params.begin() + probe_itr * key_count,
+          params.begin() + (probe_itr + 1) * key_count);
+      auto locations = index_->Scan(probe_values, key_column_ids_,
+                                    expr_types_, SCAN_DIRECTION_TYPE_FORWARD);
+      tuple_locations.insert(tuple_locations.end(), locations.begin(),
+                             locations.end());
+    }
+  }
+
+  // Outer rows with the same join key find the same tuples
+  std::sort(tuple_locations.begin(), tuple_locations.end(),
+            [](const ItemPointer &a, const ItemPointer &b) {
+              return a.block < b.block ||
+                     (a.block == b.block && a.offset < b.offset);
+            });
+  tuple_locations.erase(
+      std::unique(tuple_locations.begin(), tuple_locations.end(),
+                  [](const ItemPointer &a, const ItemPointer &b) {
+                    return a.block == b.block && a.offset == b.offset;
+                  }),
+      tuple_locations.end());
+
   done_ = true;
 
-  LOG_TRACE("Result tiles : %lu", result.size());
+  LOG_INFO("Probes: %lu, tuple_locations.size(): %lu", probe_count,
+           tuple_locations.size());
 
-  return true;
+  if (tuple_locations.size() == 0) return;
+
+  auto transaction_ = executor_context_->GetTransaction();
+  txn_id_t txn_id = transaction_->GetTransactionId();
+  cid_t commit_id = transaction_->GetLastCommitId();
+
+  result = LogicalTileFactory::WrapTileGroups(tuple_locations, full_column_ids_,
+                                              txn_id, commit_id);
+}
+
+/**
+ * @brief Builds the output of the next batch from the keys of the index
+ * entries found, reading only the tile group headers for the visibility
+ * checks.
+ */
+void IndexScanExecutor::ExecIndexOnlyLookup() {
+  auto transaction_ = executor_context_->GetTransaction();
+  txn_id_t txn_id = transaction_->GetTransactionId();
+  cid_t commit_id = transaction_->GetLastCommitId();
+  auto &manager = catalog::Manager::GetInstance();
+
+  std::unique_ptr<catalog::Schema> output_schema(
+      catalog::Schema::CopySchema(index_->GetKeySchema(), output_key_columns_));
+  const oid_t output_column_count = output_key_columns_.size();
+
+  std::shared_ptr<storage::Tile> output_tile;
+  oid_t output_tuple_id = 0;
+
+  // Consecutive entries mostly point into the same tile group
+  std::shared_ptr<storage::TileGroup> tile_group;
+  oid_t tile_group_id = INVALID_OID;
+
+  auto visitor = [&](const AbstractTuple &key, const ItemPointer &location) {
+    if (location.block != tile_group_id) {
+      tile_group = manager.GetTileGroup(location.block);
+      tile_group_id = location.block;
+    }
+
+    if (!tile_group->GetHeader()->IsVisible(location.offset, txn_id,
+                                            commit_id))
+      return;
+
+    // A batch never has more entries than fit into one tile
+    if (output_tile == nullptr) {
+      output_tile.reset(storage::TileFactory::GetTempTile(
+          *output_schema, INDEX_SCAN_BATCH_SIZE));
+    }
+
+    for (oid_t column_itr = 0; column_itr < output_column_count; column_itr++) {
+      output_tile->SetValue(key.GetValue(output_key_columns_[column_itr]),
+                            output_tuple_id, column_itr);
+    }
+    output_tuple_id++;
+  };
+
+  index_->ScanEntries(values_, key_column_ids_, expr_types_,
+                      SCAN_DIRECTION_TYPE_FORWARD, INDEX_SCAN_BATCH_SIZE,
+                      cursor_, visitor);
+
+  if (output_tuple_id > 0) AddIndexOnlyTile(output_tile, output_tuple_id);
+}
+
+/**
+ * @brief Wraps the first tuple_count tuples of a physical tile built by an
+ * index-only scan.
+ */
+void IndexScanExecutor::AddIndexOnlyTile(
+    const std::shared_ptr<storage::Tile> &tile, oid_t tuple_count) {
+  LogicalTile *logical_tile = LogicalTileFactory::GetTile();
+
+  std::vector<oid_t> position_list(tuple_count);
+  std::iota(position_list.begin(), position_list.end(), 0);
+  const oid_t position_list_idx =
+      logical_tile->AddPositionList(std::move(position_list));
+
+  for (oid_t column_itr = 0; column_itr < tile->GetColumnCount();
+       column_itr++) {
+    logical_tile->AddColumn(tile, column_itr, position_list_idx);
+  }
+
+  result.push_back(logical_tile);
 }
 
 }  // namespace executor
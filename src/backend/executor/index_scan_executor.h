@@ -12,19 +12,25 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "backend/executor/abstract_scan_executor.h"
+#include "backend/index/index.h"
 #include "backend/planner/index_scan_plan.h"
 
 namespace peloton {
 
 namespace storage {
 class AbstractTable;
+class Tile;
 }
 
 namespace executor {
 
+// Max # of index entries fetched at a time
+#define INDEX_SCAN_BATCH_SIZE DEFAULT_TUPLES_PER_TILEGROUP
+
 class IndexScanExecutor : public AbstractScanExecutor {
   IndexScanExecutor(const IndexScanExecutor &) = delete;
   IndexScanExecutor &operator=(const IndexScanExecutor &) = delete;
@@ -44,23 +50,37 @@ class IndexScanExecutor : public AbstractScanExecutor {
   //===--------------------------------------------------------------------===//
   // Helper
   //===--------------------------------------------------------------------===//
-  bool ExecIndexLookup();
+  void ExecIndexLookup();
+
+  bool HasProbeBatch();
+
+  void ExecIndexProbes();
+
+  void ExecIndexOnlyLookup();
+
+  void AddIndexOnlyTile(const std::shared_ptr<storage::Tile> &tile,
+                        oid_t tuple_count);
 
   void ExecProjection();
 
   void ExecPredication();
 
+  void ClearResult();
+
   //===--------------------------------------------------------------------===//
   // Executor State
   //===--------------------------------------------------------------------===//
 
-  /** @brief Result of index scan. */
+  /** @brief Result of the current batch of the index scan. */
   std::vector<LogicalTile *> result;
 
   /** @brief Result itr */
   oid_t result_itr = INVALID_OID;
 
-  /** @brief Computed the result */
+  /** @brief Where the index scan continues with the next batch */
+  index::Index::ScanCursor cursor_;
+
+  /** @brief Fetched the last batch */
   bool done_ = false;
 
   //===--------------------------------------------------------------------===//
@@ -84,6 +104,9 @@ class IndexScanExecutor : public AbstractScanExecutor {
 
   std::vector<oid_t> full_column_ids_;
 
+  /** @brief Key columns of the output if the index covers it. */
+  std::vector<oid_t> output_key_columns_;
+
   bool key_ready = false;
 };
 
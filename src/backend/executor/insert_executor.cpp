@@ -78,30 +78,38 @@ bool InsertExecutor::DExecute() {
     auto target_table_schema = target_table_->GetSchema();
     auto column_count = target_table_schema->GetColumnCount();
 
-    std::unique_ptr<storage::Tuple> tuple(
-        new storage::Tuple(target_table_schema, true));
+    // Materialize the logical tile tuples, then insert them as one batch
+    std::vector<std::unique_ptr<storage::Tuple>> tuples;
+    std::vector<const storage::Tuple *> batch;
 
-    // Go over the logical tile
     for (oid_t tuple_id : *logical_tile) {
       expression::ContainerTuple<LogicalTile> cur_tuple(logical_tile.get(),
                                                         tuple_id);
 
-      // Materialize the logical tile tuple
+      std::unique_ptr<storage::Tuple> tuple(
+          new storage::Tuple(target_table_schema, true));
       for (oid_t column_itr = 0; column_itr < column_count; column_itr++)
         tuple->SetValue(column_itr, cur_tuple.GetValue(column_itr),
                         executor_pool);
 
-      peloton::ItemPointer location =
-          target_table_->InsertTuple(transaction_, tuple.get());
-      if (location.block == INVALID_OID) {
-        transaction_->SetResult(peloton::Result::RESULT_FAILURE);
-        return false;
-      }
-      transaction_->RecordInsert(location);
+      batch.push_back(tuple.get());
+      tuples.push_back(std::move(tuple));
+    }
+
+    if (batch.empty()) return true;
+
+    auto locations = target_table_->InsertTuples(transaction_, batch);
+    if (locations.empty()) {
+      transaction_->SetResult(peloton::Result::RESULT_FAILURE);
+      return false;
+    }
 
-      executor_context_->num_processed += 1;  // insert one
+    for (auto location : locations) {
+      transaction_->RecordInsert(location);
     }
 
+    executor_context_->num_processed += locations.size();
+
     return true;
   }
   // Inserting a collection of tuples from plan node
@@ -125,18 +133,17 @@ bool InsertExecutor::DExecute() {
     }
 
     // Bulk Insert Mode
-    for (oid_t insert_itr = 0; insert_itr < bulk_insert_count; insert_itr++) {
-      // Carry out insertion
-      ItemPointer location =
-          target_table_->InsertTuple(transaction_, tuple.get());
-      LOG_INFO("Inserted into location: %lu, %lu", location.block,
-               location.offset);
-
-      if (location.block == INVALID_OID) {
-        LOG_INFO("Failed to Insert. Set txn failure.");
-        transaction_->SetResult(peloton::Result::RESULT_FAILURE);
-        return false;
-      }
+    std::vector<const storage::Tuple *> batch(bulk_insert_count, tuple.get());
+    auto locations = target_table_->InsertTuples(transaction_, batch);
+    LOG_TRACE("Inserted %lu tuples", locations.size());
+
+    if (locations.size() != bulk_insert_count) {
+      LOG_INFO("Failed to Insert. Set txn failure.");
+      transaction_->SetResult(peloton::Result::RESULT_FAILURE);
+      return false;
+    }
+
+    for (auto location : locations) {
       transaction_->RecordInsert(location);
 
       // Logging
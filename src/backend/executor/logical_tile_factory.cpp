@@ -12,6 +12,7 @@
 
 #include "backend/executor/logical_tile_factory.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -142,10 +143,18 @@ std::vector<LogicalTile *> LogicalTileFactory::WrapTileGroups(
     // Print tile group visibility
     // tile_group_header->PrintVisibility(txn_id, commit_id);
 
+    // Check the visibility of the slot range the block covers at once
+    auto range = std::minmax_element(block.second.begin(), block.second.end());
+    oid_t begin_slot = *range.first;
+    std::vector<uint64_t> visibility;
+    tile_group_header->ComputeVisibility(txn_id, commit_id, begin_slot,
+                                         *range.second + 1, visibility);
+
     // Add visible tuples to logical tile
     std::vector<oid_t> position_list;
     for (auto tuple_id : block.second) {
-      if (tile_group_header->IsVisible(tuple_id, txn_id, commit_id)) {
+      if (storage::TileGroupHeader::IsVisibleInBitmap(visibility,
+                                                      tuple_id - begin_slot)) {
         position_list.push_back(tuple_id);
       }
     }
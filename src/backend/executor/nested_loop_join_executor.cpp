@@ -120,11 +120,13 @@ bool NestedLoopJoinExecutor::DExecute() {
     }
 
     /*
-     * Go over every pair of tuples in left (outer plan)
-     * and pass the joinkey to the executor and inner plan (right)
+     * Go over every tuple in left (outer plan) and pass the joinkeys
+     * of the whole tile to the executor and inner plan (right) at once,
+     * so that an index scan there can look them up as one batch
      */
     if ( nl != nullptr ) { // nl is supposed to be set but here is for the original version
         left_tile = left_result_tiles_.back().get();
+        children_[1]->ClearContext();
         for (auto left_tile_row_itr : *left_tile) {
           expression::ContainerTuple<executor::LogicalTile> left_tuple(
                left_tile, left_tile_row_itr);
@@ -136,13 +138,10 @@ bool NestedLoopJoinExecutor::DExecute() {
     			//Var		   *paramval = nlp->paramval;
 
     			/*
-    			 * pass the joinkeys to executor params and set the flag = 1
+    			 * append the joinkeys of this row to the executor params
+    			 * and set the flag = 1
     			 */
     			Value value = left_tuple.GetValue(nlp->paramval->varattno -1);
-    			executor_context_->ClearParams();
-    			executor_context_->SetParams(value);
-    			executor_context_->SetParamsExec(1);
-    			children_[1]->ClearContext();
     			children_[1]->SetContext(value, 1);
 
     			/* Flag parameter value as changed */
@@ -21,8 +21,10 @@
 #include "backend/executor/logical_tile_factory.h"
 #include "backend/executor/executor_context.h"
 #include "backend/expression/abstract_expression.h"
-#include "backend/expression/container_tuple.h"
+#include "backend/expression/container_batch.h"
+#include "backend/expression/tuple_value_expression.h"
 #include "backend/storage/data_table.h"
+#include "backend/storage/tile_group.h"
 #include "backend/storage/tile_group_header.h"
 #include "backend/storage/tile.h"
 #include "backend/common/logger.h"
@@ -30,6 +32,32 @@
 namespace peloton {
 namespace executor {
 
+namespace {
+
+// The same comparison with the operands swapped, e.g. "5 < a" is "a > 5"
+ExpressionType FlipCompareType(ExpressionType compare_type) {
+  switch (compare_type) {
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      return EXPRESSION_TYPE_COMPARE_GREATERTHAN;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      return EXPRESSION_TYPE_COMPARE_LESSTHAN;
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+      return EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      return EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO;
+    default:
+      return compare_type;
+  }
+}
+
+bool IsConstantOperand(const expression::AbstractExpression *expression) {
+  ExpressionType expression_type = expression->GetExpressionType();
+  return expression_type == EXPRESSION_TYPE_VALUE_CONSTANT ||
+         expression_type == EXPRESSION_TYPE_VALUE_PARAMETER;
+}
+
+}  // End anonymous namespace
+
 /**
  * @brief Constructor for seqscan executor.
  * @param node Seqscan node corresponding to this executor.
@@ -63,9 +91,81 @@ bool SeqScanExecutor::DInit() {
     }
   }
 
+  zone_map_predicates_.clear();
+  if (target_table_ != nullptr && predicate_ != nullptr) {
+    AddZoneMapPredicates(predicate_);
+  }
+
   return true;
 }
 
+/**
+ * @brief Walks down the ANDs of the predicate and keeps the comparisons of
+ * a column with a constant or a parameter.
+ */
+void SeqScanExecutor::AddZoneMapPredicates(
+    const expression::AbstractExpression *expression) {
+  ExpressionType compare_type = expression->GetExpressionType();
+
+  switch (compare_type) {
+    case EXPRESSION_TYPE_CONJUNCTION_AND:
+      AddZoneMapPredicates(expression->GetLeft());
+      AddZoneMapPredicates(expression->GetRight());
+      return;
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      break;
+    default:
+      return;
+  }
+
+  auto column = expression->GetLeft();
+  auto constant = expression->GetRight();
+  if (IsConstantOperand(column)) {
+    std::swap(column, constant);
+    compare_type = FlipCompareType(compare_type);
+  }
+
+  if (column->GetExpressionType() != EXPRESSION_TYPE_VALUE_TUPLE ||
+      IsConstantOperand(constant) == false) {
+    return;
+  }
+
+  auto tuple_value =
+      static_cast<const expression::TupleValueExpression *>(column);
+  if (tuple_value->GetTupleIdx() != 0) return;
+
+  ZoneMapPredicate zone_map_predicate;
+  zone_map_predicate.column_id = tuple_value->GetColumnId();
+  zone_map_predicate.compare_type = compare_type;
+  zone_map_predicate.value =
+      constant->Evaluate(nullptr, nullptr, executor_context_);
+  zone_map_predicates_.push_back(zone_map_predicate);
+}
+
+/**
+ * @brief The predicate can only hold where all of the collected comparisons
+ * do, so one the zone map rules out is enough.
+ */
+bool SeqScanExecutor::CanSkipTileGroup(storage::TileGroup *tile_group) const {
+  if (zone_map_predicates_.empty()) return false;
+
+  auto &zone_map = tile_group->GetZoneMap();
+  for (auto &zone_map_predicate : zone_map_predicates_) {
+    if (zone_map.MayMatch(zone_map_predicate.column_id,
+                          zone_map_predicate.compare_type,
+                          zone_map_predicate.value) == false) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 /**
  * @brief Creates logical tile from tile group and applies scan predicate.
  * @return true on success, false otherwise.
@@ -84,13 +184,7 @@ bool SeqScanExecutor::DExecute() {
 
       if (predicate_ != nullptr) {
         // Invalidate tuples that don't satisfy the predicate.
-        for (oid_t tuple_id : *tile) {
-          expression::ContainerTuple<LogicalTile> tuple(tile.get(), tuple_id);
-          if (predicate_->Evaluate(&tuple, nullptr, executor_context_)
-                  .IsFalse()) {
-            tile->RemoveVisibility(tuple_id);
-          }
-        }
+        ApplyPredicate(tile.get());
       }
 
       if (0 == tile->GetTupleCount()) {  // Avoid returning empty tiles
@@ -116,6 +210,12 @@ bool SeqScanExecutor::DExecute() {
       auto tile_group =
           target_table_->GetTileGroup(current_tile_group_offset_++);
 
+      // Skip tile groups the predicate can't hold on anywhere
+      if (CanSkipTileGroup(tile_group.get())) {
+        LOG_TRACE("Skipping tile group %lu", tile_group->GetTileGroupId());
+        continue;
+      }
+
       storage::TileGroupHeader *tile_group_header = tile_group->GetHeader();
 
       auto transaction_ = executor_context_->GetTransaction();
@@ -130,24 +230,25 @@ bool SeqScanExecutor::DExecute() {
       std::unique_ptr<LogicalTile> logical_tile(LogicalTileFactory::GetTile());
       logical_tile->AddColumns(tile_group, column_ids_);
 
-      // Construct position list by looping through tile group
-      // and applying the predicate.
+      // Find the visible tuples of the whole tile group at once
+      std::vector<uint64_t> visibility;
+      tile_group_header->ComputeVisibility(txn_id, commit_id, 0,
+                                           active_tuple_count, visibility);
+
+      // Construct position list from the visible tuples
       std::vector<oid_t> position_list;
-      for (oid_t tuple_id = 0; tuple_id < active_tuple_count; tuple_id++) {
-        if (tile_group_header->IsVisible(tuple_id, txn_id, commit_id) ==
-            false) {
-          continue;
+      for (oid_t word_itr = 0; word_itr < visibility.size(); word_itr++) {
+        uint64_t word = visibility[word_itr];
+        while (word != 0) {
+          position_list.push_back(word_itr * 64 + __builtin_ctzll(word));
+          word &= word - 1;
         }
+      }
 
-        expression::ContainerTuple<storage::TileGroup> tuple(tile_group.get(),
-                                                             tuple_id);
-        if (predicate_ == nullptr) {
-          position_list.push_back(tuple_id);
-        } else {
-          auto eval =
-              predicate_->Evaluate(&tuple, nullptr, executor_context_).IsTrue();
-          if (eval == true) position_list.push_back(tuple_id);
-        }
+      // Drop the ones that do not satisfy the predicate, a batch at a time
+      if (predicate_ != nullptr) {
+        expression::ContainerBatch<storage::TileGroup> batch(tile_group.get());
+        predicate_->FilterBatch(batch, position_list, executor_context_);
       }
 
       logical_tile->AddPositionList(std::move(position_list));
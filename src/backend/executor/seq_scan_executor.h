@@ -34,6 +34,12 @@ class SeqScanExecutor : public AbstractScanExecutor {
   bool DExecute();
 
  private:
+  // Collects the conjuncts of the predicate the zone maps can decide
+  void AddZoneMapPredicates(const expression::AbstractExpression *expression);
+
+  // Whether the zone map rules out every tuple of the tile group
+  bool CanSkipTileGroup(storage::TileGroup *tile_group) const;
+
   //===--------------------------------------------------------------------===//
   // Executor State
   //===--------------------------------------------------------------------===//
@@ -44,6 +50,16 @@ class SeqScanExecutor : public AbstractScanExecutor {
   /** @brief Keeps track of the number of tile groups to scan. */
   oid_t table_tile_group_count_ = INVALID_OID;
 
+  /** @brief A "column <compare_type> value" conjunct of the predicate. */
+  struct ZoneMapPredicate {
+    oid_t column_id;
+    ExpressionType compare_type;
+    Value value;
+  };
+
+  /** @brief Conjuncts checked against the zone map of each tile group. */
+  std::vector<ZoneMapPredicate> zone_map_predicates_;
+
   //===--------------------------------------------------------------------===//
   // Plan Info
   //===--------------------------------------------------------------------===//
@@ -12,6 +12,7 @@
 
 #include <sstream>
 #include <cassert>
+#include <algorithm>
 #include <stdexcept>
 
 #include "backend/common/logger.h"
@@ -48,6 +49,42 @@ bool AbstractExpression::HasParameter() const {
   return (m_right && m_right->HasParameter());
 }
 
+void AbstractExpression::EvaluateBatch(
+    const ExpressionBatch &batch, const SelectionVector &sel,
+    ColumnVector &result, executor::ExecutorContext *context) const {
+  result.Reset(COLUMN_VECTOR_TYPE_VALUE, VALUE_TYPE_INVALID, sel.size());
+  for (size_t row = 0; row < sel.size(); row++) {
+    result.SetValue(row, batch.EvaluateRow(this, sel[row], context));
+  }
+}
+
+void AbstractExpression::FilterBatch(const ExpressionBatch &batch,
+                                     SelectionVector &sel,
+                                     executor::ExecutorContext *context,
+                                     bool keep_nulls) const {
+  SelectionVector chunk;
+  ColumnVector result;
+  size_t kept_count = 0;
+
+  // Evaluate a chunk at a time so that the vectors of the whole expression
+  // tree stay in cache
+  for (size_t chunk_begin = 0; chunk_begin < sel.size();
+       chunk_begin += EXPRESSION_BATCH_SIZE) {
+    size_t chunk_end =
+        std::min(sel.size(), chunk_begin + EXPRESSION_BATCH_SIZE);
+    chunk.assign(sel.begin() + chunk_begin, sel.begin() + chunk_end);
+    EvaluateBatch(batch, chunk, result, context);
+
+    for (size_t row = 0; row < chunk.size(); row++) {
+      bool keep = keep_nulls ? !result.IsFalse(row) : result.IsTrue(row);
+      sel[kept_count] = chunk[row];
+      kept_count += keep;
+    }
+  }
+
+  sel.resize(kept_count);
+}
+
 bool AbstractExpression::InitParamShortCircuits() {
   return (m_hasParameter = HasParameter());
 }
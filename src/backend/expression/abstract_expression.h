@@ -21,6 +21,7 @@
 #include "backend/common/types.h"
 #include "backend/common/planner_dom_value.h"
 #include "backend/common/printable.h"
+#include "backend/expression/column_vector.h"
 
 #include "postgres.h"
 #include "common/fe_memutils.h"
@@ -63,6 +64,23 @@ class AbstractExpression : public Printable {
                          const AbstractTuple *tuple2,
                          executor::ExecutorContext *context) const = 0;
 
+  /**
+   * Evaluates the expression on the rows of the batch in sel at once, entry i
+   * of the result is for row sel[i]. Expressions that override this run
+   * kernels on whole column vectors, the rest evaluate row by row.
+   */
+  virtual void EvaluateBatch(const ExpressionBatch &batch,
+                             const SelectionVector &sel, ColumnVector &result,
+                             executor::ExecutorContext *context) const;
+
+  /**
+   * Drops the rows from sel for which the predicate is not true, or with
+   * keep_nulls, only those for which it is false.
+   */
+  void FilterBatch(const ExpressionBatch &batch, SelectionVector &sel,
+                   executor::ExecutorContext *context,
+                   bool keep_nulls = false) const;
+
   /** return true if self or descendent should be substitute()'d */
   virtual bool HasParameter() const;
 
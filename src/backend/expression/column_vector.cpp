@@ -0,0 +1,662 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// column_vector.cpp
+//
+// Identification: src/backend/expression/column_vector.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cassert>
+#include <cmath>
+
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include "backend/expression/column_vector.h"
+
+#include "backend/common/value_factory.h"
+#include "backend/common/value_peeker.h"
+
+namespace peloton {
+namespace expression {
+
+//===--------------------------------------------------------------------===//
+// Column Vector
+//===--------------------------------------------------------------------===//
+
+void ColumnVector::Reset(ColumnVectorType type, ValueType value_type,
+                         size_t count, bool constant) {
+  assert(constant == false || count == 1);
+
+  type_ = type;
+  value_type_ = value_type;
+  constant_ = constant;
+  size_ = count;
+
+  // Writers fill in every entry, so the arrays are not cleared
+  switch (type) {
+    case COLUMN_VECTOR_TYPE_INTEGER:
+    case COLUMN_VECTOR_TYPE_BOOLEAN:
+      integers_.resize(count);
+      nulls_.resize(count);
+      break;
+    case COLUMN_VECTOR_TYPE_DOUBLE:
+      doubles_.resize(count);
+      nulls_.resize(count);
+      break;
+    case COLUMN_VECTOR_TYPE_VALUE:
+      values_.resize(count);
+      break;
+    default:
+      assert(false);
+      break;
+  }
+}
+
+void ColumnVector::SetConstant(const Value &value) {
+  ValueType value_type = value.GetValueType();
+  bool is_null = value.IsNull();
+
+  switch (value_type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+      Reset(COLUMN_VECTOR_TYPE_INTEGER, value_type, 1, true);
+      integers_[0] = is_null ? 0 : ValuePeeker::PeekAsRawInt64(value);
+      nulls_[0] = is_null;
+      break;
+    case VALUE_TYPE_DOUBLE:
+      Reset(COLUMN_VECTOR_TYPE_DOUBLE, value_type, 1, true);
+      doubles_[0] = is_null ? 0 : ValuePeeker::PeekDouble(value);
+      nulls_[0] = is_null;
+      break;
+    case VALUE_TYPE_BOOLEAN:
+      Reset(COLUMN_VECTOR_TYPE_BOOLEAN, value_type, 1, true);
+      SetBoolean(0, value);
+      break;
+    default:
+      Reset(COLUMN_VECTOR_TYPE_VALUE, value_type, 1, true);
+      values_[0] = value;
+      break;
+  }
+}
+
+Value ColumnVector::GetValue(size_t row) const {
+  size_t entry = Entry(row);
+
+  switch (type_) {
+    case COLUMN_VECTOR_TYPE_INTEGER: {
+      if (nulls_[entry]) return Value::GetNullValue(value_type_);
+      int64_t value = integers_[entry];
+      switch (value_type_) {
+        case VALUE_TYPE_TINYINT:
+          return ValueFactory::GetTinyIntValue(static_cast<int8_t>(value));
+        case VALUE_TYPE_SMALLINT:
+          return ValueFactory::GetSmallIntValue(static_cast<int16_t>(value));
+        case VALUE_TYPE_INTEGER:
+          return ValueFactory::GetIntegerValue(static_cast<int32_t>(value));
+        case VALUE_TYPE_TIMESTAMP:
+          return ValueFactory::GetTimestampValue(value);
+        default:
+          return ValueFactory::GetBigIntValue(value);
+      }
+    }
+    case COLUMN_VECTOR_TYPE_DOUBLE:
+      if (nulls_[entry]) return Value::GetNullValue(VALUE_TYPE_DOUBLE);
+      return ValueFactory::GetDoubleValue(doubles_[entry]);
+    case COLUMN_VECTOR_TYPE_BOOLEAN:
+      if (nulls_[entry]) return Value::GetNullValue(VALUE_TYPE_BOOLEAN);
+      return ValueFactory::GetBooleanValue(integers_[entry] != 0);
+    case COLUMN_VECTOR_TYPE_VALUE:
+      return values_[entry];
+    default:
+      assert(false);
+      return Value();
+  }
+}
+
+void ColumnVector::SetBoolean(size_t row, const Value &value) {
+  assert(type_ == COLUMN_VECTOR_TYPE_BOOLEAN);
+  bool is_null = value.IsNull();
+  SetBoolean(row, is_null == false && value.IsTrue(), is_null);
+}
+
+//===--------------------------------------------------------------------===//
+// Kernels
+//===--------------------------------------------------------------------===//
+
+namespace {
+
+// One side of a kernel on integers, a constant repeats for every row
+struct IntegerOperand {
+  explicit IntegerOperand(const ColumnVector &vector)
+      : data(vector.GetIntegers()), step(vector.IsConstant() ? 0 : 1) {}
+
+  inline int64_t Get(size_t row) const { return data[row * step]; }
+
+#ifdef __SSE4_2__
+  inline __m128i Load(size_t row) const {
+    if (step == 0) return _mm_set1_epi64x(data[0]);
+    return _mm_loadu_si128((const __m128i *)(data + row));
+  }
+#endif
+
+  const int64_t *data;
+  size_t step;
+};
+
+// One side of a kernel on doubles, integers are converted like Value does
+// when the other side is a double
+struct DoubleOperand {
+  explicit DoubleOperand(const ColumnVector &vector)
+      : step(vector.IsConstant() ? 0 : 1) {
+    if (vector.GetType() == COLUMN_VECTOR_TYPE_DOUBLE) {
+      data = vector.GetDoubles();
+      return;
+    }
+
+    converted.resize(vector.IsConstant() ? 1 : vector.GetSize());
+    for (size_t entry = 0; entry < converted.size(); entry++) {
+      converted[entry] = static_cast<double>(vector.GetIntegers()[entry]);
+    }
+    data = converted.data();
+  }
+
+  inline double Get(size_t row) const { return data[row * step]; }
+
+#ifdef __SSE4_2__
+  inline __m128d Load(size_t row) const {
+    if (step == 0) return _mm_set1_pd(data[0]);
+    return _mm_loadu_pd(data + row);
+  }
+#endif
+
+  const double *data;
+  size_t step;
+  std::vector<double> converted;
+};
+
+// # of rows of a kernel result, one if both sides are constants
+inline size_t GetRowCount(const ColumnVector &left, const ColumnVector &right) {
+  return left.IsConstant() ? right.GetSize() : left.GetSize();
+}
+
+void MergeNulls(const ColumnVector &left, const ColumnVector &right,
+                size_t count, uint8_t *nulls) {
+  const uint8_t *left_nulls = left.GetNulls();
+  const uint8_t *right_nulls = right.GetNulls();
+  size_t left_step = left.IsConstant() ? 0 : 1;
+  size_t right_step = right.IsConstant() ? 0 : 1;
+
+  for (size_t row = 0; row < count; row++) {
+    nulls[row] = left_nulls[row * left_step] | right_nulls[row * right_step];
+  }
+}
+
+bool HasNaN(const ColumnVector &vector) {
+  if (vector.GetType() != COLUMN_VECTOR_TYPE_DOUBLE) return false;
+
+  size_t count = vector.IsConstant() ? 1 : vector.GetSize();
+  const double *doubles = vector.GetDoubles();
+  for (size_t entry = 0; entry < count; entry++) {
+    if (std::isnan(doubles[entry])) return true;
+  }
+  return false;
+}
+
+//===--------------------------------------------------------------------===//
+// Comparison kernels
+//===--------------------------------------------------------------------===//
+
+// SSE4.2 only has == and > for 64 bit integers, the rest are derived
+struct CompareEqual {
+  template <typename T>
+  static inline bool Scalar(T left, T right) {
+    return left == right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128i Simd(__m128i left, __m128i right) {
+    return _mm_cmpeq_epi64(left, right);
+  }
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_cmpeq_pd(left, right);
+  }
+#endif
+};
+
+struct CompareNotEqual {
+  template <typename T>
+  static inline bool Scalar(T left, T right) {
+    return left != right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128i Simd(__m128i left, __m128i right) {
+    return _mm_xor_si128(_mm_cmpeq_epi64(left, right), _mm_set1_epi64x(-1));
+  }
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_cmpneq_pd(left, right);
+  }
+#endif
+};
+
+struct CompareLessThan {
+  template <typename T>
+  static inline bool Scalar(T left, T right) {
+    return left < right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128i Simd(__m128i left, __m128i right) {
+    return _mm_cmpgt_epi64(right, left);
+  }
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_cmplt_pd(left, right);
+  }
+#endif
+};
+
+struct CompareGreaterThan {
+  template <typename T>
+  static inline bool Scalar(T left, T right) {
+    return left > right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128i Simd(__m128i left, __m128i right) {
+    return _mm_cmpgt_epi64(left, right);
+  }
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_cmpgt_pd(left, right);
+  }
+#endif
+};
+
+struct CompareLessThanOrEqual {
+  template <typename T>
+  static inline bool Scalar(T left, T right) {
+    return left <= right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128i Simd(__m128i left, __m128i right) {
+    return _mm_xor_si128(_mm_cmpgt_epi64(left, right), _mm_set1_epi64x(-1));
+  }
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_cmple_pd(left, right);
+  }
+#endif
+};
+
+struct CompareGreaterThanOrEqual {
+  template <typename T>
+  static inline bool Scalar(T left, T right) {
+    return left >= right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128i Simd(__m128i left, __m128i right) {
+    return _mm_xor_si128(_mm_cmpgt_epi64(right, left), _mm_set1_epi64x(-1));
+  }
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_cmpge_pd(left, right);
+  }
+#endif
+};
+
+template <class Compare>
+void CompareIntegers(const ColumnVector &left, const ColumnVector &right,
+                     size_t count, int64_t *result) {
+  IntegerOperand left_operand(left);
+  IntegerOperand right_operand(right);
+  size_t row = 0;
+
+#ifdef __SSE4_2__
+  for (; row + 2 <= count; row += 2) {
+    __m128i matches =
+        Compare::Simd(left_operand.Load(row), right_operand.Load(row));
+    int mask = _mm_movemask_pd(_mm_castsi128_pd(matches));
+    result[row] = mask & 1;
+    result[row + 1] = mask >> 1;
+  }
+#endif
+
+  for (; row < count; row++) {
+    result[row] =
+        Compare::Scalar(left_operand.Get(row), right_operand.Get(row));
+  }
+}
+
+template <class Compare>
+void CompareDoubles(const ColumnVector &left, const ColumnVector &right,
+                    size_t count, int64_t *result) {
+  DoubleOperand left_operand(left);
+  DoubleOperand right_operand(right);
+  size_t row = 0;
+
+#ifdef __SSE4_2__
+  for (; row + 2 <= count; row += 2) {
+    int mask = _mm_movemask_pd(
+        Compare::Simd(left_operand.Load(row), right_operand.Load(row)));
+    result[row] = mask & 1;
+    result[row + 1] = mask >> 1;
+  }
+#endif
+
+  for (; row < count; row++) {
+    result[row] =
+        Compare::Scalar(left_operand.Get(row), right_operand.Get(row));
+  }
+}
+
+template <class Compare>
+void CompareNumbers(bool as_doubles, const ColumnVector &left,
+                    const ColumnVector &right, size_t count, int64_t *result) {
+  if (as_doubles) {
+    CompareDoubles<Compare>(left, right, count, result);
+  } else {
+    CompareIntegers<Compare>(left, right, count, result);
+  }
+}
+
+//===--------------------------------------------------------------------===//
+// Arithmetic kernels
+//===--------------------------------------------------------------------===//
+
+// Value throws on overflow, so each kernel tells whether any non-null row
+// overflowed instead of producing a result for it
+bool AddIntegers(const ColumnVector &left, const ColumnVector &right,
+                 size_t count, int64_t *result, const uint8_t *nulls) {
+  IntegerOperand left_operand(left);
+  IntegerOperand right_operand(right);
+  size_t row = 0;
+
+#ifdef __SSE4_2__
+  __m128i overflow = _mm_setzero_si128();
+  for (; row + 2 <= count; row += 2) {
+    __m128i lhs = left_operand.Load(row);
+    __m128i rhs = right_operand.Load(row);
+    __m128i sum = _mm_add_epi64(lhs, rhs);
+    _mm_storeu_si128((__m128i *)(result + row), sum);
+
+    // Overflowed iff the sum has a different sign than both operands
+    __m128i null_rows = _mm_set_epi64x(-int64_t(nulls[row + 1]),
+                                       -int64_t(nulls[row]));
+    overflow = _mm_or_si128(
+        overflow, _mm_andnot_si128(null_rows,
+                                   _mm_and_si128(_mm_xor_si128(lhs, sum),
+                                                 _mm_xor_si128(rhs, sum))));
+  }
+  if (_mm_movemask_pd(_mm_castsi128_pd(overflow)) != 0) return false;
+#endif
+
+  for (; row < count; row++) {
+    int64_t lhs = left_operand.Get(row);
+    int64_t rhs = right_operand.Get(row);
+    int64_t sum = int64_t(uint64_t(lhs) + uint64_t(rhs));
+    if (!nulls[row] && ((lhs ^ sum) & (rhs ^ sum)) < 0) return false;
+    result[row] = sum;
+  }
+  return true;
+}
+
+bool SubtractIntegers(const ColumnVector &left, const ColumnVector &right,
+                      size_t count, int64_t *result, const uint8_t *nulls) {
+  IntegerOperand left_operand(left);
+  IntegerOperand right_operand(right);
+  size_t row = 0;
+
+#ifdef __SSE4_2__
+  __m128i overflow = _mm_setzero_si128();
+  for (; row + 2 <= count; row += 2) {
+    __m128i lhs = left_operand.Load(row);
+    __m128i rhs = right_operand.Load(row);
+    __m128i difference = _mm_sub_epi64(lhs, rhs);
+    _mm_storeu_si128((__m128i *)(result + row), difference);
+
+    // Overflowed iff the operands differ in sign and the difference does
+    // not have the sign of the left one
+    __m128i null_rows = _mm_set_epi64x(-int64_t(nulls[row + 1]),
+                                       -int64_t(nulls[row]));
+    overflow = _mm_or_si128(
+        overflow,
+        _mm_andnot_si128(null_rows,
+                         _mm_and_si128(_mm_xor_si128(lhs, rhs),
+                                       _mm_xor_si128(lhs, difference))));
+  }
+  if (_mm_movemask_pd(_mm_castsi128_pd(overflow)) != 0) return false;
+#endif
+
+  for (; row < count; row++) {
+    int64_t lhs = left_operand.Get(row);
+    int64_t rhs = right_operand.Get(row);
+    int64_t difference = int64_t(uint64_t(lhs) - uint64_t(rhs));
+    if (!nulls[row] && ((lhs ^ rhs) & (lhs ^ difference)) < 0) return false;
+    result[row] = difference;
+  }
+  return true;
+}
+
+// There is no 64 bit multiply or divide in SSE
+bool MultiplyIntegers(const ColumnVector &left, const ColumnVector &right,
+                      size_t count, int64_t *result, const uint8_t *nulls) {
+  IntegerOperand left_operand(left);
+  IntegerOperand right_operand(right);
+
+  for (size_t row = 0; row < count; row++) {
+    if (nulls[row]) continue;
+    int64_t product;
+    if (__builtin_mul_overflow(left_operand.Get(row), right_operand.Get(row),
+                               &product) ||
+        product == INT64_NULL) {
+      return false;
+    }
+    result[row] = product;
+  }
+  return true;
+}
+
+bool DivideIntegers(const ColumnVector &left, const ColumnVector &right,
+                    size_t count, int64_t *result, const uint8_t *nulls) {
+  IntegerOperand left_operand(left);
+  IntegerOperand right_operand(right);
+
+  for (size_t row = 0; row < count; row++) {
+    if (nulls[row]) continue;
+    int64_t rhs = right_operand.Get(row);
+    if (rhs == 0) return false;
+    result[row] = left_operand.Get(row) / rhs;
+  }
+  return true;
+}
+
+struct ComputeAdd {
+  static inline double Scalar(double left, double right) {
+    return left + right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_add_pd(left, right);
+  }
+#endif
+};
+
+struct ComputeSubtract {
+  static inline double Scalar(double left, double right) {
+    return left - right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_sub_pd(left, right);
+  }
+#endif
+};
+
+struct ComputeMultiply {
+  static inline double Scalar(double left, double right) {
+    return left * right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_mul_pd(left, right);
+  }
+#endif
+};
+
+struct ComputeDivide {
+  static inline double Scalar(double left, double right) {
+    return left / right;
+  }
+#ifdef __SSE4_2__
+  static inline __m128d Simd(__m128d left, __m128d right) {
+    return _mm_div_pd(left, right);
+  }
+#endif
+};
+
+template <class Compute>
+void ComputeDoubles(const ColumnVector &left, const ColumnVector &right,
+                    size_t count, double *result) {
+  DoubleOperand left_operand(left);
+  DoubleOperand right_operand(right);
+  size_t row = 0;
+
+#ifdef __SSE4_2__
+  for (; row + 2 <= count; row += 2) {
+    _mm_storeu_pd(result + row, Compute::Simd(left_operand.Load(row),
+                                              right_operand.Load(row)));
+  }
+#endif
+
+  for (; row < count; row++) {
+    result[row] = Compute::Scalar(left_operand.Get(row), right_operand.Get(row));
+  }
+}
+
+}  // namespace
+
+bool CompareColumnVectors(ExpressionType compare_type, const ColumnVector &left,
+                          const ColumnVector &right, ColumnVector &result) {
+  if (left.IsNumeric() == false || right.IsNumeric() == false) return false;
+
+  // Value orders NaN below every other double, the kernels follow IEEE 754
+  bool as_doubles = (left.GetType() == COLUMN_VECTOR_TYPE_DOUBLE ||
+                     right.GetType() == COLUMN_VECTOR_TYPE_DOUBLE);
+  if (as_doubles && (HasNaN(left) || HasNaN(right))) return false;
+
+  size_t count = GetRowCount(left, right);
+  result.Reset(COLUMN_VECTOR_TYPE_BOOLEAN, VALUE_TYPE_BOOLEAN, count,
+               left.IsConstant() && right.IsConstant());
+  int64_t *booleans = result.GetIntegers();
+
+  switch (compare_type) {
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+      CompareNumbers<CompareEqual>(as_doubles, left, right, count, booleans);
+      break;
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+      CompareNumbers<CompareNotEqual>(as_doubles, left, right, count,
+                                      booleans);
+      break;
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      CompareNumbers<CompareLessThan>(as_doubles, left, right, count,
+                                      booleans);
+      break;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      CompareNumbers<CompareGreaterThan>(as_doubles, left, right, count,
+                                         booleans);
+      break;
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+      CompareNumbers<CompareLessThanOrEqual>(as_doubles, left, right, count,
+                                             booleans);
+      break;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      CompareNumbers<CompareGreaterThanOrEqual>(as_doubles, left, right,
+                                                count, booleans);
+      break;
+    default:
+      return false;
+  }
+
+  MergeNulls(left, right, count, result.GetNulls());
+  return true;
+}
+
+bool ComputeColumnVectors(ExpressionType operator_type,
+                          const ColumnVector &left, const ColumnVector &right,
+                          ColumnVector &result) {
+  if (left.IsNumeric() == false || right.IsNumeric() == false) return false;
+
+  size_t count = GetRowCount(left, right);
+  bool constant = left.IsConstant() && right.IsConstant();
+
+  // Like Value, integers are promoted to bigint and mixed operands to double
+  bool as_doubles = (left.GetType() == COLUMN_VECTOR_TYPE_DOUBLE ||
+                     right.GetType() == COLUMN_VECTOR_TYPE_DOUBLE);
+  if (as_doubles) {
+    result.Reset(COLUMN_VECTOR_TYPE_DOUBLE, VALUE_TYPE_DOUBLE, count, constant);
+    double *doubles = result.GetDoubles();
+
+    switch (operator_type) {
+      case EXPRESSION_TYPE_OPERATOR_PLUS:
+        ComputeDoubles<ComputeAdd>(left, right, count, doubles);
+        break;
+      case EXPRESSION_TYPE_OPERATOR_MINUS:
+        ComputeDoubles<ComputeSubtract>(left, right, count, doubles);
+        break;
+      case EXPRESSION_TYPE_OPERATOR_MULTIPLY:
+        ComputeDoubles<ComputeMultiply>(left, right, count, doubles);
+        break;
+      case EXPRESSION_TYPE_OPERATOR_DIVIDE:
+        ComputeDoubles<ComputeDivide>(left, right, count, doubles);
+        break;
+      default:
+        return false;
+    }
+
+    // Value throws on infinite or NaN results and reads the null sentinel
+    // back as null
+    uint8_t *nulls = result.GetNulls();
+    MergeNulls(left, right, count, nulls);
+    for (size_t row = 0; row < count; row++) {
+      if (nulls[row]) continue;
+      if (std::isfinite(doubles[row]) == false) return false;
+      nulls[row] = (doubles[row] <= DOUBLE_NULL);
+    }
+    return true;
+  }
+
+  result.Reset(COLUMN_VECTOR_TYPE_INTEGER, VALUE_TYPE_BIGINT, count, constant);
+  int64_t *integers = result.GetIntegers();
+  uint8_t *nulls = result.GetNulls();
+  MergeNulls(left, right, count, nulls);
+
+  bool computed;
+  switch (operator_type) {
+    case EXPRESSION_TYPE_OPERATOR_PLUS:
+      computed = AddIntegers(left, right, count, integers, nulls);
+      break;
+    case EXPRESSION_TYPE_OPERATOR_MINUS:
+      computed = SubtractIntegers(left, right, count, integers, nulls);
+      break;
+    case EXPRESSION_TYPE_OPERATOR_MULTIPLY:
+      computed = MultiplyIntegers(left, right, count, integers, nulls);
+      break;
+    case EXPRESSION_TYPE_OPERATOR_DIVIDE:
+      computed = DivideIntegers(left, right, count, integers, nulls);
+      break;
+    default:
+      return false;
+  }
+  if (computed == false) return false;
+
+  // Value reads the null sentinel back as null
+  for (size_t row = 0; row < count; row++) {
+    nulls[row] |= (integers[row] == INT64_NULL);
+  }
+  return true;
+}
+
+}  // End expression namespace
+}  // End peloton namespace
@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// column_vector.h
+//
+// Identification: src/backend/expression/column_vector.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "backend/common/types.h"
+#include "backend/common/value.h"
+
+#define EXPRESSION_BATCH_SIZE 1024  // max # of rows evaluated at once
+
+namespace peloton {
+
+namespace executor {
+class ExecutorContext;
+}
+
+namespace expression {
+
+class AbstractExpression;
+
+// Rows of a batch an expression is evaluated on, in ascending order
+typedef std::vector<oid_t> SelectionVector;
+
+enum ColumnVectorType {
+  COLUMN_VECTOR_TYPE_INVALID = 0,
+  COLUMN_VECTOR_TYPE_INTEGER = 1,  // int64_t, any integer type or timestamp
+  COLUMN_VECTOR_TYPE_DOUBLE = 2,   // double
+  COLUMN_VECTOR_TYPE_BOOLEAN = 3,  // int64_t 0 or 1
+  COLUMN_VECTOR_TYPE_VALUE = 4     // boxed Values of any other type
+};
+
+//===--------------------------------------------------------------------===//
+// Column Vector
+//===--------------------------------------------------------------------===//
+
+/**
+ * Result of evaluating an expression on a batch, one entry for each row of
+ * the selection vector it was evaluated on. Fixed-width values are unboxed
+ * into a plain array next to a null flag per row so that kernels can work on
+ * them without going through Value. A constant vector holds one entry that
+ * applies to every row.
+ */
+class ColumnVector {
+ public:
+  // Prepares the vector for count rows of the given type
+  void Reset(ColumnVectorType type, ValueType value_type, size_t count,
+             bool constant = false);
+
+  void SetConstant(const Value &value);
+
+  ColumnVectorType GetType() const { return type_; }
+
+  // Type of the Values that the entries stand for
+  ValueType GetValueType() const { return value_type_; }
+
+  bool IsConstant() const { return constant_; }
+
+  bool IsNumeric() const {
+    return type_ == COLUMN_VECTOR_TYPE_INTEGER ||
+           type_ == COLUMN_VECTOR_TYPE_DOUBLE;
+  }
+
+  size_t GetSize() const { return size_; }
+
+  int64_t *GetIntegers() { return integers_.data(); }
+  const int64_t *GetIntegers() const { return integers_.data(); }
+
+  double *GetDoubles() { return doubles_.data(); }
+  const double *GetDoubles() const { return doubles_.data(); }
+
+  // 1 for every null entry
+  uint8_t *GetNulls() { return nulls_.data(); }
+  const uint8_t *GetNulls() const { return nulls_.data(); }
+
+  inline bool IsNull(size_t row) const {
+    if (type_ == COLUMN_VECTOR_TYPE_VALUE) return values_[Entry(row)].IsNull();
+    return nulls_[Entry(row)] != 0;
+  }
+
+  // Same as GetValue(row).IsTrue()
+  inline bool IsTrue(size_t row) const {
+    if (type_ != COLUMN_VECTOR_TYPE_BOOLEAN) return GetValue(row).IsTrue();
+    size_t entry = Entry(row);
+    return nulls_[entry] == 0 && integers_[entry] != 0;
+  }
+
+  // Same as GetValue(row).IsFalse()
+  inline bool IsFalse(size_t row) const {
+    if (type_ != COLUMN_VECTOR_TYPE_BOOLEAN) return GetValue(row).IsFalse();
+    size_t entry = Entry(row);
+    return nulls_[entry] == 0 && integers_[entry] == 0;
+  }
+
+  Value GetValue(size_t row) const;
+
+  // Only for COLUMN_VECTOR_TYPE_VALUE vectors
+  void SetValue(size_t row, const Value &value) { values_[row] = value; }
+
+  // Only for COLUMN_VECTOR_TYPE_BOOLEAN vectors
+  void SetBoolean(size_t row, const Value &value);
+
+  inline void SetBoolean(size_t row, bool value, bool is_null) {
+    integers_[row] = value && !is_null;
+    nulls_[row] = is_null;
+  }
+
+ private:
+  inline size_t Entry(size_t row) const { return constant_ ? 0 : row; }
+
+  ColumnVectorType type_ = COLUMN_VECTOR_TYPE_INVALID;
+
+  ValueType value_type_ = VALUE_TYPE_INVALID;
+
+  bool constant_ = false;
+
+  size_t size_ = 0;
+
+  std::vector<int64_t> integers_;
+
+  std::vector<double> doubles_;
+
+  std::vector<uint8_t> nulls_;
+
+  std::vector<Value> values_;
+};
+
+//===--------------------------------------------------------------------===//
+// Expression Batch
+//===--------------------------------------------------------------------===//
+
+/**
+ * Rows an expression is evaluated on with AbstractExpression::EvaluateBatch,
+ * e.g. the tuples of a tile group. See ContainerBatch.
+ */
+class ExpressionBatch {
+ public:
+  virtual ~ExpressionBatch() {}
+
+  // Fetches the column for the rows in sel
+  virtual void GetColumn(oid_t column_id, const SelectionVector &sel,
+                         ColumnVector &result) const = 0;
+
+  // Evaluates the expression on a single row, for expressions without a
+  // batch kernel
+  virtual Value EvaluateRow(const AbstractExpression *expression, oid_t row,
+                            executor::ExecutorContext *context) const = 0;
+};
+
+//===--------------------------------------------------------------------===//
+// Kernels
+//===--------------------------------------------------------------------===//
+
+// Compares two numeric vectors, result is a boolean vector.
+// Returns false if the kernel can not give the same answer as Value, e.g. for
+// strings or NaNs, the caller has to compare the Values then.
+bool CompareColumnVectors(ExpressionType compare_type, const ColumnVector &left,
+                          const ColumnVector &right, ColumnVector &result);
+
+// Adds, subtracts, multiplies or divides two numeric vectors.
+// Returns false if the kernel can not give the same answer as Value, e.g. on
+// overflow or division by zero where Value throws, the caller has to
+// compute the Values then.
+bool ComputeColumnVectors(ExpressionType operator_type,
+                          const ColumnVector &left, const ColumnVector &right,
+                          ColumnVector &result);
+
+}  // End expression namespace
+}  // End peloton namespace
@@ -224,6 +224,54 @@ class ComparisonExpression : public AbstractExpression {
     return OP::compare_withoutNull(lnv, rnv);
   }
 
+  void EvaluateBatch(const ExpressionBatch &batch, const SelectionVector &sel,
+                     ColumnVector &result,
+                     executor::ExecutorContext *context) const {
+    assert(m_left != NULL);
+    assert(m_right != NULL);
+
+    ColumnVector left_result;
+    ColumnVector right_result;
+    m_left->EvaluateBatch(batch, sel, left_result, context);
+
+    // Evaluate skips the right side where the left one is null, so an error
+    // the right side raises on such a row only counts if it raises it on
+    // another row as well
+    try {
+      m_right->EvaluateBatch(batch, sel, right_result, context);
+    } catch (Exception &) {
+      SelectionVector right_sel;
+      for (size_t row = 0; row < sel.size(); row++) {
+        if (!left_result.IsNull(row)) right_sel.push_back(sel[row]);
+      }
+      if (right_sel.size() == sel.size()) throw;
+
+      ColumnVector partial_result;
+      m_right->EvaluateBatch(batch, right_sel, partial_result, context);
+
+      result.Reset(COLUMN_VECTOR_TYPE_BOOLEAN, VALUE_TYPE_BOOLEAN, sel.size());
+      for (size_t row = 0, right_row = 0; row < sel.size(); row++) {
+        if (left_result.IsNull(row)) {
+          result.SetBoolean(row, false, true);
+          continue;
+        }
+        CompareValues(left_result.GetValue(row),
+                      partial_result.GetValue(right_row++), result, row);
+      }
+      return;
+    }
+
+    if (CompareColumnVectors(this->m_type, left_result, right_result, result))
+      return;
+
+    // No kernel for these types, compare the Values like Evaluate does
+    result.Reset(COLUMN_VECTOR_TYPE_BOOLEAN, VALUE_TYPE_BOOLEAN, sel.size());
+    for (size_t row = 0; row < sel.size(); row++) {
+      CompareValues(left_result.GetValue(row), right_result.GetValue(row),
+                    result, row);
+    }
+  }
+
   inline const char *traceEval(const AbstractTuple *tuple1,
                                const AbstractTuple *tuple2,
                                executor::ExecutorContext *context) const {
@@ -241,6 +289,15 @@ class ComparisonExpression : public AbstractExpression {
   }
 
  private:
+  inline static void CompareValues(const Value &lnv, const Value &rnv,
+                                   ColumnVector &result, size_t row) {
+    if (lnv.IsNull() || rnv.IsNull()) {
+      result.SetBoolean(row, false, true);
+    } else {
+      result.SetBoolean(row, OP::compare_withoutNull(lnv, rnv));
+    }
+  }
+
   AbstractExpression *m_left;
   AbstractExpression *m_right;
 };
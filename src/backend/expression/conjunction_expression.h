@@ -17,6 +17,7 @@
 #include "backend/expression/abstract_expression.h"
 
 #include <string>
+#include <type_traits>
 
 namespace peloton {
 namespace expression {
@@ -37,6 +38,10 @@ class ConjunctionExpression : public AbstractExpression {
   Value Evaluate(const AbstractTuple *tuple1, const AbstractTuple *tuple2,
                  executor::ExecutorContext *context) const;
 
+  void EvaluateBatch(const ExpressionBatch &batch, const SelectionVector &sel,
+                     ColumnVector &result,
+                     executor::ExecutorContext *context) const;
+
   std::string DebugInfo(const std::string &spacer) const {
     return (spacer + "ConjunctionExpression\n");
   }
@@ -93,5 +98,53 @@ inline Value ConjunctionExpression<ConjunctionOr>::Evaluate(
   return Value::GetNullValue(VALUE_TYPE_BOOLEAN);
 }
 
+/*
+ * AND is decided by a false side and OR by a true one. Like Evaluate, the
+ * right side is only evaluated on the rows the left side does not decide,
+ * so it may rely on the left side to guard it.
+ */
+template <typename C>
+void ConjunctionExpression<C>::EvaluateBatch(
+    const ExpressionBatch &batch, const SelectionVector &sel,
+    ColumnVector &result, executor::ExecutorContext *context) const {
+  const bool decisive = std::is_same<C, ConjunctionOr>::value;
+
+  ColumnVector left_result;
+  m_left->EvaluateBatch(batch, sel, left_result, context);
+
+  result.Reset(COLUMN_VECTOR_TYPE_BOOLEAN, VALUE_TYPE_BOOLEAN, sel.size());
+
+  SelectionVector right_sel;
+  std::vector<size_t> right_positions;
+  for (size_t row = 0; row < sel.size(); row++) {
+    bool decided =
+        decisive ? left_result.IsTrue(row) : left_result.IsFalse(row);
+    if (decided) {
+      result.SetBoolean(row, decisive, false);
+    } else {
+      right_sel.push_back(sel[row]);
+      right_positions.push_back(row);
+    }
+  }
+
+  if (right_sel.empty()) return;
+
+  ColumnVector right_result;
+  m_right->EvaluateBatch(batch, right_sel, right_result, context);
+
+  for (size_t right_row = 0; right_row < right_sel.size(); right_row++) {
+    size_t row = right_positions[right_row];
+    bool decided = decisive ? right_result.IsTrue(right_row)
+                            : right_result.IsFalse(right_row);
+    if (decided) {
+      result.SetBoolean(row, decisive, false);
+    } else if (left_result.IsNull(row) || right_result.IsNull(right_row)) {
+      result.SetBoolean(row, false, true);
+    } else {
+      result.SetBoolean(row, !decisive, false);
+    }
+  }
+}
+
 }  // End expression namespace
 }  // End peloton namespace
@@ -44,6 +44,13 @@ class ConstantValueExpression : public AbstractExpression {
     return this->value;
   }
 
+  void EvaluateBatch(__attribute__((unused)) const ExpressionBatch &batch,
+                     __attribute__((unused)) const SelectionVector &sel,
+                     ColumnVector &result, __attribute__((unused))
+                     executor::ExecutorContext *context) const {
+    result.SetConstant(value);
+  }
+
   std::string DebugInfo(const std::string &spacer) const {
     return spacer + "OptimizedConstantValueExpression:" + value.GetInfo() + "\n";
   }
@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// container_batch.cpp
+//
+// Identification: src/backend/expression/container_batch.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/expression/container_batch.h"
+
+#include "backend/catalog/schema.h"
+#include "backend/executor/logical_tile.h"
+#include "backend/storage/tile.h"
+#include "backend/storage/tile_group.h"
+
+namespace peloton {
+namespace expression {
+
+namespace {
+
+// Reads an integer column of the tuples, NULL_OID stands for a null row
+template <typename T>
+void GatherIntegers(const char *column, size_t tuple_length,
+                    const SelectionVector &tuple_ids, T null_value,
+                    ColumnVector &result) {
+  int64_t *integers = result.GetIntegers();
+  uint8_t *nulls = result.GetNulls();
+
+  for (size_t row = 0; row < tuple_ids.size(); row++) {
+    oid_t tuple_id = tuple_ids[row];
+    if (tuple_id == NULL_OID) {
+      integers[row] = 0;
+      nulls[row] = 1;
+      continue;
+    }
+
+    T value = *reinterpret_cast<const T *>(column + tuple_id * tuple_length);
+    integers[row] = value;
+    nulls[row] = (value == null_value);
+  }
+}
+
+void GatherDoubles(const char *column, size_t tuple_length,
+                   const SelectionVector &tuple_ids, ColumnVector &result) {
+  double *doubles = result.GetDoubles();
+  uint8_t *nulls = result.GetNulls();
+
+  for (size_t row = 0; row < tuple_ids.size(); row++) {
+    oid_t tuple_id = tuple_ids[row];
+    if (tuple_id == NULL_OID) {
+      doubles[row] = 0;
+      nulls[row] = 1;
+      continue;
+    }
+
+    double value =
+        *reinterpret_cast<const double *>(column + tuple_id * tuple_length);
+    doubles[row] = value;
+    nulls[row] = (value <= DOUBLE_NULL);
+  }
+}
+
+// Unboxes the column of the tile for the tuples, same null rules as
+// Value::InitFromTupleStorage. Returns false for types that stay boxed.
+bool GatherColumn(const storage::Tile *tile, oid_t tile_column_id,
+                  const SelectionVector &tuple_ids, ColumnVector &result) {
+  const catalog::Schema *schema = tile->GetSchema();
+  ValueType column_type = schema->GetType(tile_column_id);
+  const char *column =
+      tile->GetTupleLocation(0) + schema->GetOffset(tile_column_id);
+  size_t tuple_length = schema->GetLength();
+  size_t count = tuple_ids.size();
+
+  switch (column_type) {
+    case VALUE_TYPE_TINYINT:
+      result.Reset(COLUMN_VECTOR_TYPE_INTEGER, column_type, count);
+      GatherIntegers<int8_t>(column, tuple_length, tuple_ids, INT8_NULL,
+                             result);
+      return true;
+    case VALUE_TYPE_SMALLINT:
+      result.Reset(COLUMN_VECTOR_TYPE_INTEGER, column_type, count);
+      GatherIntegers<int16_t>(column, tuple_length, tuple_ids, INT16_NULL,
+                              result);
+      return true;
+    case VALUE_TYPE_INTEGER:
+      result.Reset(COLUMN_VECTOR_TYPE_INTEGER, column_type, count);
+      GatherIntegers<int32_t>(column, tuple_length, tuple_ids, INT32_NULL,
+                              result);
+      return true;
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+      result.Reset(COLUMN_VECTOR_TYPE_INTEGER, column_type, count);
+      GatherIntegers<int64_t>(column, tuple_length, tuple_ids, INT64_NULL,
+                              result);
+      return true;
+    case VALUE_TYPE_DOUBLE:
+      result.Reset(COLUMN_VECTOR_TYPE_DOUBLE, column_type, count);
+      GatherDoubles(column, tuple_length, tuple_ids, result);
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+template <>
+void ContainerBatch<storage::TileGroup>::GetColumn(oid_t column_id,
+                                                   const SelectionVector &sel,
+                                                   ColumnVector &result) const {
+  oid_t tile_offset, tile_column_id;
+  container_->LocateTileAndColumn(column_id, tile_offset, tile_column_id);
+  storage::Tile *tile = container_->GetTile(tile_offset);
+
+  if (GatherColumn(tile, tile_column_id, sel, result)) return;
+
+  result.Reset(COLUMN_VECTOR_TYPE_VALUE,
+               tile->GetSchema()->GetType(tile_column_id), sel.size());
+  for (size_t row = 0; row < sel.size(); row++) {
+    result.SetValue(row, tile->GetValue(sel[row], tile_column_id));
+  }
+}
+
+template <>
+void ContainerBatch<executor::LogicalTile>::GetColumn(
+    oid_t column_id, const SelectionVector &sel, ColumnVector &result) const {
+  const executor::LogicalTile::ColumnInfo &column_info =
+      container_->GetColumnInfo(column_id);
+  const executor::LogicalTile::PositionList &position_list =
+      container_->GetPositionList(column_info.position_list_idx);
+
+  // Rows of the logical tile to tuples of the base tile
+  SelectionVector tuple_ids(sel.size());
+  for (size_t row = 0; row < sel.size(); row++) {
+    tuple_ids[row] = position_list[sel[row]];
+  }
+
+  storage::Tile *base_tile = column_info.base_tile.get();
+  if (GatherColumn(base_tile, column_info.origin_column_id, tuple_ids, result))
+    return;
+
+  result.Reset(COLUMN_VECTOR_TYPE_VALUE,
+               base_tile->GetSchema()->GetType(column_info.origin_column_id),
+               sel.size());
+  for (size_t row = 0; row < sel.size(); row++) {
+    result.SetValue(row, container_->GetValue(sel[row], column_id));
+  }
+}
+
+}  // End expression namespace
+}  // End peloton namespace
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// container_batch.h
+//
+// Identification: src/backend/expression/container_batch.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "backend/expression/abstract_expression.h"
+#include "backend/expression/column_vector.h"
+#include "backend/expression/container_tuple.h"
+
+namespace peloton {
+
+namespace executor {
+class LogicalTile;
+}
+
+namespace expression {
+
+//===--------------------------------------------------------------------===//
+// Container Batch wrapping a tile group or logical tile.
+//===--------------------------------------------------------------------===//
+
+/**
+ * Batch over the tuples of a tile group or logical tile, rows are tuple ids.
+ * Fixed-width columns are read straight out of the tiles.
+ */
+template <class T>
+class ContainerBatch : public ExpressionBatch {
+ public:
+  ContainerBatch(const ContainerBatch &) = delete;
+  ContainerBatch &operator=(const ContainerBatch &) = delete;
+
+  explicit ContainerBatch(T *container) : container_(container) {}
+
+  void GetColumn(oid_t column_id, const SelectionVector &sel,
+                 ColumnVector &result) const override;
+
+  Value EvaluateRow(const AbstractExpression *expression, oid_t row,
+                    executor::ExecutorContext *context) const override {
+    ContainerTuple<T> tuple(container_, row);
+    return expression->Evaluate(&tuple, nullptr, context);
+  }
+
+ private:
+  /** @brief Underlying container behind this batch interface. */
+  T *container_;
+};
+
+template <>
+void ContainerBatch<storage::TileGroup>::GetColumn(oid_t column_id,
+                                                   const SelectionVector &sel,
+                                                   ColumnVector &result) const;
+
+template <>
+void ContainerBatch<executor::LogicalTile>::GetColumn(
+    oid_t column_id, const SelectionVector &sel, ColumnVector &result) const;
+
+}  // End expression namespace
+}  // End peloton namespace
@@ -49,6 +49,25 @@ class OperatorNotExpression : public AbstractExpression {
     return operand;
   }
 
+  void EvaluateBatch(const ExpressionBatch &batch, const SelectionVector &sel,
+                     ColumnVector &result,
+                     executor::ExecutorContext *context) const {
+    assert(m_left);
+    ColumnVector operand;
+    m_left->EvaluateBatch(batch, sel, operand, context);
+
+    result.Reset(COLUMN_VECTOR_TYPE_BOOLEAN, VALUE_TYPE_BOOLEAN, sel.size());
+    for (size_t row = 0; row < sel.size(); row++) {
+      if (operand.IsTrue(row)) {
+        result.SetBoolean(row, false, false);
+      } else if (operand.IsFalse(row)) {
+        result.SetBoolean(row, true, false);
+      } else {
+        result.SetBoolean(row, false, true);
+      }
+    }
+  }
+
   std::string DebugInfo(const std::string &spacer) const {
     return (spacer + "OperatorNotExpression");
   }
@@ -72,6 +91,19 @@ class OperatorIsNullExpression : public AbstractExpression {
     }
   }
 
+  void EvaluateBatch(const ExpressionBatch &batch, const SelectionVector &sel,
+                     ColumnVector &result,
+                     executor::ExecutorContext *context) const {
+    assert(m_left);
+    ColumnVector operand;
+    m_left->EvaluateBatch(batch, sel, operand, context);
+
+    result.Reset(COLUMN_VECTOR_TYPE_BOOLEAN, VALUE_TYPE_BOOLEAN, sel.size());
+    for (size_t row = 0; row < sel.size(); row++) {
+      result.SetBoolean(row, operand.IsNull(row), false);
+    }
+  }
+
   std::string DebugInfo(const std::string &spacer) const {
     return (spacer + "OperatorIsNullExpression");
   }
@@ -202,6 +234,29 @@ class OperatorExpression : public AbstractExpression {
                    m_right->Evaluate(tuple1, tuple2, context));
   }
 
+  void EvaluateBatch(const ExpressionBatch &batch, const SelectionVector &sel,
+                     ColumnVector &result,
+                     executor::ExecutorContext *context) const {
+    assert(m_left);
+    assert(m_right);
+
+    ColumnVector left_result;
+    ColumnVector right_result;
+    m_left->EvaluateBatch(batch, sel, left_result, context);
+    m_right->EvaluateBatch(batch, sel, right_result, context);
+
+    if (ComputeColumnVectors(m_type, left_result, right_result, result))
+      return;
+
+    // No kernel for these types, or Value has to raise an error, so
+    // compute the Values like Evaluate does
+    result.Reset(COLUMN_VECTOR_TYPE_VALUE, VALUE_TYPE_INVALID, sel.size());
+    for (size_t row = 0; row < sel.size(); row++) {
+      result.SetValue(row, oper.op(left_result.GetValue(row),
+                                   right_result.GetValue(row)));
+    }
+  }
+
   std::string DebugInfo(const std::string &spacer) const {
     return (spacer + "OptimizedOperatorExpression");
   }
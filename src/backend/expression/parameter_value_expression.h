@@ -39,6 +39,13 @@ class ParameterValueExpression : public AbstractExpression {
                  __attribute__((unused)) const AbstractTuple *tuple2,
                  executor::ExecutorContext *context) const;
 
+  void EvaluateBatch(__attribute__((unused)) const ExpressionBatch &batch,
+                     __attribute__((unused)) const SelectionVector &sel,
+                     ColumnVector &result,
+                     executor::ExecutorContext *context) const {
+    result.SetConstant(Evaluate(nullptr, nullptr, context));
+  }
+
   bool HasParameter() const {
     // this class represents a parameter.
     return true;
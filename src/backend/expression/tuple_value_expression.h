@@ -56,6 +56,17 @@ class TupleValueExpression : public AbstractExpression {
     }
   }
 
+  void EvaluateBatch(const ExpressionBatch &batch, const SelectionVector &sel,
+                     ColumnVector &result,
+                     executor::ExecutorContext *context) const {
+    // A batch only holds the first tuple
+    if (tuple_idx != 0) {
+      AbstractExpression::EvaluateBatch(batch, sel, result, context);
+      return;
+    }
+    batch.GetColumn(value_idx, sel, result);
+  }
+
   std::string DebugInfo(const std::string &spacer) const {
     std::ostringstream buffer;
     buffer << spacer << "Optimized Column Reference[" << tuple_idx << ", "
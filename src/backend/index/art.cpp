@@ -0,0 +1,989 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// art.cpp
+//
+// Identification: src/backend/index/art.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "backend/index/art.h"
+
+namespace peloton {
+namespace index {
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::
+    AdaptiveRadixTree(const KeyEqualityChecker& equals)
+    : root_(new Node256(nullptr, 0)), equals_(equals) {
+  memory_footprint_ += sizeof(Node256);
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::~AdaptiveRadixTree() {
+  FreeSubtree(root_);
+  for (auto& slot : epoch_slots_) {
+    for (auto& garbage : slot.garbage_nodes_) {
+      FreeNode(garbage.second);
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+bool AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::Insert(const KeyType& key,
+                                                     const ValueType& value) {
+  EpochGuard guard(this);
+  bool inserted;
+  while (!TryInsert(key, value, inserted)) {
+  }
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+bool AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::Delete(const KeyType& key,
+                                                     const ValueType& value) {
+  EpochGuard guard(this);
+  bool deleted;
+  while (!TryDelete(key, value, deleted)) {
+  }
+  return deleted;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+std::vector<ValueType>
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::Lookup(const KeyType& key) {
+  EpochGuard guard(this);
+  std::vector<ValueType> values;
+  while (!TryLookup(key, values)) {
+  }
+  return values;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+bool AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::TryInsert(const KeyType& key,
+                                                        const ValueType& value,
+                                                        bool& inserted) {
+  InnerNode* parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+
+  InnerNode* node = root_;
+  uint64_t version;
+  if (!node->ReadLock(version)) return false;
+
+  size_t depth = 0;
+  while (true) {
+    // Where the key leaves the prefix of the node, if it does. The root has
+    // no prefix, so there is a parent if it does.
+    uint8_t prefix_length = node->prefix_length_;
+    uint8_t match_length = 0;
+    while (match_length < prefix_length &&
+           node->prefix_[match_length] ==
+               GetKeyByte(key, depth + match_length)) {
+      match_length++;
+    }
+
+    if (match_length < prefix_length) {
+      if (!parent->UpgradeToWriteLock(parent_version)) return false;
+      if (!node->UpgradeToWriteLock(version)) {
+        parent->WriteUnlock();
+        return false;
+      }
+
+      // A new node takes over the part of the prefix the key shares, with
+      // the key and a copy of the node with the rest of the prefix below it
+      InnerNode* split = NewInnerNode(NODE_4, node->prefix_, match_length);
+      AddChild(split, node->prefix_[match_length],
+               CopyInnerNode(node, node->type_,
+                             node->prefix_ + match_length + 1,
+                             prefix_length - match_length - 1, -1));
+      AddChild(split, GetKeyByte(key, depth + match_length),
+               NewLeaf(key, std::vector<ValueType>{value}));
+      ChangeChild(parent, parent_byte, split);
+
+      parent->WriteUnlock();
+      node->WriteUnlockObsolete();
+      RetireNode(node);
+      inserted = true;
+      return true;
+    }
+
+    depth += prefix_length;
+    uint8_t byte = GetKeyByte(key, depth);
+    Node* child = FindChild(node, byte);
+    bool full = IsFull(node);
+    if (!node->Validate(version)) return false;
+
+    if (child == nullptr) {
+      if (!full) {
+        if (!node->UpgradeToWriteLock(version)) return false;
+        AddChild(node, byte, NewLeaf(key, std::vector<ValueType>{value}));
+        node->WriteUnlock();
+        inserted = true;
+        return true;
+      }
+
+      // The root never fills up, so there is a parent
+      if (!parent->UpgradeToWriteLock(parent_version)) return false;
+      if (!node->UpgradeToWriteLock(version)) {
+        parent->WriteUnlock();
+        return false;
+      }
+
+      NodeType larger_type = (node->type_ == NODE_4)
+                                 ? NODE_16
+                                 : (node->type_ == NODE_16) ? NODE_48
+                                                            : NODE_256;
+      InnerNode* grown = CopyInnerNode(node, larger_type, node->prefix_,
+                                       prefix_length, -1);
+      AddChild(grown, byte, NewLeaf(key, std::vector<ValueType>{value}));
+      ChangeChild(parent, parent_byte, grown);
+
+      parent->WriteUnlock();
+      node->WriteUnlockObsolete();
+      RetireNode(node);
+      inserted = true;
+      return true;
+    }
+
+    if (child->type_ == LEAF) {
+      Leaf* leaf = static_cast<Leaf*>(child);
+
+      if (equals_(leaf->key_, key)) {
+        for (const auto& leaf_value : leaf->values_) {
+          if (value_equals_(leaf_value, value)) {
+            inserted = false;
+            return true;
+          }
+        }
+
+        // A copy with the new value takes the place of the leaf
+        if (!node->UpgradeToWriteLock(version)) return false;
+        std::vector<ValueType> values;
+        values.reserve(leaf->values_.size() + 1);
+        values.insert(values.end(), leaf->values_.begin(),
+                      leaf->values_.end());
+        values.push_back(value);
+        ChangeChild(node, byte, NewLeaf(key, std::move(values)));
+        node->WriteUnlock();
+        RetireNode(leaf);
+        inserted = true;
+        return true;
+      }
+
+      // Both keys go below a new node that holds the bytes they share
+      size_t split_depth = depth + 1;
+      while (GetKeyByte(leaf->key_, split_depth) ==
+             GetKeyByte(key, split_depth)) {
+        split_depth++;
+      }
+      uint8_t prefix[ART_MAX_KEY_SIZE];
+      for (size_t prefix_itr = depth + 1; prefix_itr < split_depth;
+           prefix_itr++) {
+        prefix[prefix_itr - depth - 1] = GetKeyByte(key, prefix_itr);
+      }
+
+      if (!node->UpgradeToWriteLock(version)) return false;
+      InnerNode* split =
+          NewInnerNode(NODE_4, prefix, split_depth - depth - 1);
+      AddChild(split, GetKeyByte(leaf->key_, split_depth), leaf);
+      AddChild(split, GetKeyByte(key, split_depth),
+               NewLeaf(key, std::vector<ValueType>{value}));
+      ChangeChild(node, byte, split);
+      node->WriteUnlock();
+      inserted = true;
+      return true;
+    }
+
+    InnerNode* inner_child = static_cast<InnerNode*>(child);
+    uint64_t child_version;
+    if (!inner_child->ReadLock(child_version)) return false;
+    if (!node->Validate(version)) return false;
+
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = inner_child;
+    version = child_version;
+    depth++;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+bool AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::TryDelete(const KeyType& key,
+                                                        const ValueType& value,
+                                                        bool& deleted) {
+  InnerNode* parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+
+  InnerNode* node = root_;
+  uint64_t version;
+  if (!node->ReadLock(version)) return false;
+
+  // The leaf compares the whole key, so the prefixes on the way down need
+  // not be checked
+  size_t depth = 0;
+  while (true) {
+    uint8_t prefix_length = node->prefix_length_;
+    depth += prefix_length;
+    uint8_t byte = GetKeyByte(key, depth);
+    Node* child = FindChild(node, byte);
+    bool underfull = (parent != nullptr) && IsUnderfull(node);
+    if (!node->Validate(version)) return false;
+
+    if (child == nullptr) {
+      deleted = false;
+      return true;
+    }
+
+    if (child->type_ == LEAF) {
+      Leaf* leaf = static_cast<Leaf*>(child);
+      auto value_itr = std::find_if(
+          leaf->values_.begin(), leaf->values_.end(),
+          [&](const ValueType& leaf_value) {
+            return value_equals_(leaf_value, value);
+          });
+      if (!equals_(leaf->key_, key) || value_itr == leaf->values_.end()) {
+        deleted = false;
+        return true;
+      }
+
+      if (leaf->values_.size() > 1) {
+        // A copy without the value takes the place of the leaf
+        if (!node->UpgradeToWriteLock(version)) return false;
+        std::vector<ValueType> values;
+        values.reserve(leaf->values_.size() - 1);
+        values.insert(values.end(), leaf->values_.begin(), value_itr);
+        values.insert(values.end(), value_itr + 1, leaf->values_.end());
+        ChangeChild(node, byte, NewLeaf(key, std::move(values)));
+        node->WriteUnlock();
+      } else if (!underfull) {
+        if (!node->UpgradeToWriteLock(version)) return false;
+        RemoveChild(node, byte);
+        node->WriteUnlock();
+      } else {
+        if (!parent->UpgradeToWriteLock(parent_version)) return false;
+        if (!node->UpgradeToWriteLock(version)) {
+          parent->WriteUnlock();
+          return false;
+        }
+
+        Node* replacement;
+        if (node->type_ == NODE_4) {
+          // The other child takes the place of the node, and an inner one
+          // takes over its prefix
+          std::vector<std::pair<uint8_t, Node*>> children;
+          GetChildren(node, children);
+          auto& other = (children[0].first == byte) ? children[1]
+                                                    : children[0];
+          replacement = other.second;
+          if (other.second->type_ != LEAF) {
+            InnerNode* other_inner = static_cast<InnerNode*>(other.second);
+            uint64_t other_version;
+            if (!other_inner->ReadLock(other_version) ||
+                !other_inner->UpgradeToWriteLock(other_version)) {
+              node->WriteUnlock();
+              parent->WriteUnlock();
+              return false;
+            }
+
+            uint8_t prefix[ART_MAX_KEY_SIZE];
+            ::memcpy(prefix, node->prefix_, prefix_length);
+            prefix[prefix_length] = other.first;
+            ::memcpy(prefix + prefix_length + 1, other_inner->prefix_,
+                     other_inner->prefix_length_);
+            replacement = CopyInnerNode(
+                other_inner, other_inner->type_, prefix,
+                prefix_length + 1 + other_inner->prefix_length_, -1);
+            other_inner->WriteUnlockObsolete();
+            RetireNode(other_inner);
+          }
+        } else {
+          NodeType smaller_type = (node->type_ == NODE_256)
+                                      ? NODE_48
+                                      : (node->type_ == NODE_48) ? NODE_16
+                                                                 : NODE_4;
+          replacement = CopyInnerNode(node, smaller_type, node->prefix_,
+                                      prefix_length, byte);
+        }
+        ChangeChild(parent, parent_byte, replacement);
+
+        parent->WriteUnlock();
+        node->WriteUnlockObsolete();
+        RetireNode(node);
+      }
+
+      RetireNode(leaf);
+      deleted = true;
+      return true;
+    }
+
+    InnerNode* inner_child = static_cast<InnerNode*>(child);
+    uint64_t child_version;
+    if (!inner_child->ReadLock(child_version)) return false;
+    if (!node->Validate(version)) return false;
+
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = inner_child;
+    version = child_version;
+    depth++;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+bool AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::
+    TryLookup(const KeyType& key, std::vector<ValueType>& values) {
+  InnerNode* node = root_;
+  uint64_t version;
+  if (!node->ReadLock(version)) return false;
+
+  // The leaf compares the whole key, so the prefixes on the way down need
+  // not be checked
+  size_t depth = 0;
+  while (true) {
+    depth += node->prefix_length_;
+    Node* child = FindChild(node, GetKeyByte(key, depth));
+    if (!node->Validate(version)) return false;
+
+    if (child == nullptr) return true;
+
+    // Leaves do not change, so they need no validation
+    if (child->type_ == LEAF) {
+      const Leaf* leaf = static_cast<const Leaf*>(child);
+      if (equals_(leaf->key_, key)) values = leaf->values_;
+      return true;
+    }
+
+    InnerNode* inner_child = static_cast<InnerNode*>(child);
+    uint64_t child_version;
+    if (!inner_child->ReadLock(child_version)) return false;
+    if (!node->Validate(version)) return false;
+
+    node = inner_child;
+    version = child_version;
+    depth++;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::
+    ScanForward(const KeyType* low_key, const ScanVisitor& visitor) {
+  Scan(low_key, true, visitor);
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::
+    ScanBackward(const KeyType* high_key, const ScanVisitor& visitor) {
+  Scan(high_key, false, visitor);
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::Scan(const KeyType* bound,
+                                                   bool forward,
+                                                   const ScanVisitor& visitor) {
+  EpochGuard guard(this);
+  std::vector<const Leaf*> leaves;
+
+  // After the first batch, we go on right after its last key
+  bool resumed = false;
+  KeyType resume_key;
+
+  while (true) {
+    leaves.clear();
+    if (!CollectLeaves(root_, 0, resumed ? &resume_key : bound, resumed,
+                       forward, leaves)) {
+      continue;
+    }
+
+    // The leaves are not freed before we deregister
+    for (const Leaf* leaf : leaves) {
+      if (forward) {
+        for (auto value = leaf->values_.begin(); value != leaf->values_.end();
+             ++value) {
+          if (!visitor(leaf->key_, *value)) return;
+        }
+      } else {
+        for (auto value = leaf->values_.rbegin();
+             value != leaf->values_.rend(); ++value) {
+          if (!visitor(leaf->key_, *value)) return;
+        }
+      }
+    }
+    if (leaves.size() < ART_SCAN_BATCH_SIZE) return;
+
+    resume_key = leaves.back()->key_;
+    resumed = true;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+bool AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::
+    CollectLeaves(InnerNode* node, size_t depth, const KeyType* bound,
+                  bool exclusive, bool forward,
+                  std::vector<const Leaf*>& leaves) {
+  uint64_t version;
+  if (!node->ReadLock(version)) return false;
+
+  // Once the prefix differs from the bound, the whole subtree is on one
+  // side of it
+  uint8_t prefix_length = node->prefix_length_;
+  for (uint8_t prefix_itr = 0; bound != nullptr && prefix_itr < prefix_length;
+       prefix_itr++) {
+    uint8_t prefix_byte = node->prefix_[prefix_itr];
+    uint8_t bound_byte = GetKeyByte(*bound, depth + prefix_itr);
+    if (prefix_byte == bound_byte) continue;
+    if ((prefix_byte < bound_byte) == forward) {
+      return node->Validate(version);
+    }
+    bound = nullptr;
+  }
+  depth += prefix_length;
+
+  std::vector<std::pair<uint8_t, Node*>> children;
+  GetChildren(node, children);
+  if (!node->Validate(version)) return false;
+  if (!forward) std::reverse(children.begin(), children.end());
+
+  for (const auto& child : children) {
+    const KeyType* child_bound = bound;
+    if (bound != nullptr) {
+      uint8_t bound_byte = GetKeyByte(*bound, depth);
+      if (child.first != bound_byte) {
+        if ((child.first < bound_byte) == forward) continue;
+        child_bound = nullptr;
+      }
+    }
+
+    if (child.second->type_ == LEAF) {
+      const Leaf* leaf = static_cast<const Leaf*>(child.second);
+      if (child_bound != nullptr) {
+        int comparison = CompareKeys(leaf->key_, *child_bound, depth + 1);
+        if (comparison == 0 ? exclusive : ((comparison < 0) == forward)) {
+          continue;
+        }
+      }
+      leaves.push_back(leaf);
+    } else if (!CollectLeaves(static_cast<InnerNode*>(child.second),
+                              depth + 1, child_bound, exclusive, forward,
+                              leaves)) {
+      return false;
+    }
+
+    if (leaves.size() == ART_SCAN_BATCH_SIZE) return true;
+  }
+
+  return true;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+typename AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                           ValueEqualityChecker>::Node*
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::FindChild(const InnerNode* node,
+                                                   uint8_t byte) const {
+  switch (node->type_) {
+    case NODE_4:
+      return FindSortedChild(static_cast<const Node4*>(node), byte);
+    case NODE_16:
+      return FindSortedChild(static_cast<const Node16*>(node), byte);
+    case NODE_48: {
+      const Node48* node48 = static_cast<const Node48*>(node);
+      uint8_t slot = node48->child_index_[byte].load(std::memory_order_acquire);
+      if (slot == Node48::EMPTY_SLOT) return nullptr;
+      return node48->children_[slot].load(std::memory_order_acquire);
+    }
+    case NODE_256:
+      return static_cast<const Node256*>(node)->children_[byte].load(
+          std::memory_order_acquire);
+    default:
+      return nullptr;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::
+    GetChildren(const InnerNode* node,
+                std::vector<std::pair<uint8_t, Node*>>& children) const {
+  switch (node->type_) {
+    case NODE_4:
+    case NODE_16: {
+      // A concurrent writer may leave the count past the entries we can see,
+      // the caller validates the node afterwards
+      size_t capacity = (node->type_ == NODE_4) ? 4 : 16;
+      size_t count = std::min<size_t>(node->GetCount(), capacity);
+      for (size_t pos = 0; pos < count; pos++) {
+        uint8_t byte;
+        Node* child;
+        if (node->type_ == NODE_4) {
+          const Node4* node4 = static_cast<const Node4*>(node);
+          byte = node4->keys_[pos].load(std::memory_order_acquire);
+          child = node4->children_[pos].load(std::memory_order_acquire);
+        } else {
+          const Node16* node16 = static_cast<const Node16*>(node);
+          byte = node16->keys_[pos].load(std::memory_order_acquire);
+          child = node16->children_[pos].load(std::memory_order_acquire);
+        }
+        if (child != nullptr) children.push_back(std::make_pair(byte, child));
+      }
+    } break;
+
+    case NODE_48: {
+      const Node48* node48 = static_cast<const Node48*>(node);
+      for (size_t byte = 0; byte < 256; byte++) {
+        uint8_t slot =
+            node48->child_index_[byte].load(std::memory_order_acquire);
+        if (slot == Node48::EMPTY_SLOT) continue;
+        Node* child = node48->children_[slot].load(std::memory_order_acquire);
+        if (child != nullptr) {
+          children.push_back(std::make_pair(static_cast<uint8_t>(byte), child));
+        }
+      }
+    } break;
+
+    case NODE_256: {
+      const Node256* node256 = static_cast<const Node256*>(node);
+      for (size_t byte = 0; byte < 256; byte++) {
+        Node* child = node256->children_[byte].load(std::memory_order_acquire);
+        if (child != nullptr) {
+          children.push_back(std::make_pair(static_cast<uint8_t>(byte), child));
+        }
+      }
+    } break;
+
+    default:
+      break;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::AddChild(InnerNode* node,
+                                                       uint8_t byte,
+                                                       Node* child) {
+  switch (node->type_) {
+    case NODE_4:
+      AddSortedChild(static_cast<Node4*>(node), byte, child);
+      break;
+    case NODE_16:
+      AddSortedChild(static_cast<Node16*>(node), byte, child);
+      break;
+    case NODE_48: {
+      // Slots are only written once the child is in place
+      Node48* node48 = static_cast<Node48*>(node);
+      uint8_t slot = 0;
+      while (node48->children_[slot].load(std::memory_order_relaxed) !=
+             nullptr) {
+        slot++;
+      }
+      node48->children_[slot].store(child, std::memory_order_release);
+      node48->child_index_[byte].store(slot, std::memory_order_release);
+      node48->count_.store(node48->count_.load() + 1,
+                           std::memory_order_release);
+    } break;
+    case NODE_256: {
+      Node256* node256 = static_cast<Node256*>(node);
+      node256->children_[byte].store(child, std::memory_order_release);
+      node256->count_.store(node256->count_.load() + 1,
+                            std::memory_order_release);
+    } break;
+    default:
+      break;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::ChangeChild(InnerNode* node,
+                                                          uint8_t byte,
+                                                          Node* child) {
+  switch (node->type_) {
+    case NODE_4:
+      ChangeSortedChild(static_cast<Node4*>(node), byte, child);
+      break;
+    case NODE_16:
+      ChangeSortedChild(static_cast<Node16*>(node), byte, child);
+      break;
+    case NODE_48: {
+      Node48* node48 = static_cast<Node48*>(node);
+      uint8_t slot = node48->child_index_[byte].load(std::memory_order_relaxed);
+      node48->children_[slot].store(child, std::memory_order_release);
+    } break;
+    case NODE_256:
+      static_cast<Node256*>(node)->children_[byte].store(
+          child, std::memory_order_release);
+      break;
+    default:
+      break;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::RemoveChild(InnerNode* node,
+                                                          uint8_t byte) {
+  switch (node->type_) {
+    case NODE_4:
+      RemoveSortedChild(static_cast<Node4*>(node), byte);
+      break;
+    case NODE_16:
+      RemoveSortedChild(static_cast<Node16*>(node), byte);
+      break;
+    case NODE_48: {
+      Node48* node48 = static_cast<Node48*>(node);
+      uint8_t slot = node48->child_index_[byte].load(std::memory_order_relaxed);
+      node48->child_index_[byte].store(Node48::EMPTY_SLOT,
+                                       std::memory_order_release);
+      node48->children_[slot].store(nullptr, std::memory_order_release);
+      node48->count_.store(node48->count_.load() - 1,
+                           std::memory_order_release);
+    } break;
+    case NODE_256: {
+      Node256* node256 = static_cast<Node256*>(node);
+      node256->children_[byte].store(nullptr, std::memory_order_release);
+      node256->count_.store(node256->count_.load() - 1,
+                            std::memory_order_release);
+    } break;
+    default:
+      break;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+template <typename SortedNode>
+typename AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                           ValueEqualityChecker>::Node*
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::FindSortedChild(const SortedNode* node,
+                                                         uint8_t byte) const {
+  const size_t capacity = sizeof(node->keys_) / sizeof(node->keys_[0]);
+  size_t count = std::min<size_t>(node->GetCount(), capacity);
+  for (size_t pos = 0; pos < count; pos++) {
+    uint8_t key_byte = node->keys_[pos].load(std::memory_order_acquire);
+    if (key_byte == byte) {
+      return node->children_[pos].load(std::memory_order_acquire);
+    }
+    if (key_byte > byte) break;
+  }
+  return nullptr;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+template <typename SortedNode>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::AddSortedChild(SortedNode* node,
+                                                             uint8_t byte,
+                                                             Node* child) {
+  uint16_t count = node->count_.load(std::memory_order_relaxed);
+  uint16_t pos = count;
+  while (pos > 0 &&
+         node->keys_[pos - 1].load(std::memory_order_relaxed) > byte) {
+    node->keys_[pos].store(node->keys_[pos - 1].load(std::memory_order_relaxed),
+                           std::memory_order_release);
+    node->children_[pos].store(
+        node->children_[pos - 1].load(std::memory_order_relaxed),
+        std::memory_order_release);
+    pos--;
+  }
+  node->keys_[pos].store(byte, std::memory_order_release);
+  node->children_[pos].store(child, std::memory_order_release);
+  node->count_.store(count + 1, std::memory_order_release);
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+template <typename SortedNode>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::
+    ChangeSortedChild(SortedNode* node, uint8_t byte, Node* child) {
+  uint16_t count = node->count_.load(std::memory_order_relaxed);
+  for (uint16_t pos = 0; pos < count; pos++) {
+    if (node->keys_[pos].load(std::memory_order_relaxed) == byte) {
+      node->children_[pos].store(child, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+template <typename SortedNode>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::RemoveSortedChild(SortedNode* node,
+                                                                uint8_t byte) {
+  uint16_t count = node->count_.load(std::memory_order_relaxed);
+  uint16_t pos = 0;
+  while (pos < count &&
+         node->keys_[pos].load(std::memory_order_relaxed) != byte) {
+    pos++;
+  }
+  for (; pos + 1 < count; pos++) {
+    node->keys_[pos].store(node->keys_[pos + 1].load(std::memory_order_relaxed),
+                           std::memory_order_release);
+    node->children_[pos].store(
+        node->children_[pos + 1].load(std::memory_order_relaxed),
+        std::memory_order_release);
+  }
+  node->count_.store(count - 1, std::memory_order_release);
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+typename AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                           ValueEqualityChecker>::InnerNode*
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::NewInnerNode(NodeType type,
+                                                      const uint8_t* prefix,
+                                                      uint8_t prefix_length) {
+  InnerNode* node;
+  switch (type) {
+    case NODE_4:
+      node = new Node4(prefix, prefix_length);
+      break;
+    case NODE_16:
+      node = new Node16(prefix, prefix_length);
+      break;
+    case NODE_48:
+      node = new Node48(prefix, prefix_length);
+      break;
+    default:
+      node = new Node256(prefix, prefix_length);
+      break;
+  }
+  memory_footprint_ += GetNodeSize(node);
+  return node;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+typename AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                           ValueEqualityChecker>::Leaf*
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::NewLeaf(const KeyType& key,
+                                                 std::vector<ValueType>&&
+                                                     values) {
+  Leaf* leaf = new Leaf(key, std::move(values));
+  memory_footprint_ += GetNodeSize(leaf);
+  return leaf;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+typename AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                           ValueEqualityChecker>::InnerNode*
+AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                  ValueEqualityChecker>::CopyInnerNode(const InnerNode* node,
+                                                       NodeType type,
+                                                       const uint8_t* prefix,
+                                                       uint8_t prefix_length,
+                                                       int skip_byte) {
+  InnerNode* copy = NewInnerNode(type, prefix, prefix_length);
+
+  std::vector<std::pair<uint8_t, Node*>> children;
+  GetChildren(node, children);
+  for (const auto& child : children) {
+    if (child.first == skip_byte) continue;
+    AddChild(copy, child.first, child.second);
+  }
+  return copy;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+size_t AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                         ValueEqualityChecker>::GetNodeSize(const Node* node)
+    const {
+  switch (node->type_) {
+    case NODE_4:
+      return sizeof(Node4);
+    case NODE_16:
+      return sizeof(Node16);
+    case NODE_48:
+      return sizeof(Node48);
+    case NODE_256:
+      return sizeof(Node256);
+    default:
+      return sizeof(Leaf) +
+             static_cast<const Leaf*>(node)->values_.capacity() *
+                 sizeof(ValueType);
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::FreeNode(Node* node) {
+  memory_footprint_ -= GetNodeSize(node);
+  switch (node->type_) {
+    case NODE_4:
+      delete static_cast<Node4*>(node);
+      break;
+    case NODE_16:
+      delete static_cast<Node16*>(node);
+      break;
+    case NODE_48:
+      delete static_cast<Node48*>(node);
+      break;
+    case NODE_256:
+      delete static_cast<Node256*>(node);
+      break;
+    default:
+      delete static_cast<Leaf*>(node);
+      break;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::FreeSubtree(Node* node) {
+  if (node->type_ != LEAF) {
+    std::vector<std::pair<uint8_t, Node*>> children;
+    GetChildren(static_cast<InnerNode*>(node), children);
+    for (const auto& child : children) {
+      FreeSubtree(child.second);
+    }
+  }
+  FreeNode(node);
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+bool AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::Cleanup() {
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    ReclaimGarbage(i);
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+size_t AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                         ValueEqualityChecker>::GetMemoryFootprint() const {
+  return memory_footprint_;
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::RegisterWorker() {
+  EpochSlot& slot = epoch_slots_[EpochThreadRegistry::GetThreadId()];
+  if (slot.depth_++ == 0) {
+    // Has to be visible before we read any node
+    slot.epoch_ = epoch_.load();
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::DeregisterWorker() {
+  EpochSlot& slot = epoch_slots_[EpochThreadRegistry::GetThreadId()];
+  assert(slot.depth_ > 0);
+  if (--slot.depth_ == 0) {
+    slot.epoch_ = QUIESCENT_EPOCH;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::RetireNode(Node* node) {
+  size_t slot_id = EpochThreadRegistry::GetThreadId();
+  EpochSlot& slot = epoch_slots_[slot_id];
+
+  // Threads that register from now on can not reach the node anymore
+  uint64_t retire_epoch = epoch_++;
+
+  slot.garbage_lock_.Lock();
+  slot.garbage_nodes_.emplace_back(retire_epoch, node);
+  bool reclaim = slot.garbage_nodes_.size() >= EPOCH_GC_BATCH_SIZE;
+  slot.garbage_lock_.Unlock();
+
+  if (reclaim) {
+    ReclaimGarbage(slot_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker>
+void AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker,
+                       ValueEqualityChecker>::ReclaimGarbage(size_t slot_id) {
+  EpochSlot& slot = epoch_slots_[slot_id];
+  uint64_t safe_epoch = epoch_;
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    uint64_t thread_epoch = epoch_slots_[i].epoch_;
+    if (thread_epoch < safe_epoch) safe_epoch = thread_epoch;
+  }
+
+  // Garbage is appended in epoch order, so we only need to cut off the front
+  std::vector<Node*> free_nodes;
+  slot.garbage_lock_.Lock();
+  auto nodes_end = slot.garbage_nodes_.begin();
+  while (nodes_end != slot.garbage_nodes_.end() &&
+         nodes_end->first < safe_epoch) {
+    free_nodes.push_back(nodes_end->second);
+    ++nodes_end;
+  }
+  slot.garbage_nodes_.erase(slot.garbage_nodes_.begin(), nodes_end);
+  slot.garbage_lock_.Unlock();
+
+  for (Node* node : free_nodes) {
+    FreeNode(node);
+  }
+}
+
+// Explicit template instantiation
+template class AdaptiveRadixTree<IntsKey<1>, ItemPointer,
+                                 IntsEqualityChecker<1>>;
+template class AdaptiveRadixTree<IntsKey<2>, ItemPointer,
+                                 IntsEqualityChecker<2>>;
+template class AdaptiveRadixTree<IntsKey<3>, ItemPointer,
+                                 IntsEqualityChecker<3>>;
+template class AdaptiveRadixTree<IntsKey<4>, ItemPointer,
+                                 IntsEqualityChecker<4>>;
+
+}  // End index namespace
+}  // End peloton namespace
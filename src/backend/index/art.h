@@ -0,0 +1,368 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// art.h
+//
+// Identification: src/backend/index/art.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "backend/common/types.h"
+#include "backend/common/platform.h"
+#include "backend/index/bwtree.h"
+#include "backend/index/index_key.h"
+
+#define ART_MAX_KEY_SIZE 32      // max # of bytes in a key
+#define ART_SCAN_BATCH_SIZE 64  // # of leaves a scan copies out at a time
+
+namespace peloton {
+namespace index {
+
+/**
+ * Adaptive radix tree over integer keys. The key is split into bytes,
+ * most significant first, so that the byte order of keys is their order as
+ * IntsKeys. Every inner node has one child per distinct next byte, and
+ * grows (and shrinks again) through four node types that hold up to 4, 16,
+ * 48 and 256 children. Bytes that all keys below a node share are kept in
+ * the node as its prefix instead of a chain of nodes with one child each.
+ * A leaf holds one key with all its values.
+ *
+ * Inner nodes have a version latch like the nodes of the OLCBTree: readers
+ * validate versions instead of taking locks and restart from the root if a
+ * node changed, and writers lock only the nodes they change. Leaves and
+ * node prefixes never change once they are published; to change them, a
+ * copy takes their place. Replaced nodes are freed by epoch.
+ */
+template <typename KeyType, typename ValueType, class KeyEqualityChecker,
+          class ValueEqualityChecker = ItemPointerEqualityChecker>
+class AdaptiveRadixTree {
+  static_assert(sizeof(KeyType) <= ART_MAX_KEY_SIZE,
+                "ART keys have to fit into ART_MAX_KEY_SIZE bytes");
+
+ public:
+  AdaptiveRadixTree(const KeyEqualityChecker& equals);
+  ~AdaptiveRadixTree();
+
+  // Adds the entry, returns false if it is there already
+  bool Insert(const KeyType& key, const ValueType& value);
+
+  // Removes the entry, returns false if it is not there
+  bool Delete(const KeyType& key, const ValueType& value);
+
+  // Values of the key
+  std::vector<ValueType> Lookup(const KeyType& key);
+
+  // Called for the entries in a scan until it returns false
+  typedef std::function<bool(const KeyType&, const ValueType&)> ScanVisitor;
+
+  // Visits the entries with a key >= low_key (all if it is null) in order
+  void ScanForward(const KeyType* low_key, const ScanVisitor& visitor);
+
+  // Visits the entries with a key <= high_key (all if it is null) in
+  // reverse order
+  void ScanBackward(const KeyType* high_key, const ScanVisitor& visitor);
+
+  // Frees all retired nodes that no thread can still be reading
+  bool Cleanup();
+
+  // Calculates the bytes of heap memory used
+  size_t GetMemoryFootprint() const;
+
+ private:
+  static constexpr size_t KEY_SIZE = sizeof(KeyType);
+
+  // ***** Nodes
+
+  enum NodeType : uint8_t { NODE_4, NODE_16, NODE_48, NODE_256, LEAF };
+
+  class Node {
+   public:
+    const NodeType type_;
+
+    explicit Node(NodeType type) : type_(type) {}
+  };
+
+  class Leaf : public Node {
+   public:
+    const KeyType key_;
+
+    const std::vector<ValueType> values_;
+
+    Leaf(const KeyType& key, std::vector<ValueType>&& values)
+        : Node(LEAF), key_(key), values_(std::move(values)) {}
+  };
+
+  class InnerNode : public Node {
+   public:
+    // Bit 0 is set once the node has been replaced, bit 1 while it is
+    // locked. The rest counts the changes made to the node.
+    std::atomic<uint64_t> version_;
+
+    // # of children
+    std::atomic<uint16_t> count_;
+
+    // Key bytes shared by everything below the node, right before the byte
+    // that picks the child
+    const uint8_t prefix_length_;
+    uint8_t prefix_[ART_MAX_KEY_SIZE];
+
+    InnerNode(NodeType type, const uint8_t* prefix, uint8_t prefix_length)
+        : Node(type), version_(0), count_(0), prefix_length_(prefix_length) {
+      if (prefix_length > 0) ::memcpy(prefix_, prefix, prefix_length);
+    }
+
+    // ***** Version latch
+
+    // Remembers the version, fails if the node is locked or obsolete
+    inline bool ReadLock(uint64_t& version) const {
+      version = version_.load(std::memory_order_acquire);
+      return (version & 3) == 0;
+    }
+
+    // Whether nothing changed since ReadLock() returned version
+    inline bool Validate(uint64_t version) const {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return version_.load(std::memory_order_relaxed) == version;
+    }
+
+    // Locks the node if nothing changed since ReadLock() returned version
+    inline bool UpgradeToWriteLock(uint64_t version) {
+      return version_.compare_exchange_strong(version, version + 2);
+    }
+
+    inline void WriteUnlock() { version_.fetch_add(2); }
+
+    // Unlocks a node that has been replaced, all readers will restart
+    inline void WriteUnlockObsolete() { version_.fetch_add(3); }
+
+    inline uint16_t GetCount() const {
+      return count_.load(std::memory_order_acquire);
+    }
+  };
+
+  // Children sorted by their byte
+  class Node4 : public InnerNode {
+   public:
+    std::atomic<uint8_t> keys_[4];
+    std::atomic<Node*> children_[4];
+
+    Node4(const uint8_t* prefix, uint8_t prefix_length)
+        : InnerNode(NODE_4, prefix, prefix_length) {}
+  };
+
+  class Node16 : public InnerNode {
+   public:
+    std::atomic<uint8_t> keys_[16];
+    std::atomic<Node*> children_[16];
+
+    Node16(const uint8_t* prefix, uint8_t prefix_length)
+        : InnerNode(NODE_16, prefix, prefix_length) {}
+  };
+
+  // Children in any of the 48 slots, child_index_ maps a byte to its slot
+  class Node48 : public InnerNode {
+   public:
+    static const uint8_t EMPTY_SLOT = 48;
+
+    std::atomic<uint8_t> child_index_[256];
+    std::atomic<Node*> children_[48];
+
+    Node48(const uint8_t* prefix, uint8_t prefix_length)
+        : InnerNode(NODE_48, prefix, prefix_length) {
+      for (auto& slot : child_index_) slot.store(EMPTY_SLOT);
+      for (auto& child : children_) child.store(nullptr);
+    }
+  };
+
+  class Node256 : public InnerNode {
+   public:
+    std::atomic<Node*> children_[256];
+
+    Node256(const uint8_t* prefix, uint8_t prefix_length)
+        : InnerNode(NODE_256, prefix, prefix_length) {
+      for (auto& child : children_) child.store(nullptr);
+    }
+  };
+
+  // ***** Functions for internal usage
+
+  static inline uint8_t GetKeyByte(const KeyType& key, size_t depth) {
+    return static_cast<uint8_t>(
+        key.data[depth / sizeof(uint64_t)] >>
+        ((sizeof(uint64_t) - 1 - depth % sizeof(uint64_t)) * 8));
+  }
+
+  // Compares the keys from the given byte on, the ones before are equal
+  static inline int CompareKeys(const KeyType& lhs, const KeyType& rhs,
+                                size_t depth) {
+    for (; depth < KEY_SIZE; depth++) {
+      uint8_t lhs_byte = GetKeyByte(lhs, depth);
+      uint8_t rhs_byte = GetKeyByte(rhs, depth);
+      if (lhs_byte != rhs_byte) return lhs_byte < rhs_byte ? -1 : 1;
+    }
+    return 0;
+  }
+
+  // One attempt at each operation, returns false if it has to restart
+  bool TryInsert(const KeyType& key, const ValueType& value, bool& inserted);
+  bool TryDelete(const KeyType& key, const ValueType& value, bool& deleted);
+  bool TryLookup(const KeyType& key, std::vector<ValueType>& values);
+
+  // Appends the leaves below node to leaves in key order, or in reverse
+  // order if forward is not set, until there are ART_SCAN_BATCH_SIZE of
+  // them. depth is the # of key bytes above node. Leaves before the bound,
+  // if there is one, are skipped, and so is the bound itself if exclusive
+  // is set. Returns false if the scan has to restart.
+  bool CollectLeaves(InnerNode* node, size_t depth, const KeyType* bound,
+                     bool exclusive, bool forward,
+                     std::vector<const Leaf*>& leaves);
+
+  // Runs a scan in batches of leaves, resuming after the last leaf
+  void Scan(const KeyType* bound, bool forward, const ScanVisitor& visitor);
+
+  // ***** Node operations, writers need the lock on the node
+
+  Node* FindChild(const InnerNode* node, uint8_t byte) const;
+
+  // Children with their bytes in ascending order
+  void GetChildren(const InnerNode* node,
+                   std::vector<std::pair<uint8_t, Node*>>& children) const;
+
+  // Adds a child for a byte that has none, the node must have room
+  void AddChild(InnerNode* node, uint8_t byte, Node* child);
+
+  // Points the child of a byte to a new node
+  void ChangeChild(InnerNode* node, uint8_t byte, Node* child);
+
+  void RemoveChild(InnerNode* node, uint8_t byte);
+
+  // Node4 and Node16 keep their children sorted by byte
+  template <typename SortedNode>
+  Node* FindSortedChild(const SortedNode* node, uint8_t byte) const;
+  template <typename SortedNode>
+  void AddSortedChild(SortedNode* node, uint8_t byte, Node* child);
+  template <typename SortedNode>
+  void ChangeSortedChild(SortedNode* node, uint8_t byte, Node* child);
+  template <typename SortedNode>
+  void RemoveSortedChild(SortedNode* node, uint8_t byte);
+
+  inline bool IsFull(const InnerNode* node) const {
+    switch (node->type_) {
+      case NODE_4:
+        return node->GetCount() == 4;
+      case NODE_16:
+        return node->GetCount() == 16;
+      case NODE_48:
+        return node->GetCount() == 48;
+      default:
+        return false;
+    }
+  }
+
+  // Whether the node is replaced by a smaller one after losing a child. A
+  // Node4 left with one child is merged into it.
+  inline bool IsUnderfull(const InnerNode* node) const {
+    switch (node->type_) {
+      case NODE_4:
+        return node->GetCount() <= 2;
+      case NODE_16:
+        return node->GetCount() <= 4;
+      case NODE_48:
+        return node->GetCount() <= 13;
+      case NODE_256:
+        return node->GetCount() <= 38;
+      default:
+        return false;
+    }
+  }
+
+  // New empty node of the given type
+  InnerNode* NewInnerNode(NodeType type, const uint8_t* prefix,
+                          uint8_t prefix_length);
+
+  Leaf* NewLeaf(const KeyType& key, std::vector<ValueType>&& values);
+
+  // Copy of a node of the given type with another prefix, without the child
+  // of skip_byte if it is not negative
+  InnerNode* CopyInnerNode(const InnerNode* node, NodeType type,
+                           const uint8_t* prefix, uint8_t prefix_length,
+                           int skip_byte);
+
+  // Bytes of heap memory held by a node
+  size_t GetNodeSize(const Node* node) const;
+
+  void FreeNode(Node* node);
+
+  // Frees a whole subtree, only used when no other thread is around
+  void FreeSubtree(Node* node);
+
+  // ***** Epoch based reclamation
+
+  void RegisterWorker();
+  void DeregisterWorker();
+
+  // Frees a replaced node once no thread can still be reading it
+  void RetireNode(Node* node);
+
+  void ReclaimGarbage(size_t slot_id);
+
+  // Registers the calling thread for the scope of an operation
+  class EpochGuard {
+   public:
+    explicit EpochGuard(AdaptiveRadixTree* tree) : tree_(tree) {
+      tree_->RegisterWorker();
+    }
+    ~EpochGuard() { tree_->DeregisterWorker(); }
+
+   private:
+    AdaptiveRadixTree* tree_;
+  };
+
+  // ***** Members
+
+  // Never replaced, so that there is no parent to lock above it
+  Node256* const root_;
+
+  KeyEqualityChecker equals_;
+  ValueEqualityChecker value_equals_;
+
+  std::atomic<size_t> memory_footprint_{0};
+
+  std::atomic<uint64_t> epoch_{0};
+
+  static constexpr uint64_t QUIESCENT_EPOCH =
+      std::numeric_limits<uint64_t>::max();
+
+  // Padded like the epoch slots of the BWTree
+  struct EpochSlot {
+    // Epoch the thread registered in, QUIESCENT_EPOCH if it isn't registered
+    std::atomic<uint64_t> epoch_{QUIESCENT_EPOCH};
+
+    // Nesting depth of RegisterWorker(), only touched by the owner
+    uint32_t depth_ = 0;
+
+    // Nodes retired by the thread, with the epoch they were retired in
+    std::vector<std::pair<uint64_t, Node*>> garbage_nodes_;
+
+    // Only contended when Cleanup() reclaims on behalf of the owner
+    Spinlock garbage_lock_;
+
+    char cache_line_padding_[64];
+  };
+
+  EpochSlot epoch_slots_[EPOCH_MAX_THREADS];
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,283 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// art_index.cpp
+//
+// Identification: src/backend/index/art_index.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/common/logger.h"
+#include "backend/index/art_index.h"
+#include "backend/index/index_key.h"
+#include "backend/storage/tuple.h"
+
+namespace peloton {
+namespace index {
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ARTIndex(
+    IndexMetadata *metadata)
+    : Index(metadata),
+      container(KeyEqualityChecker(metadata)),
+      equals(metadata),
+      comparator(metadata) {}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::~ARTIndex() {}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+bool ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    InsertEntry(const storage::Tuple *key, const ItemPointer location) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  // Insert the key, val pair
+  return container.Insert(index_key, location);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+bool ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    DeleteEntry(const storage::Tuple *key, const ItemPointer location) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  // Delete the key, val pair
+  return container.Delete(index_key, location);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+void ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    ConstructLeadingColumnKey(KeyType &key, const Value &value,
+                              uint8_t fill_byte) {
+  const catalog::Schema *key_schema = metadata->GetKeySchema();
+
+  std::unique_ptr<storage::Tuple> key_tuple(
+      new storage::Tuple(key_schema, true));
+  ConstructLeadingColumnTuple(key_tuple.get(), value);
+  key.SetFromKey(key_tuple.get());
+
+  // The other columns take up the bytes after the leading one
+  for (size_t byte_itr = GetTypeSize(key_schema->GetType(0));
+       byte_itr < sizeof(KeyType); byte_itr++) {
+    size_t shift = (sizeof(uint64_t) - 1 - byte_itr % sizeof(uint64_t)) * 8;
+    uint64_t &word = key.data[byte_itr / sizeof(uint64_t)];
+    word = (word & ~(UINT64_C(0xFF) << shift)) |
+           (static_cast<uint64_t>(fill_byte) << shift);
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+template <typename Visitor>
+void ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    ScanMatches(const std::vector<Value> &values,
+                const std::vector<oid_t> &key_column_ids,
+                const std::vector<ExpressionType> &expr_types,
+                const ScanDirectionType &scan_direction, BatchState *batch,
+                const Visitor &visitor) {
+  const catalog::Schema *key_schema = metadata->GetKeySchema();
+
+  // Constraints on the leading key column tell us where the matching keys
+  // start and end, so that we only visit that part of the tree
+  const Value *low_value;
+  const Value *high_value;
+  GetLeadingColumnBounds(values, key_column_ids, expr_types, low_value,
+                         high_value);
+
+  // Later batches start where the last one stopped
+  const KeyType *resume_key =
+      (batch != nullptr) ? batch->GetResumeKey() : nullptr;
+
+  // The keys are decoded into the same tuple one after the other
+  storage::Tuple tuple(key_schema, true);
+
+  // Hands a match to the visitor, returns false once the batch is full
+  bool stopped = false;
+  auto emit = [&](const KeyType &key, const ItemPointer &location) {
+    if (batch != nullptr) {
+      if (batch->IsFull()) {
+        stopped = true;
+        return false;
+      }
+      if (!batch->Admit(key)) return true;
+    }
+    visitor(tuple, location);
+    return true;
+  };
+
+  switch (scan_direction) {
+    case SCAN_DIRECTION_TYPE_FORWARD: {
+      KeyType start_key;
+      if (resume_key != nullptr) {
+        start_key = *resume_key;
+      } else if (low_value != nullptr) {
+        ConstructLeadingColumnKey(start_key, *low_value, 0x00);
+      }
+
+      // Scan the index entries in forward direction
+      container.ScanForward(
+          (resume_key != nullptr || low_value != nullptr) ? &start_key
+                                                          : nullptr,
+          [&](const KeyType &key, const ItemPointer &location) {
+            key.CopyToTuple(&tuple);
+
+            // We are past the end of the range
+            if (high_value != nullptr &&
+                tuple.GetValue(0).Compare(*high_value) ==
+                    VALUE_COMPARE_GREATERTHAN)
+              return false;
+
+            // Compare the current key in the scan with "values" based on
+            // "expression types"
+            // For instance, "5" EXPR_GREATER_THAN "2" is true
+            if (Compare(tuple, key_column_ids, expr_types, values) == true)
+              return emit(key, location);
+            return true;
+          });
+    } break;
+
+    case SCAN_DIRECTION_TYPE_BACKWARD: {
+      KeyType end_key;
+      if (resume_key != nullptr) {
+        end_key = *resume_key;
+      } else if (high_value != nullptr) {
+        ConstructLeadingColumnKey(end_key, *high_value, 0xFF);
+      }
+
+      // Scan the index entries in backward direction
+      container.ScanBackward(
+          (resume_key != nullptr || high_value != nullptr) ? &end_key
+                                                           : nullptr,
+          [&](const KeyType &key, const ItemPointer &location) {
+            key.CopyToTuple(&tuple);
+
+            // We are past the start of the range
+            if (low_value != nullptr &&
+                tuple.GetValue(0).Compare(*low_value) ==
+                    VALUE_COMPARE_LESSTHAN)
+              return false;
+
+            if (Compare(tuple, key_column_ids, expr_types, values) == true)
+              return emit(key, location);
+            return true;
+          });
+    } break;
+
+    case SCAN_DIRECTION_TYPE_INVALID:
+    default:
+      throw Exception("Invalid scan direction \n");
+      break;
+  }
+
+  if (batch != nullptr) batch->Finish(!stopped, key_schema, GetPool());
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
+    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType &scan_direction) {
+  std::vector<ItemPointer> result;
+
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, nullptr,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanBatch(
+    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType &scan_direction, size_t max_count,
+    ScanCursor &cursor) {
+  std::vector<ItemPointer> result;
+  if (cursor.done) return result;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+void ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    ScanEntries(const std::vector<Value> &values,
+                const std::vector<oid_t> &key_column_ids,
+                const std::vector<ExpressionType> &expr_types,
+                const ScanDirectionType &scan_direction, size_t max_count,
+                ScanCursor &cursor, const EntryVisitor &visitor) {
+  if (cursor.done) return;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              visitor);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanAllKeys() {
+  std::vector<ItemPointer> result;
+
+  container.ScanForward(nullptr,
+                        [&](const KeyType &, const ItemPointer &location) {
+                          result.push_back(location);
+                          return true;
+                        });
+
+  return result;
+}
+
+/**
+ * @brief Return all locations related to this key.
+ */
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+ARTIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanKey(
+    const storage::Tuple *key) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  return container.Lookup(index_key);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::string ARTIndex<KeyType, ValueType, KeyComparator,
+                     KeyEqualityChecker>::GetTypeName() const {
+  return "ART";
+}
+
+// Explicit template instantiation
+template class ARTIndex<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                        IntsEqualityChecker<1>>;
+template class ARTIndex<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                        IntsEqualityChecker<2>>;
+template class ARTIndex<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                        IntsEqualityChecker<3>>;
+template class ARTIndex<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                        IntsEqualityChecker<4>>;
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// art_index.h
+//
+// Identification: src/backend/index/art_index.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "backend/catalog/manager.h"
+#include "backend/common/platform.h"
+#include "backend/common/types.h"
+#include "backend/index/index.h"
+#include "backend/index/batch_scan_state.h"
+
+#include "backend/index/art.h"
+
+namespace peloton {
+namespace index {
+
+/**
+ * Adaptive radix tree index for keys made up of integer columns only, e.g.
+ * dense surrogate keys. Point lookups follow one node per key byte instead
+ * of searching a node per tree level, and sparse nodes stay small.
+ *
+ * @see Index
+ */
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+class ARTIndex : public Index {
+  friend class IndexFactory;
+
+  typedef AdaptiveRadixTree<KeyType, ValueType, KeyEqualityChecker> MapType;
+
+ public:
+  ARTIndex(IndexMetadata *metadata);
+
+  ~ARTIndex();
+
+  bool InsertEntry(const storage::Tuple *key, const ItemPointer location);
+
+  bool DeleteEntry(const storage::Tuple *key, const ItemPointer location);
+
+  std::vector<ItemPointer> Scan(const std::vector<Value> &values,
+                                const std::vector<oid_t> &key_column_ids,
+                                const std::vector<ExpressionType> &expr_types,
+                                const ScanDirectionType &scan_direction);
+
+  bool SupportsIndexOnlyScan() const { return true; }
+
+  std::vector<ItemPointer> ScanBatch(
+      const std::vector<Value> &values,
+      const std::vector<oid_t> &key_column_ids,
+      const std::vector<ExpressionType> &expr_types,
+      const ScanDirectionType &scan_direction, size_t max_count,
+      ScanCursor &cursor);
+
+  void ScanEntries(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType &scan_direction, size_t max_count,
+                   ScanCursor &cursor, const EntryVisitor &visitor);
+
+  std::vector<ItemPointer> ScanAllKeys();
+
+  std::vector<ItemPointer> ScanKey(const storage::Tuple *key);
+
+  std::string GetTypeName() const;
+
+  bool Cleanup() { return container.Cleanup(); }
+
+  size_t GetMemoryFootprint() { return container.GetMemoryFootprint(); }
+
+ protected:
+  typedef BatchScanState<KeyType, KeyEqualityChecker> BatchState;
+
+  // Calls visitor with the key tuple and location of every entry that
+  // matches the scan, or only of those in the batch if there is one
+  template <typename Visitor>
+  void ScanMatches(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType &scan_direction, BatchState *batch,
+                   const Visitor &visitor);
+
+  // Smallest (fill_byte 0x00) or largest (0xFF) key with the given value in
+  // the leading key column
+  void ConstructLeadingColumnKey(KeyType &key, const Value &value,
+                                 uint8_t fill_byte);
+
+  // container
+  MapType container;
+
+  // equality checker and comparator
+  KeyEqualityChecker equals;
+  KeyComparator comparator;
+};
+
+}  // End index namespace
+}  // End peloton namespace
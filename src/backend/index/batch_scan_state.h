@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// batch_scan_state.h
+//
+// Identification: src/backend/index/batch_scan_state.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+
+#include "backend/catalog/schema.h"
+#include "backend/index/index.h"
+#include "backend/index/index_key.h"
+#include "backend/storage/tuple.h"
+
+namespace peloton {
+namespace index {
+
+/**
+ * Bookkeeping for one batch of a scan over an ordered index. The batch
+ * starts at the key where the cursor stopped, skips the entries of that key
+ * that earlier batches returned, and saves where it stopped in the cursor.
+ */
+template <typename KeyType, class KeyEqualityChecker>
+class BatchScanState {
+ public:
+  BatchScanState(Index::ScanCursor &cursor, size_t max_count,
+                 const KeyEqualityChecker &equals)
+      : cursor_(cursor),
+        max_count_(max_count),
+        equals_(equals),
+        resumed_(cursor.key != nullptr),
+        skip_count_(cursor.key_entry_count),
+        last_key_count_(cursor.key_entry_count) {
+    if (resumed_) last_key_.SetFromKey(cursor.key.get());
+  }
+
+  // Key the batch starts at, null for the first batch
+  const KeyType *GetResumeKey() const {
+    return resumed_ ? &last_key_ : nullptr;
+  }
+
+  // Whether a matching entry belongs to this batch, i.e. has not been
+  // returned before. Has to be called for the matches in scan order.
+  inline bool Admit(const KeyType &key) {
+    if (skip_count_ > 0) {
+      if (equals_(key, last_key_)) {
+        skip_count_--;
+        return false;
+      }
+      skip_count_ = 0;
+    }
+
+    if ((count_ > 0 || resumed_) && equals_(key, last_key_)) {
+      last_key_count_++;
+    } else {
+      last_key_ = key;
+      last_key_count_ = 1;
+    }
+    count_++;
+    return true;
+  }
+
+  inline bool IsFull() const { return count_ == max_count_; }
+
+  // Saves where the batch stopped. done is set if the scan ran to the end of
+  // its range.
+  void Finish(bool done, const catalog::Schema *key_schema, VarlenPool *pool) {
+    cursor_.done = done;
+    if (done) return;
+
+    // The last key may still point into the old cursor key
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    CopyKey(last_key_, key.get(), pool);
+    cursor_.key = std::move(key);
+    cursor_.key_entry_count = last_key_count_;
+  }
+
+ private:
+  template <typename Key>
+  static void CopyKey(Key &key, storage::Tuple *tuple, VarlenPool *pool) {
+    auto key_tuple = key.GetTupleForComparison(tuple->GetSchema());
+    tuple->Copy(key_tuple.GetData(), pool);
+  }
+
+  // Integer keys are not laid out like a tuple
+  template <std::size_t KeySize>
+  static void CopyKey(IntsKey<KeySize> &key, storage::Tuple *tuple,
+                      VarlenPool *) {
+    key.CopyToTuple(tuple);
+  }
+
+  Index::ScanCursor &cursor_;
+
+  const size_t max_count_;
+
+  const KeyEqualityChecker &equals_;
+
+  // Whether an earlier batch stopped somewhere
+  const bool resumed_;
+
+  // # of entries of the resume key still to skip
+  size_t skip_count_;
+
+  // Key of the last entry returned, and # of entries with that key
+  KeyType last_key_;
+  size_t last_key_count_;
+
+  // # of entries returned by this batch
+  size_t count_ = 0;
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "backend/index/btree_index.h"
 #include "backend/index/index_key.h"
 #include "backend/common/logger.h"
@@ -43,6 +45,32 @@ bool BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::InsertEn
 
     index_lock.Unlock();
   }
+  insert_count.Add();
+
+  return true;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
+bool BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::InsertEntries(
+    const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+        entries) {
+  // Build the keys before taking the lock
+  std::vector<std::pair<KeyType, ValueType>> items(entries.size());
+  for (size_t entry_itr = 0; entry_itr < entries.size(); entry_itr++) {
+    items[entry_itr].first.SetFromKey(entries[entry_itr].first);
+    items[entry_itr].second = entries[entry_itr].second;
+  }
+
+  {
+    index_lock.WriteLock();
+
+    for (auto &item : items) {
+      container.insert(item);
+    }
+
+    index_lock.Unlock();
+  }
+  insert_count.Add(items.size());
 
   return true;
 }
@@ -80,19 +108,23 @@ bool BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::DeleteEn
 
     index_lock.Unlock();
   }
+  delete_count.Add();
 
   return true;
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
-std::vector<ItemPointer>
-BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
+template <typename Visitor>
+void BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanMatches(
     const std::vector<Value> &values,
     const std::vector<oid_t> &key_column_ids,
     const std::vector<ExpressionType> &expr_types,
-    const ScanDirectionType& scan_direction) {
-  std::vector<ItemPointer> result;
+    const ScanDirectionType& scan_direction,
+    BatchState *batch,
+    const Visitor &visitor) {
   KeyType index_key;
+  bool stopped = false;
+  size_t match_count = 0;
 
   {
     index_lock.ReadLock();
@@ -134,6 +166,11 @@ BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
       scan_begin_itr = container.equal_range(index_key).first;
     }
 
+    // Later batches start where the last one stopped
+    if (batch != nullptr && batch->GetResumeKey() != nullptr) {
+      scan_begin_itr = container.lower_bound(*batch->GetResumeKey());
+    }
+
     switch(scan_direction){
       case SCAN_DIRECTION_TYPE_FORWARD:
       case SCAN_DIRECTION_TYPE_BACKWARD: {
@@ -147,7 +184,15 @@ BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
           // For instance, "5" EXPR_GREATER_THAN "2" is true
           if (Compare(tuple, key_column_ids, expr_types, values) == true) {
             ItemPointer location = scan_itr->second;
-            result.push_back(location);
+            if (batch != nullptr) {
+              if (batch->IsFull()) {
+                stopped = true;
+                break;
+              }
+              if (!batch->Admit(scan_current_key)) continue;
+            }
+            visitor(tuple, location);
+            match_count++;
           }
           else {
             // We can stop scanning if we know that all constraints are equal
@@ -166,12 +211,68 @@ BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
         break;
     }
 
+    if (batch != nullptr) {
+      batch->Finish(!stopped, metadata->GetKeySchema(), GetPool());
+    }
+
     index_lock.Unlock();
   }
+  scan_count.Add();
+  scan_result_size.Add(match_count);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
+std::vector<ItemPointer>
+BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
+    const std::vector<Value> &values,
+    const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType& scan_direction) {
+  std::vector<ItemPointer> result;
+
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, nullptr,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
+std::vector<ItemPointer>
+BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanBatch(
+    const std::vector<Value> &values,
+    const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType& scan_direction,
+    size_t max_count, ScanCursor &cursor) {
+  std::vector<ItemPointer> result;
+  if (cursor.done) return result;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
 
   return result;
 }
 
+template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
+void BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanEntries(
+    const std::vector<Value> &values,
+    const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType& scan_direction,
+    size_t max_count, ScanCursor &cursor,
+    const EntryVisitor &visitor) {
+  if (cursor.done) return;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              visitor);
+}
+
 template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
 std::vector<ItemPointer>
 BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanAllKeys() {
@@ -217,10 +318,104 @@ BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanKey(
 
     index_lock.Unlock();
   }
+  lookup_count.Add();
 
   return result;
 }
 
+/**
+ * @brief Return the locations of each key. The keys are looked up in sorted
+ * order in one pass, walking along the leaves from one key to the next one
+ * when it is close by instead of searching from the root again.
+ */
+template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
+std::vector<std::vector<ItemPointer>>
+BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanKeys(
+    const std::vector<const storage::Tuple *> &keys) {
+  std::vector<std::vector<ItemPointer>> result(keys.size());
+
+  std::vector<KeyType> index_keys(keys.size());
+  std::vector<size_t> key_order(keys.size());
+  for (size_t key_itr = 0; key_itr < keys.size(); key_itr++) {
+    index_keys[key_itr].SetFromKey(keys[key_itr]);
+    key_order[key_itr] = key_itr;
+  }
+
+  std::sort(key_order.begin(), key_order.end(), [&](size_t a, size_t b) {
+    return comparator(index_keys[a], index_keys[b]);
+  });
+
+  {
+    index_lock.ReadLock();
+
+    auto entry = container.end();
+    const KeyType *last_key = nullptr;
+    size_t last_key_itr = 0;
+
+    for (auto key_itr : key_order) {
+      const KeyType &index_key = index_keys[key_itr];
+
+      // Same key as the last probe
+      if (last_key != nullptr && equals(*last_key, index_key)) {
+        result[key_itr] = result[last_key_itr];
+        continue;
+      }
+
+      // The entry is past the last key, so the next one is near unless the
+      // keys are far apart
+      size_t step_count = 0;
+      if (last_key != nullptr) {
+        while (entry != container.end() && comparator(entry->first, index_key) &&
+               step_count < BTREE_PROBE_MAX_STEPS) {
+          ++entry;
+          step_count++;
+        }
+      }
+      if (last_key == nullptr ||
+          (entry != container.end() && comparator(entry->first, index_key))) {
+        entry = container.lower_bound(index_key);
+      }
+
+      for (; entry != container.end() && equals(entry->first, index_key);
+           ++entry) {
+        result[key_itr].push_back(entry->second);
+      }
+
+      last_key = &index_key;
+      last_key_itr = key_itr;
+    }
+
+    index_lock.Unlock();
+  }
+  lookup_count.Add(keys.size());
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
+IndexStatistics
+BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::GetStatistics() {
+  IndexStatistics statistics = Index::GetStatistics();
+  statistics.SetCounter("inserts", insert_count.Get());
+  statistics.SetCounter("deletes", delete_count.Get());
+  statistics.SetCounter("lookups", lookup_count.Get());
+  statistics.SetCounter("scans", scan_count.Get());
+  statistics.SetHistogram("scan_result_size", scan_result_size.Get());
+
+  {
+    index_lock.ReadLock();
+
+    auto &tree_stats = container.get_stats();
+    statistics.SetCounter("entries", tree_stats.itemcount);
+    statistics.SetCounter("leaves", tree_stats.leaves);
+    statistics.SetCounter("inner_nodes", tree_stats.innernodes);
+
+    index_lock.Unlock();
+  }
+
+  return statistics;
+}
+
 template <typename KeyType, typename ValueType, class KeyComparator, class KeyEqualityChecker>
 std::string
 BTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::GetTypeName() const {
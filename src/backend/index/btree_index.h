@@ -20,9 +20,14 @@
 #include "backend/common/platform.h"
 #include "backend/common/types.h"
 #include "backend/index/index.h"
+#include "backend/index/batch_scan_state.h"
 
 #include "stx/btree_multimap.h"
 
+// # of entries a batched lookup walks to get to the next key before it
+// searches from the root instead
+#define BTREE_PROBE_MAX_STEPS 16
+
 namespace peloton {
 namespace index {
 
@@ -45,6 +50,10 @@ class BTreeIndex : public Index {
 
   bool InsertEntry(const storage::Tuple *key, const ItemPointer location);
 
+  bool InsertEntries(
+      const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+          entries);
+
   bool DeleteEntry(const storage::Tuple *key, const ItemPointer location);
 
   std::vector<ItemPointer> Scan(const std::vector<Value> &values,
@@ -52,10 +61,28 @@ class BTreeIndex : public Index {
                                 const std::vector<ExpressionType> &expr_types,
                                 const ScanDirectionType& scan_direction);
 
+  bool SupportsIndexOnlyScan() const { return true; }
+
+  std::vector<ItemPointer> ScanBatch(const std::vector<Value> &values,
+                                     const std::vector<oid_t> &key_column_ids,
+                                     const std::vector<ExpressionType> &expr_types,
+                                     const ScanDirectionType& scan_direction,
+                                     size_t max_count, ScanCursor &cursor);
+
+  void ScanEntries(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType& scan_direction,
+                   size_t max_count, ScanCursor &cursor,
+                   const EntryVisitor &visitor);
+
   std::vector<ItemPointer> ScanAllKeys();
 
   std::vector<ItemPointer> ScanKey(const storage::Tuple *key);
 
+  std::vector<std::vector<ItemPointer>> ScanKeys(
+      const std::vector<const storage::Tuple *> &keys);
+
   std::string GetTypeName() const;
 
   bool Cleanup() {
@@ -66,7 +93,21 @@ class BTreeIndex : public Index {
     return container.GetMemoryFootprint();
   }
 
+  IndexStatistics GetStatistics();
+
  protected:
+  typedef BatchScanState<KeyType, KeyEqualityChecker> BatchState;
+
+  // Calls visitor with the key tuple and location of every entry that
+  // matches the scan, or only of those in the batch if there is one
+  template <typename Visitor>
+  void ScanMatches(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType& scan_direction,
+                   BatchState *batch,
+                   const Visitor &visitor);
+
   MapType container;
 
   // equality checker and comparator
@@ -75,6 +116,13 @@ class BTreeIndex : public Index {
 
   // synch helper
   RWLock index_lock;
+
+  // Operations, and the # of entries each scan returned
+  StatisticsCounter insert_count;
+  StatisticsCounter delete_count;
+  StatisticsCounter lookup_count;
+  StatisticsCounter scan_count;
+  ConcurrentHistogram scan_result_size;
 };
 
 }  // End index namespace
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -18,6 +19,51 @@
 namespace peloton {
 namespace index {
 
+//===--------------------------------------------------------------------===//
+// Epoch thread registry
+//===--------------------------------------------------------------------===//
+
+namespace {
+
+std::mutex thread_registry_mutex;
+
+// Ids given back by threads that have exited
+std::vector<size_t> free_thread_ids;
+
+std::atomic<size_t> next_thread_id(0);
+
+// Holds the id of a thread for as long as the thread lives
+class ThreadIdHolder {
+ public:
+  ThreadIdHolder() {
+    std::lock_guard<std::mutex> lock(thread_registry_mutex);
+    if (!free_thread_ids.empty()) {
+      thread_id_ = free_thread_ids.back();
+      free_thread_ids.pop_back();
+    } else if (next_thread_id < EPOCH_MAX_THREADS) {
+      thread_id_ = next_thread_id++;
+    } else {
+      throw IndexException("Too many threads for the BWTree epoch manager");
+    }
+  }
+
+  ~ThreadIdHolder() {
+    std::lock_guard<std::mutex> lock(thread_registry_mutex);
+    free_thread_ids.push_back(thread_id_);
+  }
+
+  size_t thread_id_;
+};
+
+}  // End anonymous namespace
+
+size_t EpochThreadRegistry::GetThreadId() {
+  static thread_local ThreadIdHolder holder;
+  return holder.thread_id_;
+}
+
+size_t EpochThreadRegistry::GetMaxThreadId() { return next_thread_id; }
+
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
           bool _Duplicates ,
@@ -29,26 +75,27 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
     : comparator_(comparator),
       equals_(equals),
       reverse_comparator_(comparator),
-      epoch_manager_() {
+      separator_codec_(comparator),
+      epoch_manager_(),
+      epoch_interval_ms_(EPOCH_INTERVAL_MS),
+      consolidate_threshold_(CONSOLIDATE_THRESHOLD),
+      split_size_(SPLIT_SIZE),
+      merge_size_(MERGE_SIZE) {
   root_ = 0;
   PID_counter_ = 1;
   allow_duplicate_ = _Duplicates;
 
   InnerNode* root_base_page = new InnerNode();
+  map_table_.Reserve(root_);
   map_table_[root_] = root_base_page;
 
   epoch_ = 0;
-  epoch_garbage_[epoch_] = std::vector<Page*>();
   if (GC_ENABLED) {
     // Initialize state for epoch manager
-    active_threads_map_[epoch_] = 0;
     finished_ = false;
     Start();
   }
 
-  // Can't do this here because we're using atomic inside vector
-  // map_table_.resize(1000000);
-
   // Used for debug: print out the key
   std::vector<catalog::Column> columns;
   catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
@@ -67,6 +114,9 @@ template <typename KeyType, typename ValueType, class KeyComparator,
           class ValueEqualityChecker>
 BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
        ValueEqualityChecker>::~BWTree() {
+  // The maintenance thread may still be changing the tree
+  SetBackgroundMaintenance(false);
+
   if (GC_ENABLED) {
     finished_ = true;
     exec_finished_.notify_one();
@@ -79,10 +129,11 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
     Page* page = map_table_[i];
     FreeDeltaChain(page);
   }
-  // Free any chains left in the garbage collection queue
-  for (auto item : epoch_garbage_) {
-    for (Page *page : item.second) {
-      FreeDeltaChain(page);
+  // Free any chains left in the garbage collection queues. Retired PIDs
+  // still hold on to their chains in the map table.
+  for (auto &slot : epoch_slots_) {
+    for (auto &garbage : slot.garbage_pages_) {
+      FreeDeltaChain(garbage.second);
     }
   }
 }
@@ -94,14 +145,31 @@ template <typename KeyType, typename ValueType, class KeyComparator,
 bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
             ValueEqualityChecker>::Insert(const KeyType& key,
                                           const ValueType& data) {
+  return ConditionalInsert(key, data, nullptr);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::ConditionalInsert(const KeyType& key,
+                                                     const ValueType& data,
+                                                     std::function<bool(
+                                                         const ValueType&)>
+                                                         predicate) {
   LOG_DEBUG("Trying new insert");
   __attribute__((unused)) KeyType tmp_key = key;
   LOG_DEBUG("Trying new insert with key: %s", tmp_key.GetTupleForComparison(key_tuple_schema).GetInfo().c_str());
   uint64_t worker_epoch = RegisterWorker();
+  insert_count_.Add();
+  bool first_attempt = true;
   while (true) {
+    if (!first_attempt) restart_count_.Add();
+    first_attempt = false;
     Page* root_page = map_table_[root_];
     if (root_page->GetType() == INNER_NODE &&
-        reinterpret_cast<InnerNode*>(root_page)->children_.size() == 0) {
+        reinterpret_cast<InnerNode*>(root_page)->GetSize() == 0) {
       // InnerNode* root_base_page = reinterpret_cast<InnerNode*>(root_page);
       LOG_DEBUG("Constructing root page");
 
@@ -109,7 +177,7 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
       LeafNode* leaf_base_page = new LeafNode();
       std::vector<ValueType> locations;
       locations.push_back(data);
-      leaf_base_page->data_items_.push_back(std::make_pair(key, locations));
+      leaf_base_page->Append(key, locations.begin(), locations.end());
       leaf_base_page->low_key_ = key;
       leaf_base_page->high_key_ = key;
       leaf_base_page->absolute_min_ = true;
@@ -133,6 +201,7 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
         return true;
       } else {
         delete index_term_page;
+        cas_failure_count_.Add();
         continue;
       }
     } else {
@@ -153,16 +222,15 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
                    reverse_comparator_(key, inner_node->high_key_) <= 0);
 
             bool found_child = false;  // For debug only, should remove later
-            for (const auto& child : inner_node->children_) {
-              if (reverse_comparator_(key, child.first) <= 0) {
-                pages_visited.push(current_PID);
-                // We need to go to this child next
-                current_PID = child.second;
-                current_page = map_table_[current_PID];
-                head_of_delta = current_page;
-                found_child = true;
-                break;
-              }
+            size_t child_idx =
+                inner_node->FindChild(key, separator_codec_, comparator_);
+            if (child_idx < inner_node->GetSize()) {
+              pages_visited.push(current_PID);
+              // We need to go to this child next
+              current_PID = inner_node->GetChildPID(child_idx);
+              current_page = map_table_[current_PID];
+              head_of_delta = current_page;
+              found_child = true;
             }
             // We should always find a child to visit next
             if (!found_child) {
@@ -170,7 +238,8 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
               // the last child.
               if (inner_node->absolute_max_) {
                 pages_visited.push(current_PID);
-                current_PID = inner_node->children_.rbegin()->second;
+                current_PID =
+                    inner_node->GetChildPID(inner_node->GetSize() - 1);
                 current_page = map_table_[current_PID];
                 head_of_delta = current_page;
               } else {
@@ -200,6 +269,14 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
           }
           case INDEX_TERM_DELTA: {
             LOG_DEBUG("Visit INDEX_TERM_DELTA");
+            if (current_page == head_of_delta &&
+                CheckConsolidate(current_PID) &&
+                !DeferConsolidate(head_of_delta, key)) {
+              ConsolidateInnerNode(current_PID, head_of_delta, pages_visited);
+              current_page = map_table_[current_PID];
+              head_of_delta = current_page;
+              continue;
+            }
             IndexTermDelta* idx_delta =
                 reinterpret_cast<IndexTermDelta*>(current_page);
             // If this key is > low_separator_ and <= high_separator_ then this
@@ -261,7 +338,7 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
                 reinterpret_cast<RemoveNodeDelta*>(current_page);
 
             /* You need to attempt to complete the merge */
-            if (!complete_the_merge(remove_delta, pages_visited)) {
+            if (!complete_the_merge(current_PID, remove_delta, pages_visited)) {
               LOG_DEBUG("Unable to complete the merge");
               attempt_insert = false;
               continue;
@@ -312,27 +389,28 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
               }
 
               // Don't need to add current page to stack b/c it's not the parent
+              // The key lives in the sibling, so look at its chain instead
               current_PID = leaf->side_link_;
               current_page = map_table_[current_PID];
               head_of_delta = current_page;
+              continue;
             }
 
             // Check if the given key is already located in this leaf
-            bool found_key = false;
+            size_t item_idx = leaf->Find(key, comparator_, equals_);
+            bool found_key = item_idx < leaf->GetSize();
             std::vector<ValueType> data_items;
-            for (const auto& key_values : leaf->data_items_) {
-              if (equals_(key, key_values.first)) {
-                found_key = true;
-                // Make copy of existing values if duplicates are allowed
-                if (allow_duplicate_) data_items = key_values.second;
-                break;
-              }
-            }
-            if (!found_key || (found_key && allow_duplicate_)) {
+            bool can_insert =
+                !found_key || CanInsert(leaf->ValuesBegin(item_idx),
+                                        leaf->ValuesEnd(item_idx), predicate);
+            // Keep the existing values next to the new one
+            if (found_key && can_insert) data_items = leaf->GetValues(item_idx);
+            if (can_insert) {
               // Insert this new key-value pair into the tree
               // We can insert this key-value pair because either:
               // 1. It does not yet exist in the tree
-              // 2. It does but duplicates are allowed
+              // 2. It does but duplicates are allowed, or none of its values
+              //    satisfies the predicate
               inserted = true;
             } else {
               // We cannot insert this key because it's in the tree and
@@ -357,38 +435,19 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
                 // Free the page not contained in mapping_table
                 delete new_modify_delta;
                 LOG_DEBUG("CAS failed");
+                cas_failure_count_.Add();
                 attempt_insert = false;  // Start over
                 continue;
               }
 
               assert(attempt_insert);
+              chain_length_.Add(new_modify_delta->GetDepth());
 
               /* Check if consolidation required and perform it if it's */
-              if (CheckConsolidate(current_PID)) {
-                LOG_DEBUG("Performing consolidation");
-                Page* consolidated_page = Consolidate(current_PID);
-                if (consolidated_page) {
-                  Page* new_modify_delta_page =
-                      reinterpret_cast<Page*>(new_modify_delta);
-
-                  /* Attempt to insert updated consolidated page */
-                  if (!map_table_[current_PID].compare_exchange_strong(
-                          new_modify_delta_page, consolidated_page)) {
-                    delete consolidated_page;
-                    LOG_DEBUG("CAS of consolidation failed");
-                  } else {
-                    DeallocatePage(new_modify_delta_page);
-                    LOG_DEBUG("CAS of consolidation success");
-
-                    /* Check if split is required and perform the operation */
-                    if (!Split_Operation(consolidated_page, pages_visited,
-                        current_PID)) {
-                      /* Check if merge is requires and perform the operation */
-                      Merge_Operation(consolidated_page, pages_visited,
-                          current_PID);
-                    }
-                  }
-                }
+              if (CheckConsolidate(current_PID) &&
+                  !DeferConsolidate(new_modify_delta, key)) {
+                ConsolidateLeafNode(current_PID, new_modify_delta,
+                                    pages_visited);
               }
             }
             DeregisterWorker(worker_epoch);
@@ -400,18 +459,10 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
                 reinterpret_cast<ModifyDelta*>(current_page);
             bool inserted;  // Whether this <key, value> pair is inserted
             if (equals_(key, mod_delta->key_)) {
-              if (!allow_duplicate_ && mod_delta->locations_.size() > 0) {
-                // Key already exists in tree and duplicates are not allowed
-                // A locations_ with size > 0 means this is not a delete delta
-                inserted = false;
-              } else {
-                // We can insert the key because either:
-                // 1. Duplicates are NOT allowed but this is a delete modify
-                // delta
-                //    so this key DNE in the tree anymore
-                // 2. Duplicates are allowed so anything goes
-                inserted = true;
-              }
+              // The newest delta of the key holds all of its values. An
+              // empty locations_ means the key has been deleted.
+              inserted = CanInsert(mod_delta->locations_.begin(),
+                                   mod_delta->locations_.end(), predicate);
             } else {
               // This is not our key so we keep traversing the delta chain
               current_page = current_page->GetDeltaNext();
@@ -433,39 +484,19 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
                 delete new_modify_delta;
 
                 LOG_DEBUG("CAS failed");
+                cas_failure_count_.Add();
                 attempt_insert = false;  // Start over
                 continue;
               }
 
               assert(attempt_insert);
+              chain_length_.Add(new_modify_delta->GetDepth());
 
               /* Check if consolidation required and perform it if it's */
-              if (CheckConsolidate(current_PID)) {
-                LOG_DEBUG("Performing consolidation");
-                Page* consolidated_page = Consolidate(current_PID);
-                if (consolidated_page) {
-                  Page* new_modify_delta_page =
-                      reinterpret_cast<Page*>(new_modify_delta);
-
-                  /* Attempt to insert updated consolidated page */
-                  if (!map_table_[current_PID].compare_exchange_strong(
-                          new_modify_delta_page, consolidated_page)) {
-                    delete consolidated_page;
-                    LOG_DEBUG("CAS of consolidation failed");
-                  } else {
-                    DeallocatePage(new_modify_delta_page);
-                    LOG_DEBUG("CAS of consolidation success");
-
-                    /* Check if split is required and perform the operation */
-                    if (!Split_Operation(consolidated_page, pages_visited,
-                        current_PID)) {
-
-                      /* Check if merge is requires and perform the operation */
-                      Merge_Operation(consolidated_page, pages_visited,
-                          current_PID);
-                    }
-                  }
-                }
+              if (CheckConsolidate(current_PID) &&
+                  !DeferConsolidate(new_modify_delta, key)) {
+                ConsolidateLeafNode(current_PID, new_modify_delta,
+                                    pages_visited);
               }
             }
             DeregisterWorker(worker_epoch);
@@ -491,12 +522,16 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
                                           const ValueType& data) {
   LOG_DEBUG("Trying delete");
   uint64_t worker_epoch = RegisterWorker();
+  delete_count_.Add();
+  bool first_attempt = true;
   while (true) {
+    if (!first_attempt) restart_count_.Add();
+    first_attempt = false;
     Page* root_page = map_table_[root_];
 
     /* If empty root w/ no children then delete fails */
     if (root_page->GetType() == INNER_NODE &&
-        reinterpret_cast<InnerNode*>(root_page)->children_.size() == 0) {
+        reinterpret_cast<InnerNode*>(root_page)->GetSize() == 0) {
       LOG_DEBUG("Delete false 1");
       DeregisterWorker(worker_epoch);
       return false;
@@ -520,16 +555,15 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
 
           bool found_child = false;
           // We shouldn't be using this yet since we have no consolidation
-          for (const auto& child : inner_node->children_) {
-            if (reverse_comparator_(key, child.first) <= 0) {
-              pages_visited.push(current_PID);
-              // Found the correct child
-              current_PID = child.second;
-              current_page = map_table_[current_PID];
-              head_of_delta = current_page;
-              found_child = true;
-              break;
-            }
+          size_t child_idx =
+              inner_node->FindChild(key, separator_codec_, comparator_);
+          if (child_idx < inner_node->GetSize()) {
+            pages_visited.push(current_PID);
+            // Found the correct child
+            current_PID = inner_node->GetChildPID(child_idx);
+            current_page = map_table_[current_PID];
+            head_of_delta = current_page;
+            found_child = true;
           }
 
           // We should always find a child to visit next
@@ -538,7 +572,7 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
             // the last child.
             if (inner_node->absolute_max_) {
               pages_visited.push(current_PID);
-              current_PID = inner_node->children_.rbegin()->second;
+              current_PID = inner_node->GetChildPID(inner_node->GetSize() - 1);
               current_page = map_table_[current_PID];
               head_of_delta = current_page;
             } else {
@@ -567,6 +601,13 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
           continue;
         }
         case INDEX_TERM_DELTA: {
+          if (current_page == head_of_delta && CheckConsolidate(current_PID) &&
+              !DeferConsolidate(head_of_delta, key)) {
+            ConsolidateInnerNode(current_PID, head_of_delta, pages_visited);
+            current_page = map_table_[current_PID];
+            head_of_delta = current_page;
+            continue;
+          }
           IndexTermDelta* idx_delta =
               reinterpret_cast<IndexTermDelta*>(current_page);
           // If this key is > low_separator_ and <= high_separator_ then this is
@@ -625,7 +666,7 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
               reinterpret_cast<RemoveNodeDelta*>(current_page);
 
           /* You need to attempt to complete the merge */
-          if (!complete_the_merge(remove_delta, pages_visited)) {
+          if (!complete_the_merge(current_PID, remove_delta, pages_visited)) {
             LOG_DEBUG("Unable to complete the merge");
             attempt_delete = false;
             continue;
@@ -672,33 +713,28 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
             }
 
             // Don't need to add current page to stack b/c it's not the parent
+            // The key lives in the sibling, so look at its chain instead
             current_PID = leaf->side_link_;
             current_page = map_table_[current_PID];
             head_of_delta = current_page;
+            continue;
           }
 
+          // Even a unique key can hold several versions (see
+          // ConditionalInsert), so only the given location goes away
           bool found_location = false;
           std::vector<ValueType> data_items;
-          for (const auto& key_values : leaf->data_items_) {
-            if (equals_(key, key_values.first)) {
-              if (!allow_duplicate_) {
-                /* Only one possible instance of this key so done here */
+          size_t item_idx = leaf->Find(key, comparator_, equals_);
+          if (item_idx < leaf->GetSize()) {
+            /* Iterate over locations */
+            for (auto value_itr = leaf->ValuesBegin(item_idx);
+                 value_itr != leaf->ValuesEnd(item_idx); ++value_itr) {
+              if (value_equals_(*value_itr, data)) {
                 found_location = true;
-                break;
               } else {
-                /* Iterate over locations */
-                for (const auto& value : key_values.second) {
-                  if (value_equals_(value, data)) {
-                    found_location = true;
-                  } else {
-                    /* All items w/ != location are kept */
-                    data_items.push_back(value);
-                  }
-                }
+                /* All items w/ != location are kept */
+                data_items.push_back(*value_itr);
               }
-
-              /* No need to search the rest of the values */
-              break;
             }
           }
 
@@ -718,39 +754,18 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
             // Free the page not contained in mapping_table
             delete new_modify_delta;
             LOG_DEBUG("CAS failed");
+            cas_failure_count_.Add();
             attempt_delete = false;  // Start over
             continue;
           }
 
           assert(attempt_delete);
+          chain_length_.Add(new_modify_delta->GetDepth());
 
           /* Check if consolidation required and perform it if it's */
-          if (CheckConsolidate(current_PID)) {
-            LOG_DEBUG("Performing consolidation");
-            Page* consolidated_page = Consolidate(current_PID);
-            if (consolidated_page) {
-              Page* new_modify_delta_page =
-                  reinterpret_cast<Page*>(new_modify_delta);
-
-              /* Attempt to insert updated consolidated page */
-              if (!map_table_[current_PID].compare_exchange_strong(
-                      new_modify_delta_page, consolidated_page)) {
-                delete consolidated_page;
-                LOG_DEBUG("CAS of consolidation failed");
-              } else {
-                DeallocatePage(new_modify_delta_page);
-                LOG_DEBUG("CAS of consolidation success");
-
-                LOG_DEBUG("Checking Split Threshold");
-                /* Check if split is required and perform the operation */
-                if (!Split_Operation(consolidated_page, pages_visited, current_PID)) {
-
-                  LOG_DEBUG("Checking Merge Threshold");
-                  /* Check if merge is requires and perform the operation */
-                  Merge_Operation(consolidated_page, pages_visited, current_PID);
-                }
-              }
-            }
+          if (CheckConsolidate(current_PID) &&
+              !DeferConsolidate(new_modify_delta, key)) {
+            ConsolidateLeafNode(current_PID, new_modify_delta, pages_visited);
           }
           DeregisterWorker(worker_epoch);
           return found_location;
@@ -768,17 +783,12 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
               return false;
             }
 
-            if (!allow_duplicate_) {
-              data_items.resize(0);
-              found_location = true;
-            } else {
-              for (const auto& value : mod_delta->locations_) {
-                if (value_equals_(value, data)) {
-                  found_location = true;
-                } else {
-                  /* All items w/ != location are kept */
-                  data_items.push_back(value);
-                }
+            for (const auto& value : mod_delta->locations_) {
+              if (value_equals_(value, data)) {
+                found_location = true;
+              } else {
+                /* All items w/ != location are kept */
+                data_items.push_back(value);
               }
             }
 
@@ -798,40 +808,18 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
               // Free the page not contained in mapping_table
               delete new_modify_delta;
               LOG_DEBUG("CAS failed");
+              cas_failure_count_.Add();
               attempt_delete = false;  // Start over
               continue;
             }
 
             assert(attempt_delete);
+            chain_length_.Add(new_modify_delta->GetDepth());
 
             /* Check if consolidation required and perform it if it's */
-            if (CheckConsolidate(current_PID)) {
-              LOG_DEBUG("Performing consolidation");
-              Page* consolidated_page = Consolidate(current_PID);
-              if (consolidated_page) {
-                Page* new_modify_delta_page =
-                    reinterpret_cast<Page*>(new_modify_delta);
-
-                /* Attempt to insert updated consolidated page */
-                if (!map_table_[current_PID].compare_exchange_strong(
-                        new_modify_delta_page, consolidated_page)) {
-                  delete consolidated_page;
-                  LOG_DEBUG("CAS of consolidation failed");
-                } else {
-                  DeallocatePage(new_modify_delta_page);
-
-                  LOG_DEBUG("CAS of consolidation success");
-
-                  /* Check if split is required and perform the operation */
-                  if (!Split_Operation(consolidated_page, pages_visited,
-                      current_PID)) {
-
-                    /* Check if merge is requires and perform the operation */
-                    Merge_Operation(consolidated_page, pages_visited,
-                        current_PID);
-                  }
-                }
-              }
+            if (CheckConsolidate(current_PID) &&
+                !DeferConsolidate(new_modify_delta, key)) {
+              ConsolidateLeafNode(current_PID, new_modify_delta, pages_visited);
             }
           } else {
             current_page = current_page->GetDeltaNext();
@@ -852,26 +840,251 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
   return false;
 }
 
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::BulkLoad(std::vector<std::pair<KeyType,
+                                                                  ValueType>>&
+                                                items) {
+  Page* root_page = map_table_[root_];
+  if (root_page->GetType() != INNER_NODE ||
+      reinterpret_cast<InnerNode*>(root_page)->GetSize() != 0) {
+    throw IndexException("Bulk load requires an empty BWTree");
+  }
+  if (items.empty()) return true;
+
+  // Nodes are packed full
+  size_t split_size = split_size_;
+
+  std::stable_sort(items.begin(), items.end(),
+                   [this](const std::pair<KeyType, ValueType>& lhs,
+                          const std::pair<KeyType, ValueType>& rhs) {
+    return comparator_(lhs.first, rhs.first);
+  });
+
+  // Fill up the leaves, all values of a key go into the same leaf
+  std::vector<LeafNode*> leaves;
+  std::vector<ValueType> values;
+  LeafNode* leaf = nullptr;
+  for (size_t item_itr = 0; item_itr < items.size();) {
+    const KeyType& key = items[item_itr].first;
+    values.clear();
+    while (item_itr < items.size() && equals_(items[item_itr].first, key)) {
+      values.push_back(items[item_itr].second);
+      item_itr++;
+    }
+    if (!allow_duplicate_ && values.size() > 1) {
+      // Nothing is installed yet
+      for (LeafNode* built_leaf : leaves) delete built_leaf;
+      return false;
+    }
+
+    if (leaf == nullptr || leaf->GetSize() == split_size) {
+      leaf = new LeafNode();
+      leaves.push_back(leaf);
+    }
+    leaf->Append(key, values.begin(), values.end());
+  }
+
+  // Install the leaves and link them up. Each level is kept as the
+  // (high key, PID) pairs its parents use as children. Leaves end at the
+  // shortest separator from the next leaf.
+  std::vector<PID> installed_PIDs;
+  std::vector<std::pair<KeyType, PID>> level;
+  for (size_t leaf_itr = 0; leaf_itr < leaves.size(); leaf_itr++) {
+    leaf = leaves[leaf_itr];
+    if (leaf_itr + 1 < leaves.size()) {
+      leaf->high_key_ = separator_codec_.GetSeparator(
+          leaf->keys_.back(), leaves[leaf_itr + 1]->keys_.front());
+    } else {
+      leaf->high_key_ = leaf->keys_.back();
+    }
+    if (leaf_itr == 0) {
+      leaf->absolute_min_ = true;
+      leaf->low_key_ = leaf->keys_.front();
+    } else {
+      leaf->low_key_ = leaves[leaf_itr - 1]->high_key_;
+      leaf->prev_leaf_ = level.back().second;
+    }
+    leaf->absolute_max_ = (leaf_itr + 1 == leaves.size());
+
+    PID leaf_PID = InstallNewMapping(leaf);
+    installed_PIDs.push_back(leaf_PID);
+    if (leaf_itr > 0) {
+      leaves[leaf_itr - 1]->next_leaf_ = leaf_PID;
+      leaves[leaf_itr - 1]->side_link_ = leaf_PID;
+    }
+    level.push_back(std::make_pair(leaf->high_key_, leaf_PID));
+  }
+
+  // Build inner levels until the root can hold all nodes of the top one
+  while (level.size() > split_size) {
+    std::vector<std::pair<KeyType, PID>> parent_level;
+    InnerNode* prev_inner = nullptr;
+    for (size_t child_itr = 0; child_itr < level.size();
+         child_itr += split_size) {
+      size_t child_end = std::min(child_itr + split_size, level.size());
+      InnerNode* inner = new InnerNode();
+      std::vector<std::pair<KeyType, PID>> children(level.begin() + child_itr,
+                                                    level.begin() + child_end);
+      inner->SetChildren(children, separator_codec_);
+      inner->high_key_ = children.back().first;
+      if (prev_inner == nullptr) {
+        inner->absolute_min_ = true;
+        inner->low_key_ = children.front().first;
+      } else {
+        inner->low_key_ = prev_inner->high_key_;
+      }
+      inner->absolute_max_ = (child_end == level.size());
+
+      PID inner_PID = InstallNewMapping(inner);
+      installed_PIDs.push_back(inner_PID);
+      if (prev_inner != nullptr) prev_inner->side_link_ = inner_PID;
+      parent_level.push_back(std::make_pair(inner->high_key_, inner_PID));
+      prev_inner = inner;
+    }
+    level.swap(parent_level);
+  }
+
+  InnerNode* new_root = new InnerNode();
+  new_root->absolute_min_ = true;
+  new_root->absolute_max_ = true;
+  new_root->low_key_ = level.front().first;
+  new_root->high_key_ = level.back().first;
+  new_root->SetChildren(level, separator_codec_);
+
+  if (!map_table_[root_].compare_exchange_strong(root_page, new_root)) {
+    // Someone got in before us, take everything out again
+    for (PID pid : installed_PIDs) {
+      FreeDeltaChain(map_table_[pid].exchange(nullptr));
+    }
+    free_PIDs_lock_.Lock();
+    free_PIDs_.insert(free_PIDs_.end(), installed_PIDs.begin(),
+                      installed_PIDs.end());
+    free_PIDs_lock_.Unlock();
+    delete new_root;
+    throw IndexException("BWTree was modified during a bulk load");
+  }
+
+  DeallocatePage(root_page);
+  return true;
+}
+
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
           bool _Duplicates,
           class ValueEqualityChecker>
 std::vector<ValueType>
 BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
-       ValueEqualityChecker>::SearchKey(__attribute__((unused))
-                                        const KeyType& key) {
-  Page* current_page = map_table_[root_];
-  PID current_PID = root_;
+       ValueEqualityChecker>::SearchKey(const KeyType& key) {
+  Page* root_page = map_table_[root_];
   uint64_t worker_epoch = RegisterWorker();
+  lookup_count_.Add();
 
   /* If empty root w/ no children then search fails */
-  if (current_page->GetType() == INNER_NODE &&
-      reinterpret_cast<InnerNode*>(current_page)->children_.size() == 0) {
+  if (root_page->GetType() == INNER_NODE &&
+      reinterpret_cast<InnerNode*>(root_page)->GetSize() == 0) {
     LOG_DEBUG("SearchKey returning nothing because BWTree is empty");
     DeregisterWorker(worker_epoch);
     return std::vector<ValueType>();
   }
-  __attribute__((unused)) Page* head_of_delta = current_page;
+
+  auto data_items = SearchKeyFrom(key, root_, nullptr);
+  DeregisterWorker(worker_epoch);
+  return data_items;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+std::vector<std::vector<ValueType>>
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::SearchKeys(const std::vector<KeyType>& keys) {
+  std::vector<std::vector<ValueType>> results(keys.size());
+  if (keys.empty()) return results;
+
+  Page* root_page = map_table_[root_];
+  uint64_t worker_epoch = RegisterWorker();
+  lookup_count_.Add(keys.size());
+
+  /* If empty root w/ no children then search fails */
+  if (root_page->GetType() == INNER_NODE &&
+      reinterpret_cast<InnerNode*>(root_page)->GetSize() == 0) {
+    LOG_DEBUG("SearchKeys returning nothing because BWTree is empty");
+    DeregisterWorker(worker_epoch);
+    return results;
+  }
+
+  std::vector<PathEntry> path;
+  PID start_PID = root_;
+  for (size_t key_itr = 0; key_itr < keys.size(); key_itr++) {
+    assert(key_itr == 0 ||
+           reverse_comparator_(keys[key_itr - 1], keys[key_itr]) <= 0);
+
+    // Same key as the last probe
+    if (key_itr > 0 && equals_(keys[key_itr - 1], keys[key_itr])) {
+      results[key_itr] = results[key_itr - 1];
+      continue;
+    }
+
+    results[key_itr] = SearchKeyFrom(keys[key_itr], start_PID, &path);
+
+    // Start loading the page the next probe begins at while this one's
+    // result is handed back
+    if (key_itr + 1 < keys.size()) {
+      start_PID = FindProbeStart(keys[key_itr + 1], path);
+      __builtin_prefetch(map_table_[start_PID].load());
+    }
+  }
+
+  DeregisterWorker(worker_epoch);
+  return results;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+typename BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                _Duplicates, ValueEqualityChecker>::PID
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::FindProbeStart(const KeyType& key,
+                                             std::vector<PathEntry>& path) {
+  while (!path.empty()) {
+    PathEntry& entry = path.back();
+
+    // Pages merged away since have to be reached through their parent
+    bool covers_key = entry.absolute_max_ ||
+                      reverse_comparator_(key, entry.high_key_) <= 0;
+    if (covers_key &&
+        map_table_[entry.pid_].load()->GetType() != REMOVE_NODE_DELTA) {
+      // The descent from here adds the page again
+      PID start_PID = entry.pid_;
+      path.pop_back();
+      return start_PID;
+    }
+
+    path.pop_back();
+  }
+
+  return root_;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+std::vector<ValueType>
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::SearchKeyFrom(const KeyType& key,
+                                            PID start_PID,
+                                            std::vector<PathEntry>* path) {
+  PID current_PID = start_PID;
+  Page* current_page = map_table_[current_PID];
+  Page* head_of_delta = current_page;
   while (true) {
     switch (current_page->GetType()) {
       case INNER_NODE: {
@@ -887,16 +1100,19 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
                reverse_comparator_(key, inner_node->low_key_) > 0);
         assert(inner_node->absolute_max_ ||
                reverse_comparator_(key, inner_node->high_key_) <= 0);
+        if (path != nullptr) {
+          path->push_back({current_PID, inner_node->high_key_,
+                           inner_node->absolute_max_});
+        }
         bool found_child = false;  // For debug only, should remove later
-        for (const auto& child : inner_node->children_) {
-          if (reverse_comparator_(key, child.first) <= 0) {
-            // We need to go to this child next
-            current_PID = child.second;
-            current_page = map_table_[current_PID];
-            head_of_delta = current_page;
-            found_child = true;
-            break;
-          }
+        size_t child_idx =
+            inner_node->FindChild(key, separator_codec_, comparator_);
+        if (child_idx < inner_node->GetSize()) {
+          // We need to go to this child next
+          current_PID = inner_node->GetChildPID(child_idx);
+          current_page = map_table_[current_PID];
+          head_of_delta = current_page;
+          found_child = true;
         }
 
         // We should always find a child to visit next
@@ -904,7 +1120,7 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
           // If the key is between high_key_ and max value, then we go to
           // the last child.
           if (inner_node->absolute_max_) {
-            current_PID = inner_node->children_.rbegin()->second;
+            current_PID = inner_node->GetChildPID(inner_node->GetSize() - 1);
           } else {
             current_PID = inner_node->side_link_;
           }
@@ -977,19 +1193,34 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
         }
 
         // Check if the given key is already located in this leaf
+        size_t item_idx = leaf->Find(key, comparator_, equals_);
         std::vector<ValueType> data_items;
-        for (const auto& key_values : leaf->data_items_) {
-          if (equals_(key, key_values.first)) {
-            DeregisterWorker(worker_epoch);
-            return key_values.second;
-          }
+        if (item_idx < leaf->GetSize()) data_items = leaf->GetValues(item_idx);
+        if (path != nullptr) {
+          path->push_back({current_PID, leaf->high_key_,
+                           leaf->side_link_ == NullPID});
         }
-        return std::vector<ValueType>();
+        return data_items;
       }
       case MODIFY_DELTA: {
         ModifyDelta* mod_delta = reinterpret_cast<ModifyDelta*>(current_page);
+
+        // Keys beyond the node can skip the rest of the chain right away
+        LeafNode* base_leaf = mod_delta->GetBaseLeaf();
+        if (current_page == head_of_delta && base_leaf != nullptr &&
+            base_leaf->side_link_ != NullPID &&
+            reverse_comparator_(key, base_leaf->high_key_) > 0) {
+          current_PID = base_leaf->side_link_;
+          current_page = map_table_[current_PID];
+          head_of_delta = current_page;
+          continue;
+        }
+
         if (equals_(key, mod_delta->key_)) {
-          DeregisterWorker(worker_epoch);
+          if (path != nullptr && base_leaf != nullptr) {
+            path->push_back({current_PID, base_leaf->high_key_,
+                             base_leaf->side_link_ == NullPID});
+          }
           return mod_delta->locations_;
         } else {
           // This is not our key so we keep traversing the delta chain
@@ -1022,7 +1253,7 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
 
   /* If empty root w/ no children then search fails */
   if (current_page->GetType() == INNER_NODE &&
-      reinterpret_cast<InnerNode*>(current_page)->children_.size() == 0) {
+      reinterpret_cast<InnerNode*>(current_page)->GetSize() == 0) {
     LOG_DEBUG("SearchAllKeys returning nothing because BWTree is empty");
     DeregisterWorker(worker_epoch);
     return visited_keys;
@@ -1038,11 +1269,11 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
     switch (current_page->GetType()) {
       case INNER_NODE: {
         InnerNode* inner_node = reinterpret_cast<InnerNode*>(current_page);
-        if (inner_node->children_.size() == 0) {
+        if (inner_node->GetSize() == 0) {
           DeregisterWorker(worker_epoch);
           return visited_keys;
         } else {
-          current_PID = inner_node->children_[0].second;
+          current_PID = inner_node->GetChildPID(0);
           current_page = map_table_[current_PID];
           head_of_delta = current_page;
         }
@@ -1088,13 +1319,12 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
 
         // Traverse all data item in the leaf. If we already visited before,
         // then skip.
-        std::vector<ValueType> data_items;
-        for (const auto& key_values : leaf->data_items_) {
-          if (split_indicator &&
-              reverse_comparator_(key_values.first, split_separator) > 0)
-            break;
-
-          visited_keys.insert(std::make_pair(key_values.first, key_values.second));
+        size_t item_count = leaf->GetSize();
+        if (split_indicator)
+          item_count = leaf->UpperBound(split_separator, comparator_);
+        for (size_t item_itr = 0; item_itr < item_count; ++item_itr) {
+          visited_keys.insert(std::make_pair(leaf->keys_[item_itr],
+                                             leaf->GetValues(item_itr)));
         }
 
         if (split_indicator) {
@@ -1134,99 +1364,552 @@ template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
           bool _Duplicates,
           class ValueEqualityChecker>
-bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
-            ValueEqualityChecker>::Split_Operation(Page* consolidated_page,
-                                                   std::stack<PID>&
-                                                       pages_visited,
-                                                   PID orig_pid) {
-  bool split_required = false;
-  SplitDelta* split_delta = nullptr;
-  IndexTermDelta* index_term_delta_for_split = nullptr;
-  InnerNode* new_root_node = nullptr;
-  PID reinstalled_root = root_;
+typename BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                _Duplicates, ValueEqualityChecker>::Iterator
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::Begin() {
+  Iterator itr(this);
+  SeekLeaf(itr, KeyType(), SEEK_LEFTMOST);
+  if (itr.leaf_.items_.empty()) LoadNextLeaf(itr);
+  return itr;
+}
 
-  /* Check if split required */
-  if (consolidated_page->GetType() == INNER_NODE) {
-    InnerNode* node_to_split = reinterpret_cast<InnerNode*>(consolidated_page);
-    if (node_to_split->children_.size() > SPLIT_SIZE) {
-      LOG_DEBUG("Attempting Split");
-      split_required = true;
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+typename BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                _Duplicates, ValueEqualityChecker>::Iterator
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::Begin(const KeyType& key) {
+  Iterator itr(this);
+  SeekLeaf(itr, key, SEEK_KEY);
+  if (itr.leaf_.items_.empty()) LoadNextLeaf(itr);
+
+  // Keys that are larger than a leaf's high key live in its right sibling, so
+  // the first key >= key may be one or more leaves further on
+  while (!itr.IsEnd() && reverse_comparator_(itr.GetKey(), key) < 0) {
+    itr.Next();
+  }
+  return itr;
+}
 
-      /* Create new node */
-      InnerNode* new_inner_node = new InnerNode();
-      new_inner_node->absolute_min_ = false;
-      new_inner_node->absolute_max_ = node_to_split->absolute_max_;
-      new_inner_node->side_link_ = node_to_split->side_link_;
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+typename BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                _Duplicates, ValueEqualityChecker>::Iterator
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::RBegin() {
+  Iterator itr(this);
+  SeekLeaf(itr, KeyType(), SEEK_RIGHTMOST);
 
-      /* Choose a key to split on */
-      int key_split_index = (node_to_split->children_.size() / 2) - 1;
-      KeyType new_separator_key =
-          node_to_split->children_[key_split_index].first;
-      new_inner_node->low_key_ = new_separator_key;
-      new_inner_node->high_key_ = node_to_split->high_key_;
+  // The right-most leaf may have been split without the parent knowing yet
+  uint64_t worker_epoch = RegisterWorker();
+  while (itr.leaf_.next_leaf_ != NullPID) {
+    LeafSnapshot snapshot;
+    CollectLeaf(itr.leaf_.next_leaf_, snapshot);
+    itr.leaf_ = std::move(snapshot);
+  }
+  DeregisterWorker(worker_epoch);
 
-      /* Populate new node */
-      for (int i = (key_split_index + 1); i < node_to_split->children_.size();
-           i++) {
-        // can optimize this in the future
-        new_inner_node->children_.push_back(node_to_split->children_[i]);
-        assert(reverse_comparator_(node_to_split->children_[i].first,
-                                   new_separator_key) > 0);
-      }
+  if (itr.leaf_.items_.empty()) {
+    LoadPrevLeaf(itr);
+  } else {
+    itr.pos_ = itr.leaf_.items_.size() - 1;
+  }
+  return itr;
+}
 
-      /* Install the new page in the mapping table */
-      PID new_node_PID = InstallNewMapping(new_inner_node);
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+typename BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                _Duplicates, ValueEqualityChecker>::Iterator
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::RBegin(const KeyType& key) {
+  Iterator itr = Begin(key);
+  if (itr.IsEnd()) return RBegin();
 
-      /* Create the Delta Split to Install */
-      split_delta = new SplitDelta(new_separator_key, new_node_PID);
+  if (reverse_comparator_(itr.GetKey(), key) > 0) itr.Prev();
+  return itr;
+}
 
-      /* Check if you are splitting the root node */
-      // Need to check how we consolidate to make sure we have correct behavior
-      if (orig_pid == root_) {
-        LOG_DEBUG("Attempting to split the root node");
-        /* Copy over the old root node to a new location */
-        reinstalled_root = InstallNewMapping(consolidated_page);
-        /* Create the new root node */
-        new_root_node = new InnerNode();
-        new_root_node->absolute_min_ = true;
-        new_root_node->absolute_max_ = true;
-        new_root_node->children_.push_back(std::make_pair(new_separator_key, reinstalled_root));
-        new_root_node->children_.push_back(std::make_pair(new_inner_node->high_key_, new_node_PID));
-      } else {
-        /* Create the index term delta for the parent */
-        index_term_delta_for_split = new IndexTermDelta(
-            new_inner_node->low_key_, new_inner_node->high_key_, new_node_PID);
-        index_term_delta_for_split->absolute_max_ = new_inner_node->absolute_max_;
-      }
-    }
-  } else if (consolidated_page->GetType() == LEAF_NODE) {
-    __attribute__((unused)) LeafNode* node_to_split =
-        reinterpret_cast<LeafNode*>(consolidated_page);
-    if (node_to_split->data_items_.size() > SPLIT_SIZE) {
-      LOG_DEBUG("Attempting Split");
-      split_required = true;
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+std::uint64_t
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::FindLeaf(const KeyType& key,
+                                       LeafSeekMode mode) {
+  PID current_PID = root_;
+  Page* current_page = map_table_[current_PID];
 
-      /* Create new node */
-      LeafNode* new_leaf_node = new LeafNode();
-      new_leaf_node->absolute_min_ = false;
-      new_leaf_node->absolute_max_ = node_to_split->absolute_max_;
+  while (true) {
+    switch (current_page->GetType()) {
+      case INNER_NODE: {
+        InnerNode* inner_node = reinterpret_cast<InnerNode*>(current_page);
+
+        // Empty root w/ no children
+        if (inner_node->GetSize() == 0) return NullPID;
+
+        if (mode == SEEK_LEFTMOST) {
+          current_PID = inner_node->GetChildPID(0);
+        } else if (mode == SEEK_RIGHTMOST) {
+          if (!inner_node->absolute_max_ &&
+              inner_node->side_link_ != NullPID) {
+            current_PID = inner_node->side_link_;
+          } else {
+            current_PID = inner_node->GetChildPID(inner_node->GetSize() - 1);
+          }
+        } else if (reverse_comparator_(key, inner_node->high_key_) > 0 &&
+                   inner_node->side_link_ != NullPID) {
+          current_PID = inner_node->side_link_;
+        } else {
+          bool found_child = false;
+          size_t child_idx =
+              inner_node->FindChild(key, separator_codec_, comparator_);
+          if (child_idx < inner_node->GetSize()) {
+            current_PID = inner_node->GetChildPID(child_idx);
+            found_child = true;
+          }
+          if (!found_child) {
+            if (inner_node->absolute_max_) {
+              current_PID = inner_node->GetChildPID(inner_node->GetSize() - 1);
+            } else {
+              current_PID = inner_node->side_link_;
+            }
+          }
+        }
+        current_page = map_table_[current_PID];
+        continue;
+      }
+      case INDEX_TERM_DELTA: {
+        IndexTermDelta* idx_delta =
+            reinterpret_cast<IndexTermDelta*>(current_page);
+        bool follow;
+        if (mode == SEEK_LEFTMOST) {
+          follow = idx_delta->absolute_min_;
+        } else if (mode == SEEK_RIGHTMOST) {
+          follow = idx_delta->absolute_max_;
+        } else {
+          follow = (idx_delta->absolute_min_ ||
+                    reverse_comparator_(key, idx_delta->low_separator_) > 0) &&
+                   (idx_delta->absolute_max_ ||
+                    reverse_comparator_(key, idx_delta->high_separator_) <= 0);
+        }
+
+        if (follow) {
+          current_PID = idx_delta->side_link_;
+          current_page = map_table_[current_PID];
+        } else {
+          current_page = current_page->GetDeltaNext();
+        }
+        continue;
+      }
+      case SPLIT_DELTA: {
+        SplitDelta* split_delta = reinterpret_cast<SplitDelta*>(current_page);
+        if (mode == SEEK_RIGHTMOST ||
+            (mode == SEEK_KEY &&
+             reverse_comparator_(key, split_delta->separator_) > 0)) {
+          current_PID = split_delta->side_link_;
+          current_page = map_table_[current_PID];
+        } else {
+          current_page = current_page->GetDeltaNext();
+        }
+        continue;
+      }
+      case REMOVE_NODE_DELTA: {
+        current_page = current_page->GetDeltaNext();
+        continue;
+      }
+      case NODE_MERGE_DELTA: {
+        NodeMergeDelta* merge_delta =
+            reinterpret_cast<NodeMergeDelta*>(current_page);
+        // A merged leaf is collected as a whole, only inner nodes need to be
+        // looked into
+        if (merge_delta->physical_link_->GetType() == LEAF_NODE) {
+          return current_PID;
+        }
+        if (mode == SEEK_RIGHTMOST ||
+            (mode == SEEK_KEY &&
+             reverse_comparator_(key, merge_delta->separator_) > 0)) {
+          current_page = merge_delta->physical_link_;
+        } else {
+          current_page = current_page->GetDeltaNext();
+        }
+        continue;
+      }
+      case MODIFY_DELTA: {
+        // Keep going, there may be a split delta further down the chain
+        current_page = current_page->GetDeltaNext();
+        continue;
+      }
+      case LEAF_NODE: {
+        // Unlike SearchKey we don't follow the side link of a leaf whose high
+        // key is below the search key. Separators in the parents are exact
+        // while a leaf's high key is only the largest key it holds, and
+        // stepping backwards relies on landing on the leaf that covers the
+        // previous leaf's low key. Keys that live further right are picked up
+        // by moving forward.
+        return current_PID;
+      }
+      default:
+        throw IndexException("Unrecognized page type\n");
+        break;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::CollectLeaf(PID leaf_PID,
+                                               LeafSnapshot& snapshot) {
+  std::vector<ModifyDelta*> modify_deltas;
+  std::vector<std::pair<LeafNode*, size_t>> base_leaves;
+  bool split_indicator = false;
+  KeyType split_separator = KeyType();
+  PID split_next_node = NullPID;
+  Page* merge_link = nullptr;
+  bool first_leaf = true;
+
+  snapshot.items_.clear();
+  snapshot.next_leaf_ = NullPID;
+  snapshot.absolute_min_ = false;
+
+  Page* current_page = map_table_[leaf_PID];
+  while (current_page != nullptr) {
+    switch (current_page->GetType()) {
+      case MODIFY_DELTA: {
+        // The newest record of a key is the first one we see
+        modify_deltas.push_back(reinterpret_cast<ModifyDelta*>(current_page));
+        current_page = current_page->GetDeltaNext();
+        break;
+      }
+      case SPLIT_DELTA: {
+        SplitDelta* split_delta = reinterpret_cast<SplitDelta*>(current_page);
+        if (!split_indicator) {
+          split_indicator = true;
+          split_separator = split_delta->separator_;
+          split_next_node = split_delta->side_link_;
+        }
+        current_page = current_page->GetDeltaNext();
+        break;
+      }
+      case REMOVE_NODE_DELTA: {
+        current_page = current_page->GetDeltaNext();
+        break;
+      }
+      case NODE_MERGE_DELTA: {
+        NodeMergeDelta* merge_delta =
+            reinterpret_cast<NodeMergeDelta*>(current_page);
+        merge_link = merge_delta->physical_link_;
+        current_page = current_page->GetDeltaNext();
+        break;
+      }
+      case LEAF_NODE: {
+        LeafNode* leaf = reinterpret_cast<LeafNode*>(current_page);
+        base_leaves.push_back(std::make_pair(leaf, leaf->GetSize()));
+
+        if (first_leaf) {
+          snapshot.low_key_ = leaf->low_key_;
+          snapshot.absolute_min_ = leaf->absolute_min_;
+          first_leaf = false;
+        }
+
+        if (merge_link != nullptr) {
+          current_page = merge_link;
+          merge_link = nullptr;
+        } else {
+          snapshot.next_leaf_ =
+              split_indicator ? split_next_node : leaf->next_leaf_;
+          current_page = nullptr;
+        }
+        break;
+      }
+      default:
+        // Not a leaf, nothing to collect
+        LOG_DEBUG("CollectLeaf called on a non-leaf page");
+        return;
+    }
+  }
+
+  std::unique_ptr<LeafNode> merged_leaf(
+      MergeLeafItems(modify_deltas, base_leaves));
+
+  // Records above the separator have moved to the new sibling
+  size_t item_count = merged_leaf->GetSize();
+  if (split_indicator)
+    item_count = merged_leaf->UpperBound(split_separator, comparator_);
+  snapshot.items_.reserve(item_count);
+  for (size_t item_itr = 0; item_itr < item_count; ++item_itr) {
+    snapshot.items_.push_back(std::make_pair(merged_leaf->keys_[item_itr],
+                                             merged_leaf->GetValues(item_itr)));
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::SeekLeaf(Iterator& itr, const KeyType& key,
+                                            LeafSeekMode mode) {
+  uint64_t worker_epoch = RegisterWorker();
+  PID leaf_PID = FindLeaf(key, mode);
+  if (leaf_PID == NullPID) {
+    itr.SetEnd();
+  } else {
+    CollectLeaf(leaf_PID, itr.leaf_);
+    itr.pos_ = 0;
+  }
+  DeregisterWorker(worker_epoch);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::LoadNextLeaf(Iterator& itr) {
+  bool has_bound = !itr.leaf_.items_.empty();
+  KeyType bound = has_bound ? itr.leaf_.items_.back().first : KeyType();
+  PID next_PID = itr.leaf_.next_leaf_;
+
+  uint64_t worker_epoch = RegisterWorker();
+  while (next_PID != NullPID) {
+    LeafSnapshot snapshot;
+    CollectLeaf(next_PID, snapshot);
+
+    // Drop whatever we have returned already
+    auto& items = snapshot.items_;
+    size_t skip = 0;
+    while (has_bound && skip < items.size() &&
+           reverse_comparator_(items[skip].first, bound) <= 0) {
+      skip++;
+    }
+    items.erase(items.begin(), items.begin() + skip);
+
+    if (!items.empty()) {
+      itr.leaf_ = std::move(snapshot);
+      itr.pos_ = 0;
+      DeregisterWorker(worker_epoch);
+      return;
+    }
+    next_PID = snapshot.next_leaf_;
+  }
+  DeregisterWorker(worker_epoch);
+  itr.SetEnd();
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::LoadPrevLeaf(Iterator& itr) {
+  // Leaves don't keep a usable link to their left sibling across splits, so
+  // we search again for the leaf that covers our low key
+  bool has_bound = !itr.leaf_.items_.empty();
+  KeyType bound = has_bound ? itr.leaf_.items_.front().first : KeyType();
+  KeyType low_key = itr.leaf_.low_key_;
+  bool absolute_min = itr.leaf_.absolute_min_;
+
+  uint64_t worker_epoch = RegisterWorker();
+  while (!absolute_min) {
+    PID leaf_PID = FindLeaf(low_key, SEEK_KEY);
+    if (leaf_PID == NullPID) break;
+
+    LeafSnapshot snapshot;
+    CollectLeaf(leaf_PID, snapshot);
+
+    // Drop whatever we have returned already
+    auto& items = snapshot.items_;
+    while (has_bound && !items.empty() &&
+           reverse_comparator_(items.back().first, bound) >= 0) {
+      items.pop_back();
+    }
+
+    if (!items.empty()) {
+      itr.pos_ = items.size() - 1;
+      itr.leaf_ = std::move(snapshot);
+      DeregisterWorker(worker_epoch);
+      return;
+    }
+
+    // Make sure we are making progress to the left
+    if (!snapshot.absolute_min_ &&
+        reverse_comparator_(snapshot.low_key_, low_key) >= 0) {
+      break;
+    }
+    low_key = snapshot.low_key_;
+    absolute_min = snapshot.absolute_min_;
+  }
+  DeregisterWorker(worker_epoch);
+  itr.SetEnd();
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
+            ValueEqualityChecker>::ConsolidateInnerNode(PID pid,
+                                                        Page* head_of_delta,
+                                                        std::stack<PID>&
+                                                            pages_visited) {
+  LOG_DEBUG("Performing consolidation of inner node %lu", pid);
+  Page* consolidated_page = Consolidate(pid);
+
+  /* Attempt to insert updated consolidated page */
+  if (!map_table_[pid].compare_exchange_strong(head_of_delta,
+                                               consolidated_page)) {
+    delete consolidated_page;
+    LOG_DEBUG("CAS of consolidation failed");
+    cas_failure_count_.Add();
+    return;
+  }
+  DeallocatePage(head_of_delta);
+  LOG_DEBUG("CAS of consolidation success");
+  consolidation_count_++;
+
+  /* Check if split is required and perform the operation */
+  Split_Operation(consolidated_page, pages_visited, pid);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::ConsolidateLeafNode(PID pid,
+                                                       Page* head_of_delta,
+                                                       std::stack<PID>&
+                                                           pages_visited) {
+  LOG_DEBUG("Performing consolidation");
+  Page* consolidated_page = Consolidate(pid);
+  if (!consolidated_page) return false;
+
+  /* Attempt to insert updated consolidated page */
+  if (!map_table_[pid].compare_exchange_strong(head_of_delta,
+                                               consolidated_page)) {
+    delete consolidated_page;
+    LOG_DEBUG("CAS of consolidation failed");
+    cas_failure_count_.Add();
+    return false;
+  }
+  DeallocatePage(head_of_delta);
+  LOG_DEBUG("CAS of consolidation success");
+  consolidation_count_++;
+
+  /* Check if split is required and perform the operation */
+  if (!Split_Operation(consolidated_page, pages_visited, pid)) {
+    /* Check if merge is requires and perform the operation */
+    Merge_Operation(consolidated_page, pages_visited, pid);
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
+            ValueEqualityChecker>::Split_Operation(Page* consolidated_page,
+                                                   std::stack<PID>&
+                                                       pages_visited,
+                                                   PID orig_pid) {
+  bool split_required = false;
+  SplitDelta* split_delta = nullptr;
+  IndexTermDelta* index_term_delta_for_split = nullptr;
+
+  /* Check if split required */
+  if (consolidated_page->GetType() == INNER_NODE) {
+    InnerNode* node_to_split = reinterpret_cast<InnerNode*>(consolidated_page);
+    if (node_to_split->GetSize() > split_size_) {
+      LOG_DEBUG("Attempting Split");
+      split_required = true;
+
+      /* Create new node */
+      InnerNode* new_inner_node = new InnerNode();
+      new_inner_node->absolute_min_ = false;
+      new_inner_node->absolute_max_ = node_to_split->absolute_max_;
+      new_inner_node->side_link_ = node_to_split->side_link_;
+
+      /* Choose a key to split on */
+      int key_split_index = (node_to_split->GetSize() / 2) - 1;
+      KeyType new_separator_key =
+          node_to_split->GetSeparator(key_split_index, separator_codec_);
+      new_inner_node->low_key_ = new_separator_key;
+      new_inner_node->high_key_ = node_to_split->high_key_;
+
+      /* Populate new node */
+      std::vector<std::pair<KeyType, PID>> children;
+      for (size_t i = (key_split_index + 1); i < node_to_split->GetSize();
+           i++) {
+        children.push_back(node_to_split->GetChild(i, separator_codec_));
+        assert(reverse_comparator_(children.back().first,
+                                   new_separator_key) > 0);
+      }
+      new_inner_node->SetChildren(children, separator_codec_);
+
+      /* Install the new page in the mapping table */
+      PID new_node_PID = InstallNewMapping(new_inner_node);
+
+      /* Check if you are splitting the root node */
+      if (orig_pid == root_) {
+        SplitRoot(node_to_split, new_inner_node, new_node_PID,
+                  key_split_index);
+        return true;
+      }
+
+      /* Create the Delta Split to Install */
+      split_delta = new SplitDelta(new_separator_key, new_node_PID);
+
+      /* Create the index term delta for the parent */
+      index_term_delta_for_split = new IndexTermDelta(
+          new_inner_node->low_key_, new_inner_node->high_key_, new_node_PID);
+      index_term_delta_for_split->absolute_max_ = new_inner_node->absolute_max_;
+    }
+  } else if (consolidated_page->GetType() == LEAF_NODE) {
+    __attribute__((unused)) LeafNode* node_to_split =
+        reinterpret_cast<LeafNode*>(consolidated_page);
+    if (node_to_split->GetSize() > split_size_) {
+      LOG_DEBUG("Attempting Split");
+      split_required = true;
+
+      /* Create new node */
+      LeafNode* new_leaf_node = new LeafNode();
+      new_leaf_node->absolute_min_ = false;
+      new_leaf_node->absolute_max_ = node_to_split->absolute_max_;
       new_leaf_node->side_link_ = node_to_split->side_link_;
       new_leaf_node->prev_leaf_ = node_to_split->prev_leaf_;
       new_leaf_node->next_leaf_ = node_to_split->next_leaf_;
 
       /* Choose a key to split on */
-      int key_split_index = (node_to_split->data_items_.size() / 2) - 1;
-      KeyType new_separator_key =
-          node_to_split->data_items_[key_split_index].first;
+      size_t key_split_index = (node_to_split->GetSize() / 2) - 1;
+      KeyType new_separator_key = separator_codec_.GetSeparator(
+          node_to_split->keys_[key_split_index],
+          node_to_split->keys_[key_split_index + 1]);
       new_leaf_node->low_key_ = new_separator_key;
       new_leaf_node->high_key_ = node_to_split->high_key_;
 
       /* Populate new node */
-      for (int i = (key_split_index + 1); i < node_to_split->data_items_.size();
-           i++) {
-        // can optimize this in the future
-        new_leaf_node->data_items_.push_back(node_to_split->data_items_[i]);
-        assert(reverse_comparator_(node_to_split->data_items_[i].first,
+      new_leaf_node->Reserve(
+          node_to_split->GetSize() - key_split_index - 1,
+          node_to_split->values_.size() -
+              node_to_split->value_offsets_[key_split_index + 1]);
+      for (size_t i = key_split_index + 1; i < node_to_split->GetSize(); i++) {
+        new_leaf_node->Append(node_to_split->keys_[i],
+                              node_to_split->ValuesBegin(i),
+                              node_to_split->ValuesEnd(i));
+        assert(reverse_comparator_(node_to_split->keys_[i],
                                    new_separator_key) > 0);
       }
 
@@ -1250,60 +1933,101 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
   if (split_required) {
     LOG_DEBUG("Performing Split");
     split_delta->SetDeltaNext(consolidated_page);
-    PID pid_to_use = (orig_pid == root_) ? reinstalled_root : orig_pid;
-    assert(pid_to_use != root_);
-    if (!map_table_[pid_to_use].compare_exchange_strong(consolidated_page,
+    assert(orig_pid != root_);
+    if (!map_table_[orig_pid].compare_exchange_strong(consolidated_page,
                                                       split_delta)) {
       delete split_delta;
-      if (orig_pid == root_) {
-        delete new_root_node;
-      } else {
-        delete index_term_delta_for_split;
-      }
+      delete index_term_delta_for_split;
 
       LOG_DEBUG("CAS of installing delta split failed");
+      cas_failure_count_.Add();
       return true;
     } else {
       LOG_DEBUG("CAS of installing delta split success");
+      split_count_++;
 
-      /* Check if we are splitting the root node */
-      if (orig_pid == root_) {
-        assert (new_root_node);
-        if (!map_table_[root_].compare_exchange_strong(consolidated_page,
-                                                              new_root_node)) {
-          LOG_DEBUG("CAS of installing new root node failed");
-          delete new_root_node;
-          return true;
-        }
-        LOG_DEBUG("Installing new root node successful");
-        return true;
-      } else {
-        /* Get PID of parent node */
-        PID pid_of_parent = pages_visited.top();
-
-        /* Attempt to install index term delta on the parent */
-        while (true) {
-          Page* parent_node = map_table_[pid_of_parent];
-          if (parent_node->GetType() != REMOVE_NODE_DELTA) {
-            index_term_delta_for_split->SetDeltaNext(parent_node);
-            if (map_table_[pid_of_parent].compare_exchange_strong(
-                parent_node, index_term_delta_for_split)) {
-              LOG_DEBUG("CAS of installing index term delta in parent succeeded");
-              LOG_DEBUG("with low key: %s high key: %s",
-                index_term_delta_for_split->low_separator_.GetTupleForComparison(key_tuple_schema).GetInfo().c_str(),
-                index_term_delta_for_split->high_separator_.GetTupleForComparison(key_tuple_schema).GetInfo().c_str());
-              return true;
-            }
-          } else {
-            delete index_term_delta_for_split;
-            LOG_DEBUG("CAS of installing index term delta in parent failed");
+      /* Get PID of parent node */
+      PID pid_of_parent = pages_visited.top();
+
+      /* Attempt to install index term delta on the parent */
+      while (true) {
+        Page* parent_node = map_table_[pid_of_parent];
+        if (parent_node->GetType() != REMOVE_NODE_DELTA) {
+          index_term_delta_for_split->SetDeltaNext(parent_node);
+          if (map_table_[pid_of_parent].compare_exchange_strong(
+              parent_node, index_term_delta_for_split)) {
+            LOG_DEBUG("CAS of installing index term delta in parent succeeded");
+            LOG_DEBUG("with low key: %s high key: %s",
+              index_term_delta_for_split->low_separator_.GetTupleForComparison(key_tuple_schema).GetInfo().c_str(),
+              index_term_delta_for_split->high_separator_.GetTupleForComparison(key_tuple_schema).GetInfo().c_str());
             return true;
           }
+        } else {
+          delete index_term_delta_for_split;
+          LOG_DEBUG("CAS of installing index term delta in parent failed");
+          return true;
         }
       }
     }
   }
-  return true;
+  return split_required;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
+            ValueEqualityChecker>::SplitRoot(InnerNode* old_root,
+                                             InnerNode* new_inner_node,
+                                             PID new_node_PID,
+                                             size_t key_split_index) {
+  LOG_DEBUG("Attempting to split the root node");
+
+  /* The root keeps its PID, so the lower half moves to a new node too */
+  InnerNode* lower_inner_node = new InnerNode();
+  lower_inner_node->absolute_min_ = old_root->absolute_min_;
+  lower_inner_node->low_key_ = old_root->low_key_;
+  std::vector<std::pair<KeyType, PID>> children;
+  for (size_t i = 0; i <= key_split_index; i++)
+    children.push_back(old_root->GetChild(i, separator_codec_));
+  lower_inner_node->SetChildren(children, separator_codec_);
+  lower_inner_node->high_key_ = children.back().first;
+  lower_inner_node->side_link_ = new_node_PID;
+  PID lower_node_PID = InstallNewMapping(lower_inner_node);
+
+  /* Create the new root node */
+  InnerNode* new_root_node = new InnerNode();
+  new_root_node->absolute_min_ = true;
+  new_root_node->absolute_max_ = true;
+  new_root_node->low_key_ = lower_inner_node->low_key_;
+  new_root_node->high_key_ = new_inner_node->high_key_;
+  children.clear();
+  children.push_back(
+      std::make_pair(lower_inner_node->high_key_, lower_node_PID));
+  children.push_back(std::make_pair(new_inner_node->high_key_, new_node_PID));
+  new_root_node->SetChildren(children, separator_codec_);
+
+  Page* expected = old_root;
+  if (map_table_[root_].compare_exchange_strong(expected, new_root_node)) {
+    LOG_DEBUG("Installing new root node successful");
+    split_count_++;
+    DeallocatePage(old_root);
+    return;
+  }
+
+  /* Nobody can have reached the new nodes yet */
+  LOG_DEBUG("CAS of installing new root node failed");
+  cas_failure_count_.Add();
+  delete new_root_node;
+  map_table_[lower_node_PID] = nullptr;
+  map_table_[new_node_PID] = nullptr;
+  delete lower_inner_node;
+  delete new_inner_node;
+  free_PIDs_lock_.Lock();
+  free_PIDs_.push_back(lower_node_PID);
+  free_PIDs_.push_back(new_node_PID);
+  free_PIDs_lock_.Unlock();
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
@@ -1381,14 +2105,16 @@ void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
   /* Check if merge required */
   if (consolidated_page->GetType() == INNER_NODE) {
     InnerNode* node_to_merge = reinterpret_cast<InnerNode*>(consolidated_page);
-    if ((node_to_merge->children_.size() < MERGE_SIZE) &&
+    if ((node_to_merge->GetSize() < merge_size_) &&
         (!node_to_merge->absolute_min_)) {
       LOG_DEBUG("Attempting Merge");
       merge_required = true;
 
       /* Find the node to merge into */
       pid_merging_into =
-          find_left_sibling(pages_visited, node_to_merge->low_key_);
+          find_left_sibling(pages_visited, node_to_merge->low_key_,
+                            node_to_merge->high_key_,
+                            node_to_merge->absolute_max_, orig_pid);
 
       if (pid_merging_into == root_) {
         LOG_DEBUG("Merge abandoned - couldn't find left sibling");
@@ -1435,6 +2161,7 @@ void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
       index_term_delta_for_merge->absolute_max_ = node_to_merge->absolute_max_;
       index_term_delta_for_merge->absolute_min_ =
           node_merging_into->absolute_min_;
+      index_term_delta_for_merge->merged_PID_ = orig_pid;
 
       /* Attempt to install the consolidated page */
       if (map_table_[pid_merging_into].compare_exchange_strong(
@@ -1455,14 +2182,16 @@ void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
   } else if (consolidated_page->GetType() == LEAF_NODE) {
     __attribute__((unused)) LeafNode* node_to_merge =
         reinterpret_cast<LeafNode*>(consolidated_page);
-    if ((node_to_merge->data_items_.size() < MERGE_SIZE) &&
+    if ((node_to_merge->GetSize() < merge_size_) &&
         (!node_to_merge->absolute_min_)) {
       LOG_DEBUG("Attempting Merge");
       merge_required = true;
 
       /* Find the node to merge into */
       pid_merging_into =
-          find_left_sibling(pages_visited, node_to_merge->low_key_);
+          find_left_sibling(pages_visited, node_to_merge->low_key_,
+                            node_to_merge->high_key_,
+                            node_to_merge->absolute_max_, orig_pid);
 
       if (pid_merging_into == root_) {
         LOG_DEBUG("Merge abandoned - couldn't find left sibling");
@@ -1509,6 +2238,7 @@ void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
       index_term_delta_for_merge->absolute_max_ = node_to_merge->absolute_max_;
       index_term_delta_for_merge->absolute_min_ =
           node_merging_into->absolute_min_;
+      index_term_delta_for_merge->merged_PID_ = orig_pid;
 
       /* Attempt to install the consolidated page */
       if (map_table_[pid_merging_into].compare_exchange_strong(
@@ -1536,12 +2266,14 @@ void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
     if (!map_table_[orig_pid].compare_exchange_strong(consolidated_page,
                                                       remove_node_delta)) {
       LOG_DEBUG("CAS of installing remove node failed");
+      cas_failure_count_.Add();
       delete remove_node_delta;
       delete merge_delta;
       delete index_term_delta_for_merge;
       return;
     } else {
       LOG_DEBUG("CAS of installing remove node success with PID: %ld", orig_pid);
+      merge_count_++;
 
       /* Attempt to install node merge delta */
       if (page_merging_into->GetType() == REMOVE_NODE_DELTA) {
@@ -1560,6 +2292,7 @@ void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
           delete merge_delta;
           delete index_term_delta_for_merge;
           LOG_DEBUG("CAS of installing node merge delta failed");
+          cas_failure_count_.Add();
           return;
         }
       }
@@ -1586,6 +2319,26 @@ void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
           return;
         }
       }
+
+      /* Fold the merge delta into the node we merged into. After that only
+         threads that are already on their way can reach orig_pid. */
+      Page* top_of_merged_into = map_table_[pid_merging_into];
+      if (top_of_merged_into->GetType() == REMOVE_NODE_DELTA) {
+        return;
+      }
+      remove_node_delta->retired_ = true;
+      Page* consolidated_merged_into = Consolidate(pid_merging_into);
+      if (!consolidated_merged_into) {
+        return;
+      }
+      if (map_table_[pid_merging_into].compare_exchange_strong(
+              top_of_merged_into, consolidated_merged_into)) {
+        DeallocatePage(top_of_merged_into);
+        RetirePID(orig_pid);
+      } else {
+        delete consolidated_merged_into;
+        LOG_DEBUG("Not recycling PID %ld, node merged into has changed", orig_pid);
+      }
     }
   }
 }
@@ -1598,7 +2351,10 @@ template <typename KeyType, typename ValueType, class KeyComparator,
 std::uint64_t
 BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
        ValueEqualityChecker>::find_left_sibling(std::stack<PID>& pages_visited,
-                                                KeyType merge_key) {
+                                                KeyType merge_key,
+                                                KeyType high_key,
+                                                bool absolute_max,
+                                                PID merge_PID) {
   PID parent_pid = pages_visited.top();
   Page* parent_page = Consolidate(parent_pid);
   if (!parent_page) {
@@ -1613,10 +2369,22 @@ BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
       case INNER_NODE: {
         InnerNode* inner_node = reinterpret_cast<InnerNode*>(parent_page);
 
-        for (const auto& child : inner_node->children_) {
-          if (reverse_comparator_(merge_key, child.first) == 0) {
+        size_t child_idx =
+            inner_node->FindChild(merge_key, separator_codec_, comparator_);
+        if (child_idx + 1 < inner_node->GetSize() &&
+            reverse_comparator_(
+                merge_key,
+                inner_node->GetSeparator(child_idx, separator_codec_)) == 0) {
+          /* The node to merge has to be the next child, and the parent has
+           * to route its whole range to it */
+          auto next_child = inner_node->GetChild(child_idx + 1,
+                                                 separator_codec_);
+          bool last_child = (child_idx + 2 == inner_node->GetSize());
+          if (next_child.second == merge_PID &&
+              (reverse_comparator_(high_key, next_child.first) == 0 ||
+               (absolute_max && last_child && inner_node->absolute_max_))) {
             LOG_DEBUG("Found left sibling in Inner Node");
-            PID found_pid = child.second;
+            PID found_pid = inner_node->GetChildPID(child_idx);
             delete parent_page;
             return found_pid;
           }
@@ -1682,11 +2450,17 @@ template <typename KeyType, typename ValueType, class KeyComparator,
           class ValueEqualityChecker>
 bool BWTree<
     KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
-    ValueEqualityChecker>::complete_the_merge(RemoveNodeDelta* remove_node,
+    ValueEqualityChecker>::complete_the_merge(PID removed_PID,
+                                              RemoveNodeDelta* remove_node,
                                               std::stack<PID>& pages_visited) {
   PID merged_into_pid = remove_node->merged_into_;
   IndexTermDelta* index_term_delta = nullptr;
 
+  /* The merge has been folded in already, just go to the left sibling */
+  if (remove_node->retired_) {
+    return true;
+  }
+
   /* Get the high key of the page that's deleted */
   Page* page_deleted = remove_node->GetDeltaNext();
 
@@ -1705,6 +2479,7 @@ bool BWTree<
           page_merging_into, page_merging_into_consolidate)) {
     delete page_merging_into_consolidate;
     LOG_DEBUG("CAS of consolidated page failed");
+    cas_failure_count_.Add();
     return false;
   } else {
     DeallocatePage(page_merging_into);
@@ -1726,127 +2501,462 @@ bool BWTree<
       if (!map_table_[merged_into_pid].compare_exchange_strong(
               page_merging_into_consolidate, merge_delta)) {
         LOG_DEBUG("CAS of merge delta failed");
+        cas_failure_count_.Add();
+        delete merge_delta;
+        return false;
+      }
+    }
+
+    InnerNode* inner_merged_into =
+        reinterpret_cast<InnerNode*>(page_merging_into_consolidate);
+    index_term_delta =
+        new IndexTermDelta(inner_merged_into->low_key_,
+                           inner_node->high_key_, merged_into_pid);
+    index_term_delta->absolute_max_ = inner_node->absolute_max_;
+    index_term_delta->absolute_min_ = inner_merged_into->absolute_min_;
+    index_term_delta->merged_PID_ = removed_PID;
+  } else if (page_deleted->GetType() == LEAF_NODE) {
+    __attribute__((unused)) LeafNode* leaf =
+        reinterpret_cast<LeafNode*>(page_deleted);
+    if (!is_merge_installed(page_merging_into_consolidate, page_deleted,
+                            leaf->high_key_)) {
+      LOG_DEBUG("Need to install merge delta for incomplete SMO");
+
+      /* Create a new merge delta */
+      NodeMergeDelta* merge_delta = new NodeMergeDelta(
+          leaf->low_key_, leaf->absolute_max_, page_deleted);
+
+      /* Install Merge Delta */
+      merge_delta->SetDeltaNext(page_merging_into_consolidate);
+      if (!map_table_[merged_into_pid].compare_exchange_strong(
+              page_merging_into_consolidate, merge_delta)) {
+        LOG_DEBUG("CAS of merge delta failed");
+        cas_failure_count_.Add();
         delete merge_delta;
         return false;
       }
     }
 
-    InnerNode* inner_merged_into =
-        reinterpret_cast<InnerNode*>(page_merging_into_consolidate);
-    index_term_delta =
-        new IndexTermDelta(inner_merged_into->low_key_,
-                           inner_node->high_key_, merged_into_pid);
-    index_term_delta->absolute_max_ = inner_node->absolute_max_;
-    index_term_delta->absolute_min_ = inner_merged_into->absolute_min_;
-  } else if (page_deleted->GetType() == LEAF_NODE) {
-    __attribute__((unused)) LeafNode* leaf =
-        reinterpret_cast<LeafNode*>(page_deleted);
-    if (!is_merge_installed(page_merging_into_consolidate, page_deleted,
-                            leaf->high_key_)) {
-      LOG_DEBUG("Need to install merge delta for incomplete SMO");
+    __attribute__((unused)) LeafNode* leaf_merged_into =
+        reinterpret_cast<LeafNode*>(page_merging_into_consolidate);
+    index_term_delta =
+        new IndexTermDelta(leaf_merged_into->low_key_,
+                           leaf->high_key_, merged_into_pid);
+    index_term_delta->absolute_max_ = leaf->absolute_max_;
+    index_term_delta->absolute_min_ = leaf_merged_into->absolute_min_;
+    index_term_delta->merged_PID_ = removed_PID;
+  } else {
+    assert(0);
+  }
+
+  /* Get PID of parent node */
+  PID pid_of_parent = pages_visited.top();
+
+  /* Attempt to install index term delta on the parent */
+  while (true) {
+    Page* parent_node = map_table_[pid_of_parent];
+    if (parent_node->GetType() != REMOVE_NODE_DELTA) {
+      index_term_delta->SetDeltaNext(parent_node);
+      if (map_table_[pid_of_parent].compare_exchange_strong(parent_node,
+                                                            index_term_delta)) {
+        LOG_DEBUG("CAS of installing index term delta in parent succeeded");
+        return true;
+      }
+    } else {
+      delete index_term_delta;
+      LOG_DEBUG("CAS of installing index term delta in parent failed because parent is removed");
+      return false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
+            ValueEqualityChecker>::is_merge_installed(Page* page_merging_into,
+                                                      Page* compare_to,
+                                                      KeyType high_key) {
+  Page* current_page = page_merging_into;
+
+  while (true) {
+    switch (current_page->GetType()) {
+      case INNER_NODE: {
+        InnerNode* inner_node = reinterpret_cast<InnerNode*>(current_page);
+
+        if (reverse_comparator_(high_key, inner_node->high_key_) <= 0) {
+          return true;
+        } else {
+          return false;
+        }
+        continue;
+      }
+      case INDEX_TERM_DELTA: {
+        current_page = current_page->GetDeltaNext();
+        continue;
+      }
+      case SPLIT_DELTA: {
+        assert(0);
+        continue;
+      }
+      case REMOVE_NODE_DELTA: {
+        assert(0);
+        continue;
+      }
+      case NODE_MERGE_DELTA: {
+        NodeMergeDelta* merge_delta =
+            reinterpret_cast<NodeMergeDelta*>(current_page);
+        if (merge_delta->physical_link_ == compare_to) {
+          LOG_DEBUG("because of this?");
+          return true;
+        }
+
+        current_page = current_page->GetDeltaNext();
+        continue;
+      }
+      case LEAF_NODE: {
+        __attribute__((unused)) LeafNode* leaf =
+            reinterpret_cast<LeafNode*>(current_page);
+
+        if (reverse_comparator_(high_key, leaf->high_key_) <= 0) {
+          LOG_DEBUG("because of that?");
+          return true;
+        } else {
+          return false;
+        }
+        continue;
+      }
+      case MODIFY_DELTA: {
+        current_page = current_page->GetDeltaNext();
+        continue;
+      }
+      default:
+        throw IndexException("Unrecognized page type\n");
+        break;
+    }
+  }
+
+  assert(0);
+  return false;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
+            ValueEqualityChecker>::RunEpochManager() {
+  if (!GC_ENABLED) {
+    assert(false);
+  }
+  std::mutex mtx;
+  std::unique_lock<std::mutex> lck(mtx);
+  while (!finished_) {
+    // Also woken up when the interval changes or the tree goes away
+    exec_finished_.wait_for(lck,
+        std::chrono::milliseconds(epoch_interval_ms_.load()));
+    if (finished_)
+      break;
+
+    // Garbage is reclaimed by the worker threads themselves in batches, so
+    // all we have to do here is move on to the next epoch
+    ++epoch_;
+    LOG_DEBUG("Incremented epoch to %u", (unsigned) epoch_.load());
+  }
+  LOG_DEBUG("Woken up, exiting...");
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::SetEpochInterval(uint64_t interval_ms) {
+  epoch_interval_ms_ = interval_ms;
+  exec_finished_.notify_one();
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::SetConsolidateThreshold(size_t threshold) {
+  if (threshold == 0) {
+    throw IndexException("BWTree consolidation threshold has to be positive");
+  }
+  consolidate_threshold_ = threshold;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::SetSplitSize(size_t split_size) {
+  // Both halves of a split node have to stay above the merge size
+  if (split_size < 2 || split_size < merge_size_ * 2) {
+    throw IndexException("BWTree split size has to be at least twice the "
+                         "merge size");
+  }
+  split_size_ = split_size;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::SetMergeSize(size_t merge_size) {
+  if (merge_size * 2 > split_size_) {
+    throw IndexException("BWTree merge size can be at most half the split "
+                         "size");
+  }
+  merge_size_ = merge_size;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::SetBackgroundMaintenance(bool enabled) {
+  std::unique_lock<std::mutex> lock(maintenance_lock_);
+  if (enabled == !maintenance_stopped_) return;
+
+  if (enabled) {
+    maintenance_stopped_ = false;
+    maintenance_thread_ = std::thread(&BWTree::RunMaintenance, this);
+    background_maintenance_ = true;
+    return;
+  }
+
+  // Foreground threads consolidate inline again from here on. Chains that
+  // were posted but not handled yet are too long already, so the next
+  // insert or delete on them takes care of them.
+  background_maintenance_ = false;
+  maintenance_stopped_ = true;
+  maintenance_hints_.clear();
+  lock.unlock();
+  maintenance_cv_.notify_one();
+  maintenance_thread_.join();
+  maintenance_done_cv_.notify_all();
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::WaitForMaintenance() {
+  std::unique_lock<std::mutex> lock(maintenance_lock_);
+  maintenance_done_cv_.wait(lock, [this] {
+    return maintenance_stopped_ ||
+           (maintenance_hints_.empty() && !maintenance_busy_);
+  });
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::PostMaintenanceHint(const KeyType& key) {
+  {
+    std::lock_guard<std::mutex> lock(maintenance_lock_);
+    if (maintenance_stopped_) return;
+    if (maintenance_hints_.size() >= MAINTENANCE_QUEUE_SIZE) {
+      dropped_hint_count_.Add();
+      return;
+    }
+    maintenance_hints_.push_back(key);
+    posted_hint_count_.Add();
+  }
+  maintenance_cv_.notify_one();
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::RunMaintenance() {
+  std::unique_lock<std::mutex> lock(maintenance_lock_);
+  while (true) {
+    maintenance_cv_.wait(lock, [this] {
+      return maintenance_stopped_ || !maintenance_hints_.empty();
+    });
+    if (maintenance_stopped_) break;
 
-      /* Create a new merge delta */
-      NodeMergeDelta* merge_delta = new NodeMergeDelta(
-          leaf->low_key_, leaf->absolute_max_, page_deleted);
+    KeyType key = maintenance_hints_.front();
+    maintenance_hints_.pop_front();
+    maintenance_busy_ = true;
+    lock.unlock();
 
-      /* Install Merge Delta */
-      merge_delta->SetDeltaNext(page_merging_into_consolidate);
-      if (!map_table_[merged_into_pid].compare_exchange_strong(
-              page_merging_into_consolidate, merge_delta)) {
-        LOG_DEBUG("CAS of merge delta failed");
-        delete merge_delta;
-        return false;
-      }
-    }
+    MaintainKey(key);
 
-    __attribute__((unused)) LeafNode* leaf_merged_into =
-        reinterpret_cast<LeafNode*>(page_merging_into_consolidate);
-    index_term_delta =
-        new IndexTermDelta(leaf_merged_into->low_key_,
-                           leaf->high_key_, merged_into_pid);
-    index_term_delta->absolute_max_ = leaf->absolute_max_;
-    index_term_delta->absolute_min_ = leaf_merged_into->absolute_min_;
-  } else {
-    assert(0);
+    lock.lock();
+    maintenance_busy_ = false;
+    if (maintenance_hints_.empty()) maintenance_done_cv_.notify_all();
   }
+  LOG_DEBUG("Maintenance thread exiting...");
+}
 
-  /* Get PID of parent node */
-  PID pid_of_parent = pages_visited.top();
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::MaintainKey(const KeyType& key) {
+  uint64_t worker_epoch = RegisterWorker();
 
-  /* Attempt to install index term delta on the parent */
-  while (true) {
-    Page* parent_node = map_table_[pid_of_parent];
-    if (parent_node->GetType() != REMOVE_NODE_DELTA) {
-      index_term_delta->SetDeltaNext(parent_node);
-      if (map_table_[pid_of_parent].compare_exchange_strong(parent_node,
-                                                            index_term_delta)) {
-        LOG_DEBUG("CAS of installing index term delta in parent succeeded");
-        return true;
+  // Foreground threads may get to the chain first, so a lost race is only
+  // retried a few times
+  for (size_t attempt = 0; attempt < MAINTENANCE_MAX_ATTEMPTS; attempt++) {
+    std::stack<PID> pages_visited;
+    PID leaf_PID = FindLeafPath(key, pages_visited);
+    if (leaf_PID == NullPID) continue;
+
+    Page* head_of_delta = map_table_[leaf_PID];
+    if (head_of_delta->GetDepth() > consolidate_threshold_) {
+      if (!ConsolidateLeafNode(leaf_PID, head_of_delta, pages_visited)) {
+        continue;
+      }
+    } else if (head_of_delta->GetType() == LEAF_NODE) {
+      // Consolidated by someone else, but it may still need a split or merge
+      if (!Split_Operation(head_of_delta, pages_visited, leaf_PID)) {
+        Merge_Operation(head_of_delta, pages_visited, leaf_PID);
       }
-    } else {
-      delete index_term_delta;
-      LOG_DEBUG("CAS of installing index term delta in parent failed because parent is removed");
-      return false;
     }
+    break;
   }
+
+  DeregisterWorker(worker_epoch);
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
           bool _Duplicates,
           class ValueEqualityChecker>
-bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
-            ValueEqualityChecker>::is_merge_installed(Page* page_merging_into,
-                                                      Page* compare_to,
-                                                      KeyType high_key) {
-  Page* current_page = page_merging_into;
-
+typename BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                _Duplicates, ValueEqualityChecker>::PID
+BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+       ValueEqualityChecker>::FindLeafPath(const KeyType& key,
+                                           std::stack<PID>& pages_visited) {
+  PID current_PID = root_;
+  Page* current_page = map_table_[current_PID];
+  Page* head_of_delta = current_page;
   while (true) {
     switch (current_page->GetType()) {
       case INNER_NODE: {
         InnerNode* inner_node = reinterpret_cast<InnerNode*>(current_page);
 
-        if (reverse_comparator_(high_key, inner_node->high_key_) <= 0) {
-          return true;
-        } else {
-          return false;
+        /* Nothing but the empty root */
+        if (inner_node->GetSize() == 0) return NullPID;
+
+        bool found_child = false;
+        size_t child_idx =
+            inner_node->FindChild(key, separator_codec_, comparator_);
+        if (child_idx < inner_node->GetSize()) {
+          pages_visited.push(current_PID);
+          current_PID = inner_node->GetChildPID(child_idx);
+          found_child = true;
+        }
+        if (!found_child) {
+          // If the key is between high_key_ and max value, then we go to
+          // the last child.
+          if (inner_node->absolute_max_) {
+            pages_visited.push(current_PID);
+            current_PID = inner_node->GetChildPID(inner_node->GetSize() - 1);
+          } else {
+            /* Means we need to repair a split  */
+            if (!complete_the_split(inner_node->side_link_, pages_visited)) {
+              return NullPID;
+            }
+            current_PID = inner_node->side_link_;
+          }
         }
+        current_page = map_table_[current_PID];
+        head_of_delta = current_page;
         continue;
       }
       case INDEX_TERM_DELTA: {
-        current_page = current_page->GetDeltaNext();
+        if (current_page == head_of_delta && CheckConsolidate(current_PID)) {
+          ConsolidateInnerNode(current_PID, head_of_delta, pages_visited);
+          current_page = map_table_[current_PID];
+          head_of_delta = current_page;
+          continue;
+        }
+        IndexTermDelta* idx_delta =
+            reinterpret_cast<IndexTermDelta*>(current_page);
+        if ((idx_delta->absolute_min_ ||
+             reverse_comparator_(key, idx_delta->low_separator_) > 0) &&
+            (idx_delta->absolute_max_ ||
+             reverse_comparator_(key, idx_delta->high_separator_) <= 0)) {
+          // Follow the side link to this child
+          pages_visited.push(current_PID);
+          current_PID = idx_delta->side_link_;
+          current_page = map_table_[current_PID];
+          head_of_delta = current_page;
+        } else {
+          current_page = current_page->GetDeltaNext();
+        }
         continue;
       }
       case SPLIT_DELTA: {
-        assert(0);
+        SplitDelta* split_delta = reinterpret_cast<SplitDelta*>(current_page);
+
+        /* Check if your Key is affected by the split */
+        if (reverse_comparator_(key, split_delta->separator_) > 0) {
+          if (!complete_the_split(split_delta->side_link_, pages_visited)) {
+            return NullPID;
+          }
+          current_PID = split_delta->side_link_;
+          current_page = map_table_[current_PID];
+          head_of_delta = current_page;
+        } else {
+          current_page = current_page->GetDeltaNext();
+        }
         continue;
       }
       case REMOVE_NODE_DELTA: {
-        assert(0);
+        RemoveNodeDelta* remove_delta =
+            reinterpret_cast<RemoveNodeDelta*>(current_page);
+        if (!complete_the_merge(current_PID, remove_delta, pages_visited)) return NullPID;
+
+        current_PID = remove_delta->merged_into_;
+        current_page = map_table_[current_PID];
+        head_of_delta = current_page;
         continue;
       }
       case NODE_MERGE_DELTA: {
         NodeMergeDelta* merge_delta =
             reinterpret_cast<NodeMergeDelta*>(current_page);
-        if (merge_delta->physical_link_ == compare_to) {
-          LOG_DEBUG("because of this?");
-          return true;
-        }
 
-        current_page = current_page->GetDeltaNext();
+        /* Check if your Key is in merged node  */
+        if (reverse_comparator_(key, merge_delta->separator_) > 0) {
+          current_page = merge_delta->physical_link_;
+        } else {
+          current_page = current_page->GetDeltaNext();
+        }
         continue;
       }
       case LEAF_NODE: {
-        __attribute__((unused)) LeafNode* leaf =
-            reinterpret_cast<LeafNode*>(current_page);
+        LeafNode* leaf = reinterpret_cast<LeafNode*>(current_page);
 
-        if (reverse_comparator_(high_key, leaf->high_key_) <= 0) {
-          LOG_DEBUG("because of that?");
-          return true;
-        } else {
-          return false;
+        /* Check if we need to complete split SMO */
+        if (!leaf->absolute_max_ &&
+            reverse_comparator_(key, leaf->high_key_) > 0) {
+          if (!complete_the_split(leaf->side_link_, pages_visited)) {
+            return NullPID;
+          }
+          current_PID = leaf->side_link_;
+          current_page = map_table_[current_PID];
+          head_of_delta = current_page;
+          continue;
         }
-        continue;
+        return current_PID;
       }
       case MODIFY_DELTA: {
         current_page = current_page->GetDeltaNext();
@@ -1857,86 +2967,93 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
         break;
     }
   }
-
-  assert(0);
-  return false;
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
           bool _Duplicates,
           class ValueEqualityChecker>
-void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,  _Duplicates,
-            ValueEqualityChecker>::RunEpochManager() {
+uint64_t BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::RegisterWorker() {
   if (!GC_ENABLED) {
-    assert(false);
+    return 0;
   }
-  std::mutex mtx;
-  std::unique_lock<std::mutex> lck(mtx);
-  while (exec_finished_.wait_for(lck,
-        std::chrono::milliseconds(EPOCH_INTERVAL_MS)) == std::cv_status::timeout
-      && !finished_) {
-    LOG_DEBUG("Timed out...");
-    // Get next epoch #
-    uint64_t next_epoch = epoch_ + 1;
-    LOG_DEBUG("Incrementing epoch to %u", (unsigned) next_epoch);
-
-    // Add new epoch slots to the active workers map and the garbage
-    // collection map
-    LOG_DEBUG("epoch garbage size: %u", (unsigned) epoch_garbage_.size());
-    LOG_DEBUG("active threads size: %u", (unsigned) active_threads_map_.size());
-    active_threads_map_[next_epoch] = 0;
-    epoch_garbage_[next_epoch] = std::vector<Page*>();
-
-    // Now increment the global epoch counter. This should always be
-    // equal to next_epoch because this thread should be the only one
-    // ever changing it.
-    ++epoch_;
-
-    // We disable doind cleanup on our own because otherwise we do not pass
-    // the speed test.
-    // Cleanup();
-    assert(epoch_ == next_epoch);
-    for (uint64_t i = 0; i < epoch_; ++i) {
-      auto entry = active_threads_map_.find(i);
-      if (entry != active_threads_map_.end() && active_threads_map_[i] > 0) {
-        LOG_DEBUG("Epoch %u has %u active threads remaining",(unsigned) i,
-            (unsigned)active_threads_map_[i]);
-      }
-    }
-    if (finished_)
-      break;
+  EpochSlot &slot = epoch_slots_[EpochThreadRegistry::GetThreadId()];
+  if (slot.depth_++ == 0) {
+    // Has to be visible before we read any page
+    slot.epoch_ = epoch_.load();
   }
-  LOG_DEBUG("Woken up, exiting...");
+  return slot.epoch_;
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
           bool _Duplicates,
           class ValueEqualityChecker>
-uint64_t BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
-            ValueEqualityChecker>::RegisterWorker() {
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::DeregisterWorker(__attribute__((unused))
+                                                    uint64_t worker_epoch) {
   if (!GC_ENABLED) {
-    return 0;
+    return;
+  }
+  EpochSlot &slot = epoch_slots_[EpochThreadRegistry::GetThreadId()];
+  assert(slot.depth_ > 0);
+  if (--slot.depth_ == 0) {
+    slot.epoch_ = QUIESCENT_EPOCH;
   }
-  uint64_t current_epoch = epoch_;
-  LOG_DEBUG("Registering thread for epoch %u", (unsigned) current_epoch);
-  ++(active_threads_map_[current_epoch]);
-  return current_epoch;
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
-          bool _Duplicates ,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::DeallocatePage(Page *page) {
+  size_t slot_id = EpochThreadRegistry::GetThreadId();
+  EpochSlot &slot = epoch_slots_[slot_id];
+
+  slot.garbage_lock_.Lock();
+  slot.garbage_pages_.emplace_back(epoch_.load(), page);
+  bool reclaim = slot.garbage_pages_.size() + slot.garbage_PIDs_.size() >=
+                 slot.reclaim_at_;
+  slot.garbage_lock_.Unlock();
+
+  if (GC_ENABLED && reclaim) {
+    ReclaimGarbage(slot_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
           class ValueEqualityChecker>
 void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
-            ValueEqualityChecker>::DeregisterWorker(uint64_t worker_epoch) {
+            ValueEqualityChecker>::RetirePID(PID pid) {
+  // Without GC we never know when it is safe to reuse a PID
   if (!GC_ENABLED) {
     return;
   }
-  LOG_DEBUG("Deregistering thread from epoch %u", (unsigned) worker_epoch);
-  --(active_threads_map_[worker_epoch]);
-  assert(active_threads_map_[worker_epoch] >= 0);
+  EpochSlot &slot = epoch_slots_[EpochThreadRegistry::GetThreadId()];
+  LOG_DEBUG("Retiring PID %lu", pid);
+
+  slot.garbage_lock_.Lock();
+  slot.garbage_PIDs_.emplace_back(epoch_.load(), pid);
+  slot.garbage_lock_.Unlock();
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+uint64_t BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::GetSafeEpoch() {
+  uint64_t safe_epoch = epoch_;
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    uint64_t thread_epoch = epoch_slots_[i].epoch_;
+    if (thread_epoch < safe_epoch) safe_epoch = thread_epoch;
+  }
+  return safe_epoch;
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
@@ -1944,12 +3061,50 @@ template <typename KeyType, typename ValueType, class KeyComparator,
           bool _Duplicates,
           class ValueEqualityChecker>
 void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
-            ValueEqualityChecker>::DeallocatePage(Page *page) {
-  uint64_t current_epoch = epoch_;
-  LOG_DEBUG("Deallocating page in epoch %u", (unsigned) current_epoch);
-  dealloc_lock.WriteLock();
-  epoch_garbage_[current_epoch].push_back(page);
-  dealloc_lock.Unlock();
+            ValueEqualityChecker>::ReclaimGarbage(size_t slot_id) {
+  EpochSlot &slot = epoch_slots_[slot_id];
+  uint64_t safe_epoch = GetSafeEpoch();
+  std::vector<Page*> free_pages;
+  std::vector<PID> free_PIDs;
+
+  // Garbage is appended in epoch order, so we only need to cut off the front
+  slot.garbage_lock_.Lock();
+  auto pages_end = slot.garbage_pages_.begin();
+  while (pages_end != slot.garbage_pages_.end() &&
+         pages_end->first < safe_epoch) {
+    free_pages.push_back(pages_end->second);
+    ++pages_end;
+  }
+  slot.garbage_pages_.erase(slot.garbage_pages_.begin(), pages_end);
+
+  auto PIDs_end = slot.garbage_PIDs_.begin();
+  while (PIDs_end != slot.garbage_PIDs_.end() &&
+         PIDs_end->first < safe_epoch) {
+    free_PIDs.push_back(PIDs_end->second);
+    ++PIDs_end;
+  }
+  slot.garbage_PIDs_.erase(slot.garbage_PIDs_.begin(), PIDs_end);
+
+  // Don't try again before the batch has filled up, even if a long running
+  // thread keeps us from freeing anything
+  size_t remaining = slot.garbage_pages_.size() + slot.garbage_PIDs_.size();
+  slot.reclaim_at_ = std::max<size_t>(EPOCH_GC_BATCH_SIZE, 2 * remaining);
+  slot.garbage_lock_.Unlock();
+
+  LOG_DEBUG("Reclaiming %lu pages and %lu PIDs older than epoch %lu",
+            free_pages.size(), free_PIDs.size(), safe_epoch);
+  for (Page *chain_head : free_pages) {
+    FreeDeltaChain(chain_head);
+  }
+
+  if (!free_PIDs.empty()) {
+    for (PID pid : free_PIDs) {
+      FreeDeltaChain(map_table_[pid].exchange(nullptr));
+    }
+    free_PIDs_lock_.Lock();
+    free_PIDs_.insert(free_PIDs_.end(), free_PIDs.begin(), free_PIDs.end());
+    free_PIDs_lock_.Unlock();
+  }
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
@@ -1962,34 +3117,10 @@ bool BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
     return true;
   }
   LOG_DEBUG("Cleaning up old pages");
-  cleanup_lock.WriteLock();
-  uint64_t current_epoch = epoch_;
-
-  // Find all epochs that are safe to garbage collect
-  for (uint64_t i = 0; i < current_epoch; ++i) {
-    auto entry = active_threads_map_.find(i);
-    if (entry != active_threads_map_.end() && entry->second == 0) {
-      // This is a previous epoch and there are no active threads remaining
-      // (safe to clean)
-      LOG_DEBUG("Found safe epoch %u", (unsigned) i);
-      std::vector<Page*>& dealloc_pages = epoch_garbage_[i];
-      LOG_DEBUG("Deleting garbage (%u items) in safe epoch %u\n", 
-          (unsigned) dealloc_pages.size(),
-          (unsigned) i);
-      for (uint64_t j = 0; j < dealloc_pages.size(); ++j) {
-        Page *chain_head = dealloc_pages[j];
-        FreeDeltaChain(chain_head);
-        dealloc_pages[j] = nullptr;
-      }
-      active_threads_map_.erase(i);
-      epoch_garbage_.erase(i);
-    }
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    ReclaimGarbage(i);
   }
-  LOG_DEBUG("epoch garbage size: %u", (unsigned) epoch_garbage_.size());
-  LOG_DEBUG("active threads size: %u", (unsigned) active_threads_map_.size());
-  assert(epoch_garbage_.size() == active_threads_map_.size());
-  cleanup_lock.Unlock();
-
   return true;
 }
 
@@ -2007,8 +3138,11 @@ size_t BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates
   size_t memory_footprint = 0;
 
   // First walk through mapping table and calculate footprint
+  memory_footprint += map_table_.GetMemoryFootprint();
   PID num_pids = PID_counter_;
-  for (PID i = 0; i < PID_counter_; ++i) {
+  for (PID i = 0; i < num_pids; ++i) {
+    // The chunk may not have been published yet
+    if (!map_table_.IsReserved(i)) continue;
     Page *current_page = map_table_[i];
     while (current_page != nullptr) {
       memory_footprint += GetPageSize(current_page);
@@ -2017,29 +3151,99 @@ size_t BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates
   }
 
   // Now walk through pages to be deallocated (but haven't yet)
-  uint64_t current_epoch = epoch_;
-  cleanup_lock.ReadLock();
-
-  for (uint64_t i = 0; i < current_epoch; ++i) {
-    auto entry = epoch_garbage_.find(i);
-    if (entry != epoch_garbage_.end()) {
-      std::vector<Page*> chain_heads = entry->second;
-      for (Page *chain_head : chain_heads) {
-        Page *current_page = chain_head;
-        while (current_page != nullptr) {
-          memory_footprint += GetPageSize(current_page);
-          current_page = current_page->GetDeltaNext();
-        }
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    EpochSlot &slot = epoch_slots_[i];
+    slot.garbage_lock_.Lock();
+    for (auto &garbage : slot.garbage_pages_) {
+      Page *current_page = garbage.second;
+      while (current_page != nullptr) {
+        memory_footprint += GetPageSize(current_page);
+        current_page = current_page->GetDeltaNext();
       }
     }
+    slot.garbage_lock_.Unlock();
   }
-  cleanup_lock.Unlock();
 
   DeregisterWorker(worker_epoch);
   LOG_DEBUG("Finished GetMemoryFootprint");
   return memory_footprint;
 }
 
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          bool _Duplicates,
+          class ValueEqualityChecker>
+void BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates,
+            ValueEqualityChecker>::GetStatistics(IndexStatistics& statistics) {
+  statistics.SetCounter("inserts", insert_count_.Get());
+  statistics.SetCounter("deletes", delete_count_.Get());
+  statistics.SetCounter("lookups", lookup_count_.Get());
+  statistics.SetCounter("cas_failures", cas_failure_count_.Get());
+  statistics.SetCounter("restarts", restart_count_.Get());
+  statistics.SetCounter("consolidations", consolidation_count_);
+  statistics.SetCounter("splits", split_count_);
+  statistics.SetCounter("merges", merge_count_);
+  statistics.SetCounter("maintenance_hints", posted_hint_count_.Get());
+  statistics.SetCounter("maintenance_hints_dropped",
+                        dropped_hint_count_.Get());
+  statistics.SetHistogram("modify_chain_length", chain_length_.Get());
+
+  uint64_t worker_epoch = RegisterWorker();
+
+  // Chains as they are now, one value per node, and the separators of the
+  // inner nodes against what they would take as whole keys
+  StatisticsHistogram node_chain_length;
+  size_t separator_bytes = 0;
+  size_t separator_bytes_saved = 0;
+  PID num_pids = PID_counter_;
+  for (PID i = 0; i < num_pids; ++i) {
+    if (!map_table_.IsReserved(i)) continue;
+    Page *current_page = map_table_[i];
+    if (current_page == nullptr) continue;
+    node_chain_length.Add(current_page->GetDepth());
+    for (; current_page != nullptr;
+         current_page = current_page->GetDeltaNext()) {
+      if (current_page->GetType() != INNER_NODE) continue;
+      InnerNode* inner_node = reinterpret_cast<InnerNode*>(current_page);
+      size_t full_size = inner_node->GetSize() * sizeof(KeyType);
+      separator_bytes += inner_node->GetSeparatorSize();
+      if (full_size > inner_node->GetSeparatorSize())
+        separator_bytes_saved += full_size - inner_node->GetSeparatorSize();
+    }
+  }
+  statistics.SetHistogram("node_chain_length", node_chain_length);
+  statistics.SetCounter("nodes", node_chain_length.GetCount());
+  statistics.SetCounter("separator_bytes", separator_bytes);
+  statistics.SetCounter("separator_bytes_saved", separator_bytes_saved);
+
+  // How many epochs the oldest registered thread holds back reclamation
+  uint64_t epoch = epoch_;
+  uint64_t safe_epoch = GetSafeEpoch();
+  statistics.SetCounter("epoch_lag", epoch - std::min(epoch, safe_epoch));
+
+  size_t garbage_pages = 0;
+  size_t garbage_PIDs = 0;
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    EpochSlot &slot = epoch_slots_[i];
+    slot.garbage_lock_.Lock();
+    garbage_pages += slot.garbage_pages_.size();
+    garbage_PIDs += slot.garbage_PIDs_.size();
+    slot.garbage_lock_.Unlock();
+  }
+  statistics.SetCounter("garbage_pages", garbage_pages);
+  statistics.SetCounter("garbage_pids", garbage_PIDs);
+
+  // PIDs handed out so far, and those of merged nodes waiting for reuse
+  statistics.SetCounter("pids", num_pids);
+  free_PIDs_lock_.Lock();
+  statistics.SetCounter("free_pids", free_PIDs_.size());
+  free_PIDs_lock_.Unlock();
+
+  DeregisterWorker(worker_epoch);
+}
+
 template <typename KeyType, typename ValueType, class KeyComparator,
           class KeyEqualityChecker,
           bool _Duplicates,
@@ -2050,7 +3254,7 @@ size_t BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates
   switch (page->GetType()) {
     case INNER_NODE: {
       InnerNode* inner_node = reinterpret_cast<InnerNode*>(page);
-      page_size = sizeof(*inner_node);
+      page_size = sizeof(*inner_node) + inner_node->GetHeapSize();
       break;
     }
     case INDEX_TERM_DELTA: {
@@ -2075,7 +3279,7 @@ size_t BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, _Duplicates
     }
     case LEAF_NODE: {
       LeafNode* leaf = reinterpret_cast<LeafNode*>(page);
-      page_size = sizeof(*leaf);
+      page_size = sizeof(*leaf) + leaf->GetHeapSize();
       break;
     }
     case MODIFY_DELTA: {
@@ -2129,5 +3333,43 @@ template class BWTree<GenericKey<512>, ItemPointer, GenericComparator<512>,
 template class BWTree<TupleKey, ItemPointer, TupleKeyComparator,
                       TupleKeyEqualityChecker>;
 
+// Unique key trees
+template class BWTree<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                      IntsEqualityChecker<1>, false>;
+template class BWTree<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                      IntsEqualityChecker<2>, false>;
+template class BWTree<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                      IntsEqualityChecker<3>, false>;
+template class BWTree<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                      IntsEqualityChecker<4>, false>;
+
+template class BWTree<GenericKey<4>, ItemPointer, GenericComparator<4>,
+                      GenericEqualityChecker<4>, false>;
+template class BWTree<GenericKey<8>, ItemPointer, GenericComparator<8>,
+                      GenericEqualityChecker<8>, false>;
+template class BWTree<GenericKey<12>, ItemPointer, GenericComparator<12>,
+                      GenericEqualityChecker<12>, false>;
+template class BWTree<GenericKey<16>, ItemPointer, GenericComparator<16>,
+                      GenericEqualityChecker<16>, false>;
+template class BWTree<GenericKey<24>, ItemPointer, GenericComparator<24>,
+                      GenericEqualityChecker<24>, false>;
+template class BWTree<GenericKey<32>, ItemPointer, GenericComparator<32>,
+                      GenericEqualityChecker<32>, false>;
+template class BWTree<GenericKey<48>, ItemPointer, GenericComparator<48>,
+                      GenericEqualityChecker<48>, false>;
+template class BWTree<GenericKey<64>, ItemPointer, GenericComparator<64>,
+                      GenericEqualityChecker<64>, false>;
+template class BWTree<GenericKey<96>, ItemPointer, GenericComparator<96>,
+                      GenericEqualityChecker<96>, false>;
+template class BWTree<GenericKey<128>, ItemPointer, GenericComparator<128>,
+                      GenericEqualityChecker<128>, false>;
+template class BWTree<GenericKey<256>, ItemPointer, GenericComparator<256>,
+                      GenericEqualityChecker<256>, false>;
+template class BWTree<GenericKey<512>, ItemPointer, GenericComparator<512>,
+                      GenericEqualityChecker<512>, false>;
+
+template class BWTree<TupleKey, ItemPointer, TupleKeyComparator,
+                      TupleKeyEqualityChecker, false>;
+
 }  // End index namespace
 }  // End peloton namespace
@@ -12,7 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -22,19 +26,98 @@
 #include <atomic>
 
 #include "backend/common/types.h"
+#include "backend/common/exception.h"
 #include "backend/common/logger.h"
 #include "backend/common/platform.h"
 #include "backend/index/index_key.h"
-
-#define CONSOLIDATE_THRESHOLD 8
-#define SPLIT_SIZE 10
-#define MERGE_SIZE 4
-#define EPOCH_INTERVAL_MS 40  // in milliseconds
+#include "backend/index/index_statistics.h"
+
+#define CONSOLIDATE_THRESHOLD 8  // default, max delta chain length
+#define SPLIT_SIZE 10  // default, max entries of a node
+#define MERGE_SIZE 4  // default, min entries of a node
+#define MAINTENANCE_QUEUE_SIZE 4096  // max # of pending maintenance hints
+#define MAINTENANCE_MAX_ATTEMPTS 4  // lost races before a hint is given up
+#define MAINTENANCE_BACKSTOP_FACTOR 4  // chains this many times longer than
+                                       // the threshold are consolidated inline
+#define EPOCH_INTERVAL_MS 40  // default, in milliseconds
+#define EPOCH_MAX_THREADS 256  // max # of threads using BWTrees at once
+#define EPOCH_GC_BATCH_SIZE 64  // garbage a thread collects before reclaiming
 #define GC_ENABLED true
+#define MAPPING_TABLE_CHUNK_BITS 12         // 4096 PIDs per chunk
+#define MAPPING_TABLE_DIRECTORY_SIZE 16384  // max # of chunks
 
 namespace peloton {
 namespace index {
 
+// Hands out small ids to threads, used to index the per-thread epoch state
+// of a BWTree. An id is given back when its thread exits.
+class EpochThreadRegistry {
+ public:
+  // Id of the calling thread, always < EPOCH_MAX_THREADS
+  static size_t GetThreadId();
+
+  // Upper bound on all ids handed out so far
+  static size_t GetMaxThreadId();
+};
+
+// How the inner nodes of a BWTree store their separators. A separator is
+// kept up to its last significant byte, and the bytes after it are filled
+// in by Clear() when it is read back. Keys are taken as they are by
+// default, all of their bytes counting.
+template <typename KeyType, class KeyComparator>
+class SeparatorCodec {
+ public:
+  SeparatorCodec(const KeyComparator&) {}
+
+  // A separator between two neighbouring keys, >= lhs and < rhs
+  inline KeyType GetSeparator(const KeyType& lhs, const KeyType&) const {
+    return lhs;
+  }
+
+  inline size_t GetSignificantLength(const KeyType&) const {
+    return sizeof(KeyType);
+  }
+
+  inline void Clear(KeyType&) const {}
+};
+
+// GenericKeys only use the first bytes of their data, and the NULL columns
+// at the end of a separator are not stored. Separators end right after the
+// first column in which the two neighbouring keys differ.
+template <std::size_t KeySize>
+class SeparatorCodec<GenericKey<KeySize>, GenericComparator<KeySize>> {
+ public:
+  SeparatorCodec(const GenericComparator<KeySize>& comparator)
+      : layout_(comparator.layout) {}
+
+  // The upper key cut after the column that tells it from the lower one,
+  // with the remaining columns NULL. That sorts below the upper key unless
+  // its remaining columns are NULL already, in which case the lower key is
+  // used.
+  inline GenericKey<KeySize> GetSeparator(
+      const GenericKey<KeySize>& lhs, const GenericKey<KeySize>& rhs) const {
+    size_t column_itr = layout_->GetFirstDifference(lhs.data, rhs.data);
+    if (column_itr + 1 >= layout_->GetColumnCount()) return lhs;
+
+    GenericKey<KeySize> separator;
+    Clear(separator);
+    ::memcpy(separator.data, rhs.data, layout_->GetColumnEnd(column_itr));
+    if (layout_->Compare(separator.data, rhs.data) < 0) return separator;
+    return lhs;
+  }
+
+  inline size_t GetSignificantLength(const GenericKey<KeySize>& key) const {
+    return layout_->GetSignificantLength(key.data);
+  }
+
+  inline void Clear(GenericKey<KeySize>& key) const {
+    ::memcpy(key.data, layout_->GetNullKey(), layout_->GetLength());
+  }
+
+ private:
+  std::shared_ptr<const GenericKeyLayout> layout_;
+};
+
 struct ItemPointerEqualityChecker {
   bool operator()(const ItemPointer& l, const ItemPointer& r) const {
     if (l.block == r.block && l.offset == r.offset) return true;
@@ -50,6 +133,7 @@ template <typename KeyType, typename ValueType, class KeyComparator,
 class BWTree {
   using PID = std::uint64_t;
   static constexpr PID NullPID = std::numeric_limits<PID>::max();
+  using Codec = SeparatorCodec<KeyType, KeyComparator>;
 
  public:
   BWTree(const KeyComparator& comparator, const KeyEqualityChecker& equals);
@@ -58,19 +142,93 @@ class BWTree {
   // Insert function
   bool Insert(const KeyType& key, const ValueType& data);
 
+  // Inserts data unless the key already has a value for which predicate
+  // returns true. The check and the insert are done in a single traversal,
+  // with the delta installed by the same CAS. Values that fail predicate do
+  // not count, so this also adds versions of a key in a unique tree.
+  bool ConditionalInsert(const KeyType& key, const ValueType& data,
+                         std::function<bool(const ValueType&)> predicate);
+
   // Delete function
   bool Delete(const KeyType& key, const ValueType& data);
 
+  // Builds the tree bottom-up out of key/value pairs, which do not have to
+  // be sorted. Leaves and inner nodes are packed and installed into the
+  // mapping table directly. The tree has to be empty, and no other thread
+  // may use it until the load is done. Returns false, leaving the tree
+  // empty, if duplicates are not allowed and a key comes more than once.
+  bool BulkLoad(std::vector<std::pair<KeyType, ValueType>>& items);
+
   // Search functions
   std::vector<ValueType> SearchKey(const KeyType& key);
+
+  // Looks up a batch of keys, which have to be sorted, with one epoch
+  // registration. Each probe starts from the deepest page on the path of the
+  // previous one that still covers its key instead of from the root.
+  std::vector<std::vector<ValueType>> SearchKeys(
+      const std::vector<KeyType>& keys);
   std::map<KeyType, std::vector<ValueType>, KeyComparator> SearchAllKeys();
 
+  // Range scan iterator over the leaf chain
+  class Iterator;
+
+  // Positions at the smallest key
+  Iterator Begin();
+
+  // Positions at the first key >= the given key
+  Iterator Begin(const KeyType& key);
+
+  // Positions at the largest key
+  Iterator RBegin();
+
+  // Positions at the last key <= the given key
+  Iterator RBegin(const KeyType& key);
+
   // Forces GC
   bool Cleanup();
 
+  // How often the epoch manager moves to the next epoch
+  void SetEpochInterval(uint64_t interval_ms);
+  inline uint64_t GetEpochInterval() const { return epoch_interval_ms_; }
+
+  // Structure modification thresholds. A delta chain longer than the
+  // consolidation threshold gets consolidated, and a node with more than
+  // split size entries is split. Nodes with less than merge size entries are
+  // merged into their left sibling, so it has to be at most half the split
+  // size.
+  void SetConsolidateThreshold(size_t threshold);
+  void SetSplitSize(size_t split_size);
+  void SetMergeSize(size_t merge_size);
+  inline size_t GetConsolidateThreshold() const {
+    return consolidate_threshold_;
+  }
+  inline size_t GetSplitSize() const { return split_size_; }
+  inline size_t GetMergeSize() const { return merge_size_; }
+
+  // With background maintenance, Insert and Delete only post the key of a
+  // node whose delta chain got too long. A maintenance thread consolidates,
+  // splits and merges it off the critical path.
+  void SetBackgroundMaintenance(bool enabled);
+  inline bool IsBackgroundMaintenance() const {
+    return background_maintenance_;
+  }
+
+  // Blocks until the maintenance thread has handled all posted hints
+  void WaitForMaintenance();
+
   // Calculates the bytes of heap memory used
   size_t GetMemoryFootprint();
 
+  // Structure modifications installed so far
+  inline uint64_t GetConsolidationCount() const { return consolidation_count_; }
+  inline uint64_t GetSplitCount() const { return split_count_; }
+  inline uint64_t GetMergeCount() const { return merge_count_; }
+
+  // Adds the operation and CAS failure counts, the delta chain lengths seen
+  // by modifications and, from a walk over the mapping table, the current
+  // chain lengths, epoch lag, garbage backlog and free PIDs
+  void GetStatistics(IndexStatistics& statistics);
+
  private:
   // ***** Different types of page records
 
@@ -87,35 +245,60 @@ class BWTree {
     NODE_MERGE_DELTA
   };
 
+  class LeafNode;
+
   class Page {
    protected:
     PageType type_;
     Page* delta_next_;
 
+    // Length of the delta chain from this page down to the base page. A
+    // NODE_MERGE_DELTA counts twice since the merged node's chain hangs off
+    // it as well.
+    uint32_t depth_;
+
+    // Base page of a leaf chain that has nothing but modify deltas on top of
+    // it, and so tells the key range of the chain. Null otherwise.
+    LeafNode* base_leaf_;
+
    public:
-    Page(PageType type) : type_(type) { delta_next_ = nullptr; }
+    // Set once the chain topped by this page was posted to the maintenance
+    // thread, so that threads passing by don't post it again
+    std::atomic_bool maintenance_posted_;
+
+    Page(PageType type)
+        : type_(type),
+          delta_next_(nullptr),
+          depth_(1),
+          base_leaf_(nullptr),
+          maintenance_posted_(false) {
+      if (type_ == LEAF_NODE) base_leaf_ = reinterpret_cast<LeafNode*>(this);
+    }
 
     virtual ~Page() { };
 
     const inline PageType& GetType() const { return type_; }
 
-    inline void SetDeltaNext(Page* next) { delta_next_ = next; }
+    inline void SetDeltaNext(Page* next) {
+      delta_next_ = next;
+      depth_ = next->depth_ + (type_ == NODE_MERGE_DELTA ? 2 : 1);
+      base_leaf_ = (type_ == MODIFY_DELTA) ? next->base_leaf_ : nullptr;
+    }
 
     inline Page* GetDeltaNext() { return delta_next_; }
 
+    inline uint32_t GetDepth() const { return depth_; }
+
+    inline LeafNode* GetBaseLeaf() const { return base_leaf_; }
   };
 
   // A key belongs to an InnerNode if at least one of the following exists:
   // (1) absolute_min_ == true && absolute_max_ == true
-  // (2) absolute_min_ == true && key <= children_.rbegin()->first
-  // (3) absolute_max == true && key > children_.begin()->first
-  // (4) children_.begin()->first < key <= children_.begin()->first
+  // (2) absolute_min_ == true && key <= the last separator
+  // (3) absolute_max == true && key > the first separator
+  // (4) the first separator < key <= the last separator
   class InnerNode : public Page {
    public:
-    // Separator keys and links for the children
-    // The key in the pair is the high_key_ of the child.
-    std::vector<std::pair<KeyType, PID>> children_;
-
     // Node link used during structure modifications
     PID side_link_;
 
@@ -135,14 +318,142 @@ class BWTree {
         : Page(INNER_NODE),
           side_link_(NullPID),
           absolute_min_(false),
-          absolute_max_(false) {}
+          absolute_max_(false),
+          prefix_length_(0),
+          suffix_length_(0) {}
+
+    inline size_t GetSize() const { return child_PIDs_.size(); }
+
+    inline PID GetChildPID(size_t child_idx) const {
+      return child_PIDs_[child_idx];
+    }
+
+    // The separator of a child is its high key
+    inline KeyType GetSeparator(size_t child_idx, const Codec& codec) const {
+      KeyType separator;
+      codec.Clear(separator);
+      char* data = reinterpret_cast<char*>(&separator);
+      size_t begin, end;
+      if (separator_ends_.empty()) {
+        begin = prefix_length_ + child_idx * suffix_length_;
+        end = begin + suffix_length_;
+      } else {
+        begin = (child_idx == 0) ? prefix_length_
+                                 : separator_ends_[child_idx - 1];
+        end = separator_ends_[child_idx];
+      }
+      ::memcpy(data, separator_bytes_.data(), prefix_length_);
+      ::memcpy(data + prefix_length_, separator_bytes_.data() + begin,
+               end - begin);
+      return separator;
+    }
+
+    inline std::pair<KeyType, PID> GetChild(size_t child_idx,
+                                            const Codec& codec) const {
+      return std::make_pair(GetSeparator(child_idx, codec),
+                            child_PIDs_[child_idx]);
+    }
+
+    // Appends all children to the given vector
+    inline void GetChildren(std::vector<std::pair<KeyType, PID>>& children,
+                            const Codec& codec) const {
+      for (size_t child_idx = 0; child_idx < GetSize(); child_idx++)
+        children.push_back(GetChild(child_idx, codec));
+    }
+
+    // Index of the first child whose separator is >= key, GetSize() if the
+    // key is above all of them
+    inline size_t FindChild(const KeyType& key, const Codec& codec,
+                            const KeyComparator& comparator) const {
+      size_t low = 0, high = GetSize();
+      while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (comparator(GetSeparator(mid, codec), key))
+          low = mid + 1;
+        else
+          high = mid;
+      }
+      return low;
+    }
+
+    // Replaces the children, which have to be sorted by separator. The
+    // bytes all separators start with are stored once, and the rest of each
+    // separator up to its last significant byte. Where the separators are
+    // kept is only recorded if they are not all of the same length.
+    inline void SetChildren(
+        const std::vector<std::pair<KeyType, PID>>& children,
+        const Codec& codec) {
+      child_PIDs_.clear();
+      separator_bytes_.clear();
+      separator_ends_.clear();
+      prefix_length_ = 0;
+      suffix_length_ = 0;
+
+      std::vector<size_t> lengths;
+      for (auto& child : children)
+        lengths.push_back(codec.GetSignificantLength(child.first));
+
+      if (!children.empty()) {
+        const char* first =
+            reinterpret_cast<const char*>(&children.front().first);
+        prefix_length_ = *std::min_element(lengths.begin(), lengths.end());
+        for (auto& child : children) {
+          const char* data = reinterpret_cast<const char*>(&child.first);
+          prefix_length_ =
+              std::mismatch(first, first + prefix_length_, data).first -
+              first;
+        }
+        separator_bytes_.assign(first, first + prefix_length_);
+        suffix_length_ = lengths.front() - prefix_length_;
+      }
+
+      bool same_length = std::all_of(
+          lengths.begin(), lengths.end(),
+          [&lengths](size_t length) { return length == lengths.front(); });
+      child_PIDs_.reserve(children.size());
+      for (size_t child_idx = 0; child_idx < children.size(); child_idx++) {
+        const char* data =
+            reinterpret_cast<const char*>(&children[child_idx].first);
+        separator_bytes_.insert(separator_bytes_.end(), data + prefix_length_,
+                                data + lengths[child_idx]);
+        if (!same_length) separator_ends_.push_back(separator_bytes_.size());
+        child_PIDs_.push_back(children[child_idx].second);
+      }
+      separator_bytes_.shrink_to_fit();
+      separator_ends_.shrink_to_fit();
+    }
+
+    // Bytes taken by the separators
+    inline size_t GetSeparatorSize() const {
+      return separator_bytes_.size() +
+             separator_ends_.size() * sizeof(uint32_t);
+    }
+
+    // Memory used by the children outside of the node itself
+    inline size_t GetHeapSize() const {
+      return child_PIDs_.capacity() * sizeof(PID) +
+             separator_bytes_.capacity() +
+             separator_ends_.capacity() * sizeof(uint32_t);
+    }
+
+   private:
+    // Links to the children
+    std::vector<PID> child_PIDs_;
+
+    // The prefix shared by all separators, followed by the rest of each
+    // separator. Separator i ends at separator_ends_[i], or takes up
+    // suffix_length_ bytes if they all have the same length.
+    std::vector<char> separator_bytes_;
+    std::vector<uint32_t> separator_ends_;
+    size_t prefix_length_;
+    size_t suffix_length_;
   };
 
   // A key belongs to an LeafNode if at least one of the following exists:
   // (1) absolute_min_ == true && absolute_max_ == true
-  // (2) absolute_min_ == true && key <= data_items.rbegin()->first
-  // (3) absolute_max == true && key > data_items_.begin()->first
-  // (4) data_items_.begin()->first < key <= data_items_.rbegin()->first
+  // (2) absolute_min_ == true && key <= keys_.back()
+  // (3) absolute_max == true && key > keys_.front()
+  // (4) keys_.front() < key <= keys_.back()
   class LeafNode : public Page {
    public:
     // PID of next child
@@ -151,8 +462,13 @@ class BWTree {
     // PID of previous child
     PID prev_leaf_;
 
-    // Keys and pointers to all data stored in this leaf
-    std::vector<std::pair<KeyType, std::vector<ValueType>>> data_items_;
+    // All keys stored in this leaf, in ascending order
+    std::vector<KeyType> keys_;
+
+    // The values of keys_[i] are values_[value_offsets_[i]] up to (excluding)
+    // values_[value_offsets_[i + 1]]
+    std::vector<size_t> value_offsets_;
+    std::vector<ValueType> values_;
 
     // Temporary node link used during structure modifications
     PID side_link_;
@@ -173,9 +489,72 @@ class BWTree {
         : Page(LEAF_NODE),
           next_leaf_(NullPID),
           prev_leaf_(NullPID),
+          value_offsets_(1, 0),
           side_link_(NullPID),
           absolute_min_(false),
           absolute_max_(false) {}
+
+    inline size_t GetSize() const { return keys_.size(); }
+
+    inline typename std::vector<ValueType>::const_iterator ValuesBegin(
+        size_t idx) const {
+      return values_.begin() + value_offsets_[idx];
+    }
+
+    inline typename std::vector<ValueType>::const_iterator ValuesEnd(
+        size_t idx) const {
+      return values_.begin() + value_offsets_[idx + 1];
+    }
+
+    inline std::vector<ValueType> GetValues(size_t idx) const {
+      return std::vector<ValueType>(ValuesBegin(idx), ValuesEnd(idx));
+    }
+
+    // Index of the first key that is not less than key
+    inline size_t LowerBound(const KeyType& key,
+                             const KeyComparator& comparator) const {
+      return std::lower_bound(keys_.begin(), keys_.end(), key, comparator) -
+             keys_.begin();
+    }
+
+    // Index of the first key that is greater than key
+    inline size_t UpperBound(const KeyType& key,
+                             const KeyComparator& comparator) const {
+      return std::upper_bound(keys_.begin(), keys_.end(), key, comparator) -
+             keys_.begin();
+    }
+
+    // Index of key, or GetSize() if the leaf does not hold it
+    inline size_t Find(const KeyType& key, const KeyComparator& comparator,
+                       const KeyEqualityChecker& equals) const {
+      size_t idx = LowerBound(key, comparator);
+      if (idx < keys_.size() && equals(keys_[idx], key)) return idx;
+      return keys_.size();
+    }
+
+    // Adds key after all keys already in the leaf. Keys without any value
+    // are dropped.
+    template <typename InputIterator>
+    inline void Append(const KeyType& key, InputIterator first,
+                       InputIterator last) {
+      if (first == last) return;
+      keys_.push_back(key);
+      values_.insert(values_.end(), first, last);
+      value_offsets_.push_back(values_.size());
+    }
+
+    inline void Reserve(size_t key_count, size_t value_count) {
+      keys_.reserve(key_count);
+      value_offsets_.reserve(key_count + 1);
+      values_.reserve(value_count);
+    }
+
+    // Heap memory held by the arrays
+    inline size_t GetHeapSize() const {
+      return keys_.capacity() * sizeof(KeyType) +
+             value_offsets_.capacity() * sizeof(size_t) +
+             values_.capacity() * sizeof(ValueType);
+    }
   };
 
   class SplitDelta : public Page {
@@ -210,12 +589,17 @@ class BWTree {
 
     PID side_link_;
 
+    // Set when posted by a merge: the child that was merged into side_link_,
+    // whose entry goes away once the parent is consolidated
+    PID merged_PID_;
+
     IndexTermDelta(KeyType low_separator_key, KeyType high_separator_key,
                    PID new_sibling)
         : Page(INDEX_TERM_DELTA),
           low_separator_(low_separator_key),
           high_separator_(high_separator_key),
-          side_link_(new_sibling) {
+          side_link_(new_sibling),
+          merged_PID_(NullPID) {
       absolute_min_ = false;
       absolute_max_ = false;
     }
@@ -225,8 +609,13 @@ class BWTree {
   class RemoveNodeDelta : public Page {
    public:
     PID merged_into_;
+
+    // Set once the merge has been completed and folded into merged_into_,
+    // after which visitors simply move on to merged_into_
+    std::atomic<bool> retired_;
+
     RemoveNodeDelta(PID merged_into)
-        : Page(REMOVE_NODE_DELTA), merged_into_(merged_into) {}
+        : Page(REMOVE_NODE_DELTA), merged_into_(merged_into), retired_(false) {}
   };
 
   class NodeMergeDelta : public Page {
@@ -253,12 +642,89 @@ class BWTree {
         : Page(MODIFY_DELTA), key_(key), locations_(location) {}
   };
 
+  // Maps PIDs to the head of their delta chain. The slots live in fixed-size
+  // chunks that are only allocated once a PID in them is handed out, and a
+  // fixed directory points to the chunks. Chunks are published with a CAS and
+  // never move, so readers go through two loads without taking any lock.
+  class MappingTable {
+   public:
+    static constexpr PID CHUNK_SIZE = 1UL << MAPPING_TABLE_CHUNK_BITS;
+    static constexpr PID CHUNK_MASK = CHUNK_SIZE - 1;
+
+    MappingTable() {
+      for (PID i = 0; i < MAPPING_TABLE_DIRECTORY_SIZE; ++i) {
+        directory_[i] = nullptr;
+      }
+    }
+
+    ~MappingTable() {
+      for (PID i = 0; i < MAPPING_TABLE_DIRECTORY_SIZE; ++i) {
+        delete[] directory_[i].load();
+      }
+    }
+
+    // The slot must have been reserved before
+    inline std::atomic<Page*>& operator[](PID pid) {
+      return directory_[pid >> MAPPING_TABLE_CHUNK_BITS].load()
+          [pid & CHUNK_MASK];
+    }
+
+    inline bool IsReserved(PID pid) const {
+      return (pid >> MAPPING_TABLE_CHUNK_BITS) < MAPPING_TABLE_DIRECTORY_SIZE &&
+             directory_[pid >> MAPPING_TABLE_CHUNK_BITS].load() != nullptr;
+    }
+
+    // Makes sure that the chunk holding pid is allocated
+    inline void Reserve(PID pid) {
+      PID chunk_id = pid >> MAPPING_TABLE_CHUNK_BITS;
+      if (chunk_id >= MAPPING_TABLE_DIRECTORY_SIZE) {
+        throw IndexException("Not enough space in mapping table");
+      }
+      if (directory_[chunk_id].load() != nullptr) return;
+
+      std::atomic<Page*>* chunk = new std::atomic<Page*>[CHUNK_SIZE];
+      for (PID i = 0; i < CHUNK_SIZE; ++i) {
+        chunk[i] = nullptr;
+      }
+
+      // Someone else might have allocated it in the meantime
+      std::atomic<Page*>* expected = nullptr;
+      if (!directory_[chunk_id].compare_exchange_strong(expected, chunk)) {
+        delete[] chunk;
+      } else {
+        ++chunk_count_;
+      }
+    }
+
+    // Memory used by the table itself
+    inline size_t GetMemoryFootprint() const {
+      return sizeof(directory_) +
+             chunk_count_ * CHUNK_SIZE * sizeof(std::atomic<Page*>);
+    }
+
+   private:
+    std::atomic<std::atomic<Page*>*> directory_[MAPPING_TABLE_DIRECTORY_SIZE];
+
+    std::atomic<size_t> chunk_count_{0};
+  };
+
   // ***** Functions for internal usage
 
-  // Performs a node split
+  // Collapses the index term deltas on an inner node into a new base node,
+  // and splits it if it has grown too large
+  void ConsolidateInnerNode(PID pid, Page* head_of_delta,
+                            std::stack<PID>& pages_visited);
+
+  // Performs a node split. Returns false if the node was small enough to
+  // be left alone, so the caller can check for a merge instead.
   bool Split_Operation(Page* consolidated_page, std::stack<PID>& pages_visited,
                        PID orig_pid);
 
+  // Splits a consolidated root node in two. The halves get new PIDs and a
+  // new root with two children replaces the old one in place.
+  void SplitRoot(InnerNode* old_root, InnerNode* new_inner_node,
+                 PID new_node_PID, size_t key_split_index);
+
   // Completes the 2nd half of the split
   bool complete_the_split(PID side_link, std::stack<PID>& pages_visited);
 
@@ -266,11 +732,14 @@ class BWTree {
   void Merge_Operation(Page* consolidated_page, std::stack<PID>& pages_visited,
                        PID orig_pid);
 
-  // Helper function to find the left sibling of a particular node
-  PID find_left_sibling(std::stack<PID>& pages_visited, KeyType merge_key);
+  // Helper function to find the left sibling of the node merge_PID, which
+  // covers (merge_key, high_key]. Returns the root PID unless both are
+  // children of the parent on top of pages_visited, next to each other.
+  PID find_left_sibling(std::stack<PID>& pages_visited, KeyType merge_key,
+                        KeyType high_key, bool absolute_max, PID merge_PID);
 
   // Completes the latter part of the merge
-  bool complete_the_merge(RemoveNodeDelta* remove_node,
+  bool complete_the_merge(PID removed_PID, RemoveNodeDelta* remove_node,
                           std::stack<PID>& pages_visited);
 
   // Checks if merge is already installed
@@ -279,36 +748,236 @@ class BWTree {
 
   // Installs a new page into the map table
   inline PID InstallNewMapping(Page* new_page) {
-    PID new_slot = PID_counter_++;
+    PID new_slot = NullPID;
+
+    // Hand out PIDs of nodes removed by merges first
+    free_PIDs_lock_.Lock();
+    if (!free_PIDs_.empty()) {
+      new_slot = free_PIDs_.back();
+      free_PIDs_.pop_back();
+    }
+    free_PIDs_lock_.Unlock();
 
-    if (PID_counter_ >= map_table_.size()) {
-      LOG_ERROR("FATAL: Not enough space in mapping table!");
-      return NullPID;
+    if (new_slot == NullPID) {
+      new_slot = PID_counter_++;
+      map_table_.Reserve(new_slot);
     }
 
     map_table_[new_slot] = new_page;
     return new_slot;
   }
 
+  // Gives the PID of a node that was merged away back once no thread can
+  // still be on its way to it. Its remove delta and base page are freed at
+  // the same time.
+  void RetirePID(PID pid);
+
+  // Whether data can be added to a key that has the values [first, last)
+  template <typename InputIterator>
+  inline bool CanInsert(
+      InputIterator first, InputIterator last,
+      const std::function<bool(const ValueType&)>& predicate) const {
+    if (!predicate) return allow_duplicate_ || first == last;
+    for (; first != last; ++first) {
+      if (predicate(*first)) return false;
+    }
+    return true;
+  }
+
   // Check whether we need to consolidate this delta chain
   inline bool CheckConsolidate(PID page_PID) {
-    Page* current_page = map_table_[page_PID];
-    int page_length = 0;
-
-    // Traverse the delta chain to get length. We count NODE_MERGE_DELTA as 2
-    // length because we don't know the length of it. But if the merged node
-    // consolidated successfully before merging, then it should have only one
-    // extra length.
-    while (current_page != nullptr) {
-      if (current_page->GetType() == NODE_MERGE_DELTA) page_length++;
-      page_length++;
-      current_page = current_page->GetDeltaNext();
-    }
-
-    if (page_length > CONSOLIDATE_THRESHOLD)
-      return true;
-    else
-      return false;
+    return map_table_[page_PID].load()->GetDepth() > consolidate_threshold_;
+  }
+
+  // Whether a foreground thread that found the delta chain topped by
+  // head_of_delta too long should leave the consolidation to the maintenance
+  // thread. The key is posted when the chain crosses the threshold and again
+  // every threshold deltas after, in case the hint was dropped. Chains that
+  // still grow past the backstop are consolidated inline.
+  inline bool DeferConsolidate(Page* head_of_delta, const KeyType& key) {
+    if (!background_maintenance_) return false;
+
+    size_t depth = head_of_delta->GetDepth();
+    size_t threshold = consolidate_threshold_;
+    if (depth > threshold * MAINTENANCE_BACKSTOP_FACTOR) return false;
+    if ((depth - 1) % threshold == 0 &&
+        !head_of_delta->maintenance_posted_.exchange(true)) {
+      PostMaintenanceHint(key);
+    }
+    return true;
+  }
+
+  // Consolidates the leaf chain topped by head_of_delta and splits or merges
+  // the new base page if it is too full or too empty. Returns false if
+  // another thread changed the chain first.
+  bool ConsolidateLeafNode(PID pid, Page* head_of_delta,
+                           std::stack<PID>& pages_visited);
+
+  // Queues the key of a node for the maintenance thread, dropped if the
+  // queue is full
+  void PostMaintenanceHint(const KeyType& key);
+
+  // Descends to the leaf that owns key, consolidating the inner nodes on the
+  // way that need it, and brings the leaf back in shape
+  void MaintainKey(const KeyType& key);
+
+  // Descends from the root to the leaf that owns key and remembers the inner
+  // nodes on the way. Unfinished splits and merges are completed. Returns
+  // NullPID if that failed and the descent has to be retried.
+  PID FindLeafPath(const KeyType& key, std::stack<PID>& pages_visited);
+
+  // Maintenance thread logic
+  void RunMaintenance();
+
+  // Builds a new leaf out of base leaves (in key order, along with how many
+  // of their items to take) and the modify deltas on top of them (newest
+  // first). The deltas are sorted, and then merged with the base items in a
+  // single pass where the newest delta of a key wins. modify_deltas is left
+  // sorted by key.
+  inline LeafNode* MergeLeafItems(
+      std::vector<ModifyDelta*>& modify_deltas,
+      const std::vector<std::pair<LeafNode*, size_t>>& base_leaves) {
+    std::stable_sort(modify_deltas.begin(), modify_deltas.end(),
+                     [this](const ModifyDelta* lhs, const ModifyDelta* rhs) {
+      return comparator_(lhs->key_, rhs->key_);
+    });
+
+    size_t key_count = modify_deltas.size();
+    size_t value_count = 0;
+    for (auto delta : modify_deltas) value_count += delta->locations_.size();
+    for (const auto& base : base_leaves) {
+      key_count += base.second;
+      value_count += base.first->value_offsets_[base.second];
+    }
+
+    LeafNode* new_leaf = new LeafNode();
+    new_leaf->Reserve(key_count, value_count);
+
+    size_t delta_itr = 0;
+    auto append_delta = [&]() {
+      ModifyDelta* delta = modify_deltas[delta_itr];
+      new_leaf->Append(delta->key_, delta->locations_.begin(),
+                       delta->locations_.end());
+      // Skip older deltas of the same key
+      while (++delta_itr < modify_deltas.size() &&
+             equals_(modify_deltas[delta_itr]->key_, delta->key_)) {
+      }
+    };
+
+    for (const auto& base : base_leaves) {
+      LeafNode* leaf = base.first;
+      for (size_t item_itr = 0; item_itr < base.second; ++item_itr) {
+        const KeyType& key = leaf->keys_[item_itr];
+        while (delta_itr < modify_deltas.size() &&
+               comparator_(modify_deltas[delta_itr]->key_, key)) {
+          append_delta();
+        }
+        if (delta_itr < modify_deltas.size() &&
+            equals_(modify_deltas[delta_itr]->key_, key)) {
+          append_delta();
+          continue;
+        }
+        new_leaf->Append(key, leaf->ValuesBegin(item_itr),
+                         leaf->ValuesEnd(item_itr));
+      }
+    }
+    while (delta_itr < modify_deltas.size()) append_delta();
+
+    return new_leaf;
+  }
+
+  // Builds a new inner node out of base inner nodes (in key order) and the
+  // index term deltas on top of them (newest first). A delta is posted when
+  // its side link split off the upper part of some child, so it takes over
+  // the rest of the child range that holds its low separator. Replaying the
+  // deltas oldest first this way also copes with parent updates that were
+  // posted out of order, or more than once. Deltas posted by merges drop the
+  // entry of the merged child instead. The children are left in the given
+  // vector for the caller to set.
+  inline InnerNode* MergeInnerItems(
+      const std::vector<IndexTermDelta*>& index_term_deltas,
+      const std::vector<InnerNode*>& base_inners, bool absolute_min,
+      bool absolute_max, std::vector<std::pair<KeyType, PID>>& children) {
+    InnerNode* new_inner = new InnerNode();
+    if (!base_inners.empty()) new_inner->low_key_ = base_inners[0]->low_key_;
+    for (auto base : base_inners) {
+      base->GetChildren(children, separator_codec_);
+    }
+    new_inner->absolute_min_ = absolute_min;
+    new_inner->absolute_max_ = absolute_max;
+
+    for (auto delta_itr = index_term_deltas.rbegin();
+         delta_itr != index_term_deltas.rend(); ++delta_itr) {
+      IndexTermDelta* idx_delta = *delta_itr;
+      const KeyType& low_separator = idx_delta->low_separator_;
+
+      if (idx_delta->merged_PID_ != NullPID) {
+        // The merged child hands its range to its left neighbour. Deltas
+        // posted again by threads completing the merge find nothing to do.
+        for (size_t child_idx = 1; child_idx < children.size(); child_idx++) {
+          if (children[child_idx].second == idx_delta->merged_PID_ &&
+              children[child_idx - 1].second == idx_delta->side_link_) {
+            children[child_idx].second = idx_delta->side_link_;
+            children.erase(children.begin() + child_idx - 1);
+            break;
+          }
+        }
+        continue;
+      }
+
+      // The child whose range holds the keys right above the separator
+      size_t child_idx = 0;
+      if (!idx_delta->absolute_min_) {
+        child_idx =
+            std::upper_bound(
+                children.begin(), children.end(), low_separator,
+                [this](const KeyType& key,
+                       const std::pair<KeyType, PID>& child) {
+                  return comparator_(key, child.first);
+                }) -
+            children.begin();
+        if (child_idx == children.size() && new_inner->absolute_max_ &&
+            !children.empty()) {
+          // The last child covers everything above its key, so it keeps
+          // the range up to the separator
+          children.back().first = low_separator;
+          children.push_back(std::make_pair(idx_delta->high_separator_,
+                                            idx_delta->side_link_));
+          continue;
+        }
+      }
+
+      if (child_idx == children.size()) {
+        // Beyond all children we know of
+        children.push_back(
+            std::make_pair(idx_delta->high_separator_, idx_delta->side_link_));
+        if (idx_delta->absolute_min_) new_inner->absolute_min_ = true;
+        if (idx_delta->absolute_max_) new_inner->absolute_max_ = true;
+        continue;
+      }
+
+      bool above_low_key;
+      if (idx_delta->absolute_min_) {
+        above_low_key = false;
+      } else if (child_idx == 0) {
+        above_low_key = new_inner->absolute_min_ ||
+                        comparator_(new_inner->low_key_, low_separator);
+      } else {
+        above_low_key =
+            comparator_(children[child_idx - 1].first, low_separator);
+      }
+
+      if (above_low_key) {
+        // The child keeps the range up to the separator
+        children.insert(
+            children.begin() + child_idx,
+            std::make_pair(low_separator, children[child_idx].second));
+        child_idx++;
+      }
+      children[child_idx].second = idx_delta->side_link_;
+    }
+
+    return new_inner;
   }
 
   // Consolidates a delta chain and returns a new base page
@@ -316,11 +985,15 @@ class BWTree {
     std::vector<ValueType> result;
     Page* current_page = map_table_[page_PID];
 
-    std::map<KeyType, PID, KeyComparator> key_pointers(comparator_);
-    std::map<KeyType, std::vector<ValueType>, KeyComparator> key_locations(
-        comparator_);
-    std::map<KeyType, std::pair<KeyType, PID>, KeyComparator> index_term_ranges(
-        comparator_);
+    // Leaf content: modify deltas from newest to oldest, and the base leaves
+    // with the number of their items that are still valid
+    std::vector<ModifyDelta*> modify_deltas;
+    std::vector<std::pair<LeafNode*, size_t>> base_leaves;
+
+    // Inner content: index term deltas from newest to oldest, and the base
+    // nodes in key order
+    std::vector<IndexTermDelta*> index_term_deltas;
+    std::vector<InnerNode*> base_inners;
 
     // Indicate whether we have met absolute min/max along consolidation
     bool absolute_min = false;
@@ -333,6 +1006,7 @@ class BWTree {
     PID side_link = -1;
 
     KeyType leaf_low_key;
+    KeyType leaf_high_key;
     PID next_leaf = -1;
     PID prev_leaf = -1;
 
@@ -344,36 +1018,7 @@ class BWTree {
       switch (current_page->GetType()) {
         case INNER_NODE: {
           InnerNode* inner_node = reinterpret_cast<InnerNode*>(current_page);
-
-          KeyType last_key = inner_node->low_key_;
-          bool first_child = true;
-          for (const auto& child : inner_node->children_) {
-            // Check whether a child is already contained in an index_term_delta
-            bool insert = true;
-            bool first_element = true;
-            for (auto& key_value : index_term_ranges) {
-              if (((first_element && absolute_min) ||
-                   (!(first_child && inner_node->absolute_min_) &&
-                    reverse_comparator_(key_value.first, last_key) <= 0)) &&
-                  reverse_comparator_(key_value.second.first, last_key) > 0) {
-                insert = false;
-                break;
-              }
-              first_element = false;
-            }
-
-            // Check whether the child has been split out
-            if (split_indicator &&
-                reverse_comparator_(split_separator, child.first) < 0)
-              insert = false;
-
-            if (insert) {
-              index_term_ranges.emplace(last_key, child);
-            }
-
-            last_key = child.first;
-            first_child = false;
-          }
+          base_inners.push_back(inner_node);
 
           is_leaf = false;
           if (inner_node->absolute_min_) absolute_min = true;
@@ -392,43 +1037,13 @@ class BWTree {
         case INDEX_TERM_DELTA: {
           IndexTermDelta* idx_delta =
               reinterpret_cast<IndexTermDelta*>(current_page);
-          LOG_DEBUG("Current page: %p", current_page);
-
           LOG_DEBUG("Consolidate INDEX_TERM_DELTA with low key: %s high key: %s",
                 idx_delta->low_separator_.GetTupleForComparison(key_tuple_schema).GetInfo().c_str(),
                 idx_delta->high_separator_.GetTupleForComparison(key_tuple_schema).GetInfo().c_str());
+          index_term_deltas.push_back(idx_delta);
 
-          bool first_element = true;
-          bool end_case = false;
-          for (auto& key_value : index_term_ranges) {
-            if ((((first_element && absolute_min) ||
-                  (!idx_delta->absolute_min_ &&
-                   reverse_comparator_(key_value.first,
-                                       idx_delta->low_separator_) <= 0))) &&
-                reverse_comparator_(key_value.second.first,
-                                    idx_delta->low_separator_) > 0) {
-              current_page = current_page->GetDeltaNext();
-              end_case = true;
-              break;
-            }
-
-            first_element = false;
-          }
-
-          if (end_case)
-            continue;
-
-
-
-          if (idx_delta->absolute_min_) absolute_min = true;
-          if (idx_delta->absolute_max_) absolute_max = true;
-
-          index_term_ranges.emplace(idx_delta->low_separator_,
-                                    std::make_pair(idx_delta->high_separator_,
-                                                   idx_delta->side_link_));
           // Keep traversing the delta chain.
           current_page = current_page->GetDeltaNext();
-          LOG_DEBUG("Next page: %p", current_page);
           continue;
         }
         case SPLIT_DELTA: {
@@ -467,15 +1082,11 @@ class BWTree {
         case LEAF_NODE: {
           LeafNode* leaf = reinterpret_cast<LeafNode*>(current_page);
 
-          // Traverse all data item in the leaf. If we already visited before,
-          // then skip.
-          std::vector<ValueType> data_items;
-          for (const auto& key_values : leaf->data_items_) {
-            if (split_indicator &&
-                reverse_comparator_(split_separator, key_values.first) < 0)
-              break;
-            key_locations.insert(key_values);
-          }
+          // Items above the split separator have moved to the new sibling
+          size_t item_count = leaf->GetSize();
+          if (split_indicator)
+            item_count = leaf->UpperBound(split_separator, comparator_);
+          base_leaves.push_back(std::make_pair(leaf, item_count));
 
           is_leaf = true;
           if (leaf->absolute_min_) absolute_min = true;
@@ -492,6 +1103,7 @@ class BWTree {
               prev_leaf = leaf->prev_leaf_;
             }
             next_leaf = leaf->next_leaf_;
+            leaf_high_key = leaf->high_key_;
 
             if (!split_indicator) side_link = leaf->side_link_;
             stop = true;
@@ -500,8 +1112,7 @@ class BWTree {
         }
         case MODIFY_DELTA: {
           ModifyDelta* mod_delta = reinterpret_cast<ModifyDelta*>(current_page);
-          key_locations.insert(
-              std::make_pair(mod_delta->key_, mod_delta->locations_));
+          modify_deltas.push_back(mod_delta);
 
           current_page = current_page->GetDeltaNext();
           continue;
@@ -512,11 +1123,22 @@ class BWTree {
     }
 
     if (is_leaf) {
-      LeafNode* new_leaf = new LeafNode();
+      LeafNode* new_leaf = MergeLeafItems(modify_deltas, base_leaves);
       new_leaf->low_key_ = leaf_low_key;
-      if (!key_locations.empty())
-        new_leaf->high_key_ = key_locations.rbegin()->first;
-      else {
+
+      // The high key bounds the range of the leaf, whatever is left in it,
+      // so that it keeps matching the separator in the parent after
+      // deletes. Only the rightmost leaf can hold keys above it.
+      new_leaf->high_key_ = split_indicator ? split_separator : leaf_high_key;
+      if (!split_indicator) {
+        if (new_leaf->GetSize() > 0 &&
+            comparator_(new_leaf->high_key_, new_leaf->keys_.back()))
+          new_leaf->high_key_ = new_leaf->keys_.back();
+        if (!modify_deltas.empty() &&
+            comparator_(new_leaf->high_key_, modify_deltas.back()->key_))
+          new_leaf->high_key_ = modify_deltas.back()->key_;
+      }
+      if (new_leaf->GetSize() == 0 && modify_deltas.empty()) {
         LOG_DEBUG("We meet an empty leaf node!");
       }
       new_leaf->absolute_min_ = absolute_min;
@@ -530,54 +1152,95 @@ class BWTree {
       new_leaf->prev_leaf_ = prev_leaf;
 
       new_leaf->side_link_ = side_link;
-
-      LOG_DEBUG("Consolidate leaf item:");
-      // KeyType old_key;
-      for (auto& key_location : key_locations) {
-        if (key_location.second.size())
-          new_leaf->data_items_.push_back(key_location);
-        // LOG_DEBUG("%d", comparator_(old_key, key_location.first));
-        // old_key = key_location.first;
-        LOG_DEBUG("one entry with size: %ld", key_location.second.size());
-      }
-      LOG_DEBUG("Consolidate leaf item end.");
       return new_leaf;
     } else {
-      InnerNode* new_inner = new InnerNode();
-      if (!index_term_ranges.empty()) {
-        new_inner->low_key_ = index_term_ranges.begin()->first;
-        new_inner->high_key_ = index_term_ranges.rbegin()->second.first;
+      std::vector<std::pair<KeyType, PID>> children;
+      InnerNode* new_inner = MergeInnerItems(
+          index_term_deltas, base_inners, absolute_min, absolute_max, children);
+      if (split_indicator) {
+        // Children above the split separator have moved to the new sibling
+        auto split_itr = std::lower_bound(
+            children.begin(), children.end(), split_separator,
+            [this](const std::pair<KeyType, PID>& child, const KeyType& key) {
+              return comparator_(child.first, key);
+            });
+        if (split_itr != children.end()) {
+          split_itr->first = split_separator;
+          children.erase(split_itr + 1, children.end());
+        }
+        new_inner->absolute_max_ = false;
+      }
+      if (!children.empty()) {
+        new_inner->high_key_ = children.back().first;
       } else {
         LOG_DEBUG("We meet an empty inner node!");
       }
-      new_inner->absolute_min_ = absolute_min;
-      if (!split_indicator) new_inner->absolute_max_ = absolute_max;
+      new_inner->SetChildren(children, separator_codec_);
 
       new_inner->side_link_ = side_link;
-
-      if (!index_term_ranges.empty()) {
-        LOG_DEBUG("Consolidate inner item:");
-        bool first_child = true;
-        PID last_PID = index_term_ranges.begin()->second.second;
-        for (auto& kv : index_term_ranges) {
-          if (first_child) {
-            first_child = false;
-            continue;
-          }
-          new_inner->children_.push_back(std::make_pair(kv.first, last_PID));
-          last_PID = kv.second.second;
-          __attribute__((unused)) KeyType tmp_key = kv.first;
-          LOG_DEBUG("one entry with high key : %s", tmp_key.GetTupleForComparison(key_tuple_schema).GetInfo().c_str());
-        }
-        new_inner->children_.push_back(
-            std::make_pair(index_term_ranges.rbegin()->second.first, last_PID));
-        LOG_DEBUG("one entry with high key : %s", index_term_ranges.rbegin()->second.first.GetTupleForComparison(key_tuple_schema).GetInfo().c_str());
-        LOG_DEBUG("Consolidate inner item end.");
-      }
       return new_inner;
     }
   }
 
+  // ***** Functions used by point lookups
+
+  // A page passed on the way down to a leaf, with the largest key it covers
+  struct PathEntry {
+    PID pid_;
+
+    KeyType high_key_;
+
+    // Covers everything up to the largest key
+    bool absolute_max_;
+  };
+
+  // Descends from start_PID to the leaf that owns key and returns its
+  // values. The pages passed are appended to path if given. The caller must
+  // be registered with the epoch manager.
+  std::vector<ValueType> SearchKeyFrom(const KeyType& key, PID start_PID,
+                                       std::vector<PathEntry>* path);
+
+  // Deepest page on path that covers key, popping the ones that don't. Keys
+  // have to come in ascending order, so pages left behind are never needed
+  // again.
+  PID FindProbeStart(const KeyType& key, std::vector<PathEntry>& path);
+
+  // ***** Functions used by the range scan iterator
+
+  // Where to stop when descending to a leaf
+  enum LeafSeekMode { SEEK_KEY, SEEK_LEFTMOST, SEEK_RIGHTMOST };
+
+  // Live entries of one logical leaf node (base page + delta chain),
+  // copied out so that the iterator never holds on to a page
+  struct LeafSnapshot {
+    std::vector<std::pair<KeyType, std::vector<ValueType>>> items_;
+
+    // Leaf to continue with when scanning forward
+    PID next_leaf_ = NullPID;
+
+    // Exclusive lower bound of the leaf, used to step backwards
+    KeyType low_key_;
+
+    bool absolute_min_ = false;
+  };
+
+  // Descends from the root to the leaf that owns key (SEEK_KEY), or to the
+  // left/right-most leaf. The caller must be registered with the epoch manager.
+  PID FindLeaf(const KeyType& key, LeafSeekMode mode);
+
+  // Collects the live entries of a leaf in key order. Must be called while
+  // registered with the epoch manager.
+  void CollectLeaf(PID leaf_PID, LeafSnapshot& snapshot);
+
+  // Loads the leaf for key/mode into the iterator
+  void SeekLeaf(Iterator& itr, const KeyType& key, LeafSeekMode mode);
+
+  // Moves the iterator to the next/previous non-empty leaf. Keys that were
+  // already returned are filtered out, so concurrent splits and merges can't
+  // make the scan return an entry twice.
+  void LoadNextLeaf(Iterator& itr);
+  void LoadPrevLeaf(Iterator& itr);
+
   // Frees up the pages in a delta chain
   inline void FreeDeltaChain(Page* page) {
     // Actually we can't free stale delta chain here, because other threads
@@ -621,10 +1284,17 @@ class BWTree {
   // De-registers a worker thread from its local epoch
   void DeregisterWorker(uint64_t worker_epoch);
 
-  // Adds this delta chain to the list of deallocated chains
-  // for the current epoch
+  // Adds this delta chain to the calling thread's garbage for the current
+  // epoch
   void DeallocatePage(Page *page);
 
+  // Oldest epoch that a registered thread may still be reading in. Garbage
+  // from before it can be freed.
+  uint64_t GetSafeEpoch();
+
+  // Frees the garbage of a slot that no thread can reach any more
+  void ReclaimGarbage(size_t slot_id);
+
   // Returns the size of the given page type
   size_t GetPageSize(Page *page);
 
@@ -635,7 +1305,11 @@ class BWTree {
   std::atomic<PID> PID_counter_;
 
   // Maps node PIDs to memory locations
-  std::vector<std::atomic<Page*>> map_table_{1000000};
+  MappingTable map_table_;
+
+  // PIDs that can be handed out again
+  std::vector<PID> free_PIDs_;
+  Spinlock free_PIDs_lock_;
 
   // True if duplicate keys are permitted
   bool allow_duplicate_;
@@ -648,6 +1322,9 @@ class BWTree {
 
   ReverseComparator reverse_comparator_;
 
+  // Shortens the separators of inner nodes
+  Codec separator_codec_;
+
   // Value equality function object
   ValueEqualityChecker value_equals_;
 
@@ -660,22 +1337,144 @@ class BWTree {
   // Global epoch counter
   std::atomic_ullong epoch_;
 
-  // Map that tracks the number of active threads in each epoch
-  std::unordered_map<uint64_t, std::atomic_ullong> active_threads_map_;
+  // Time between two epochs
+  std::atomic<uint64_t> epoch_interval_ms_;
+
+  // Structure modification thresholds
+  std::atomic<size_t> consolidate_threshold_;
+  std::atomic<size_t> split_size_;
+  std::atomic<size_t> merge_size_;
+
+  // Whether structure modifications are left to the maintenance thread
+  std::atomic_bool background_maintenance_{false};
+
+  // Maintenance background thread, only running in background mode
+  std::thread maintenance_thread_;
+
+  // Keys of nodes to maintain, and whether the thread is working on one.
+  // maintenance_cv_ wakes up the thread, maintenance_done_cv_ its waiters.
+  std::deque<KeyType> maintenance_hints_;
+  bool maintenance_busy_ = false;
+  bool maintenance_stopped_ = true;
+  std::mutex maintenance_lock_;
+  std::condition_variable maintenance_cv_;
+  std::condition_variable maintenance_done_cv_;
+
+  // Successful consolidations, splits and merges
+  std::atomic<uint64_t> consolidation_count_{0};
+  std::atomic<uint64_t> split_count_{0};
+  std::atomic<uint64_t> merge_count_{0};
+
+  // Operations, failed CASes and restarts of an operation from the root
+  StatisticsCounter insert_count_;
+  StatisticsCounter delete_count_;
+  StatisticsCounter lookup_count_;
+  StatisticsCounter cas_failure_count_;
+  StatisticsCounter restart_count_;
+
+  // Maintenance hints queued and dropped because the queue was full
+  StatisticsCounter posted_hint_count_;
+  StatisticsCounter dropped_hint_count_;
+
+  // Length of the leaf delta chain a modification was installed on
+  ConcurrentHistogram chain_length_;
+
+  // Epoch state of one thread. Registering only writes to the calling
+  // thread's slot.
+  static constexpr uint64_t QUIESCENT_EPOCH =
+      std::numeric_limits<uint64_t>::max();
+
+  // Slots are padded so that the epochs of two threads never share a cache
+  // line. This is done by hand as new does not honor alignas before C++17.
+  struct EpochSlot {
+    // Epoch the thread registered in, QUIESCENT_EPOCH if it isn't registered
+    std::atomic<uint64_t> epoch_{QUIESCENT_EPOCH};
+
+    // Nesting depth of RegisterWorker(), only touched by the owner
+    uint32_t depth_ = 0;
+
+    // Delta chains and PIDs retired by the thread, with the epoch they were
+    // retired in
+    std::vector<std::pair<uint64_t, Page*>> garbage_pages_;
+    std::vector<std::pair<uint64_t, PID>> garbage_PIDs_;
+
+    // Garbage count at which the owner reclaims next
+    size_t reclaim_at_ = EPOCH_GC_BATCH_SIZE;
+
+    // Only contended when Cleanup() reclaims on behalf of the owner
+    Spinlock garbage_lock_;
+
+    char cache_line_padding_[64];
+  };
 
-  // Map that tracks the delta chains deallocated in each epoch
-  std::unordered_map<uint64_t, std::vector<Page*>> epoch_garbage_;
+  EpochSlot epoch_slots_[EPOCH_MAX_THREADS];
 
   // CV to wake up epoch manager if finished
   std::condition_variable exec_finished_;
 
-  // TODO: synch helper for debug
-  RWLock cleanup_lock;
-  RWLock dealloc_lock;
-
   // Used for debug
   catalog::Schema *key_tuple_schema;
 };
 
+/**
+ * Iterator over the keys of a BWTree in key order. It copies out one logical
+ * leaf at a time and walks the leaf chain (next_leaf_ and split side links)
+ * to get to the following leaf, so a range scan only touches the leaves that
+ * overlap the range.
+ */
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, bool _Duplicates,
+          class ValueEqualityChecker>
+class BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+             _Duplicates, ValueEqualityChecker>::Iterator {
+  friend class BWTree;
+
+ public:
+  inline bool IsEnd() const { return pos_ >= leaf_.items_.size(); }
+
+  inline const KeyType& GetKey() const { return leaf_.items_[pos_].first; }
+
+  inline const std::vector<ValueType>& GetValues() const {
+    return leaf_.items_[pos_].second;
+  }
+
+  // Moves to the next larger key
+  inline void Next() {
+    assert(!IsEnd());
+    if (pos_ + 1 < leaf_.items_.size()) {
+      ++pos_;
+    } else {
+      tree_->LoadNextLeaf(*this);
+    }
+  }
+
+  // Moves to the next smaller key
+  inline void Prev() {
+    assert(!IsEnd());
+    if (pos_ > 0) {
+      --pos_;
+    } else {
+      tree_->LoadPrevLeaf(*this);
+    }
+  }
+
+ private:
+  Iterator(BWTree* tree) : tree_(tree), pos_(0) {}
+
+  inline void SetEnd() {
+    leaf_.items_.clear();
+    leaf_.next_leaf_ = NullPID;
+    pos_ = 0;
+  }
+
+  BWTree* tree_;
+
+  // Entries of the current leaf
+  LeafSnapshot leaf_;
+
+  // Position inside the current leaf
+  size_t pos_;
+};
+
 }  // End index namespace
 }  // End peloton namespace
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "backend/common/logger.h"
 #include "backend/index/bwtree_index.h"
 #include "backend/index/index_key.h"
@@ -19,9 +21,9 @@ namespace peloton {
 namespace index {
 
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
-BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::BWTreeIndex(
-    IndexMetadata *metadata)
+          class KeyEqualityChecker, bool Duplicates>
+BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+            Duplicates>::BWTreeIndex(IndexMetadata *metadata)
     : Index(metadata),
       container(KeyComparator(metadata), KeyEqualityChecker(metadata)),
       equals(metadata),
@@ -29,16 +31,16 @@ BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::BWTreeIndex(
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
+          class KeyEqualityChecker, bool Duplicates>
 BWTreeIndex<KeyType, ValueType, KeyComparator,
-            KeyEqualityChecker>::~BWTreeIndex() {
+            KeyEqualityChecker, Duplicates>::~BWTreeIndex() {
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
-bool BWTreeIndex<KeyType, ValueType, KeyComparator,
-                 KeyEqualityChecker>::InsertEntry(const storage::Tuple *key,
-                                                  const ItemPointer location) {
+          class KeyEqualityChecker, bool Duplicates>
+bool BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                 Duplicates>::InsertEntry(const storage::Tuple *key,
+                                          const ItemPointer location) {
   KeyType index_key;
   index_key.SetFromKey(key);
 
@@ -48,12 +50,43 @@ bool BWTreeIndex<KeyType, ValueType, KeyComparator,
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
-bool BWTreeIndex<KeyType, ValueType, KeyComparator,
-                 KeyEqualityChecker>::DeleteEntry(__attribute__((unused))
-                                                  const storage::Tuple *key,
-                                                  __attribute__((unused))
-                                                  const ItemPointer location) {
+          class KeyEqualityChecker, bool Duplicates>
+bool BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                 Duplicates>::
+    CondInsertEntry(const storage::Tuple *key, const ItemPointer location,
+                    std::function<bool(const ItemPointer &)> predicate) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  // Check the existing entries and insert in the same traversal
+  return container.ConditionalInsert(index_key, location, predicate);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, bool Duplicates>
+bool BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                 Duplicates>::
+    BulkLoad(const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+                 entries) {
+  std::vector<std::pair<KeyType, ItemPointer>> items;
+  items.reserve(entries.size());
+  for (auto &entry : entries) {
+    KeyType index_key;
+    index_key.SetFromKey(entry.first);
+    items.push_back(std::make_pair(index_key, entry.second));
+  }
+
+  // Build the tree bottom-up instead of going through the delta chains
+  return container.BulkLoad(items);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, bool Duplicates>
+bool BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                 Duplicates>::DeleteEntry(__attribute__((unused))
+                                          const storage::Tuple *key,
+                                          __attribute__((unused))
+                                          const ItemPointer location) {
   KeyType index_key;
   index_key.SetFromKey(key);
 
@@ -62,33 +95,134 @@ bool BWTreeIndex<KeyType, ValueType, KeyComparator,
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
-std::vector<ItemPointer>
-BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
-    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
-    const std::vector<ExpressionType> &expr_types,
-    const ScanDirectionType &scan_direction) {
-  std::vector<ItemPointer> result;
+          class KeyEqualityChecker, bool Duplicates>
+template <typename Visitor>
+void BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                 Duplicates>::
+    ScanMatches(const std::vector<Value> &values,
+                const std::vector<oid_t> &key_column_ids,
+                const std::vector<ExpressionType> &expr_types,
+                const ScanDirectionType &scan_direction, BatchState *batch,
+                const Visitor &visitor) {
+  const catalog::Schema *key_schema = metadata->GetKeySchema();
+
+  // Constraints on the leading key column tell us where the matching keys
+  // start and end, so that we only walk over that part of the leaf chain
+  const Value *low_value;
+  const Value *high_value;
+  GetLeadingColumnBounds(values, key_column_ids, expr_types, low_value,
+                         high_value);
 
-  auto key_values = container.SearchAllKeys();
+  // Later batches start where the last one stopped
+  const KeyType *resume_key =
+      (batch != nullptr) ? batch->GetResumeKey() : nullptr;
+
+  // Hands a match to the visitor, returns false once the batch is full
+  bool stopped = false;
+  auto emit = [&](const KeyType &key, const storage::Tuple &tuple,
+                  const ItemPointer &location) {
+    if (batch != nullptr) {
+      if (batch->IsFull()) return false;
+      if (!batch->Admit(key)) return true;
+    }
+    visitor(tuple, location);
+    return true;
+  };
 
   switch (scan_direction) {
-    case SCAN_DIRECTION_TYPE_FORWARD:
-    case SCAN_DIRECTION_TYPE_BACKWARD: {
+    case SCAN_DIRECTION_TYPE_FORWARD: {
+      std::unique_ptr<storage::Tuple> start_tuple;
+      KeyType start_key;
+      if (resume_key != nullptr) {
+        start_key = *resume_key;
+      } else if (low_value != nullptr) {
+        start_tuple.reset(new storage::Tuple(key_schema, true));
+        ConstructLeadingColumnTuple(start_tuple.get(), *low_value);
+        start_key.SetFromKey(start_tuple.get());
+      }
+
       // Scan the index entries in forward direction
-      for (auto &key_value : key_values) {
-        auto scan_current_key = key_value.first;
-        auto tuple =
-            scan_current_key.GetTupleForComparison(metadata->GetKeySchema());
+      MapIterator itr = (resume_key != nullptr || low_value != nullptr)
+                            ? container.Begin(start_key)
+                            : container.Begin();
+      for (; !stopped && !itr.IsEnd(); itr.Next()) {
+        auto scan_current_key = itr.GetKey();
+        auto tuple = scan_current_key.GetTupleForComparison(key_schema);
+
+        // We are past the end of the range
+        if (high_value != nullptr &&
+            tuple.GetValue(0).Compare(*high_value) == VALUE_COMPARE_GREATERTHAN)
+          break;
 
         // Compare the current key in the scan with "values" based on
         // "expression types"
         // For instance, "5" EXPR_GREATER_THAN "2" is true
-        if (Compare(tuple, key_column_ids, expr_types, values) == true)
-          result.insert(result.end(), key_value.second.begin(),
-                        key_value.second.end());
+        if (Compare(tuple, key_column_ids, expr_types, values) == true) {
+          for (auto &location : itr.GetValues()) {
+            if (!emit(scan_current_key, tuple, location)) {
+              stopped = true;
+              break;
+            }
+          }
+        }
       }
+    } break;
+
+    case SCAN_DIRECTION_TYPE_BACKWARD: {
+      std::unique_ptr<storage::Tuple> end_tuple;
+      KeyType end_key;
+      if (resume_key == nullptr && high_value != nullptr) {
+        end_tuple.reset(new storage::Tuple(key_schema, true));
+        ConstructLeadingColumnTuple(end_tuple.get(), *high_value);
+        end_key.SetFromKey(end_tuple.get());
+      }
+
+      MapIterator itr = container.RBegin();
+      if (resume_key != nullptr) {
+        // Go back to the key the last batch stopped at, or the one before
+        // it if it has been deleted since
+        itr = container.Begin(*resume_key);
+        if (itr.IsEnd())
+          itr = container.RBegin();
+        else if (!equals(itr.GetKey(), *resume_key))
+          itr.Prev();
+      } else if (high_value != nullptr) {
+        // Find the last key whose leading column is still within the range.
+        // Only the leading column is bounded, so we seek to the first key
+        // with that value and move past all keys sharing it.
+        for (itr = container.Begin(end_key); !itr.IsEnd(); itr.Next()) {
+          auto scan_current_key = itr.GetKey();
+          auto tuple = scan_current_key.GetTupleForComparison(key_schema);
+          if (tuple.GetValue(0).Compare(*high_value) ==
+              VALUE_COMPARE_GREATERTHAN)
+            break;
+        }
 
+        if (itr.IsEnd())
+          itr = container.RBegin();
+        else
+          itr.Prev();
+      }
+
+      // Scan the index entries in backward direction
+      for (; !stopped && !itr.IsEnd(); itr.Prev()) {
+        auto scan_current_key = itr.GetKey();
+        auto tuple = scan_current_key.GetTupleForComparison(key_schema);
+
+        // We are past the start of the range
+        if (low_value != nullptr &&
+            tuple.GetValue(0).Compare(*low_value) == VALUE_COMPARE_LESSTHAN)
+          break;
+
+        if (Compare(tuple, key_column_ids, expr_types, values) == true) {
+          for (auto &location : itr.GetValues()) {
+            if (!emit(scan_current_key, tuple, location)) {
+              stopped = true;
+              break;
+            }
+          }
+        }
+      }
     } break;
 
     case SCAN_DIRECTION_TYPE_INVALID:
@@ -97,19 +231,74 @@ BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
       break;
   }
 
+  if (batch != nullptr) batch->Finish(!stopped, key_schema, GetPool());
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, bool Duplicates>
+std::vector<ItemPointer>
+BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+            Duplicates>::Scan(
+    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType &scan_direction) {
+  std::vector<ItemPointer> result;
+
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, nullptr,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
+
   return result;
 }
 
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
-std::vector<ItemPointer> BWTreeIndex<KeyType, ValueType, KeyComparator,
-                                     KeyEqualityChecker>::ScanAllKeys() {
+          class KeyEqualityChecker, bool Duplicates>
+std::vector<ItemPointer>
+BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+            Duplicates>::ScanBatch(const std::vector<Value> &values,
+                                   const std::vector<oid_t> &key_column_ids,
+                                   const std::vector<ExpressionType> &expr_types,
+                                   const ScanDirectionType &scan_direction,
+                                   size_t max_count, ScanCursor &cursor) {
+  std::vector<ItemPointer> result;
+  if (cursor.done) return result;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, bool Duplicates>
+void BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                 Duplicates>::
+    ScanEntries(const std::vector<Value> &values,
+                const std::vector<oid_t> &key_column_ids,
+                const std::vector<ExpressionType> &expr_types,
+                const ScanDirectionType &scan_direction, size_t max_count,
+                ScanCursor &cursor, const EntryVisitor &visitor) {
+  if (cursor.done) return;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              visitor);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, bool Duplicates>
+std::vector<ItemPointer>
+BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+            Duplicates>::ScanAllKeys() {
   std::vector<ValueType> result;
 
-  auto key_values = container.SearchAllKeys();
-  for (auto &key_value : key_values)
-    result.insert(result.end(), key_value.second.begin(),
-                  key_value.second.end());
+  for (auto itr = container.Begin(); !itr.IsEnd(); itr.Next())
+    result.insert(result.end(), itr.GetValues().begin(),
+                  itr.GetValues().end());
 
   return result;
 }
@@ -118,10 +307,10 @@ std::vector<ItemPointer> BWTreeIndex<KeyType, ValueType, KeyComparator,
  * @brief Return all locations related to this key.
  */
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
+          class KeyEqualityChecker, bool Duplicates>
 std::vector<ItemPointer>
-BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanKey(
-    const storage::Tuple *key) {
+BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+            Duplicates>::ScanKey(const storage::Tuple *key) {
   KeyType index_key;
   index_key.SetFromKey(key);
 
@@ -129,10 +318,46 @@ BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanKey(
   return container.SearchKey(index_key);
 }
 
+/**
+ * @brief Return the locations of each key. The keys are looked up in sorted
+ * order, so that probes for nearby keys share most of the way down the tree.
+ */
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, bool Duplicates>
+std::vector<std::vector<ItemPointer>>
+BWTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+            Duplicates>::ScanKeys(const std::vector<const storage::Tuple *> &
+                                      keys) {
+  std::vector<KeyType> index_keys(keys.size());
+  std::vector<size_t> key_order(keys.size());
+  for (size_t key_itr = 0; key_itr < keys.size(); key_itr++) {
+    index_keys[key_itr].SetFromKey(keys[key_itr]);
+    key_order[key_itr] = key_itr;
+  }
+
+  std::sort(key_order.begin(), key_order.end(), [&](size_t a, size_t b) {
+    return comparator(index_keys[a], index_keys[b]);
+  });
+
+  std::vector<KeyType> sorted_keys;
+  sorted_keys.reserve(keys.size());
+  for (auto key_itr : key_order) sorted_keys.push_back(index_keys[key_itr]);
+
+  auto sorted_result = container.SearchKeys(sorted_keys);
+
+  // Hand the locations back in the order of the keys
+  std::vector<std::vector<ItemPointer>> result(keys.size());
+  for (size_t sorted_itr = 0; sorted_itr < key_order.size(); sorted_itr++) {
+    result[key_order[sorted_itr]] = std::move(sorted_result[sorted_itr]);
+  }
+
+  return result;
+}
+
 template <typename KeyType, typename ValueType, class KeyComparator,
-          class KeyEqualityChecker>
+          class KeyEqualityChecker, bool Duplicates>
 std::string BWTreeIndex<KeyType, ValueType, KeyComparator,
-                        KeyEqualityChecker>::GetTypeName() const {
+                        KeyEqualityChecker, Duplicates>::GetTypeName() const {
   return "BWTree";
 }
 
@@ -174,5 +399,43 @@ template class BWTreeIndex<GenericKey<512>, ItemPointer, GenericComparator<512>,
 template class BWTreeIndex<TupleKey, ItemPointer, TupleKeyComparator,
                            TupleKeyEqualityChecker>;
 
+// Unique key indexes
+template class BWTreeIndex<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                           IntsEqualityChecker<1>, false>;
+template class BWTreeIndex<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                           IntsEqualityChecker<2>, false>;
+template class BWTreeIndex<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                           IntsEqualityChecker<3>, false>;
+template class BWTreeIndex<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                           IntsEqualityChecker<4>, false>;
+
+template class BWTreeIndex<GenericKey<4>, ItemPointer, GenericComparator<4>,
+                           GenericEqualityChecker<4>, false>;
+template class BWTreeIndex<GenericKey<8>, ItemPointer, GenericComparator<8>,
+                           GenericEqualityChecker<8>, false>;
+template class BWTreeIndex<GenericKey<12>, ItemPointer, GenericComparator<12>,
+                           GenericEqualityChecker<12>, false>;
+template class BWTreeIndex<GenericKey<16>, ItemPointer, GenericComparator<16>,
+                           GenericEqualityChecker<16>, false>;
+template class BWTreeIndex<GenericKey<24>, ItemPointer, GenericComparator<24>,
+                           GenericEqualityChecker<24>, false>;
+template class BWTreeIndex<GenericKey<32>, ItemPointer, GenericComparator<32>,
+                           GenericEqualityChecker<32>, false>;
+template class BWTreeIndex<GenericKey<48>, ItemPointer, GenericComparator<48>,
+                           GenericEqualityChecker<48>, false>;
+template class BWTreeIndex<GenericKey<64>, ItemPointer, GenericComparator<64>,
+                           GenericEqualityChecker<64>, false>;
+template class BWTreeIndex<GenericKey<96>, ItemPointer, GenericComparator<96>,
+                           GenericEqualityChecker<96>, false>;
+template class BWTreeIndex<GenericKey<128>, ItemPointer, GenericComparator<128>,
+                           GenericEqualityChecker<128>, false>;
+template class BWTreeIndex<GenericKey<256>, ItemPointer, GenericComparator<256>,
+                           GenericEqualityChecker<256>, false>;
+template class BWTreeIndex<GenericKey<512>, ItemPointer, GenericComparator<512>,
+                           GenericEqualityChecker<512>, false>;
+
+template class BWTreeIndex<TupleKey, ItemPointer, TupleKeyComparator,
+                           TupleKeyEqualityChecker, false>;
+
 }  // End index namespace
 }  // End peloton namespace
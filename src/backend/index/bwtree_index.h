@@ -20,6 +20,7 @@
 #include "backend/common/platform.h"
 #include "backend/common/types.h"
 #include "backend/index/index.h"
+#include "backend/index/batch_scan_state.h"
 
 #include "backend/index/bwtree.h"
 
@@ -27,15 +28,19 @@ namespace peloton {
 namespace index {
 
 /**
- * BW tree-based index implementation.
+ * BW tree-based index implementation. Unique indexes use a tree that keeps
+ * duplicates out (Duplicates = false).
  *
  * @see Index
  */
-template <typename KeyType, typename ValueType, typename KeyComparator, typename KeyEqualityChecker>
+template <typename KeyType, typename ValueType, typename KeyComparator,
+          typename KeyEqualityChecker, bool Duplicates = true>
 class BWTreeIndex : public Index {
   friend class IndexFactory;
 
-  typedef BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker, true> MapType;
+  typedef BWTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                 Duplicates> MapType;
+  typedef typename MapType::Iterator MapIterator;
 
  public:
   BWTreeIndex(IndexMetadata *metadata);
@@ -44,6 +49,13 @@ class BWTreeIndex : public Index {
 
   bool InsertEntry(const storage::Tuple *key, const ItemPointer location);
 
+  bool CondInsertEntry(const storage::Tuple *key, const ItemPointer location,
+                       std::function<bool(const ItemPointer &)> predicate);
+
+  bool BulkLoad(
+      const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+          entries);
+
   bool DeleteEntry(const storage::Tuple *key, const ItemPointer location);
 
   std::vector<ItemPointer> Scan(const std::vector<Value> &values,
@@ -51,10 +63,28 @@ class BWTreeIndex : public Index {
                                 const std::vector<ExpressionType> &expr_types,
                                 const ScanDirectionType& scan_direction);
 
+  bool SupportsIndexOnlyScan() const { return true; }
+
+  std::vector<ItemPointer> ScanBatch(
+      const std::vector<Value> &values,
+      const std::vector<oid_t> &key_column_ids,
+      const std::vector<ExpressionType> &expr_types,
+      const ScanDirectionType &scan_direction, size_t max_count,
+      ScanCursor &cursor);
+
+  void ScanEntries(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType &scan_direction, size_t max_count,
+                   ScanCursor &cursor, const EntryVisitor &visitor);
+
   std::vector<ItemPointer> ScanAllKeys();
 
   std::vector<ItemPointer> ScanKey(const storage::Tuple *key);
 
+  std::vector<std::vector<ItemPointer>> ScanKeys(
+      const std::vector<const storage::Tuple *> &keys);
+
   std::string GetTypeName() const;
 
   bool Cleanup() {
@@ -65,7 +95,47 @@ class BWTreeIndex : public Index {
     return container.GetMemoryFootprint();
   }
 
+  IndexStatistics GetStatistics() {
+    IndexStatistics statistics = Index::GetStatistics();
+    container.GetStatistics(statistics);
+    return statistics;
+  }
+
+  uint64_t GetConsolidationCount() const {
+    return container.GetConsolidationCount();
+  }
+
+  uint64_t GetSplitCount() const { return container.GetSplitCount(); }
+
+  uint64_t GetMergeCount() const { return container.GetMergeCount(); }
+
+  // Structure modification thresholds and background maintenance, see BWTree
+  void SetConsolidateThreshold(size_t threshold) {
+    container.SetConsolidateThreshold(threshold);
+  }
+
+  void SetSplitSize(size_t split_size) { container.SetSplitSize(split_size); }
+
+  void SetMergeSize(size_t merge_size) { container.SetMergeSize(merge_size); }
+
+  void SetBackgroundMaintenance(bool enabled) {
+    container.SetBackgroundMaintenance(enabled);
+  }
+
+  void WaitForMaintenance() { container.WaitForMaintenance(); }
+
  protected:
+  typedef BatchScanState<KeyType, KeyEqualityChecker> BatchState;
+
+  // Calls visitor with the key tuple and location of every entry that
+  // matches the scan, or only of those in the batch if there is one
+  template <typename Visitor>
+  void ScanMatches(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType &scan_direction, BatchState *batch,
+                   const Visitor &visitor);
+
   // container
   MapType container;
 
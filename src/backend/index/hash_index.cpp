@@ -0,0 +1,277 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// hash_index.cpp
+//
+// Identification: src/backend/index/hash_index.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "backend/index/hash_index.h"
+#include "backend/index/index_key.h"
+#include "backend/common/exception.h"
+#include "backend/common/logger.h"
+#include "backend/storage/tuple.h"
+
+namespace peloton {
+namespace index {
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::HashIndex(
+    IndexMetadata *metadata)
+    : Index(metadata), hasher(metadata), equals(metadata) {
+  for (oid_t segment_itr = 0; segment_itr < HASH_INDEX_SEGMENT_COUNT;
+       segment_itr++) {
+    segments.emplace_back(new Segment(hasher, equals));
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::~HashIndex() {}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+bool HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::InsertEntry(
+    const storage::Tuple *key, const ItemPointer location) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+  auto &segment = GetSegment(index_key);
+  bool inserted = false;
+
+  {
+    segment.lock.WriteLock();
+
+    // Unique indexes take one entry per key
+    if (HasUniqueKeys() == false ||
+        segment.map.find(index_key) == segment.map.end()) {
+      segment.map.insert(std::pair<KeyType, ValueType>(index_key, location));
+      inserted = true;
+    }
+
+    segment.lock.Unlock();
+  }
+
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+bool HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::
+    CondInsertEntry(const storage::Tuple *key, const ItemPointer location,
+                    std::function<bool(const ItemPointer &)> predicate) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+  auto &segment = GetSegment(index_key);
+  bool inserted = true;
+
+  {
+    segment.lock.WriteLock();
+
+    // Check the existing entries under the same lock as the insert
+    auto entries = segment.map.equal_range(index_key);
+    for (auto entry = entries.first; entry != entries.second; ++entry) {
+      if (predicate(entry->second)) {
+        inserted = false;
+        break;
+      }
+    }
+
+    if (inserted) {
+      segment.map.insert(std::pair<KeyType, ValueType>(index_key, location));
+    }
+
+    segment.lock.Unlock();
+  }
+
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+bool HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::DeleteEntry(
+    const storage::Tuple *key, const ItemPointer location) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+  auto &segment = GetSegment(index_key);
+  bool deleted = false;
+
+  {
+    segment.lock.WriteLock();
+
+    // Delete the < key, location > pairs
+    auto entries = segment.map.equal_range(index_key);
+    for (auto entry = entries.first; entry != entries.second;) {
+      ItemPointer value = entry->second;
+
+      if ((value.block == location.block) &&
+          (value.offset == location.offset)) {
+        entry = segment.map.erase(entry);
+        deleted = true;
+      } else {
+        ++entry;
+      }
+    }
+
+    segment.lock.Unlock();
+  }
+
+  return deleted;
+}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::Scan(
+    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType &scan_direction) {
+  if (scan_direction == SCAN_DIRECTION_TYPE_INVALID) {
+    throw Exception("Invalid scan direction \n");
+  }
+
+  // Without an equality on every key column there is no key to hash.
+  // ConstructLowerBoundTuple fills in columns missing from key_column_ids
+  // with their min value, so check that none is missing first.
+  auto key_schema = metadata->GetKeySchema();
+  bool all_constraints_are_equal = std::all_of(
+      expr_types.begin(), expr_types.end(), [](ExpressionType expr_type) {
+        return expr_type == EXPRESSION_TYPE_COMPARE_EQUAL;
+      });
+  for (oid_t column_itr = 0; column_itr < key_schema->GetColumnCount();
+       column_itr++) {
+    if (std::find(key_column_ids.begin(), key_column_ids.end(), column_itr) ==
+        key_column_ids.end()) {
+      all_constraints_are_equal = false;
+    }
+  }
+  if (all_constraints_are_equal == false) {
+    throw IndexException(
+        "Hash index only supports equality lookups on all key columns");
+  }
+
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  ConstructLowerBoundTuple(key.get(), values, key_column_ids, expr_types);
+
+  return ScanKey(key.get());
+}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::ScanAllKeys() {
+  std::vector<ItemPointer> result;
+
+  // One segment at a time, in no particular key order
+  for (auto &segment : segments) {
+    segment->lock.ReadLock();
+
+    for (auto &entry : segment->map) {
+      result.push_back(entry.second);
+    }
+
+    segment->lock.Unlock();
+  }
+
+  return result;
+}
+
+/**
+ * @brief Return all locations related to this key.
+ */
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+HashIndex<KeyType, ValueType, KeyHasher, KeyEqualityChecker>::ScanKey(
+    const storage::Tuple *key) {
+  std::vector<ItemPointer> result;
+  KeyType index_key;
+  index_key.SetFromKey(key);
+  auto &segment = GetSegment(index_key);
+
+  {
+    segment.lock.ReadLock();
+
+    // find the <key, location> pairs
+    auto entries = segment.map.equal_range(index_key);
+    for (auto entry = entries.first; entry != entries.second; ++entry) {
+      result.push_back(entry->second);
+    }
+
+    segment.lock.Unlock();
+  }
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+std::string HashIndex<KeyType, ValueType, KeyHasher,
+                      KeyEqualityChecker>::GetTypeName() const {
+  return "Hash";
+}
+
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+size_t HashIndex<KeyType, ValueType, KeyHasher,
+                 KeyEqualityChecker>::GetMemoryFootprint() {
+  // Each entry is a node with a next pointer and the cached hash
+  const size_t node_size =
+      sizeof(typename MapType::value_type) + sizeof(void *) + sizeof(size_t);
+  size_t footprint = sizeof(*this);
+
+  for (auto &segment : segments) {
+    segment->lock.ReadLock();
+
+    footprint += sizeof(Segment) + segment->map.size() * node_size +
+                 segment->map.bucket_count() * sizeof(void *);
+
+    segment->lock.Unlock();
+  }
+
+  return footprint;
+}
+
+// Explicit template instantiation
+template class HashIndex<IntsKey<1>, ItemPointer, IntsHasher<1>,
+                         IntsEqualityChecker<1>>;
+template class HashIndex<IntsKey<2>, ItemPointer, IntsHasher<2>,
+                         IntsEqualityChecker<2>>;
+template class HashIndex<IntsKey<3>, ItemPointer, IntsHasher<3>,
+                         IntsEqualityChecker<3>>;
+template class HashIndex<IntsKey<4>, ItemPointer, IntsHasher<4>,
+                         IntsEqualityChecker<4>>;
+
+template class HashIndex<GenericKey<4>, ItemPointer, GenericHasher<4>,
+                         GenericEqualityChecker<4>>;
+template class HashIndex<GenericKey<8>, ItemPointer, GenericHasher<8>,
+                         GenericEqualityChecker<8>>;
+template class HashIndex<GenericKey<12>, ItemPointer, GenericHasher<12>,
+                         GenericEqualityChecker<12>>;
+template class HashIndex<GenericKey<16>, ItemPointer, GenericHasher<16>,
+                         GenericEqualityChecker<16>>;
+template class HashIndex<GenericKey<24>, ItemPointer, GenericHasher<24>,
+                         GenericEqualityChecker<24>>;
+template class HashIndex<GenericKey<32>, ItemPointer, GenericHasher<32>,
+                         GenericEqualityChecker<32>>;
+template class HashIndex<GenericKey<48>, ItemPointer, GenericHasher<48>,
+                         GenericEqualityChecker<48>>;
+template class HashIndex<GenericKey<64>, ItemPointer, GenericHasher<64>,
+                         GenericEqualityChecker<64>>;
+template class HashIndex<GenericKey<96>, ItemPointer, GenericHasher<96>,
+                         GenericEqualityChecker<96>>;
+template class HashIndex<GenericKey<128>, ItemPointer, GenericHasher<128>,
+                         GenericEqualityChecker<128>>;
+template class HashIndex<GenericKey<256>, ItemPointer, GenericHasher<256>,
+                         GenericEqualityChecker<256>>;
+template class HashIndex<GenericKey<512>, ItemPointer, GenericHasher<512>,
+                         GenericEqualityChecker<512>>;
+
+}  // End index namespace
+}  // End peloton namespace
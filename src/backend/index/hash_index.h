@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// hash_index.h
+//
+// Identification: src/backend/index/hash_index.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+
+#include "backend/catalog/manager.h"
+#include "backend/common/platform.h"
+#include "backend/common/types.h"
+#include "backend/index/index.h"
+
+// Number of independently locked parts of the table. Must stay fixed for
+// the lifetime of an index since it decides where a key lives.
+#define HASH_INDEX_SEGMENT_COUNT 64
+
+namespace peloton {
+namespace index {
+
+/**
+ * Hash index for equality lookups. The table is split into segments, each
+ * with its own lock, and every segment rehashes on its own as it grows, so
+ * resizing never stops the whole index. Scan only answers lookups that fix
+ * every key column with an equality.
+ *
+ * @see Index
+ */
+template <typename KeyType, typename ValueType, class KeyHasher,
+          class KeyEqualityChecker>
+class HashIndex : public Index {
+  friend class IndexFactory;
+
+  // Define the container type
+  typedef std::unordered_multimap<KeyType, ValueType, KeyHasher,
+                                  KeyEqualityChecker> MapType;
+
+  struct Segment {
+    Segment(const KeyHasher &hasher, const KeyEqualityChecker &equals)
+        : map(0, hasher, equals) {}
+
+    RWLock lock;
+
+    MapType map;
+  };
+
+ public:
+  HashIndex(IndexMetadata *metadata);
+
+  ~HashIndex();
+
+  bool InsertEntry(const storage::Tuple *key, const ItemPointer location);
+
+  bool CondInsertEntry(const storage::Tuple *key, const ItemPointer location,
+                       std::function<bool(const ItemPointer &)> predicate);
+
+  bool DeleteEntry(const storage::Tuple *key, const ItemPointer location);
+
+  std::vector<ItemPointer> Scan(const std::vector<Value> &values,
+                                const std::vector<oid_t> &key_column_ids,
+                                const std::vector<ExpressionType> &expr_types,
+                                const ScanDirectionType &scan_direction);
+
+  std::vector<ItemPointer> ScanAllKeys();
+
+  std::vector<ItemPointer> ScanKey(const storage::Tuple *key);
+
+  std::string GetTypeName() const;
+
+  bool Cleanup() { return true; }
+
+  size_t GetMemoryFootprint();
+
+ protected:
+  inline Segment &GetSegment(const KeyType &key) {
+    return *segments[hasher(key) % HASH_INDEX_SEGMENT_COUNT];
+  }
+
+  std::vector<std::unique_ptr<Segment>> segments;
+
+  // hash function and equality checker
+  KeyHasher hasher;
+  KeyEqualityChecker equals;
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -31,6 +31,89 @@ Index::~Index() {
   delete pool;
 }
 
+bool Index::CondInsertEntry(
+    const storage::Tuple *key, const ItemPointer location,
+    std::function<bool(const ItemPointer &)> predicate) {
+  auto locations = ScanKey(key);
+  for (auto entry : locations) {
+    if (predicate(entry)) return false;
+  }
+
+  return InsertEntry(key, location);
+}
+
+bool Index::BulkLoad(
+    const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+        entries) {
+  bool status = true;
+  for (auto &entry : entries) {
+    status = InsertEntry(entry.first, entry.second) && status;
+  }
+
+  return status;
+}
+
+bool Index::InsertEntries(
+    const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+        entries) {
+  bool status = true;
+  for (auto &entry : entries) {
+    status = InsertEntry(entry.first, entry.second) && status;
+  }
+
+  return status;
+}
+
+IndexStatistics Index::GetStatistics() {
+  IndexStatistics statistics;
+  statistics.SetCounter("memory_footprint", GetMemoryFootprint());
+  return statistics;
+}
+
+Index::ScanCursor::ScanCursor() : key_entry_count(0), done(false) {}
+
+Index::ScanCursor::~ScanCursor() {}
+
+void Index::ScanCursor::Reset() {
+  key.reset();
+  key_entry_count = 0;
+  done = false;
+}
+
+std::vector<ItemPointer> Index::ScanBatch(
+    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &exprs,
+    const ScanDirectionType &scan_direction,
+    __attribute__((unused)) size_t max_count, ScanCursor &cursor) {
+  if (cursor.done) return std::vector<ItemPointer>();
+
+  cursor.done = true;
+  if (key_column_ids.empty()) return ScanAllKeys();
+  return Scan(values, key_column_ids, exprs, scan_direction);
+}
+
+std::vector<std::vector<ItemPointer>> Index::ScanKeys(
+    const std::vector<const storage::Tuple *> &keys) {
+  std::vector<std::vector<ItemPointer>> result;
+  result.reserve(keys.size());
+
+  for (auto key : keys) result.push_back(ScanKey(key));
+
+  return result;
+}
+
+void Index::ScanEntries(
+    __attribute__((unused)) const std::vector<Value> &values,
+    __attribute__((unused)) const std::vector<oid_t> &key_column_ids,
+    __attribute__((unused)) const std::vector<ExpressionType> &exprs,
+    __attribute__((unused)) const ScanDirectionType &scan_direction,
+    __attribute__((unused)) size_t max_count,
+    __attribute__((unused)) ScanCursor &cursor,
+    __attribute__((unused)) const EntryVisitor &visitor) {
+  throw IndexException("Index-only scans are not supported by " +
+                       GetTypeName() + " indexes");
+}
+
 IndexMetadata::~IndexMetadata() {
   // clean up key schema
   delete key_schema;
@@ -182,6 +265,45 @@ bool Index::ConstructLowerBoundTuple(storage::Tuple *index_key,
   return all_constraints_equal;
 }
 
+void Index::GetLeadingColumnBounds(
+    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types, const Value *&low_value,
+    const Value *&high_value) {
+  low_value = nullptr;
+  high_value = nullptr;
+  for (oid_t i = 0; i < key_column_ids.size(); i++) {
+    if (key_column_ids[i] != 0) continue;
+    switch (expr_types[i]) {
+      case EXPRESSION_TYPE_COMPARE_EQUAL:
+        low_value = high_value = &values[i];
+        break;
+      case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+        if (low_value == nullptr) low_value = &values[i];
+        break;
+      case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+        if (high_value == nullptr) high_value = &values[i];
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void Index::ConstructLeadingColumnTuple(storage::Tuple *key_tuple,
+                                        const Value &value) {
+  const catalog::Schema *key_schema = metadata->GetKeySchema();
+
+  key_tuple->SetValue(0, value, GetPool());
+  for (oid_t column_itr = 1; column_itr < key_schema->GetColumnCount();
+       column_itr++) {
+    auto value_type = key_schema->GetType(column_itr);
+    key_tuple->SetValue(column_itr, Value::GetMinValue(value_type),
+                        GetPool());
+  }
+}
+
 Index::Index(IndexMetadata *metadata) : metadata(metadata) {
   index_oid = metadata->GetOid();
   // initialize counters
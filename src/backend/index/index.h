@@ -12,11 +12,15 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <utility>
 #include <vector>
 #include <string>
 
 #include "backend/common/printable.h"
 #include "backend/common/types.h"
+#include "backend/index/index_statistics.h"
 
 namespace peloton {
 
@@ -118,6 +122,28 @@ class Index : public Printable {
   virtual bool InsertEntry(const storage::Tuple *key,
                            const ItemPointer location) = 0;
 
+  // insert an index entry unless the key already has an entry for which
+  // predicate returns true. The default implementation looks up the key
+  // before inserting, indexes that can do both in one step override it.
+  virtual bool CondInsertEntry(
+      const storage::Tuple *key, const ItemPointer location,
+      std::function<bool(const ItemPointer &)> predicate);
+
+  // insert the entries of an index that is still empty, e.g. when it is built
+  // over a table that already has tuples. Returns false if a unique index
+  // gets the same key more than once. The default implementation inserts
+  // them one by one.
+  virtual bool BulkLoad(
+      const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+          entries);
+
+  // insert a batch of entries, e.g. for a multi-row insert. Unlike
+  // BulkLoad the index may already have entries. The default implementation
+  // inserts them one by one.
+  virtual bool InsertEntries(
+      const std::vector<std::pair<const storage::Tuple *, ItemPointer>> &
+          entries);
+
   // delete the index entry linked to given tuple and location
   virtual bool DeleteEntry(const storage::Tuple *key,
                            const ItemPointer location) = 0;
@@ -134,11 +160,62 @@ class Index : public Printable {
       const std::vector<ExpressionType> &exprs,
       const ScanDirectionType& scan_direction) = 0;
 
+  // where a batched scan stopped, so that the next batch continues there
+  struct ScanCursor {
+    ScanCursor();
+    ~ScanCursor();
+
+    // start over with the first batch
+    void Reset();
+
+    // key of the last entry returned, null before the first batch
+    std::unique_ptr<storage::Tuple> key;
+
+    // # of entries with that key returned so far
+    size_t key_entry_count;
+
+    // set once all entries have been returned
+    bool done;
+  };
+
+  // scan like Scan(), but return at most max_count locations per call. Call
+  // it with the same cursor until cursor.done is set to get the rest. The
+  // default implementation returns all of them in the first batch.
+  virtual std::vector<ItemPointer> ScanBatch(
+      const std::vector<Value> &values,
+      const std::vector<oid_t> &key_column_ids,
+      const std::vector<ExpressionType> &exprs,
+      const ScanDirectionType &scan_direction, size_t max_count,
+      ScanCursor &cursor);
+
+  // called by ScanEntries() for every entry found, with a view of its key
+  typedef std::function<void(const AbstractTuple &key,
+                             const ItemPointer &location)> EntryVisitor;
+
+  // whether ScanEntries() is supported, i.e. index-only scans can be used
+  virtual bool SupportsIndexOnlyScan() const { return false; }
+
+  // scan in batches like ScanBatch(), but hand every matching entry to the
+  // visitor together with its key, so that key columns can be read without
+  // going to the table. The default implementation throws.
+  virtual void ScanEntries(const std::vector<Value> &values,
+                           const std::vector<oid_t> &key_column_ids,
+                           const std::vector<ExpressionType> &exprs,
+                           const ScanDirectionType &scan_direction,
+                           size_t max_count, ScanCursor &cursor,
+                           const EntryVisitor &visitor);
+
   // scan the entire index, working like a sort
   virtual std::vector<ItemPointer> ScanAllKeys() = 0;
 
   virtual std::vector<ItemPointer> ScanKey(const storage::Tuple *key) = 0;
 
+  // look up a batch of keys at once, e.g. the join keys of an outer tile in
+  // a nested loop join. Returns the locations for each key in the order of
+  // the keys. The default implementation calls ScanKey() for each of them.
+  virtual std::vector<std::vector<ItemPointer>> ScanKeys(
+      const std::vector<const storage::Tuple *> &keys);
+
   //===--------------------------------------------------------------------===//
   // STATS
   //===--------------------------------------------------------------------===//
@@ -197,6 +274,10 @@ class Index : public Printable {
   // Get the memory footprint
   virtual size_t GetMemoryFootprint() = 0;
 
+  // Aggregates the counters and histograms the index keeps. The base
+  // version only has the memory footprint.
+  virtual IndexStatistics GetStatistics();
+
  protected:
   Index(IndexMetadata *schema);
 
@@ -206,6 +287,19 @@ class Index : public Printable {
                           const std::vector<oid_t> &key_column_ids,
                           const std::vector<ExpressionType> &expr_types);
 
+  // Finds the constraints on the leading key column, which tell where the
+  // matching keys start and end. Either bound is null if there is none.
+  static void GetLeadingColumnBounds(
+      const std::vector<Value> &values,
+      const std::vector<oid_t> &key_column_ids,
+      const std::vector<ExpressionType> &expr_types, const Value *&low_value,
+      const Value *&high_value);
+
+  // Fills key_tuple with value in the leading column and the min value in
+  // all other columns, i.e. the smallest key with that leading value
+  void ConstructLeadingColumnTuple(storage::Tuple *key_tuple,
+                                   const Value &value);
+
   //===--------------------------------------------------------------------===//
   //  Data members
   //===--------------------------------------------------------------------===//
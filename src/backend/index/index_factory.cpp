@@ -18,12 +18,256 @@
 #include "backend/index/index_factory.h"
 #include "backend/index/index_key.h"
 
+#include "backend/index/art_index.h"
 #include "backend/index/btree_index.h"
 #include "backend/index/bwtree_index.h"
+#include "backend/index/hash_index.h"
+#include "backend/index/olc_btree_index.h"
 
 namespace peloton {
 namespace index {
 
+namespace {
+
+// BWTree index for the given key size. Duplicates is false for unique indexes.
+template <bool Duplicates>
+Index *GetBWTreeInstance(IndexMetadata *metadata, size_t key_size,
+                         bool ints_only) {
+  if (ints_only) {
+    if (key_size <= sizeof(uint64_t)) {
+      return new BWTreeIndex<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                            IntsEqualityChecker<1>, Duplicates>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 2) {
+      return new BWTreeIndex<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                            IntsEqualityChecker<2>, Duplicates>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 3) {
+      return new BWTreeIndex<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                            IntsEqualityChecker<3>, Duplicates>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 4) {
+      return new BWTreeIndex<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                            IntsEqualityChecker<4>, Duplicates>(metadata);
+    } else {
+      throw IndexException(
+          "We currently only support tree index on non-unique "
+          "integer keys of size 32 bytes or smaller...");
+    }
+  }
+
+  if (key_size <= 4) {
+    return new BWTreeIndex<GenericKey<4>, ItemPointer, GenericComparator<4>,
+                          GenericEqualityChecker<4>, Duplicates>(metadata);
+  } else if (key_size <= 8) {
+    return new BWTreeIndex<GenericKey<8>, ItemPointer, GenericComparator<8>,
+                          GenericEqualityChecker<8>, Duplicates>(metadata);
+  } else if (key_size <= 12) {
+    return new BWTreeIndex<GenericKey<12>, ItemPointer, GenericComparator<12>,
+                          GenericEqualityChecker<12>, Duplicates>(metadata);
+  } else if (key_size <= 16) {
+    return new BWTreeIndex<GenericKey<16>, ItemPointer, GenericComparator<16>,
+                          GenericEqualityChecker<16>, Duplicates>(metadata);
+  } else if (key_size <= 24) {
+    return new BWTreeIndex<GenericKey<24>, ItemPointer, GenericComparator<24>,
+                          GenericEqualityChecker<24>, Duplicates>(metadata);
+  } else if (key_size <= 32) {
+    return new BWTreeIndex<GenericKey<32>, ItemPointer, GenericComparator<32>,
+                          GenericEqualityChecker<32>, Duplicates>(metadata);
+  } else if (key_size <= 48) {
+    return new BWTreeIndex<GenericKey<48>, ItemPointer, GenericComparator<48>,
+                          GenericEqualityChecker<48>, Duplicates>(metadata);
+  } else if (key_size <= 64) {
+    return new BWTreeIndex<GenericKey<64>, ItemPointer, GenericComparator<64>,
+                          GenericEqualityChecker<64>, Duplicates>(metadata);
+  } else if (key_size <= 96) {
+    return new BWTreeIndex<GenericKey<96>, ItemPointer, GenericComparator<96>,
+                          GenericEqualityChecker<96>, Duplicates>(metadata);
+  } else if (key_size <= 128) {
+    return new BWTreeIndex<GenericKey<128>, ItemPointer, GenericComparator<128>,
+                          GenericEqualityChecker<128>, Duplicates>(metadata);
+  } else if (key_size <= 256) {
+    return new BWTreeIndex<GenericKey<256>, ItemPointer, GenericComparator<256>,
+                          GenericEqualityChecker<256>, Duplicates>(metadata);
+  } else if (key_size <= 512) {
+    return new BWTreeIndex<GenericKey<512>, ItemPointer, GenericComparator<512>,
+                          GenericEqualityChecker<512>, Duplicates>(metadata);
+  } else {
+    return new BWTreeIndex<TupleKey, ItemPointer, TupleKeyComparator,
+                          TupleKeyEqualityChecker, Duplicates>(metadata);
+  }
+}
+
+// OLC B+tree index for the given key size
+Index *GetOLCBTreeInstance(IndexMetadata *metadata, size_t key_size,
+                           bool ints_only) {
+  if (ints_only) {
+    if (key_size <= sizeof(uint64_t)) {
+      return new OLCBTreeIndex<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                               IntsEqualityChecker<1>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 2) {
+      return new OLCBTreeIndex<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                               IntsEqualityChecker<2>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 3) {
+      return new OLCBTreeIndex<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                               IntsEqualityChecker<3>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 4) {
+      return new OLCBTreeIndex<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                               IntsEqualityChecker<4>>(metadata);
+    } else {
+      throw IndexException(
+          "We currently only support tree index on non-unique "
+          "integer keys of size 32 bytes or smaller...");
+    }
+  }
+
+  if (key_size <= 4) {
+    return new OLCBTreeIndex<GenericKey<4>, ItemPointer, GenericComparator<4>,
+                             GenericEqualityChecker<4>>(metadata);
+  } else if (key_size <= 8) {
+    return new OLCBTreeIndex<GenericKey<8>, ItemPointer, GenericComparator<8>,
+                             GenericEqualityChecker<8>>(metadata);
+  } else if (key_size <= 12) {
+    return new OLCBTreeIndex<GenericKey<12>, ItemPointer, GenericComparator<12>,
+                             GenericEqualityChecker<12>>(metadata);
+  } else if (key_size <= 16) {
+    return new OLCBTreeIndex<GenericKey<16>, ItemPointer, GenericComparator<16>,
+                             GenericEqualityChecker<16>>(metadata);
+  } else if (key_size <= 24) {
+    return new OLCBTreeIndex<GenericKey<24>, ItemPointer, GenericComparator<24>,
+                             GenericEqualityChecker<24>>(metadata);
+  } else if (key_size <= 32) {
+    return new OLCBTreeIndex<GenericKey<32>, ItemPointer, GenericComparator<32>,
+                             GenericEqualityChecker<32>>(metadata);
+  } else if (key_size <= 48) {
+    return new OLCBTreeIndex<GenericKey<48>, ItemPointer, GenericComparator<48>,
+                             GenericEqualityChecker<48>>(metadata);
+  } else if (key_size <= 64) {
+    return new OLCBTreeIndex<GenericKey<64>, ItemPointer, GenericComparator<64>,
+                             GenericEqualityChecker<64>>(metadata);
+  } else if (key_size <= 96) {
+    return new OLCBTreeIndex<GenericKey<96>, ItemPointer, GenericComparator<96>,
+                             GenericEqualityChecker<96>>(metadata);
+  } else if (key_size <= 128) {
+    return new OLCBTreeIndex<GenericKey<128>, ItemPointer, GenericComparator<128>,
+                             GenericEqualityChecker<128>>(metadata);
+  } else if (key_size <= 256) {
+    return new OLCBTreeIndex<GenericKey<256>, ItemPointer, GenericComparator<256>,
+                             GenericEqualityChecker<256>>(metadata);
+  } else if (key_size <= 512) {
+    return new OLCBTreeIndex<GenericKey<512>, ItemPointer, GenericComparator<512>,
+                             GenericEqualityChecker<512>>(metadata);
+  } else {
+    return new OLCBTreeIndex<TupleKey, ItemPointer, TupleKeyComparator,
+                             TupleKeyEqualityChecker>(metadata);
+  }
+}
+
+// Hash index for the given key size
+Index *GetHashInstance(IndexMetadata *metadata, size_t key_size,
+                       bool ints_only) {
+  if (ints_only) {
+    if (key_size <= sizeof(uint64_t)) {
+      return new HashIndex<IntsKey<1>, ItemPointer, IntsHasher<1>,
+                           IntsEqualityChecker<1>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 2) {
+      return new HashIndex<IntsKey<2>, ItemPointer, IntsHasher<2>,
+                           IntsEqualityChecker<2>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 3) {
+      return new HashIndex<IntsKey<3>, ItemPointer, IntsHasher<3>,
+                           IntsEqualityChecker<3>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 4) {
+      return new HashIndex<IntsKey<4>, ItemPointer, IntsHasher<4>,
+                           IntsEqualityChecker<4>>(metadata);
+    } else {
+      throw IndexException(
+          "We currently only support hash index on integer keys "
+          "of size 32 bytes or smaller...");
+    }
+  }
+
+  if (key_size <= 4) {
+    return new HashIndex<GenericKey<4>, ItemPointer, GenericHasher<4>,
+                         GenericEqualityChecker<4>>(metadata);
+  } else if (key_size <= 8) {
+    return new HashIndex<GenericKey<8>, ItemPointer, GenericHasher<8>,
+                         GenericEqualityChecker<8>>(metadata);
+  } else if (key_size <= 12) {
+    return new HashIndex<GenericKey<12>, ItemPointer, GenericHasher<12>,
+                         GenericEqualityChecker<12>>(metadata);
+  } else if (key_size <= 16) {
+    return new HashIndex<GenericKey<16>, ItemPointer, GenericHasher<16>,
+                         GenericEqualityChecker<16>>(metadata);
+  } else if (key_size <= 24) {
+    return new HashIndex<GenericKey<24>, ItemPointer, GenericHasher<24>,
+                         GenericEqualityChecker<24>>(metadata);
+  } else if (key_size <= 32) {
+    return new HashIndex<GenericKey<32>, ItemPointer, GenericHasher<32>,
+                         GenericEqualityChecker<32>>(metadata);
+  } else if (key_size <= 48) {
+    return new HashIndex<GenericKey<48>, ItemPointer, GenericHasher<48>,
+                         GenericEqualityChecker<48>>(metadata);
+  } else if (key_size <= 64) {
+    return new HashIndex<GenericKey<64>, ItemPointer, GenericHasher<64>,
+                         GenericEqualityChecker<64>>(metadata);
+  } else if (key_size <= 96) {
+    return new HashIndex<GenericKey<96>, ItemPointer, GenericHasher<96>,
+                         GenericEqualityChecker<96>>(metadata);
+  } else if (key_size <= 128) {
+    return new HashIndex<GenericKey<128>, ItemPointer, GenericHasher<128>,
+                         GenericEqualityChecker<128>>(metadata);
+  } else if (key_size <= 256) {
+    return new HashIndex<GenericKey<256>, ItemPointer, GenericHasher<256>,
+                         GenericEqualityChecker<256>>(metadata);
+  } else if (key_size <= 512) {
+    return new HashIndex<GenericKey<512>, ItemPointer, GenericHasher<512>,
+                         GenericEqualityChecker<512>>(metadata);
+  }
+
+  throw IndexException(
+      "We currently only support hash index on keys of size 512 bytes "
+      "or smaller...");
+}
+
+// Whether every key column is an integer, so that the key fits an IntsKey
+bool HasIntegerKeys(const catalog::Schema *key_schema) {
+  for (oid_t column_itr = 0; column_itr < key_schema->GetColumnCount();
+       column_itr++) {
+    switch (key_schema->GetType(column_itr)) {
+      case VALUE_TYPE_TINYINT:
+      case VALUE_TYPE_SMALLINT:
+      case VALUE_TYPE_INTEGER:
+      case VALUE_TYPE_BIGINT:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+// Adaptive radix tree index for the given key size
+Index *GetARTInstance(IndexMetadata *metadata, size_t key_size) {
+  if (HasIntegerKeys(metadata->GetKeySchema())) {
+    if (key_size <= sizeof(uint64_t)) {
+      return new ARTIndex<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                          IntsEqualityChecker<1>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 2) {
+      return new ARTIndex<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                          IntsEqualityChecker<2>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 3) {
+      return new ARTIndex<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                          IntsEqualityChecker<3>>(metadata);
+    } else if (key_size <= sizeof(int64_t) * 4) {
+      return new ARTIndex<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                          IntsEqualityChecker<4>>(metadata);
+    }
+  }
+
+  throw IndexException(
+      "We currently only support ART index on integer keys "
+      "of size 32 bytes or smaller...");
+}
+
+}  // End anonymous namespace
+
 Index *IndexFactory::GetInstance(IndexMetadata *metadata) {
   bool ints_only = false;
 
@@ -101,67 +345,23 @@ Index *IndexFactory::GetInstance(IndexMetadata *metadata) {
     }
   }
 
-  if (ints_only && (index_type == INDEX_TYPE_BWTREE)) {
-    if (key_size <= sizeof(uint64_t)) {
-      return new BWTreeIndex<IntsKey<1>, ItemPointer, IntsComparator<1>,
-                            IntsEqualityChecker<1>>(metadata);
-    } else if (key_size <= sizeof(int64_t) * 2) {
-      return new BWTreeIndex<IntsKey<2>, ItemPointer, IntsComparator<2>,
-                            IntsEqualityChecker<2>>(metadata);
-    } else if (key_size <= sizeof(int64_t) * 3) {
-      return new BWTreeIndex<IntsKey<3>, ItemPointer, IntsComparator<3>,
-                            IntsEqualityChecker<3>>(metadata);
-    } else if (key_size <= sizeof(int64_t) * 4) {
-      return new BWTreeIndex<IntsKey<4>, ItemPointer, IntsComparator<4>,
-                            IntsEqualityChecker<4>>(metadata);
-    } else {
-      throw IndexException(
-          "We currently only support tree index on non-unique "
-          "integer keys of size 32 bytes or smaller...");
-    }
+  if (index_type == INDEX_TYPE_BWTREE) {
+    // Unique indexes keep duplicates out of the tree itself
+    if (metadata->HasUniqueKeys())
+      return GetBWTreeInstance<false>(metadata, key_size, ints_only);
+    return GetBWTreeInstance<true>(metadata, key_size, ints_only);
   }
 
-  if (index_type == INDEX_TYPE_BWTREE) {
-    if (key_size <= 4) {
-      return new BWTreeIndex<GenericKey<4>, ItemPointer, GenericComparator<4>,
-                            GenericEqualityChecker<4>>(metadata);
-    } else if (key_size <= 8) {
-      return new BWTreeIndex<GenericKey<8>, ItemPointer, GenericComparator<8>,
-                            GenericEqualityChecker<8>>(metadata);
-    } else if (key_size <= 12) {
-      return new BWTreeIndex<GenericKey<12>, ItemPointer, GenericComparator<12>,
-                            GenericEqualityChecker<12>>(metadata);
-    } else if (key_size <= 16) {
-      return new BWTreeIndex<GenericKey<16>, ItemPointer, GenericComparator<16>,
-                            GenericEqualityChecker<16>>(metadata);
-    } else if (key_size <= 24) {
-      return new BWTreeIndex<GenericKey<24>, ItemPointer, GenericComparator<24>,
-                            GenericEqualityChecker<24>>(metadata);
-    } else if (key_size <= 32) {
-      return new BWTreeIndex<GenericKey<32>, ItemPointer, GenericComparator<32>,
-                            GenericEqualityChecker<32>>(metadata);
-    } else if (key_size <= 48) {
-      return new BWTreeIndex<GenericKey<48>, ItemPointer, GenericComparator<48>,
-                            GenericEqualityChecker<48>>(metadata);
-    } else if (key_size <= 64) {
-      return new BWTreeIndex<GenericKey<64>, ItemPointer, GenericComparator<64>,
-                            GenericEqualityChecker<64>>(metadata);
-    } else if (key_size <= 96) {
-      return new BWTreeIndex<GenericKey<96>, ItemPointer, GenericComparator<96>,
-                            GenericEqualityChecker<96>>(metadata);
-    } else if (key_size <= 128) {
-      return new BWTreeIndex<GenericKey<128>, ItemPointer, GenericComparator<128>,
-                            GenericEqualityChecker<128>>(metadata);
-    } else if (key_size <= 256) {
-      return new BWTreeIndex<GenericKey<256>, ItemPointer, GenericComparator<256>,
-                            GenericEqualityChecker<256>>(metadata);
-    } else if (key_size <= 512) {
-      return new BWTreeIndex<GenericKey<512>, ItemPointer, GenericComparator<512>,
-                            GenericEqualityChecker<512>>(metadata);
-    } else {
-      return new BWTreeIndex<TupleKey, ItemPointer, TupleKeyComparator,
-                            TupleKeyEqualityChecker>(metadata);
-    }
+  if (index_type == INDEX_TYPE_OLC_BTREE) {
+    return GetOLCBTreeInstance(metadata, key_size, ints_only);
+  }
+
+  if (index_type == INDEX_TYPE_HASH) {
+    return GetHashInstance(metadata, key_size, ints_only);
+  }
+
+  if (index_type == INDEX_TYPE_ART) {
+    return GetARTInstance(metadata, key_size);
   }
 
   throw IndexException("Unsupported index scheme.");
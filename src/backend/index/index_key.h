@@ -13,9 +13,15 @@
 #pragma once
 
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <sstream>
+#include <vector>
 
+#include "backend/common/value_factory.h"
 #include "backend/common/value_peeker.h"
 #include "backend/common/logger.h"
 #include "backend/storage/tuple.h"
@@ -215,6 +221,62 @@ class IntsKey {
     return std::string(buffer.str());
   }
 
+  /*
+   * Inverse of SetFromKey. Writes the key columns into an allocated tuple
+   * of the key schema.
+   */
+  inline void CopyToTuple(storage::Tuple *tuple) const {
+    const catalog::Schema *key_schema = tuple->GetSchema();
+    const int GetColumnCount = key_schema->GetColumnCount();
+    int key_offset = 0;
+    int intra_key_offset = sizeof(uint64_t) - 1;
+    for (int ii = 0; ii < GetColumnCount; ii++) {
+      switch (key_schema->GetColumn(ii).column_type) {
+        case VALUE_TYPE_BIGINT: {
+          const uint64_t key_value =
+              ExtractKeyValue<uint64_t>(key_offset, intra_key_offset);
+          tuple->SetValue(ii, ValueFactory::GetBigIntValue(
+                                  ConvertUnsignedValueToSignedValue<
+                                      int64_t, INT64_MAX>(key_value)),
+                          nullptr);
+          break;
+        }
+        case VALUE_TYPE_INTEGER: {
+          const uint64_t key_value =
+              ExtractKeyValue<uint32_t>(key_offset, intra_key_offset);
+          tuple->SetValue(ii, ValueFactory::GetIntegerValue(
+                                  ConvertUnsignedValueToSignedValue<
+                                      int32_t, INT32_MAX>(key_value)),
+                          nullptr);
+          break;
+        }
+        case VALUE_TYPE_SMALLINT: {
+          const uint64_t key_value =
+              ExtractKeyValue<uint16_t>(key_offset, intra_key_offset);
+          tuple->SetValue(ii, ValueFactory::GetSmallIntValue(
+                                  ConvertUnsignedValueToSignedValue<
+                                      int16_t, INT16_MAX>(key_value)),
+                          nullptr);
+          break;
+        }
+        case VALUE_TYPE_TINYINT: {
+          const uint64_t key_value =
+              ExtractKeyValue<uint8_t>(key_offset, intra_key_offset);
+          tuple->SetValue(ii, ValueFactory::GetTinyIntValue(
+                                  ConvertUnsignedValueToSignedValue<
+                                      int8_t, INT8_MAX>(key_value)),
+                          nullptr);
+          break;
+        }
+        default:
+          throw IndexException(
+              "We currently only support a specific set of "
+              "column index sizes...");
+          break;
+      }
+    }
+  }
+
   inline void SetFromKey(const storage::Tuple *tuple) {
     ::memset(data, 0, KeySize * sizeof(uint64_t));
     assert(tuple);
@@ -382,11 +444,11 @@ class IntsEqualityChecker {
  */
 template <std::size_t KeySize>
 struct IntsHasher : std::unary_function<IntsKey<KeySize>, std::size_t> {
-  IntsHasher(catalog::Schema *key_schema) {}
+  IntsHasher(index::IndexMetadata *metadata __attribute__((unused))) {}
 
   inline size_t operator()(IntsKey<KeySize> const &p) const {
     size_t seed = 0;
-    for (int ii = 0; ii < KeySize; ii++) {
+    for (size_t ii = 0; ii < KeySize; ii++) {
       boost::hash_combine(seed, p.data[ii]);
     }
     return seed;
@@ -426,44 +488,234 @@ class GenericKey {
 };
 
 /**
- * Function object returns true if lhs < rhs, used for trees
+ * Comparison plan for the GenericKeys of one key schema. Column offsets and
+ * types are looked up once; fixed-width columns are then compared with typed
+ * loads straight from the key bytes and only the rest go through Value.
  */
-template <std::size_t KeySize>
-class GenericComparator {
+class GenericKeyLayout {
  public:
-  /** Type information passed to the constuctor as it's not in the key itself */
-  GenericComparator(index::IndexMetadata *metadata)
-      : schema(metadata->GetKeySchema()) {}
-
-  inline bool operator()(const GenericKey<KeySize> &lhs,
-                         const GenericKey<KeySize> &rhs) const {
-    /*
-    storage::Tuple lhTuple(schema);
-    lhTuple.MoveToTuple(reinterpret_cast<const void *>(&lhs));
-    storage::Tuple rhTuple(schema);
-    rhTuple.MoveToTuple(reinterpret_cast<const void *>(&rhs));
-    // lexicographical compare could be faster for fixed N
-    int diff = lhTuple.Compare(rhTuple);
-    return diff < 0;
-    */
-
+  GenericKeyLayout(const catalog::Schema *schema)
+      : schema(schema), length(schema->GetLength()) {
     for (oid_t column_itr = 0; column_itr < schema->GetColumnCount();
          column_itr++) {
-      const Value lhs_value = lhs.ToValueFast(schema, column_itr);
-      const Value rhs_value = rhs.ToValueFast(schema, column_itr);
+      size_t end = (column_itr + 1 < schema->GetColumnCount())
+                       ? schema->GetOffset(column_itr + 1)
+                       : length;
+      columns.push_back(Column{column_itr, schema->GetType(column_itr),
+                               schema->GetOffset(column_itr), end});
+    }
 
-      int diff = lhs_value.Compare(rhs_value);
+    // NULL sorts first, so this is the smallest key there is
+    storage::Tuple null_tuple(schema, true);
+    null_tuple.SetAllNulls();
+    null_key.assign(null_tuple.GetData(), null_tuple.GetData() + length);
+  }
 
+  // Returns <0, 0 or >0 like Value::Compare, with NULL sorting first
+  inline int Compare(const char *lhs, const char *rhs) const {
+    for (const Column &column : columns) {
+      int diff = CompareColumn(column, lhs, rhs);
       if (diff) {
-        return diff < 0;
+        return diff;
       }
     }
 
     /* equal */
-    return false;
+    return 0;
+  }
+
+  // Bytes of a key that its columns take up, at most the size of the key
+  inline size_t GetLength() const { return length; }
+
+  // A key with all columns NULL, GetLength() bytes long
+  inline const char *GetNullKey() const { return null_key.data(); }
+
+  // Index of the first column the two keys differ in, the number of
+  // columns if they are equal
+  inline size_t GetFirstDifference(const char *lhs, const char *rhs) const {
+    size_t column_itr = 0;
+    while (column_itr < columns.size() &&
+           CompareColumn(columns[column_itr], lhs, rhs) == 0) {
+      column_itr++;
+    }
+    return column_itr;
+  }
+
+  // Where the given column ends in the key
+  inline size_t GetColumnEnd(size_t column_itr) const {
+    return columns[column_itr].end;
+  }
+
+  inline size_t GetColumnCount() const { return columns.size(); }
+
+  // Bytes up to the end of the last column that is not stored as NULL.
+  // Filling in the rest from GetNullKey() gives back the same key.
+  inline size_t GetSignificantLength(const char *data) const {
+    size_t column_itr = columns.size();
+    while (column_itr > 0) {
+      const Column &column = columns[column_itr - 1];
+      if (::memcmp(data + column.offset, &null_key[column.offset],
+                   column.end - column.offset) != 0) {
+        break;
+      }
+      column_itr--;
+    }
+    return column_itr > 0 ? columns[column_itr - 1].end : 0;
+  }
+
+  // Hash that agrees with Compare: keys that compare equal hash the same
+  inline size_t Hash(const char *data) const {
+    size_t seed = 0;
+    for (const Column &column : columns) {
+      const char *column_data = data + column.offset;
+
+      switch (column.type) {
+        case VALUE_TYPE_BOOLEAN:
+        case VALUE_TYPE_TINYINT:
+          HashFixed<int8_t>(seed, column_data);
+          break;
+        case VALUE_TYPE_SMALLINT:
+          HashFixed<int16_t>(seed, column_data);
+          break;
+        case VALUE_TYPE_INTEGER:
+          HashFixed<int32_t>(seed, column_data);
+          break;
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+          HashFixed<int64_t>(seed, column_data);
+          break;
+        case VALUE_TYPE_DOUBLE:
+          HashDouble(seed, column_data);
+          break;
+        default:
+          Value::InitFromTupleStorage(column_data, column.type,
+                                      schema->IsInlined(column.column_id))
+              .HashCombine(seed);
+          break;
+      }
+    }
+
+    return seed;
+  }
+
+ private:
+  struct Column {
+    oid_t column_id;
+    ValueType type;
+    size_t offset;
+    size_t end;
+  };
+
+  inline int CompareColumn(const Column &column, const char *lhs,
+                           const char *rhs) const {
+    const char *lhs_data = lhs + column.offset;
+    const char *rhs_data = rhs + column.offset;
+
+    switch (column.type) {
+      case VALUE_TYPE_BOOLEAN:
+      case VALUE_TYPE_TINYINT:
+        return CompareFixed<int8_t>(lhs_data, rhs_data);
+      case VALUE_TYPE_SMALLINT:
+        return CompareFixed<int16_t>(lhs_data, rhs_data);
+      case VALUE_TYPE_INTEGER:
+        return CompareFixed<int32_t>(lhs_data, rhs_data);
+      case VALUE_TYPE_BIGINT:
+      case VALUE_TYPE_TIMESTAMP:
+        return CompareFixed<int64_t>(lhs_data, rhs_data);
+      case VALUE_TYPE_DOUBLE:
+        return CompareDouble(lhs_data, rhs_data);
+      default:
+        return CompareValue(column, lhs_data, rhs_data);
+    }
+  }
+
+  // The NULL markers of the integer types are their minimum values, so the
+  // plain order of the stored integers already puts NULL first
+  template <typename T>
+  static inline int CompareFixed(const char *lhs_data, const char *rhs_data) {
+    T lhs_value, rhs_value;
+    ::memcpy(&lhs_value, lhs_data, sizeof(T));
+    ::memcpy(&rhs_value, rhs_data, sizeof(T));
+    return (lhs_value > rhs_value) - (lhs_value < rhs_value);
+  }
+
+  // Same order as Value: NULL, then NaN, then the numbers
+  static inline int CompareDouble(const char *lhs_data, const char *rhs_data) {
+    double lhs_value, rhs_value;
+    ::memcpy(&lhs_value, lhs_data, sizeof(double));
+    ::memcpy(&rhs_value, rhs_data, sizeof(double));
+
+    const bool lhs_null = lhs_value <= DOUBLE_NULL;
+    const bool rhs_null = rhs_value <= DOUBLE_NULL;
+    if (lhs_null || rhs_null) return rhs_null - lhs_null;
+
+    const bool lhs_nan = std::isnan(lhs_value);
+    const bool rhs_nan = std::isnan(rhs_value);
+    if (lhs_nan || rhs_nan) return rhs_nan - lhs_nan;
+
+    return (lhs_value > rhs_value) - (lhs_value < rhs_value);
+  }
+
+  template <typename T>
+  static inline void HashFixed(size_t &seed, const char *data) {
+    T value;
+    ::memcpy(&value, data, sizeof(T));
+    boost::hash_combine(seed, value);
+  }
+
+  // All NULLs, all NaNs and both zeros are equal to each other in Compare
+  static inline void HashDouble(size_t &seed, const char *data) {
+    double value;
+    ::memcpy(&value, data, sizeof(double));
+    if (value <= DOUBLE_NULL) {
+      value = DOUBLE_NULL;
+    } else if (std::isnan(value)) {
+      value = std::numeric_limits<double>::quiet_NaN();
+    } else if (value == 0) {
+      value = 0;
+    }
+    boost::hash_combine(seed, value);
+  }
+
+  inline int CompareValue(const Column &column, const char *lhs_data,
+                          const char *rhs_data) const {
+    const bool is_inlined = schema->IsInlined(column.column_id);
+    const Value lhs_value =
+        Value::InitFromTupleStorage(lhs_data, column.type, is_inlined);
+    const Value rhs_value =
+        Value::InitFromTupleStorage(rhs_data, column.type, is_inlined);
+    return lhs_value.Compare(rhs_value);
+  }
+
+  const catalog::Schema *schema;
+
+  size_t length;
+
+  std::vector<Column> columns;
+
+  std::vector<char> null_key;
+};
+
+/**
+ * Function object returns true if lhs < rhs, used for trees
+ */
+template <std::size_t KeySize>
+class GenericComparator {
+ public:
+  /** Type information passed to the constuctor as it's not in the key itself */
+  GenericComparator(index::IndexMetadata *metadata)
+      : schema(metadata->GetKeySchema()),
+        layout(std::make_shared<GenericKeyLayout>(schema)) {}
+
+  inline bool operator()(const GenericKey<KeySize> &lhs,
+                         const GenericKey<KeySize> &rhs) const {
+    return layout->Compare(lhs.data, rhs.data) < 0;
   }
 
   const catalog::Schema *schema;
+
+  // Shared so that copies of the comparator stay cheap
+  std::shared_ptr<const GenericKeyLayout> layout;
 };
 
 /**
@@ -474,18 +726,17 @@ class GenericEqualityChecker {
  public:
   /** Type information passed to the constuctor as it's not in the key itself */
   GenericEqualityChecker(index::IndexMetadata *metadata)
-      : schema(metadata->GetKeySchema()) {}
+      : schema(metadata->GetKeySchema()),
+        layout(std::make_shared<GenericKeyLayout>(schema)) {}
 
   inline bool operator()(const GenericKey<KeySize> &lhs,
                          const GenericKey<KeySize> &rhs) const {
-    storage::Tuple lhTuple(schema);
-    lhTuple.MoveToTuple(reinterpret_cast<const void *>(&lhs));
-    storage::Tuple rhTuple(schema);
-    rhTuple.MoveToTuple(reinterpret_cast<const void *>(&rhs));
-    return lhTuple.EqualsNoSchemaCheck(rhTuple);
+    return layout->Compare(lhs.data, rhs.data) == 0;
   }
 
   const catalog::Schema *schema;
+
+  std::shared_ptr<const GenericKeyLayout> layout;
 };
 
 /**
@@ -495,16 +746,17 @@ template <std::size_t KeySize>
 struct GenericHasher : std::unary_function<GenericKey<KeySize>, std::size_t> {
   /** Type information passed to the constuctor as it's not in the key itself */
   GenericHasher(index::IndexMetadata *metadata)
-      : schema(metadata->GetKeySchema()) {}
+      : schema(metadata->GetKeySchema()),
+        layout(std::make_shared<GenericKeyLayout>(schema)) {}
 
   /** Generate a 64-bit number for the key value */
   inline size_t operator()(GenericKey<KeySize> const &p) const {
-    storage::Tuple pTuple(schema);
-    pTuple.MoveToTuple(reinterpret_cast<const void *>(&p));
-    return pTuple.HashCode();
+    return layout->Hash(p.data);
   }
 
   const catalog::Schema *schema;
+
+  std::shared_ptr<const GenericKeyLayout> layout;
 };
 
 /*
@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// index_statistics.cpp
+//
+// Identification: src/backend/index/index_statistics.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+
+#include "backend/index/index_statistics.h"
+
+namespace peloton {
+namespace index {
+
+//===--------------------------------------------------------------------===//
+// Statistics Histogram
+//===--------------------------------------------------------------------===//
+
+size_t StatisticsHistogram::GetBucket(uint64_t value) {
+  size_t bucket = 0;
+  while (value != 0 && bucket < STATISTICS_HISTOGRAM_BUCKETS - 1) {
+    value >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+uint64_t StatisticsHistogram::GetBucketLimit(size_t bucket) {
+  if (bucket == STATISTICS_HISTOGRAM_BUCKETS - 1) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return (uint64_t(1) << bucket) - 1;
+}
+
+void StatisticsHistogram::Add(size_t bucket, uint64_t count, uint64_t sum,
+                              uint64_t max) {
+  buckets_[bucket] += count;
+  count_ += count;
+  sum_ += sum;
+  max_ = std::max(max_, max);
+}
+
+void StatisticsHistogram::Merge(const StatisticsHistogram &other) {
+  for (size_t bucket = 0; bucket < STATISTICS_HISTOGRAM_BUCKETS; bucket++) {
+    buckets_[bucket] += other.buckets_[bucket];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  max_ = std::max(max_, other.max_);
+}
+
+double StatisticsHistogram::GetMean() const {
+  if (count_ == 0) return 0;
+  return double(sum_) / count_;
+}
+
+uint64_t StatisticsHistogram::GetPercentile(double fraction) const {
+  uint64_t rank = uint64_t(fraction * count_);
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < STATISTICS_HISTOGRAM_BUCKETS; bucket++) {
+    seen += buckets_[bucket];
+    if (seen > rank) return std::min(GetBucketLimit(bucket), max_);
+  }
+  return max_;
+}
+
+//===--------------------------------------------------------------------===//
+// Index Statistics
+//===--------------------------------------------------------------------===//
+
+uint64_t IndexStatistics::GetCounter(const std::string &name) const {
+  auto counter = counters_.find(name);
+  if (counter == counters_.end()) return 0;
+  return counter->second;
+}
+
+StatisticsHistogram IndexStatistics::GetHistogram(
+    const std::string &name) const {
+  auto histogram = histograms_.find(name);
+  if (histogram == histograms_.end()) return StatisticsHistogram();
+  return histogram->second;
+}
+
+const std::string IndexStatistics::GetInfo() const {
+  std::ostringstream os;
+
+  for (auto &counter : counters_) {
+    os << std::setw(24) << std::left << counter.first << " : "
+       << counter.second << std::endl;
+  }
+
+  for (auto &histogram : histograms_) {
+    const StatisticsHistogram &values = histogram.second;
+    os << std::setw(24) << std::left << histogram.first << " : "
+       << "count " << values.GetCount() << " mean " << values.GetMean()
+       << " p50 " << values.GetPercentile(0.50) << " p99 "
+       << values.GetPercentile(0.99) << " max " << values.GetMax()
+       << std::endl;
+  }
+
+  return os.str();
+}
+
+//===--------------------------------------------------------------------===//
+// Concurrent recorders
+//===--------------------------------------------------------------------===//
+
+static std::atomic<size_t> next_stripe(0);
+
+size_t GetStatisticsStripe() {
+  static thread_local size_t stripe = next_stripe++ % STATISTICS_STRIPES;
+  return stripe;
+}
+
+uint64_t StatisticsCounter::Get() const {
+  uint64_t value = 0;
+  for (auto &stripe : stripes_) {
+    value += stripe.value_.load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+StatisticsHistogram ConcurrentHistogram::Get() const {
+  StatisticsHistogram histogram;
+  for (auto &stripe : stripes_) {
+    // The sum and max go with the first non-empty bucket
+    bool first_bucket = true;
+    for (size_t bucket = 0; bucket < STATISTICS_HISTOGRAM_BUCKETS; bucket++) {
+      uint64_t count = stripe.buckets_[bucket].load(std::memory_order_relaxed);
+      if (count == 0) continue;
+      histogram.Add(bucket, count,
+                    first_bucket ? stripe.sum_.load(std::memory_order_relaxed)
+                                 : 0,
+                    first_bucket ? stripe.max_.load(std::memory_order_relaxed)
+                                 : 0);
+      first_bucket = false;
+    }
+  }
+  return histogram;
+}
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// index_statistics.h
+//
+// Identification: src/backend/index/index_statistics.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <string>
+
+#include "backend/common/printable.h"
+
+#define STATISTICS_STRIPES 16  // # of per-thread copies of a counter
+#define STATISTICS_HISTOGRAM_BUCKETS 16  // power of two buckets
+
+namespace peloton {
+namespace index {
+
+//===--------------------------------------------------------------------===//
+// Statistics Histogram
+//===--------------------------------------------------------------------===//
+
+/**
+ * Distribution of non-negative values. Bucket 0 counts zeros and bucket i
+ * the values in [2^(i-1), 2^i), the last bucket also takes everything above.
+ */
+class StatisticsHistogram {
+ public:
+  static size_t GetBucket(uint64_t value);
+
+  // Largest value that falls into the bucket
+  static uint64_t GetBucketLimit(size_t bucket);
+
+  void Add(uint64_t value) { Add(GetBucket(value), 1, value, value); }
+
+  // Adds count values that fall into bucket, sum and max of which are known
+  void Add(size_t bucket, uint64_t count, uint64_t sum, uint64_t max);
+
+  void Merge(const StatisticsHistogram &other);
+
+  uint64_t GetCount() const { return count_; }
+
+  uint64_t GetMax() const { return max_; }
+
+  double GetMean() const;
+
+  // Upper bound of the value below which the fraction of values lie
+  uint64_t GetPercentile(double fraction) const;
+
+  uint64_t GetBucketCount(size_t bucket) const { return buckets_[bucket]; }
+
+ private:
+  uint64_t buckets_[STATISTICS_HISTOGRAM_BUCKETS] = {};
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+//===--------------------------------------------------------------------===//
+// Index Statistics
+//===--------------------------------------------------------------------===//
+
+/**
+ * Snapshot of the counters and histograms of an index, gathered on demand
+ * by Index::GetStatistics(). Names are up to the index type.
+ */
+class IndexStatistics : public Printable {
+ public:
+  void SetCounter(const std::string &name, uint64_t value) {
+    counters_[name] = value;
+  }
+
+  // Zero if the index does not keep that counter
+  uint64_t GetCounter(const std::string &name) const;
+
+  bool HasCounter(const std::string &name) const {
+    return counters_.count(name) != 0;
+  }
+
+  void SetHistogram(const std::string &name,
+                    const StatisticsHistogram &histogram) {
+    histograms_[name] = histogram;
+  }
+
+  // Empty if the index does not keep that histogram
+  StatisticsHistogram GetHistogram(const std::string &name) const;
+
+  const std::map<std::string, uint64_t> &GetCounters() const {
+    return counters_;
+  }
+
+  const std::map<std::string, StatisticsHistogram> &GetHistograms() const {
+    return histograms_;
+  }
+
+  // One line per counter and histogram
+  const std::string GetInfo() const;
+
+ private:
+  std::map<std::string, uint64_t> counters_;
+  std::map<std::string, StatisticsHistogram> histograms_;
+};
+
+//===--------------------------------------------------------------------===//
+// Concurrent recorders
+//===--------------------------------------------------------------------===//
+
+// Stripe of the calling thread. Threads are spread round robin, so with up
+// to STATISTICS_STRIPES threads no two of them share one.
+size_t GetStatisticsStripe();
+
+/**
+ * Counter that many threads bump at once. Each stripe sits on its own cache
+ * line, so updates are a relaxed add that is rarely contended, and reads
+ * sum up the stripes.
+ */
+class StatisticsCounter {
+ public:
+  inline void Add(uint64_t count = 1) {
+    stripes_[GetStatisticsStripe()].value_.fetch_add(
+        count, std::memory_order_relaxed);
+  }
+
+  uint64_t Get() const;
+
+ private:
+  struct Stripe {
+    std::atomic<uint64_t> value_{0};
+    char cache_line_padding_[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  Stripe stripes_[STATISTICS_STRIPES];
+};
+
+/**
+ * StatisticsHistogram that many threads add to at once, striped like
+ * StatisticsCounter.
+ */
+class ConcurrentHistogram {
+ public:
+  inline void Add(uint64_t value) {
+    Stripe &stripe = stripes_[GetStatisticsStripe()];
+    stripe.buckets_[StatisticsHistogram::GetBucket(value)].fetch_add(
+        1, std::memory_order_relaxed);
+    stripe.sum_.fetch_add(value, std::memory_order_relaxed);
+    if (value > stripe.max_.load(std::memory_order_relaxed)) {
+      stripe.max_.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  StatisticsHistogram Get() const;
+
+ private:
+  struct Stripe {
+    std::atomic<uint64_t> buckets_[STATISTICS_HISTOGRAM_BUCKETS];
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+    char cache_line_padding_[3 * 64 - (STATISTICS_HISTOGRAM_BUCKETS + 2) *
+                                          sizeof(std::atomic<uint64_t>)];
+
+    Stripe() : sum_(0), max_(0) {
+      for (auto &bucket : buckets_) bucket = 0;
+    }
+  };
+
+  Stripe stripes_[STATISTICS_STRIPES];
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,585 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// olc_btree.cpp
+//
+// Identification: src/backend/index/olc_btree.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/index/olc_btree.h"
+
+namespace peloton {
+namespace index {
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+         ValueComparator>::OLCBTree(const KeyComparator& comparator,
+                                    const KeyEqualityChecker& equals)
+    : comparator_(comparator), equals_(equals) {
+  // The tree starts out as a single empty leaf
+  LeafNode* root = new LeafNode(true);
+  AllocatedNode(root);
+  root_ = root;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+         ValueComparator>::~OLCBTree() {
+  FreeSubtree(root_);
+  for (auto& slot : epoch_slots_) {
+    for (auto& garbage : slot.garbage_nodes_) {
+      FreeNode(garbage.second);
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+bool OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::Insert(const KeyType& key,
+                                       const ValueType& value) {
+  EpochGuard guard(this);
+  auto goes_left = [&](const KeyType& entry_key, const ValueType& entry_value) {
+    return !EntryLess(entry_key, entry_value, key, value);
+  };
+
+  while (true) {
+    uint64_t version;
+    InnerNode* parent;
+    uint64_t parent_version;
+    SlotId parent_pos;
+    LeafNode* leaf = FindLeaf(goes_left, true, version, parent,
+                              parent_version, parent_pos, nullptr);
+    if (leaf == nullptr) continue;
+
+    SlotId count = leaf->GetCount();
+    SlotId pos = leaf->Search(count, goes_left);
+    bool exists = false;
+    if (pos < count) {
+      SlotId slot = leaf->GetSlot(pos);
+      exists = equals_(leaf->keys_[slot], key) &&
+               !value_comparator_(value, leaf->values_[slot]);
+    }
+    bool full = leaf->IsFull();
+    if (!leaf->Validate(version)) continue;
+
+    if (exists) return false;
+
+    if (full) {
+      // Make room and try again
+      if (parent != nullptr && !parent->UpgradeToWriteLock(parent_version))
+        continue;
+      if (!leaf->UpgradeToWriteLock(version)) {
+        if (parent != nullptr) parent->WriteUnlock();
+        continue;
+      }
+      SplitNode(leaf, parent, parent_pos);
+      continue;
+    }
+
+    if (!leaf->UpgradeToWriteLock(version)) continue;
+    leaf->Publish(pos, leaf->AddSlot(key, value));
+    leaf->WriteUnlock();
+    return true;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+bool OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::Delete(const KeyType& key,
+                                       const ValueType& value) {
+  EpochGuard guard(this);
+  auto goes_left = [&](const KeyType& entry_key, const ValueType& entry_value) {
+    return !EntryLess(entry_key, entry_value, key, value);
+  };
+
+  while (true) {
+    uint64_t version;
+    InnerNode* parent;
+    uint64_t parent_version;
+    SlotId parent_pos;
+    LeafNode* leaf = FindLeaf(goes_left, false, version, parent,
+                              parent_version, parent_pos, nullptr);
+    if (leaf == nullptr) continue;
+
+    SlotId count = leaf->GetCount();
+    SlotId pos = leaf->Search(count, goes_left);
+    bool exists = false;
+    if (pos < count) {
+      SlotId slot = leaf->GetSlot(pos);
+      exists = equals_(leaf->keys_[slot], key) &&
+               !value_comparator_(value, leaf->values_[slot]);
+    }
+
+    if (!exists) {
+      if (!leaf->Validate(version)) continue;
+      return false;
+    }
+
+    // Empty leaves are left in place, there are no merges
+    if (!leaf->UpgradeToWriteLock(version)) continue;
+    leaf->RemoveAt(pos);
+    leaf->WriteUnlock();
+    return true;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::ScanForward(const KeyType* low_key,
+                                            const ScanVisitor& visitor) {
+  EpochGuard guard(this);
+  std::vector<std::pair<KeyType, ValueType>> entries;
+
+  // After the first leaf, we go on right above its high fence
+  bool after_fence = false;
+  KeyType fence_key;
+  ValueType fence_value;
+
+  while (true) {
+    Fences fences;
+    entries.clear();
+    bool done;
+    if (after_fence) {
+      auto above_fence = [&](const KeyType& key, const ValueType& value) {
+        return EntryLess(fence_key, fence_value, key, value);
+      };
+      done = ReadLeaf(above_fence, above_fence, entries, fences);
+    } else if (low_key != nullptr) {
+      auto not_below = [&](const KeyType& key, const ValueType&) {
+        return !comparator_(key, *low_key);
+      };
+      done = ReadLeaf(not_below, not_below, entries, fences);
+    } else {
+      auto leftmost = [](const KeyType&, const ValueType&) { return true; };
+      done = ReadLeaf(leftmost, leftmost, entries, fences);
+    }
+    if (!done) continue;
+
+    // The fences point into immutable slots of nodes that are not freed
+    // before we deregister
+    bool last_leaf = (fences.high_key_ == nullptr);
+    if (!last_leaf) {
+      fence_key = *fences.high_key_;
+      fence_value = *fences.high_value_;
+      after_fence = true;
+    }
+
+    for (auto& entry : entries) {
+      if (!visitor(entry.first, entry.second)) return;
+    }
+    if (last_leaf) return;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::ScanBackward(const KeyType* high_key,
+                                             const ScanVisitor& visitor) {
+  EpochGuard guard(this);
+  std::vector<std::pair<KeyType, ValueType>> entries;
+
+  // After the first leaf, we go on with the leaf that holds its low fence
+  bool before_fence = false;
+  KeyType fence_key;
+  ValueType fence_value;
+
+  while (true) {
+    Fences fences;
+    entries.clear();
+    bool done;
+    if (before_fence) {
+      auto not_below_fence = [&](const KeyType& key, const ValueType& value) {
+        return !EntryLess(key, value, fence_key, fence_value);
+      };
+      auto not_above_fence = [&](const KeyType& key, const ValueType& value) {
+        return !EntryLess(fence_key, fence_value, key, value);
+      };
+      done = ReadLeaf(not_below_fence, not_above_fence, entries, fences);
+    } else if (high_key != nullptr) {
+      auto above = [&](const KeyType& key, const ValueType&) {
+        return comparator_(*high_key, key);
+      };
+      auto not_above = [&](const KeyType& key, const ValueType&) {
+        return !comparator_(*high_key, key);
+      };
+      done = ReadLeaf(above, not_above, entries, fences);
+    } else {
+      auto rightmost = [](const KeyType&, const ValueType&) { return false; };
+      auto all = [](const KeyType&, const ValueType&) { return true; };
+      done = ReadLeaf(rightmost, all, entries, fences);
+    }
+    if (!done) continue;
+
+    bool first_leaf = (fences.low_key_ == nullptr);
+    if (!first_leaf) {
+      fence_key = *fences.low_key_;
+      fence_value = *fences.low_value_;
+      before_fence = true;
+    }
+
+    for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+      if (!visitor(entry->first, entry->second)) return;
+    }
+    if (first_leaf) return;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+template <typename GoesLeft, typename InBound>
+bool OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::
+    ReadLeaf(const GoesLeft& goes_left, const InBound& in_bound,
+             std::vector<std::pair<KeyType, ValueType>>& entries,
+             Fences& fences) {
+  uint64_t version;
+  InnerNode* parent;
+  uint64_t parent_version;
+  SlotId parent_pos;
+  LeafNode* leaf = FindLeaf(goes_left, false, version, parent, parent_version,
+                            parent_pos, &fences);
+  if (leaf == nullptr) return false;
+
+  SlotId count = leaf->GetCount();
+  for (SlotId pos = 0; pos < count; pos++) {
+    SlotId slot = leaf->GetSlot(pos);
+    if (in_bound(leaf->keys_[slot], leaf->values_[slot])) {
+      entries.push_back(std::make_pair(leaf->keys_[slot], leaf->values_[slot]));
+    }
+  }
+
+  if (!leaf->Validate(version)) {
+    entries.clear();
+    return false;
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+template <typename GoesLeft>
+typename OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                  ValueComparator>::LeafNode*
+OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+         ValueComparator>::FindLeaf(const GoesLeft& goes_left, bool split_full,
+                                    uint64_t& leaf_version, InnerNode*& parent,
+                                    uint64_t& parent_version,
+                                    SlotId& parent_pos, Fences* fences) {
+  parent = nullptr;
+  parent_version = 0;
+  parent_pos = 0;
+
+  // A root that is replaced right after we load it is already locked or
+  // obsolete, or its version changes before we validate it
+  Node* node = root_.load();
+  uint64_t version;
+  if (!node->ReadLock(version)) return nullptr;
+
+  while (!node->is_leaf_) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+
+    // Split full nodes on the way down, so that their children always have
+    // room for one more separator
+    if (split_full && inner->IsFull()) {
+      if (parent != nullptr && !parent->UpgradeToWriteLock(parent_version))
+        return nullptr;
+      if (!inner->UpgradeToWriteLock(version)) {
+        if (parent != nullptr) parent->WriteUnlock();
+        return nullptr;
+      }
+      SplitNode(inner, parent, parent_pos);
+      return nullptr;
+    }
+
+    SlotId count = inner->GetCount();
+    SlotId pos = inner->Search(count, goes_left);
+    Node* child = inner->GetChild(pos, count);
+    if (fences != nullptr) {
+      if (pos > 0) {
+        SlotId slot = inner->GetSlot(pos - 1);
+        fences->low_key_ = &inner->keys_[slot];
+        fences->low_value_ = &inner->values_[slot];
+      }
+      if (pos < count) {
+        SlotId slot = inner->GetSlot(pos);
+        fences->high_key_ = &inner->keys_[slot];
+        fences->high_value_ = &inner->values_[slot];
+      }
+    }
+    if (!inner->Validate(version)) return nullptr;
+
+    uint64_t child_version;
+    if (!child->ReadLock(child_version)) return nullptr;
+    if (!inner->Validate(version)) return nullptr;
+
+    parent = inner;
+    parent_version = version;
+    parent_pos = pos;
+    node = child;
+    version = child_version;
+  }
+
+  leaf_version = version;
+  return node;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::SplitNode(Node* node, InnerNode* parent,
+                                          SlotId parent_pos) {
+  SlotId count = node->GetCount();
+
+  // Enough entries were deleted from the leaf that one node will do
+  if (node->is_leaf_ && count <= OLC_BTREE_NODE_SIZE / 2) {
+    Node* copy = CopyNode(node, 0, count);
+    if (parent == nullptr) {
+      root_ = copy;
+    } else {
+      parent->SetChild(parent_pos, copy);
+      parent->WriteUnlock();
+    }
+    node->WriteUnlockObsolete();
+    RetireNode(node);
+    return;
+  }
+
+  Node* lower_node;
+  Node* upper_node;
+  SlotId separator_slot;
+  if (node->is_leaf_) {
+    // The separator is the largest entry in the lower half
+    SlotId split_pos = count / 2;
+    lower_node = CopyNode(node, 0, split_pos);
+    upper_node = CopyNode(node, split_pos, count);
+    separator_slot = node->GetSlot(split_pos - 1);
+  } else {
+    // The separator moves up, its child becomes the last one of the lower
+    // half
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    SlotId split_pos = count / 2;
+    lower_node = CopyNode(node, 0, split_pos);
+    upper_node = CopyNode(node, split_pos + 1, count);
+    separator_slot = node->GetSlot(split_pos);
+    static_cast<InnerNode*>(lower_node)
+        ->last_child_.store(inner->children_[separator_slot].load());
+    static_cast<InnerNode*>(upper_node)
+        ->last_child_.store(inner->last_child_.load());
+  }
+  const KeyType& separator_key = node->keys_[separator_slot];
+  const ValueType& separator_value = node->values_[separator_slot];
+
+  if (parent == nullptr) {
+    InnerNode* new_root = new InnerNode();
+    AllocatedNode(new_root);
+    SlotId slot = new_root->AddSlot(separator_key, separator_value);
+    new_root->children_[slot].store(lower_node);
+    new_root->Publish(0, slot);
+    new_root->last_child_.store(upper_node);
+    root_ = new_root;
+  } else {
+    // The upper half takes the place of the node, and the lower half goes
+    // right before it
+    parent->SetChild(parent_pos, upper_node);
+    SlotId slot = parent->AddSlot(separator_key, separator_value);
+    parent->children_[slot].store(lower_node);
+    parent->Publish(parent_pos, slot);
+    parent->WriteUnlock();
+  }
+  node->WriteUnlockObsolete();
+  RetireNode(node);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+typename OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                  ValueComparator>::Node*
+OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+         ValueComparator>::CopyNode(const Node* node, SlotId begin,
+                                    SlotId end) {
+  Node* copy;
+  if (node->is_leaf_) {
+    copy = new LeafNode(true);
+  } else {
+    copy = new InnerNode();
+  }
+  AllocatedNode(copy);
+
+  for (SlotId pos = begin; pos < end; pos++) {
+    SlotId slot = node->GetSlot(pos);
+    SlotId new_slot = copy->AddSlot(node->keys_[slot], node->values_[slot]);
+    if (!node->is_leaf_) {
+      static_cast<InnerNode*>(copy)->children_[new_slot].store(
+          static_cast<const InnerNode*>(node)->children_[slot].load());
+    }
+    copy->Publish(pos - begin, new_slot);
+  }
+  return copy;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::FreeNode(Node* node) {
+  if (node->is_leaf_) {
+    memory_footprint_ -= sizeof(LeafNode);
+    delete node;
+  } else {
+    memory_footprint_ -= sizeof(InnerNode);
+    delete static_cast<InnerNode*>(node);
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::FreeSubtree(Node* node) {
+  if (!node->is_leaf_) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    SlotId count = inner->GetCount();
+    for (SlotId pos = 0; pos <= count; pos++) {
+      FreeSubtree(inner->GetChild(pos, count));
+    }
+  }
+  FreeNode(node);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+bool OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::Cleanup() {
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    ReclaimGarbage(i);
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+size_t OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+                ValueComparator>::GetMemoryFootprint() const {
+  return memory_footprint_;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::RegisterWorker() {
+  EpochSlot& slot = epoch_slots_[EpochThreadRegistry::GetThreadId()];
+  if (slot.depth_++ == 0) {
+    // Has to be visible before we read any node
+    slot.epoch_ = epoch_.load();
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::DeregisterWorker() {
+  EpochSlot& slot = epoch_slots_[EpochThreadRegistry::GetThreadId()];
+  assert(slot.depth_ > 0);
+  if (--slot.depth_ == 0) {
+    slot.epoch_ = QUIESCENT_EPOCH;
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::RetireNode(Node* node) {
+  size_t slot_id = EpochThreadRegistry::GetThreadId();
+  EpochSlot& slot = epoch_slots_[slot_id];
+
+  // Threads that register from now on can not reach the node anymore
+  uint64_t retire_epoch = epoch_++;
+
+  slot.garbage_lock_.Lock();
+  slot.garbage_nodes_.emplace_back(retire_epoch, node);
+  bool reclaim = slot.garbage_nodes_.size() >= EPOCH_GC_BATCH_SIZE;
+  slot.garbage_lock_.Unlock();
+
+  if (reclaim) {
+    ReclaimGarbage(slot_id);
+  }
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker, class ValueComparator>
+void OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker,
+              ValueComparator>::ReclaimGarbage(size_t slot_id) {
+  EpochSlot& slot = epoch_slots_[slot_id];
+  uint64_t safe_epoch = epoch_;
+  size_t max_thread_id = EpochThreadRegistry::GetMaxThreadId();
+  for (size_t i = 0; i < max_thread_id; ++i) {
+    uint64_t thread_epoch = epoch_slots_[i].epoch_;
+    if (thread_epoch < safe_epoch) safe_epoch = thread_epoch;
+  }
+
+  // Garbage is appended in epoch order, so we only need to cut off the front
+  std::vector<Node*> free_nodes;
+  slot.garbage_lock_.Lock();
+  auto nodes_end = slot.garbage_nodes_.begin();
+  while (nodes_end != slot.garbage_nodes_.end() &&
+         nodes_end->first < safe_epoch) {
+    free_nodes.push_back(nodes_end->second);
+    ++nodes_end;
+  }
+  slot.garbage_nodes_.erase(slot.garbage_nodes_.begin(), nodes_end);
+  slot.garbage_lock_.Unlock();
+
+  for (Node* node : free_nodes) {
+    FreeNode(node);
+  }
+}
+
+// Explicit template instantiation
+template class OLCBTree<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                        IntsEqualityChecker<1>>;
+template class OLCBTree<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                        IntsEqualityChecker<2>>;
+template class OLCBTree<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                        IntsEqualityChecker<3>>;
+template class OLCBTree<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                        IntsEqualityChecker<4>>;
+
+template class OLCBTree<GenericKey<4>, ItemPointer, GenericComparator<4>,
+                        GenericEqualityChecker<4>>;
+template class OLCBTree<GenericKey<8>, ItemPointer, GenericComparator<8>,
+                        GenericEqualityChecker<8>>;
+template class OLCBTree<GenericKey<12>, ItemPointer, GenericComparator<12>,
+                        GenericEqualityChecker<12>>;
+template class OLCBTree<GenericKey<16>, ItemPointer, GenericComparator<16>,
+                        GenericEqualityChecker<16>>;
+template class OLCBTree<GenericKey<24>, ItemPointer, GenericComparator<24>,
+                        GenericEqualityChecker<24>>;
+template class OLCBTree<GenericKey<32>, ItemPointer, GenericComparator<32>,
+                        GenericEqualityChecker<32>>;
+template class OLCBTree<GenericKey<48>, ItemPointer, GenericComparator<48>,
+                        GenericEqualityChecker<48>>;
+template class OLCBTree<GenericKey<64>, ItemPointer, GenericComparator<64>,
+                        GenericEqualityChecker<64>>;
+template class OLCBTree<GenericKey<96>, ItemPointer, GenericComparator<96>,
+                        GenericEqualityChecker<96>>;
+template class OLCBTree<GenericKey<128>, ItemPointer, GenericComparator<128>,
+                        GenericEqualityChecker<128>>;
+template class OLCBTree<GenericKey<256>, ItemPointer, GenericComparator<256>,
+                        GenericEqualityChecker<256>>;
+template class OLCBTree<GenericKey<512>, ItemPointer, GenericComparator<512>,
+                        GenericEqualityChecker<512>>;
+
+template class OLCBTree<TupleKey, ItemPointer, TupleKeyComparator,
+                        TupleKeyEqualityChecker>;
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,343 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// olc_btree.h
+//
+// Identification: src/backend/index/olc_btree.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "backend/common/types.h"
+#include "backend/common/platform.h"
+#include "backend/index/bwtree.h"
+#include "backend/index/index_key.h"
+
+#define OLC_BTREE_NODE_SIZE 64  // max # of entries in a node
+
+namespace peloton {
+namespace index {
+
+struct ItemPointerComparator {
+  bool operator()(const ItemPointer& l, const ItemPointer& r) const {
+    if (l.block != r.block) return l.block < r.block;
+    return l.offset < r.offset;
+  }
+};
+
+/**
+ * B+tree with optimistic lock coupling. Every node has a version latch:
+ * readers remember the version, read the node without writing to shared
+ * memory and check the version again afterwards, restarting from the root
+ * if it changed. Writers lock only the nodes they change, and nodes that
+ * are full are split on the way down so that a split never has to go up
+ * more than one level.
+ *
+ * Entries are <key, value> pairs ordered by key and then by value, so that
+ * all values of a key can be spread over several leaves like any other
+ * entries. Within a node, the entries are kept in slots that are written
+ * once and never change after; a small array of slot numbers gives their
+ * order. Readers thus never see a key that is half written, even if they
+ * are about to restart. Nodes that run out of slots are replaced by
+ * compacted or split copies, and retired nodes are freed once no thread
+ * that might still read them is registered in an older epoch.
+ */
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker,
+          class ValueComparator = ItemPointerComparator>
+class OLCBTree {
+ public:
+  OLCBTree(const KeyComparator& comparator, const KeyEqualityChecker& equals);
+  ~OLCBTree();
+
+  // Adds the entry, returns false if it is there already
+  bool Insert(const KeyType& key, const ValueType& value);
+
+  // Removes the entry, returns false if it is not there
+  bool Delete(const KeyType& key, const ValueType& value);
+
+  // Called for the entries in a scan until it returns false
+  typedef std::function<bool(const KeyType&, const ValueType&)> ScanVisitor;
+
+  // Visits the entries with a key >= low_key (all if it is null) in order
+  void ScanForward(const KeyType* low_key, const ScanVisitor& visitor);
+
+  // Visits the entries with a key <= high_key (all if it is null) in
+  // reverse order
+  void ScanBackward(const KeyType* high_key, const ScanVisitor& visitor);
+
+  // Frees all retired nodes that no thread can still be reading
+  bool Cleanup();
+
+  // Calculates the bytes of heap memory used
+  size_t GetMemoryFootprint() const;
+
+ private:
+  typedef uint16_t SlotId;
+
+  // ***** Nodes
+
+  class Node {
+   public:
+    // Bit 0 is set once the node has been replaced, bit 1 while it is
+    // locked. The rest counts the changes made to the node.
+    std::atomic<uint64_t> version_;
+
+    const bool is_leaf_;
+
+    // # of entries, their slots are order_[0] up to order_[count_ - 1]
+    std::atomic<SlotId> count_;
+
+    // # of slots handed out so far, only changed under the lock
+    std::atomic<SlotId> used_slots_;
+
+    std::atomic<SlotId> order_[OLC_BTREE_NODE_SIZE];
+
+    // Entry slots. In inner nodes, they hold the separators.
+    KeyType keys_[OLC_BTREE_NODE_SIZE];
+    ValueType values_[OLC_BTREE_NODE_SIZE];
+
+    explicit Node(bool is_leaf)
+        : version_(0), is_leaf_(is_leaf), count_(0), used_slots_(0) {}
+
+    // ***** Version latch
+
+    // Remembers the version, fails if the node is locked or obsolete
+    inline bool ReadLock(uint64_t& version) const {
+      version = version_.load(std::memory_order_acquire);
+      return (version & 3) == 0;
+    }
+
+    // Whether nothing changed since ReadLock() returned version
+    inline bool Validate(uint64_t version) const {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return version_.load(std::memory_order_relaxed) == version;
+    }
+
+    // Locks the node if nothing changed since ReadLock() returned version
+    inline bool UpgradeToWriteLock(uint64_t version) {
+      return version_.compare_exchange_strong(version, version + 2);
+    }
+
+    inline void WriteUnlock() { version_.fetch_add(2); }
+
+    // Unlocks a node that has been replaced, all readers will restart
+    inline void WriteUnlockObsolete() { version_.fetch_add(3); }
+
+    // ***** Entries
+
+    inline SlotId GetCount() const {
+      return count_.load(std::memory_order_acquire);
+    }
+
+    inline SlotId GetSlot(SlotId pos) const {
+      return order_[pos].load(std::memory_order_acquire);
+    }
+
+    inline bool IsFull() const {
+      return used_slots_.load(std::memory_order_relaxed) ==
+             OLC_BTREE_NODE_SIZE;
+    }
+
+    // Position of the first entry for which goes_left returns true, i.e.
+    // that is not below the target, or count if there is none
+    template <typename GoesLeft>
+    inline SlotId Search(SlotId count, const GoesLeft& goes_left) const {
+      SlotId low = 0;
+      SlotId high = count;
+      while (low < high) {
+        SlotId mid = (low + high) / 2;
+        SlotId slot = GetSlot(mid);
+        if (goes_left(keys_[slot], values_[slot])) {
+          high = mid;
+        } else {
+          low = mid + 1;
+        }
+      }
+      return low;
+    }
+
+    // Writes an entry into a new slot that is not visible yet. Needs the
+    // lock and a free slot.
+    inline SlotId AddSlot(const KeyType& key, const ValueType& value) {
+      SlotId slot = used_slots_.load(std::memory_order_relaxed);
+      keys_[slot] = key;
+      values_[slot] = value;
+      used_slots_.store(slot + 1, std::memory_order_relaxed);
+      return slot;
+    }
+
+    // Makes a new slot the entry at position pos. Needs the lock.
+    inline void Publish(SlotId pos, SlotId slot) {
+      SlotId count = count_.load(std::memory_order_relaxed);
+      for (SlotId itr = count; itr > pos; itr--) {
+        order_[itr].store(order_[itr - 1].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+      }
+      order_[pos].store(slot, std::memory_order_release);
+      count_.store(count + 1, std::memory_order_release);
+    }
+
+    // Drops the entry at position pos, its slot is not reused. Needs the
+    // lock.
+    inline void RemoveAt(SlotId pos) {
+      SlotId count = count_.load(std::memory_order_relaxed);
+      for (SlotId itr = pos; itr + 1 < count; itr++) {
+        order_[itr].store(order_[itr + 1].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+      }
+      count_.store(count - 1, std::memory_order_release);
+    }
+  };
+
+  typedef Node LeafNode;
+
+  // Child i holds the entries above separator i - 1 up to and including
+  // separator i, last_child_ the ones above all separators
+  class InnerNode : public Node {
+   public:
+    // Children by the slot of their separator
+    std::atomic<Node*> children_[OLC_BTREE_NODE_SIZE];
+
+    std::atomic<Node*> last_child_;
+
+    InnerNode() : Node(false), last_child_(nullptr) {}
+
+    // Child at position pos, last_child_ if pos is past the separators
+    inline Node* GetChild(SlotId pos, SlotId count) const {
+      if (pos == count) return last_child_.load(std::memory_order_acquire);
+      return children_[this->GetSlot(pos)].load(std::memory_order_acquire);
+    }
+
+    // Points the child at position pos to a new node. Needs the lock.
+    inline void SetChild(SlotId pos, Node* child) {
+      if (pos == this->GetCount()) {
+        last_child_.store(child, std::memory_order_release);
+      } else {
+        children_[this->GetSlot(pos)].store(child, std::memory_order_release);
+      }
+    }
+  };
+
+  // Separators around a leaf, pointing into the slots of its ancestors
+  struct Fences {
+    const KeyType* low_key_ = nullptr;
+    const ValueType* low_value_ = nullptr;
+    const KeyType* high_key_ = nullptr;
+    const ValueType* high_value_ = nullptr;
+  };
+
+  // ***** Functions for internal usage
+
+  inline bool EntryLess(const KeyType& lhs_key, const ValueType& lhs_value,
+                        const KeyType& rhs_key,
+                        const ValueType& rhs_value) const {
+    if (comparator_(lhs_key, rhs_key)) return true;
+    if (comparator_(rhs_key, lhs_key)) return false;
+    return value_comparator_(lhs_value, rhs_value);
+  }
+
+  // Descends to the leaf that holds the target, where goes_left tells
+  // whether the target is not above an entry. Returns nullptr if the
+  // traversal has to restart, and the read version of the leaf and its
+  // parent otherwise. Inner nodes that are full are split along the way if
+  // split_full is set.
+  template <typename GoesLeft>
+  LeafNode* FindLeaf(const GoesLeft& goes_left, bool split_full,
+                     uint64_t& leaf_version, InnerNode*& parent,
+                     uint64_t& parent_version, SlotId& parent_pos,
+                     Fences* fences);
+
+  // Replaces a full node by a compacted or split copy. Both the node and
+  // its parent (if it is not the root) are locked, and both are unlocked
+  // again when done.
+  void SplitNode(Node* node, InnerNode* parent, SlotId parent_pos);
+
+  // Copies the entries at positions [begin, end) of a node into a new one
+  Node* CopyNode(const Node* node, SlotId begin, SlotId end);
+
+  // Finds the leaf that holds the target of goes_left and copies its
+  // entries for which in_bound returns true. Returns false if the traversal
+  // has to restart.
+  template <typename GoesLeft, typename InBound>
+  bool ReadLeaf(const GoesLeft& goes_left, const InBound& in_bound,
+                std::vector<std::pair<KeyType, ValueType>>& entries,
+                Fences& fences);
+
+  inline void AllocatedNode(const Node* node) {
+    memory_footprint_ += node->is_leaf_ ? sizeof(LeafNode) : sizeof(InnerNode);
+  }
+
+  void FreeNode(Node* node);
+
+  // Frees a whole subtree, only used when no other thread is around
+  void FreeSubtree(Node* node);
+
+  // ***** Epoch based reclamation
+
+  void RegisterWorker();
+  void DeregisterWorker();
+
+  // Frees a replaced node once no thread can still be reading it
+  void RetireNode(Node* node);
+
+  void ReclaimGarbage(size_t slot_id);
+
+  // Registers the calling thread for the scope of an operation
+  class EpochGuard {
+   public:
+    explicit EpochGuard(OLCBTree* tree) : tree_(tree) {
+      tree_->RegisterWorker();
+    }
+    ~EpochGuard() { tree_->DeregisterWorker(); }
+
+   private:
+    OLCBTree* tree_;
+  };
+
+  // ***** Members
+
+  std::atomic<Node*> root_;
+
+  KeyComparator comparator_;
+  KeyEqualityChecker equals_;
+  ValueComparator value_comparator_;
+
+  std::atomic<size_t> memory_footprint_{0};
+
+  std::atomic<uint64_t> epoch_{0};
+
+  static constexpr uint64_t QUIESCENT_EPOCH =
+      std::numeric_limits<uint64_t>::max();
+
+  // Padded like the epoch slots of the BWTree
+  struct EpochSlot {
+    // Epoch the thread registered in, QUIESCENT_EPOCH if it isn't registered
+    std::atomic<uint64_t> epoch_{QUIESCENT_EPOCH};
+
+    // Nesting depth of RegisterWorker(), only touched by the owner
+    uint32_t depth_ = 0;
+
+    // Nodes retired by the thread, with the epoch they were retired in
+    std::vector<std::pair<uint64_t, Node*>> garbage_nodes_;
+
+    // Only contended when Cleanup() reclaims on behalf of the owner
+    Spinlock garbage_lock_;
+
+    char cache_line_padding_[64];
+  };
+
+  EpochSlot epoch_slots_[EPOCH_MAX_THREADS];
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,329 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// olc_btree_index.cpp
+//
+// Identification: src/backend/index/olc_btree_index.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "backend/common/logger.h"
+#include "backend/index/olc_btree_index.h"
+#include "backend/index/index_key.h"
+#include "backend/storage/tuple.h"
+
+namespace peloton {
+namespace index {
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+OLCBTreeIndex<KeyType, ValueType, KeyComparator,
+              KeyEqualityChecker>::OLCBTreeIndex(IndexMetadata *metadata)
+    : Index(metadata),
+      container(KeyComparator(metadata), KeyEqualityChecker(metadata)),
+      equals(metadata),
+      comparator(metadata) {}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+OLCBTreeIndex<KeyType, ValueType, KeyComparator,
+              KeyEqualityChecker>::~OLCBTreeIndex() {}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+bool OLCBTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    InsertEntry(const storage::Tuple *key, const ItemPointer location) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  // Insert the key, val pair
+  return container.Insert(index_key, location);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+bool OLCBTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    DeleteEntry(const storage::Tuple *key, const ItemPointer location) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  // Delete the key, val pair
+  return container.Delete(index_key, location);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+template <typename Visitor>
+void OLCBTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    ScanMatches(const std::vector<Value> &values,
+                const std::vector<oid_t> &key_column_ids,
+                const std::vector<ExpressionType> &expr_types,
+                const ScanDirectionType &scan_direction, BatchState *batch,
+                const Visitor &visitor) {
+  const catalog::Schema *key_schema = metadata->GetKeySchema();
+
+  // Constraints on the leading key column tell us where the matching keys
+  // start and end, so that we only visit that part of the tree
+  const Value *low_value;
+  const Value *high_value;
+  GetLeadingColumnBounds(values, key_column_ids, expr_types, low_value,
+                         high_value);
+
+  // Later batches start where the last one stopped
+  const KeyType *resume_key =
+      (batch != nullptr) ? batch->GetResumeKey() : nullptr;
+
+  // Hands a match to the visitor, returns false once the batch is full
+  bool stopped = false;
+  auto emit = [&](const KeyType &key, const storage::Tuple &tuple,
+                  const ItemPointer &location) {
+    if (batch != nullptr) {
+      if (batch->IsFull()) {
+        stopped = true;
+        return false;
+      }
+      if (!batch->Admit(key)) return true;
+    }
+    visitor(tuple, location);
+    return true;
+  };
+
+  switch (scan_direction) {
+    case SCAN_DIRECTION_TYPE_FORWARD: {
+      std::unique_ptr<storage::Tuple> start_tuple;
+      KeyType start_key;
+      if (resume_key != nullptr) {
+        start_key = *resume_key;
+      } else if (low_value != nullptr) {
+        start_tuple.reset(new storage::Tuple(key_schema, true));
+        ConstructLeadingColumnTuple(start_tuple.get(), *low_value);
+        start_key.SetFromKey(start_tuple.get());
+      }
+
+      // Scan the index entries in forward direction
+      container.ScanForward(
+          (resume_key != nullptr || low_value != nullptr) ? &start_key
+                                                          : nullptr,
+          [&](const KeyType &key, const ItemPointer &location) {
+            auto scan_current_key = key;
+            auto tuple = scan_current_key.GetTupleForComparison(key_schema);
+
+            // We are past the end of the range
+            if (high_value != nullptr &&
+                tuple.GetValue(0).Compare(*high_value) ==
+                    VALUE_COMPARE_GREATERTHAN)
+              return false;
+
+            // Compare the current key in the scan with "values" based on
+            // "expression types"
+            // For instance, "5" EXPR_GREATER_THAN "2" is true
+            if (Compare(tuple, key_column_ids, expr_types, values) == true)
+              return emit(key, tuple, location);
+            return true;
+          });
+    } break;
+
+    case SCAN_DIRECTION_TYPE_BACKWARD: {
+      auto visit = [&](const KeyType &key, const ItemPointer &location) {
+        auto scan_current_key = key;
+        auto tuple = scan_current_key.GetTupleForComparison(key_schema);
+
+        // We are past the start of the range
+        if (low_value != nullptr &&
+            tuple.GetValue(0).Compare(*low_value) == VALUE_COMPARE_LESSTHAN)
+          return false;
+
+        if (Compare(tuple, key_column_ids, expr_types, values) == true)
+          return emit(key, tuple, location);
+        return true;
+      };
+
+      if (resume_key != nullptr || high_value == nullptr) {
+        container.ScanBackward(resume_key, visit);
+        break;
+      }
+
+      // We can only build the smallest key with the leading value, so the
+      // keys above it that still have that value are collected first
+      std::unique_ptr<storage::Tuple> end_tuple(
+          new storage::Tuple(key_schema, true));
+      ConstructLeadingColumnTuple(end_tuple.get(), *high_value);
+      KeyType end_key;
+      end_key.SetFromKey(end_tuple.get());
+
+      std::vector<std::pair<KeyType, ItemPointer>> upper_entries;
+      container.ScanForward(
+          &end_key, [&](const KeyType &key, const ItemPointer &location) {
+            auto scan_current_key = key;
+            auto tuple = scan_current_key.GetTupleForComparison(key_schema);
+            if (tuple.GetValue(0).Compare(*high_value) ==
+                VALUE_COMPARE_GREATERTHAN)
+              return false;
+            if (!equals(key, end_key))
+              upper_entries.push_back(std::make_pair(key, location));
+            return true;
+          });
+
+      bool go_on = true;
+      for (auto entry = upper_entries.rbegin();
+           go_on && entry != upper_entries.rend(); ++entry) {
+        go_on = visit(entry->first, entry->second);
+      }
+      if (go_on) container.ScanBackward(&end_key, visit);
+    } break;
+
+    case SCAN_DIRECTION_TYPE_INVALID:
+    default:
+      throw Exception("Invalid scan direction \n");
+      break;
+  }
+
+  if (batch != nullptr) batch->Finish(!stopped, key_schema, GetPool());
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+OLCBTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::Scan(
+    const std::vector<Value> &values, const std::vector<oid_t> &key_column_ids,
+    const std::vector<ExpressionType> &expr_types,
+    const ScanDirectionType &scan_direction) {
+  std::vector<ItemPointer> result;
+
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, nullptr,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+OLCBTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    ScanBatch(const std::vector<Value> &values,
+              const std::vector<oid_t> &key_column_ids,
+              const std::vector<ExpressionType> &expr_types,
+              const ScanDirectionType &scan_direction, size_t max_count,
+              ScanCursor &cursor) {
+  std::vector<ItemPointer> result;
+  if (cursor.done) return result;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              [&](const storage::Tuple &, const ItemPointer &location) {
+                result.push_back(location);
+              });
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+void OLCBTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::
+    ScanEntries(const std::vector<Value> &values,
+                const std::vector<oid_t> &key_column_ids,
+                const std::vector<ExpressionType> &expr_types,
+                const ScanDirectionType &scan_direction, size_t max_count,
+                ScanCursor &cursor, const EntryVisitor &visitor) {
+  if (cursor.done) return;
+
+  BatchState batch(cursor, max_count, equals);
+  ScanMatches(values, key_column_ids, expr_types, scan_direction, &batch,
+              visitor);
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer> OLCBTreeIndex<KeyType, ValueType, KeyComparator,
+                                       KeyEqualityChecker>::ScanAllKeys() {
+  std::vector<ItemPointer> result;
+
+  container.ScanForward(nullptr,
+                        [&](const KeyType &, const ItemPointer &location) {
+                          result.push_back(location);
+                          return true;
+                        });
+
+  return result;
+}
+
+/**
+ * @brief Return all locations related to this key.
+ */
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::vector<ItemPointer>
+OLCBTreeIndex<KeyType, ValueType, KeyComparator, KeyEqualityChecker>::ScanKey(
+    const storage::Tuple *key) {
+  std::vector<ItemPointer> result;
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  // The values of a key are next to each other
+  container.ScanForward(
+      &index_key, [&](const KeyType &key, const ItemPointer &location) {
+        if (!equals(key, index_key)) return false;
+        result.push_back(location);
+        return true;
+      });
+
+  return result;
+}
+
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+std::string OLCBTreeIndex<KeyType, ValueType, KeyComparator,
+                          KeyEqualityChecker>::GetTypeName() const {
+  return "OLCBTree";
+}
+
+// Explicit template instantiation
+template class OLCBTreeIndex<IntsKey<1>, ItemPointer, IntsComparator<1>,
+                             IntsEqualityChecker<1>>;
+template class OLCBTreeIndex<IntsKey<2>, ItemPointer, IntsComparator<2>,
+                             IntsEqualityChecker<2>>;
+template class OLCBTreeIndex<IntsKey<3>, ItemPointer, IntsComparator<3>,
+                             IntsEqualityChecker<3>>;
+template class OLCBTreeIndex<IntsKey<4>, ItemPointer, IntsComparator<4>,
+                             IntsEqualityChecker<4>>;
+
+template class OLCBTreeIndex<GenericKey<4>, ItemPointer, GenericComparator<4>,
+                             GenericEqualityChecker<4>>;
+template class OLCBTreeIndex<GenericKey<8>, ItemPointer, GenericComparator<8>,
+                             GenericEqualityChecker<8>>;
+template class OLCBTreeIndex<GenericKey<12>, ItemPointer, GenericComparator<12>,
+                             GenericEqualityChecker<12>>;
+template class OLCBTreeIndex<GenericKey<16>, ItemPointer, GenericComparator<16>,
+                             GenericEqualityChecker<16>>;
+template class OLCBTreeIndex<GenericKey<24>, ItemPointer, GenericComparator<24>,
+                             GenericEqualityChecker<24>>;
+template class OLCBTreeIndex<GenericKey<32>, ItemPointer, GenericComparator<32>,
+                             GenericEqualityChecker<32>>;
+template class OLCBTreeIndex<GenericKey<48>, ItemPointer, GenericComparator<48>,
+                             GenericEqualityChecker<48>>;
+template class OLCBTreeIndex<GenericKey<64>, ItemPointer, GenericComparator<64>,
+                             GenericEqualityChecker<64>>;
+template class OLCBTreeIndex<GenericKey<96>, ItemPointer, GenericComparator<96>,
+                             GenericEqualityChecker<96>>;
+template class OLCBTreeIndex<GenericKey<128>, ItemPointer,
+                             GenericComparator<128>,
+                             GenericEqualityChecker<128>>;
+template class OLCBTreeIndex<GenericKey<256>, ItemPointer,
+                             GenericComparator<256>,
+                             GenericEqualityChecker<256>>;
+template class OLCBTreeIndex<GenericKey<512>, ItemPointer,
+                             GenericComparator<512>,
+                             GenericEqualityChecker<512>>;
+
+template class OLCBTreeIndex<TupleKey, ItemPointer, TupleKeyComparator,
+                             TupleKeyEqualityChecker>;
+
+}  // End index namespace
+}  // End peloton namespace
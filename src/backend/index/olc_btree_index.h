@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// olc_btree_index.h
+//
+// Identification: src/backend/index/olc_btree_index.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+#include <string>
+
+#include "backend/catalog/manager.h"
+#include "backend/common/platform.h"
+#include "backend/common/types.h"
+#include "backend/index/index.h"
+#include "backend/index/batch_scan_state.h"
+
+#include "backend/index/olc_btree.h"
+
+namespace peloton {
+namespace index {
+
+/**
+ * B+tree index with optimistic lock coupling. Readers do not write to
+ * shared memory and writers only lock the nodes they change, so unlike
+ * BTreeIndex there is no index-wide lock.
+ *
+ * @see Index
+ */
+template <typename KeyType, typename ValueType, class KeyComparator,
+          class KeyEqualityChecker>
+class OLCBTreeIndex : public Index {
+  friend class IndexFactory;
+
+  typedef OLCBTree<KeyType, ValueType, KeyComparator, KeyEqualityChecker>
+      MapType;
+
+ public:
+  OLCBTreeIndex(IndexMetadata *metadata);
+
+  ~OLCBTreeIndex();
+
+  bool InsertEntry(const storage::Tuple *key, const ItemPointer location);
+
+  bool DeleteEntry(const storage::Tuple *key, const ItemPointer location);
+
+  std::vector<ItemPointer> Scan(const std::vector<Value> &values,
+                                const std::vector<oid_t> &key_column_ids,
+                                const std::vector<ExpressionType> &expr_types,
+                                const ScanDirectionType &scan_direction);
+
+  bool SupportsIndexOnlyScan() const { return true; }
+
+  std::vector<ItemPointer> ScanBatch(
+      const std::vector<Value> &values,
+      const std::vector<oid_t> &key_column_ids,
+      const std::vector<ExpressionType> &expr_types,
+      const ScanDirectionType &scan_direction, size_t max_count,
+      ScanCursor &cursor);
+
+  void ScanEntries(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType &scan_direction, size_t max_count,
+                   ScanCursor &cursor, const EntryVisitor &visitor);
+
+  std::vector<ItemPointer> ScanAllKeys();
+
+  std::vector<ItemPointer> ScanKey(const storage::Tuple *key);
+
+  std::string GetTypeName() const;
+
+  bool Cleanup() { return container.Cleanup(); }
+
+  size_t GetMemoryFootprint() { return container.GetMemoryFootprint(); }
+
+ protected:
+  typedef BatchScanState<KeyType, KeyEqualityChecker> BatchState;
+
+  // Calls visitor with the key tuple and location of every entry that
+  // matches the scan, or only of those in the batch if there is one
+  template <typename Visitor>
+  void ScanMatches(const std::vector<Value> &values,
+                   const std::vector<oid_t> &key_column_ids,
+                   const std::vector<ExpressionType> &expr_types,
+                   const ScanDirectionType &scan_direction, BatchState *batch,
+                   const Visitor &visitor);
+
+  // container
+  MapType container;
+
+  // equality checker and comparator
+  KeyEqualityChecker equals;
+  KeyComparator comparator;
+};
+
+}  // End index namespace
+}  // End peloton namespace
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// index_scan_plan.cpp
+//
+// Identification: src/backend/planner/index_scan_plan.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/planner/index_scan_plan.h"
+
+#include <algorithm>
+
+#include "backend/catalog/schema.h"
+#include "backend/index/index.h"
+
+namespace peloton {
+namespace planner {
+
+IndexScanPlan::IndexScanPlan(storage::DataTable *table,
+                             expression::AbstractExpression *predicate,
+                             const std::vector<oid_t> &column_ids,
+                             const IndexScanDesc &index_scan_desc)
+    : AbstractScan(table, predicate, column_ids),
+      index_(index_scan_desc.index),
+      column_ids_(column_ids),
+      key_column_ids_(std::move(index_scan_desc.key_column_ids)),
+      expr_types_(std::move(index_scan_desc.expr_types)),
+      values_(std::move(index_scan_desc.values)),
+      runtime_keys_(std::move(index_scan_desc.runtime_keys)) {
+  // The predicate refers to table columns, so it needs the base tuples
+  if (index_ == nullptr || predicate != nullptr || column_ids_.empty() ||
+      !index_->SupportsIndexOnlyScan())
+    return;
+
+  // Table column of each key column
+  auto indexed_columns = index_->GetKeySchema()->GetIndexedColumns();
+
+  std::vector<oid_t> output_key_columns;
+  for (auto column_id : column_ids_) {
+    auto key_column_itr = std::find(indexed_columns.begin(),
+                                    indexed_columns.end(), column_id);
+    if (key_column_itr == indexed_columns.end()) return;
+    output_key_columns.push_back(
+        std::distance(indexed_columns.begin(), key_column_itr));
+  }
+
+  output_key_columns_ = std::move(output_key_columns);
+}
+
+}  // namespace planner
+}  // namespace peloton
@@ -67,14 +67,7 @@ class IndexScanPlan : public AbstractScan {
   IndexScanPlan(storage::DataTable *table,
                 expression::AbstractExpression *predicate,
                 const std::vector<oid_t> &column_ids,
-                const IndexScanDesc &index_scan_desc)
-      : AbstractScan(table, predicate, column_ids),
-        index_(index_scan_desc.index),
-        column_ids_(column_ids),
-        key_column_ids_(std::move(index_scan_desc.key_column_ids)),
-        expr_types_(std::move(index_scan_desc.expr_types)),
-        values_(std::move(index_scan_desc.values)),
-        runtime_keys_(std::move(index_scan_desc.runtime_keys)) {}
+                const IndexScanDesc &index_scan_desc);
 
   ~IndexScanPlan() {
     for (auto expr : runtime_keys_) {
@@ -103,6 +96,15 @@ class IndexScanPlan : public AbstractScan {
     return runtime_keys_;
   }
 
+  // Whether the index key holds all output columns, so that the scan can
+  // read them from the index instead of the table
+  bool IsIndexOnlyScan() const { return !output_key_columns_.empty(); }
+
+  // Position in the index key of each output column for index-only scans
+  const std::vector<oid_t> &GetOutputKeyColumns() const {
+    return output_key_columns_;
+  }
+
   inline PlanNodeType GetPlanNodeType() const {
     return PLAN_NODE_TYPE_INDEXSCAN;
   }
@@ -122,6 +124,9 @@ class IndexScanPlan : public AbstractScan {
   const std::vector<Value> values_;
 
   const std::vector<expression::AbstractExpression *> runtime_keys_;
+
+  /** @brief Key columns of the output, empty if the index does not cover it. */
+  std::vector<oid_t> output_key_columns_;
 };
 
 }  // namespace planner
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <mutex>
 #include <utility>
 
@@ -41,8 +42,8 @@ bool peloton_fsm;
 namespace peloton {
 namespace storage {
 
-bool ContainsVisibleEntry(std::vector<ItemPointer> &locations,
-                          const concurrency::Transaction *transaction);
+bool IsVisibleEntry(const ItemPointer &location,
+                    const concurrency::Transaction *transaction);
 
 DataTable::DataTable(catalog::Schema *schema, std::string table_name,
                      oid_t database_oid, oid_t table_oid,
@@ -57,6 +58,10 @@ DataTable::DataTable(catalog::Schema *schema, std::string table_name,
     default_partition[col_itr] = std::make_pair(0, col_itr);
   }
 
+  for (auto &active_tile_group : active_tile_groups) {
+    active_tile_group = nullptr;
+  }
+
   // Create a tile group.
   AddDefaultTileGroup();
 }
@@ -84,28 +89,21 @@ DataTable::~DataTable() {
 }
 
 /**
- * Check if the locations contains at least one visible entry to the transaction
+ * Check if the entry at the location is visible to the transaction
  */
-bool ContainsVisibleEntry(std::vector<ItemPointer> &locations,
-                          const concurrency::Transaction *transaction) {
+bool IsVisibleEntry(const ItemPointer &location,
+                    const concurrency::Transaction *transaction) {
   auto &manager = catalog::Manager::GetInstance();
 
-  for (auto loc : locations) {
-    oid_t tile_group_id = loc.block;
-    oid_t tuple_offset = loc.offset;
-
-    auto tile_group = manager.GetTileGroup(tile_group_id);
-    auto header = tile_group->GetHeader();
+  oid_t tile_group_id = location.block;
+  oid_t tuple_offset = location.offset;
 
-    auto transaction_id = transaction->GetTransactionId();
-    auto last_commit_id = transaction->GetLastCommitId();
-    bool visible =
-        header->IsVisible(tuple_offset, transaction_id, last_commit_id);
+  auto tile_group = manager.GetTileGroup(tile_group_id);
+  auto header = tile_group->GetHeader();
 
-    if (visible) return true;
-  }
-
-  return false;
+  auto transaction_id = transaction->GetTransactionId();
+  auto last_commit_id = transaction->GetLastCommitId();
+  return header->IsVisible(tuple_offset, transaction_id, last_commit_id);
 }
 
 //===--------------------------------------------------------------------===//
@@ -140,43 +138,55 @@ bool DataTable::CheckConstraints(const storage::Tuple *tuple) const {
   return true;
 }
 
+/**
+ * Active tile group slot of the calling thread. Threads are handed slots
+ * round robin.
+ */
+static size_t GetActiveSlot() {
+  static std::atomic<size_t> next_active_slot(0);
+  static thread_local size_t active_slot =
+      next_active_slot++ % ACTIVE_TILE_GROUP_COUNT;
+  return active_slot;
+}
+
 ItemPointer DataTable::GetTupleSlot(const concurrency::Transaction *transaction,
                                     const storage::Tuple *tuple) {
   assert(tuple);
 
   if (CheckConstraints(tuple) == false) return INVALID_ITEMPOINTER;
 
-  std::shared_ptr<storage::TileGroup> tile_group;
+  storage::TileGroup *tile_group = nullptr;
   oid_t tuple_slot = INVALID_OID;
-  oid_t tile_group_offset = INVALID_OID;
   oid_t tile_group_id = INVALID_OID;
   auto transaction_id = transaction->GetTransactionId();
+  size_t active_slot = GetActiveSlot();
 
   LOG_TRACE("DataTable :: transaction_id %lu \n", transaction_id);
 
   while (tuple_slot == INVALID_OID) {
-    // First, figure out last tile group
-    {
-      std::lock_guard<std::mutex> lock(table_mutex);
-      assert(GetTileGroupCount() > 0);
-      tile_group_offset = GetTileGroupCount() - 1;
-      LOG_TRACE("Tile group offset :: %lu ", tile_group_offset);
+    // First, figure out the tile group this thread inserts into. Slots
+    // freed up by the vacuum are reused before the table grows.
+    bool reusing = false;
+    if (reusable_tile_group_count.load(std::memory_order_relaxed) > 0) {
+      tile_group = GetReusableTileGroup();
+      reusing = (tile_group != nullptr);
     }
+    if (reusing == false) tile_group = GetActiveTileGroup(active_slot);
 
     // Then, try to grab a slot in the tile group header
-    tile_group = GetTileGroup(tile_group_offset);
-
     tuple_slot = tile_group->InsertTuple(transaction_id, tuple);
     tile_group_id = tile_group->GetTileGroupId();
 
     if (tuple_slot == INVALID_OID) {
-      // XXX Should we put this in a critical section?
-      AddDefaultTileGroup();
+      if (reusing)
+        DropReusableTileGroup(tile_group);
+      else
+        AddDefaultTileGroup(active_slot);
     }
   }
 
-  LOG_INFO("tile group offset: %lu, tile group id: %lu, address: %p",
-           tile_group_offset, tile_group->GetTileGroupId(), tile_group.get());
+  LOG_INFO("active slot: %lu, tile group id: %lu, address: %p", active_slot,
+           tile_group_id, tile_group);
 
   // Set tuple location
   ItemPointer location(tile_group_id, tuple_slot);
@@ -190,6 +200,9 @@ ItemPointer DataTable::GetTupleSlot(const concurrency::Transaction *transaction,
 
 ItemPointer DataTable::InsertTuple(const concurrency::Transaction *transaction,
                                    const storage::Tuple *tuple) {
+  // An index that is being populated either sees the slot or gets the entry
+  PelotonReadLock index_build_read_lock(index_build_lock);
+
   // First, do integrity checks and claim a slot
   ItemPointer location = GetTupleSlot(transaction, tuple);
   if (location.block == INVALID_OID) {
@@ -213,6 +226,67 @@ ItemPointer DataTable::InsertTuple(const concurrency::Transaction *transaction,
   return location;
 }
 
+/**
+ * @brief Insert a batch of tuples. Each tile group the batch lands in gets
+ * one slot reservation and is filled tile by tile, and every non-unique
+ * index gets one bulk insert.
+ *
+ * @returns The tuple locations in order, empty if a constraint is violated.
+ * Nothing of a rejected batch is left in the table or its indexes then.
+ */
+std::vector<ItemPointer> DataTable::InsertTuples(
+    const concurrency::Transaction *transaction,
+    const std::vector<const storage::Tuple *> &tuples) {
+  std::vector<ItemPointer> locations;
+  if (tuples.empty()) return locations;
+
+  // First, do integrity checks
+  for (auto tuple : tuples) {
+    assert(tuple);
+    if (CheckConstraints(tuple) == false) return locations;
+  }
+
+  // Then, claim slots, as many per tile group as still fit
+  PelotonReadLock index_build_read_lock(index_build_lock);
+  auto transaction_id = transaction->GetTransactionId();
+  size_t active_slot = GetActiveSlot();
+  locations.reserve(tuples.size());
+
+  while (locations.size() < tuples.size()) {
+    storage::TileGroup *tile_group = GetActiveTileGroup(active_slot);
+
+    oid_t inserted_count = 0;
+    oid_t first_slot = tile_group->InsertTuples(
+        transaction_id, tuples, locations.size(), inserted_count);
+
+    if (first_slot == INVALID_OID) {
+      AddDefaultTileGroup(active_slot);
+      continue;
+    }
+
+    oid_t tile_group_id = tile_group->GetTileGroupId();
+    for (oid_t tuple_itr = 0; tuple_itr < inserted_count; tuple_itr++) {
+      locations.push_back(ItemPointer(tile_group_id, first_slot + tuple_itr));
+    }
+
+    LOG_TRACE("Inserted %lu tuples at %lu, %lu", inserted_count,
+              tile_group_id, first_slot);
+  }
+
+  // Index checks and updates. On a conflict the index entries of the batch
+  // are gone already, and nobody else can see the slots yet.
+  if (InsertInIndexes(transaction, tuples, locations) == false) {
+    LOG_WARN("Index constraint violated");
+    ReleaseTupleSlots(locations);
+    return std::vector<ItemPointer>();
+  }
+
+  IncreaseNumberOfTuplesBy(tuples.size());
+  for (auto index : indexes) index->IncreaseNumberOfTuplesBy(tuples.size());
+
+  return locations;
+}
+
 /**
  * @brief Insert a tuple into all indexes. If index is primary/unique,
  * check visibility of existing
@@ -227,21 +301,27 @@ bool DataTable::InsertInIndexes(const concurrency::Transaction *transaction,
                                 ItemPointer location) {
   int index_count = GetIndexCount();
 
-  // (A) Check existence for primary/unique indexes
-  // FIXME Since this is NOT protected by a lock, concurrent insert may happen.
+  // An existing entry only conflicts if the transaction can see it
+  auto predicate = [transaction](const ItemPointer &entry) {
+    return IsVisibleEntry(entry, transaction);
+  };
+
+  // (A) Check existence and insert into primary/unique indexes. The index
+  // does both in one go, so that no concurrent insert can get in between.
+  // If a later index rejects the tuple, the entries added before point to a
+  // tuple that never becomes visible.
   for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
     auto index = GetIndex(index_itr);
-    auto index_schema = index->GetKeySchema();
-    auto indexed_columns = index_schema->GetIndexedColumns();
-    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
-    key->SetFromTuple(tuple, indexed_columns, index->GetPool());
-
     switch (index->GetIndexType()) {
       case INDEX_CONSTRAINT_TYPE_PRIMARY_KEY:
       case INDEX_CONSTRAINT_TYPE_UNIQUE: {
-        auto locations = index->ScanKey(key.get());
-        auto exist_visible = ContainsVisibleEntry(locations, transaction);
-        if (exist_visible) {
+        auto index_schema = index->GetKeySchema();
+        auto indexed_columns = index_schema->GetIndexedColumns();
+        std::unique_ptr<storage::Tuple> key(
+            new storage::Tuple(index_schema, true));
+        key->SetFromTuple(tuple, indexed_columns, index->GetPool());
+
+        if (index->CondInsertEntry(key.get(), location, predicate) == false) {
           LOG_WARN("A visible index entry exists.");
           return false;
         }
@@ -254,9 +334,14 @@ bool DataTable::InsertInIndexes(const concurrency::Transaction *transaction,
     LOG_INFO("Index constraint check on %s passed.", index->GetName().c_str());
   }
 
-  // (B) Insert into index
+  // (B) Insert into the other indexes
   for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
     auto index = GetIndex(index_itr);
+    auto index_type = index->GetIndexType();
+    if (index_type == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY ||
+        index_type == INDEX_CONSTRAINT_TYPE_UNIQUE)
+      continue;
+
     auto index_schema = index->GetKeySchema();
     auto indexed_columns = index_schema->GetIndexedColumns();
     std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
@@ -270,6 +355,87 @@ bool DataTable::InsertInIndexes(const concurrency::Transaction *transaction,
   return true;
 }
 
+bool DataTable::InsertInIndexes(const concurrency::Transaction *transaction,
+                                const std::vector<const Tuple *> &tuples,
+                                const std::vector<ItemPointer> &locations) {
+  assert(tuples.size() == locations.size());
+  int index_count = GetIndexCount();
+
+  auto predicate = [transaction](const ItemPointer &entry) {
+    return IsVisibleEntry(entry, transaction);
+  };
+
+  // Removes the entries of the first tuple_count tuples from index
+  auto remove_entries = [&](index::Index *index, size_t tuple_count) {
+    auto index_schema = index->GetKeySchema();
+    auto indexed_columns = index_schema->GetIndexedColumns();
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+    for (size_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      key->SetFromTuple(tuples[tuple_itr], indexed_columns, index->GetPool());
+      index->DeleteEntry(key.get(), locations[tuple_itr]);
+    }
+  };
+
+  // (A) Check existence and insert into primary/unique indexes, tuple by
+  // tuple, as a tuple may also conflict with an earlier one of the batch.
+  // On a conflict, the entries added for the batch so far are taken out.
+  std::vector<index::Index *> unique_indexes;
+  for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
+    auto index = GetIndex(index_itr);
+    auto index_type = index->GetIndexType();
+    if (index_type != INDEX_CONSTRAINT_TYPE_PRIMARY_KEY &&
+        index_type != INDEX_CONSTRAINT_TYPE_UNIQUE)
+      continue;
+
+    auto index_schema = index->GetKeySchema();
+    auto indexed_columns = index_schema->GetIndexedColumns();
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+
+    for (size_t tuple_itr = 0; tuple_itr < tuples.size(); tuple_itr++) {
+      key->SetFromTuple(tuples[tuple_itr], indexed_columns, index->GetPool());
+      if (index->CondInsertEntry(key.get(), locations[tuple_itr], predicate) ==
+          false) {
+        LOG_WARN("A visible index entry exists.");
+        remove_entries(index, tuple_itr);
+        for (auto unique_index : unique_indexes)
+          remove_entries(unique_index, tuples.size());
+        return false;
+      }
+    }
+    unique_indexes.push_back(index);
+  }
+
+  // (B) Insert the whole batch into each of the other indexes at once
+  for (int index_itr = index_count - 1; index_itr >= 0; --index_itr) {
+    auto index = GetIndex(index_itr);
+    auto index_type = index->GetIndexType();
+    if (index_type == INDEX_CONSTRAINT_TYPE_PRIMARY_KEY ||
+        index_type == INDEX_CONSTRAINT_TYPE_UNIQUE)
+      continue;
+
+    auto index_schema = index->GetKeySchema();
+    auto indexed_columns = index_schema->GetIndexedColumns();
+
+    std::vector<std::unique_ptr<storage::Tuple>> keys;
+    std::vector<std::pair<const storage::Tuple *, ItemPointer>> entries;
+    keys.reserve(tuples.size());
+    entries.reserve(tuples.size());
+    for (size_t tuple_itr = 0; tuple_itr < tuples.size(); tuple_itr++) {
+      std::unique_ptr<storage::Tuple> key(
+          new storage::Tuple(index_schema, true));
+      key->SetFromTuple(tuples[tuple_itr], indexed_columns, index->GetPool());
+      entries.push_back(std::make_pair(key.get(), locations[tuple_itr]));
+      keys.push_back(std::move(key));
+    }
+
+    auto status = index->InsertEntries(entries);
+    (void)status;
+    assert(status);
+  }
+
+  return true;
+}
+
 //===--------------------------------------------------------------------===//
 // DELETE
 //===--------------------------------------------------------------------===//
@@ -309,6 +475,131 @@ bool DataTable::DeleteTuple(const concurrency::Transaction *transaction,
   return true;
 }
 
+//===--------------------------------------------------------------------===//
+// VACUUM
+//===--------------------------------------------------------------------===//
+
+/**
+ * @brief Reclaim the slots of dead versions. Their index entries are
+ * removed before the slot goes on the free list of its tile group, so no
+ * index lookup can end up at a reused slot.
+ *
+ * @param oldest_cid Oldest last commit id of the running transactions.
+ * @return Number of slots reclaimed.
+ */
+size_t DataTable::Vacuum(cid_t oldest_cid) {
+  std::lock_guard<std::mutex> vacuum_lock(vacuum_mutex);
+  PelotonReadLock index_build_read_lock(index_build_lock);
+  size_t reclaimed_count = 0;
+
+  oid_t tile_group_count = GetTileGroupCount();
+  for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+       tile_group_itr++) {
+    auto tile_group = GetTileGroup(tile_group_itr);
+    auto header = tile_group->GetHeader();
+    oid_t tile_group_id = tile_group->GetTileGroupId();
+    size_t tile_group_reclaimed_count = 0;
+
+    oid_t tuple_count = header->GetNextTupleSlot();
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      if (header->ClaimDeadTupleSlot(tuple_itr, oldest_cid) == false)
+        continue;
+
+      DeleteInIndexes(tile_group.get(), ItemPointer(tile_group_id, tuple_itr));
+      header->ReclaimTupleSlot(tuple_itr);
+      tile_group_reclaimed_count++;
+    }
+
+    if (tile_group_reclaimed_count == 0) continue;
+    reclaimed_count += tile_group_reclaimed_count;
+
+    // The freed values may have been the bounds of the zone map
+    tile_group->InvalidateZoneMap();
+    AddReusableTileGroup(tile_group.get());
+  }
+
+  if (reclaimed_count > 0) {
+    LOG_TRACE("Vacuumed %lu slots of table %s", reclaimed_count,
+              GetName().c_str());
+    for (auto index : indexes) index->DecreaseNumberOfTuplesBy(reclaimed_count);
+  }
+
+  return reclaimed_count;
+}
+
+void DataTable::DeleteInIndexes(TileGroup *tile_group, ItemPointer location) {
+  for (auto index : indexes) {
+    auto index_schema = index->GetKeySchema();
+    auto indexed_columns = index_schema->GetIndexedColumns();
+
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(index_schema, true));
+    for (oid_t column_itr = 0; column_itr < indexed_columns.size();
+         column_itr++) {
+      key->SetValue(
+          column_itr,
+          tile_group->GetValue(location.offset, indexed_columns[column_itr]),
+          index->GetPool());
+    }
+
+    index->DeleteEntry(key.get(), location);
+  }
+}
+
+void DataTable::ReleaseTupleSlots(const std::vector<ItemPointer> &locations) {
+  std::shared_ptr<TileGroup> tile_group;
+  for (auto location : locations) {
+    if (tile_group == nullptr ||
+        tile_group->GetTileGroupId() != location.block) {
+      if (tile_group != nullptr) {
+        tile_group->InvalidateZoneMap();
+        AddReusableTileGroup(tile_group.get());
+      }
+      tile_group = GetTileGroupById(location.block);
+    }
+
+    auto header = tile_group->GetHeader();
+    header->SetTransactionId(location.offset, INVALID_TXN_ID);
+    header->ReclaimTupleSlot(location.offset);
+  }
+
+  if (tile_group != nullptr) {
+    tile_group->InvalidateZoneMap();
+    AddReusableTileGroup(tile_group.get());
+  }
+}
+
+void DataTable::AddReusableTileGroup(TileGroup *tile_group) {
+  reusable_tile_group_lock.Lock();
+  if (std::find(reusable_tile_groups.begin(), reusable_tile_groups.end(),
+                tile_group) == reusable_tile_groups.end()) {
+    reusable_tile_groups.push_back(tile_group);
+    reusable_tile_group_count = reusable_tile_groups.size();
+  }
+  reusable_tile_group_lock.Unlock();
+}
+
+TileGroup *DataTable::GetReusableTileGroup() {
+  TileGroup *tile_group = nullptr;
+
+  reusable_tile_group_lock.Lock();
+  if (reusable_tile_groups.empty() == false) {
+    tile_group = reusable_tile_groups.front();
+  }
+  reusable_tile_group_lock.Unlock();
+
+  return tile_group;
+}
+
+void DataTable::DropReusableTileGroup(TileGroup *tile_group) {
+  reusable_tile_group_lock.Lock();
+  if (reusable_tile_groups.empty() == false &&
+      reusable_tile_groups.front() == tile_group) {
+    reusable_tile_groups.pop_front();
+    reusable_tile_group_count = reusable_tile_groups.size();
+  }
+  reusable_tile_group_lock.Unlock();
+}
+
 //===--------------------------------------------------------------------===//
 // STATS
 //===--------------------------------------------------------------------===//
@@ -427,7 +718,25 @@ column_map_type DataTable::GetTileGroupLayout(LayoutType layout_type) {
   return column_map;
 }
 
-oid_t DataTable::AddDefaultTileGroup() {
+TileGroup *DataTable::GetActiveTileGroup(size_t active_slot) {
+  TileGroup *tile_group = active_tile_groups[active_slot];
+  if (tile_group != nullptr) return tile_group;
+
+  {
+    std::lock_guard<std::mutex> lock(table_mutex);
+
+    tile_group = active_tile_groups[active_slot];
+    if (tile_group == nullptr) {
+      assert(GetTileGroupCount() > 0);
+      tile_group = GetTileGroup(GetTileGroupCount() - 1).get();
+      active_tile_groups[active_slot] = tile_group;
+    }
+  }
+
+  return tile_group;
+}
+
+oid_t DataTable::AddDefaultTileGroup(size_t active_slot) {
   column_map_type column_map;
   oid_t tile_group_id = INVALID_OID;
 
@@ -452,19 +761,21 @@ oid_t DataTable::AddDefaultTileGroup() {
       // add tile group metadata in locator
       catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
       LOG_TRACE("Recording tile group : %lu ", tile_group_id);
+      active_tile_groups[active_slot] = tile_group.get();
       return tile_group_id;
     }
 
-    // (B) no slots in last tile group in table
-    auto last_tile_group_offset = GetTileGroupCount() - 1;
-    auto last_tile_group = GetTileGroup(last_tile_group_offset);
-
-    oid_t active_tuple_count = last_tile_group->GetNextTupleSlot();
-    oid_t allocated_tuple_count = last_tile_group->GetAllocatedTupleCount();
-    if (active_tuple_count < allocated_tuple_count) {
-      LOG_TRACE("Slot exists in last tile group :: %lu %lu ",
-                active_tuple_count, allocated_tuple_count);
-      return INVALID_OID;
+    // (B) no slots in the tile group of the active slot, unless another
+    // thread of the slot replaced it already
+    auto active_tile_group = active_tile_groups[active_slot].load();
+    if (active_tile_group != nullptr) {
+      oid_t active_tuple_count = active_tile_group->GetNextTupleSlot();
+      oid_t allocated_tuple_count = active_tile_group->GetAllocatedTupleCount();
+      if (active_tuple_count < allocated_tuple_count) {
+        LOG_TRACE("Slot exists in active tile group :: %lu %lu ",
+                  active_tuple_count, allocated_tuple_count);
+        return INVALID_OID;
+      }
     }
 
     LOG_TRACE("Added a tile group ");
@@ -473,6 +784,7 @@ oid_t DataTable::AddDefaultTileGroup() {
     // add tile group metadata in locator
     catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
     LOG_TRACE("Recording tile group : %lu ", tile_group_id);
+    active_tile_groups[active_slot] = tile_group.get();
   }
 
   return tile_group_id;
@@ -505,6 +817,11 @@ oid_t DataTable::AddTileGroupWithOid(oid_t tile_group_id) {
     // add tile group metadata in locator
     catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
     LOG_TRACE("Recording tile group : %lu ", tile_group_id);
+
+    // inserts move on to the new tile group
+    for (auto &active_tile_group : active_tile_groups) {
+      active_tile_group = nullptr;
+    }
   }
 
   return tile_group_id;
@@ -520,6 +837,11 @@ void DataTable::AddTileGroup(const std::shared_ptr<TileGroup> &tile_group) {
     // add tile group in catalog
     catalog::Manager::GetInstance().AddTileGroup(tile_group_id, tile_group);
     LOG_TRACE("Recording tile group : %lu ", tile_group_id);
+
+    // inserts move on to the new tile group
+    for (auto &active_tile_group : active_tile_groups) {
+      active_tile_group = nullptr;
+    }
   }
 }
 
@@ -589,6 +911,54 @@ void DataTable::AddIndex(index::Index *index) {
   }
 }
 
+bool DataTable::PopulateIndex(index::Index *index) {
+  // No insert may claim a slot between the scan and adding the index
+  PelotonWriteLock index_build_write_lock(index_build_lock);
+
+  auto index_schema = index->GetKeySchema();
+  auto indexed_columns = index_schema->GetIndexedColumns();
+
+  // Every version that has not been deleted gets an entry, the same as
+  // if it had been inserted with the index in place
+  std::vector<std::unique_ptr<storage::Tuple>> keys;
+  std::vector<std::pair<const storage::Tuple *, ItemPointer>> entries;
+
+  oid_t tile_group_count = GetTileGroupCount();
+  for (oid_t tile_group_itr = 0; tile_group_itr < tile_group_count;
+       tile_group_itr++) {
+    auto tile_group = GetTileGroup(tile_group_itr);
+    auto header = tile_group->GetHeader();
+    oid_t tile_group_id = tile_group->GetTileGroupId();
+
+    oid_t tuple_count = header->GetNextTupleSlot();
+    for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+      if (header->GetTransactionId(tuple_itr) == INVALID_TXN_ID ||
+          header->GetEndCommitId(tuple_itr) != MAX_CID)
+        continue;
+
+      std::unique_ptr<storage::Tuple> key(
+          new storage::Tuple(index_schema, true));
+      for (oid_t column_itr = 0; column_itr < indexed_columns.size();
+           column_itr++) {
+        key->SetValue(column_itr,
+                      tile_group->GetValue(tuple_itr,
+                                           indexed_columns[column_itr]),
+                      index->GetPool());
+      }
+
+      entries.push_back(
+          std::make_pair(key.get(), ItemPointer(tile_group_id, tuple_itr)));
+      keys.push_back(std::move(key));
+    }
+  }
+
+  if (index->BulkLoad(entries) == false) return false;
+  index->SetNumberOfTuples(entries.size());
+
+  AddIndex(index);
+  return true;
+}
+
 index::Index *DataTable::GetIndexWithOid(const oid_t index_oid) const {
   for (auto index : indexes)
     if (index->GetOid() == index_oid) return index;
@@ -729,6 +1099,8 @@ void SetTransformedTileGroup(storage::TileGroup *orig_tile_group,
   auto header = orig_tile_group->GetHeader();
   auto new_header = new_tile_group->GetHeader();
   *new_header = *header;
+
+  new_tile_group->InvalidateZoneMap();
 }
 
 storage::TileGroup *DataTable::TransformTileGroup(oid_t tile_group_offset,
@@ -12,11 +12,13 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 
 #include "backend/brain/sample.h"
 #include "backend/bridge/ddl/bridge.h"
 #include "backend/catalog/foreign_key.h"
+#include "backend/common/platform.h"
 #include "backend/storage/abstract_table.h"
 #include "backend/concurrency/transaction.h"
 
@@ -48,6 +50,9 @@ extern bool peloton_fsm;
 
 extern std::vector<peloton::oid_t> hyadapt_column_ids;
 
+// # of tile groups of a table that take inserts at the same time
+#define ACTIVE_TILE_GROUP_COUNT 8
+
 namespace peloton {
 
 typedef std::map<oid_t, std::pair<oid_t, oid_t>> column_map_type;
@@ -98,10 +103,24 @@ class DataTable : public AbstractTable {
   ItemPointer InsertTuple(const concurrency::Transaction *transaction,
                           const Tuple *tuple);
 
+  // insert tuples in table, filling contiguous slots of a tile group.
+  // returns their locations, or nothing if any of them can't be inserted.
+  std::vector<ItemPointer> InsertTuples(
+      const concurrency::Transaction *transaction,
+      const std::vector<const Tuple *> &tuples);
+
   // delete the tuple at given location
   bool DeleteTuple(const concurrency::Transaction *transaction,
                    ItemPointer location);
 
+  //===--------------------------------------------------------------------===//
+  // VACUUM
+  //===--------------------------------------------------------------------===//
+
+  // reclaim the slots of versions deleted at or before oldest_cid, which no
+  // transaction can see anymore. returns the # of slots reclaimed.
+  size_t Vacuum(cid_t oldest_cid);
+
   //===--------------------------------------------------------------------===//
   // TILE GROUP
   //===--------------------------------------------------------------------===//
@@ -131,6 +150,12 @@ class DataTable : public AbstractTable {
 
   void AddIndex(index::Index *index);
 
+  // Fills a new (still empty) index with the tuples already in the table and
+  // adds it to the table. Inserts wait meanwhile, so that none of them is
+  // missed. Returns false, without adding the index, if the index does not
+  // take the tuples, e.g. a unique index over duplicate keys.
+  bool PopulateIndex(index::Index *index);
+
   index::Index *GetIndexWithOid(const oid_t index_oid) const;
 
   void DropIndexWithOid(const oid_t index_oid);
@@ -214,8 +239,26 @@ class DataTable : public AbstractTable {
   ItemPointer GetTupleSlot(const concurrency::Transaction *transaction,
                            const storage::Tuple *tuple);
 
-  // add a default unpartitioned tile group to table
-  oid_t AddDefaultTileGroup();
+  // add a default unpartitioned tile group to table, which takes the inserts
+  // of the given active slot from then on
+  oid_t AddDefaultTileGroup(size_t active_slot = 0);
+
+  // tile group the active slot inserts into, the last one of the table if
+  // the slot doesn't have one yet
+  TileGroup *GetActiveTileGroup(size_t active_slot);
+
+  // tile group with slots freed up by the vacuum, if any
+  TileGroup *GetReusableTileGroup();
+
+  // lets inserts fill up the free slots of the tile group first
+  void AddReusableTileGroup(TileGroup *tile_group);
+
+  // frees the slots of a batch that was rejected before anybody could see
+  // it, for the next inserts to take
+  void ReleaseTupleSlots(const std::vector<ItemPointer> &locations);
+
+  // inserts found no free slot left in the tile group
+  void DropReusableTileGroup(TileGroup *tile_group);
 
   // get a partitioning with given layout type
   column_map_type GetTileGroupLayout(LayoutType layout_type);
@@ -228,6 +271,14 @@ class DataTable : public AbstractTable {
   bool InsertInIndexes(const concurrency::Transaction *transaction,
                        const storage::Tuple *tuple, ItemPointer location);
 
+  // same for a batch of tuples, one bulk insert per non-unique index
+  bool InsertInIndexes(const concurrency::Transaction *transaction,
+                       const std::vector<const Tuple *> &tuples,
+                       const std::vector<ItemPointer> &locations);
+
+  // remove the index entries of a dead version
+  void DeleteInIndexes(TileGroup *tile_group, ItemPointer location);
+
   /** @return True if it's a same-key update and it's successful */
   bool UpdateInIndexes(const storage::Tuple *tuple, ItemPointer location);
 
@@ -243,9 +294,30 @@ class DataTable : public AbstractTable {
   // set of tile groups
   std::vector<oid_t> tile_groups;
 
+  // tile groups that take inserts. A thread always inserts through the same
+  // slot, so concurrent inserters don't all bump the slot counter of one
+  // tile group. The catalog keeps the tile groups alive as long as the table.
+  std::atomic<TileGroup *> active_tile_groups[ACTIVE_TILE_GROUP_COUNT];
+
+  // tile groups the vacuum freed up slots in. inserts fill them up before
+  // going to the active tile groups.
+  std::deque<TileGroup *> reusable_tile_groups;
+
+  std::atomic<size_t> reusable_tile_group_count = ATOMIC_VAR_INIT(0);
+
+  Spinlock reusable_tile_group_lock;
+
+  // only one vacuum per table at a time
+  std::mutex vacuum_mutex;
+
   // INDEXES
   std::vector<index::Index *> indexes;
 
+  // Held shared by inserts and the vacuum from the time they touch a slot
+  // until its index entries are in (or out), and exclusively while a new
+  // index is populated and added
+  RWLock index_build_lock;
+
   // CONSTRAINTS
   std::vector<catalog::ForeignKey *> foreign_keys;
 
@@ -26,6 +26,22 @@
 namespace peloton {
 namespace storage {
 
+namespace {
+
+// Types of the tile group columns in column offset order
+std::vector<ValueType> GetColumnTypes(
+    const std::vector<catalog::Schema> &schemas,
+    const column_map_type &column_map) {
+  std::vector<ValueType> column_types;
+  for (auto &column_map_entry : column_map) {
+    const catalog::Schema &schema = schemas[column_map_entry.second.first];
+    column_types.push_back(schema.GetType(column_map_entry.second.second));
+  }
+  return column_types;
+}
+
+}  // End anonymous namespace
+
 TileGroup::TileGroup(BackendType backend_type,
                      TileGroupHeader *tile_group_header, AbstractTable *table,
                      const std::vector<catalog::Schema> &schemas,
@@ -38,7 +54,8 @@ TileGroup::TileGroup(BackendType backend_type,
       tile_group_header(tile_group_header),
       table(table),
       num_tuple_slots(tuple_count),
-      column_map(column_map) {
+      column_map(column_map),
+      zone_map(GetColumnTypes(schemas, column_map)) {
   tile_count = tile_schemas.size();
 
   for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
@@ -139,9 +156,77 @@ oid_t TileGroup::InsertTuple(txn_id_t transaction_id, const Tuple *tuple) {
   tile_group_header->SetInsertCommit(tuple_slot_id, false);
   tile_group_header->SetDeleteCommit(tuple_slot_id, false);
 
+  zone_map.Insert(tuple);
+
   return tuple_slot_id;
 }
 
+/**
+ * Reserve a contiguous range of slots for the tuples from tuple_offset on
+ * and fill them in one tile at a time
+ * Returns the first slot of the range (INVALID_OID if the group is full)
+ */
+oid_t TileGroup::InsertTuples(txn_id_t transaction_id,
+                              const std::vector<const Tuple *> &tuples,
+                              oid_t tuple_offset, oid_t &inserted_count) {
+  assert(tuple_offset < tuples.size());
+  oid_t first_slot_id = tile_group_header->GetNextEmptyTupleSlots(
+      tuples.size() - tuple_offset, inserted_count);
+
+  LOG_TRACE("Tile Group Id :: %lu reserved %lu slots from %lu out of %lu ",
+            tile_group_id, inserted_count, first_slot_id, num_tuple_slots);
+
+  // No more slots
+  if (first_slot_id == INVALID_OID) {
+    return INVALID_OID;
+  }
+
+  oid_t tile_column_offset = 0;
+
+  for (oid_t tile_itr = 0; tile_itr < tile_count; tile_itr++) {
+    const catalog::Schema &schema = tile_schemas[tile_itr];
+    oid_t tile_column_count = schema.GetColumnCount();
+
+    storage::Tile *tile = GetTile(tile_itr);
+    assert(tile);
+
+    for (oid_t tuple_itr = 0; tuple_itr < inserted_count; tuple_itr++) {
+      const Tuple *tuple = tuples[tuple_offset + tuple_itr];
+      char *tile_tuple_location =
+          tile->GetTupleLocation(first_slot_id + tuple_itr);
+      assert(tile_tuple_location);
+
+      // NOTE:: Only a tuple wrapper
+      storage::Tuple tile_tuple(&schema, tile_tuple_location);
+
+      for (oid_t tile_column_itr = 0; tile_column_itr < tile_column_count;
+           tile_column_itr++) {
+        oid_t column_itr = tile_column_offset + tile_column_itr;
+        tile_tuple.SetValue(tile_column_itr, tuple->GetValue(column_itr),
+                            tile->GetPool());
+      }
+    }
+
+    tile_column_offset += tile_column_count;
+  }
+
+  // Set MVCC info
+  for (oid_t tuple_slot_id = first_slot_id;
+       tuple_slot_id < first_slot_id + inserted_count; tuple_slot_id++) {
+    assert(tile_group_header->GetTransactionId(tuple_slot_id) ==
+           INVALID_TXN_ID);
+    tile_group_header->SetTransactionId(tuple_slot_id, transaction_id);
+    tile_group_header->SetBeginCommitId(tuple_slot_id, MAX_CID);
+    tile_group_header->SetEndCommitId(tuple_slot_id, MAX_CID);
+    tile_group_header->SetInsertCommit(tuple_slot_id, false);
+    tile_group_header->SetDeleteCommit(tuple_slot_id, false);
+  }
+
+  zone_map.Insert(tuples, tuple_offset, inserted_count);
+
+  return first_slot_id;
+}
+
 /**
  * Grab specific slot and fill in the tuple
  * Used by recovery
@@ -188,6 +273,8 @@ oid_t TileGroup::InsertTuple(txn_id_t transaction_id, oid_t tuple_slot_id,
   tile_group_header->SetDeleteCommit(tuple_slot_id, false);
   tile_group_header->SetPrevItemPointer(tuple_slot_id, INVALID_ITEMPOINTER);
 
+  zone_map.Insert(tuple);
+
   return tuple_slot_id;
 }
 
@@ -319,6 +406,11 @@ double TileGroup::GetSchemaDifference(
   return theta;
 }
 
+ZoneMap &TileGroup::GetZoneMap() {
+  if (zone_map.IsStale()) zone_map.Rebuild(this);
+  return zone_map;
+}
+
 void TileGroup::Sync() {
   // Sync the tile group data by syncing all the underlying tiles
   for (auto tile : tiles) {
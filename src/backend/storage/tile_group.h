@@ -21,6 +21,7 @@
 
 #include "backend/common/types.h"
 #include "backend/common/printable.h"
+#include "backend/storage/zone_map.h"
 
 namespace peloton {
 
@@ -76,6 +77,12 @@ class TileGroup : public Printable {
   // insert tuple at next available slot in tile if a slot exists
   oid_t InsertTuple(txn_id_t transaction_id, const Tuple *tuple);
 
+  // insert as many of the tuples as fit into contiguous slots, starting
+  // with the first. returns the first slot and sets inserted_count.
+  oid_t InsertTuples(txn_id_t transaction_id,
+                     const std::vector<const Tuple *> &tuples,
+                     oid_t tuple_offset, oid_t &inserted_count);
+
   // insert tuple at specific tuple slot
   // used by recovery mode
   oid_t InsertTuple(txn_id_t transaction_id, oid_t tuple_slot_id,
@@ -165,6 +172,13 @@ class TileGroup : public Printable {
   // Sync the contents
   void Sync();
 
+  // Min/max synopses of the columns, rebuilt first if they went stale
+  ZoneMap &GetZoneMap();
+
+  // Have the zone map rebuilt before it is used next, e.g. after slots were
+  // freed or the tuples were copied in behind its back
+  void InvalidateZoneMap() { zone_map.Invalidate(); }
+
  protected:
   //===--------------------------------------------------------------------===//
   // Data members
@@ -201,6 +215,9 @@ class TileGroup : public Printable {
   // column to tile mapping :
   // <column offset> to <tile offset, tile column offset>
   column_map_type column_map;
+
+  // min/max/null count of the fixed-width columns, for pruning scans
+  ZoneMap zone_map;
 };
 
 }  // End storage namespace
@@ -14,6 +14,10 @@
 #include <iomanip>
 #include <sstream>
 
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
 #include "backend/concurrency/transaction_manager.h"
 #include "backend/storage/storage_manager.h"
 #include "backend/storage/tile_group_header.h"
@@ -25,7 +29,8 @@ TileGroupHeader::TileGroupHeader(BackendType backend_type, int tuple_count)
     : backend_type(backend_type),
       data(nullptr),
       num_tuple_slots(tuple_count),
-      next_tuple_slot(0) {
+      next_tuple_slot(0),
+      free_tuple_slot_count(0) {
   header_size = num_tuple_slots * header_entry_size;
 
   // allocate storage space for header
@@ -198,17 +203,134 @@ void TileGroupHeader::PrintVisibility(txn_id_t txn_id, cid_t at_cid) {
 }
 
 oid_t TileGroupHeader::GetActiveTupleCount(txn_id_t txn_id) {
-  oid_t active_tuple_slots = 0;
   auto &txn_manager = concurrency::TransactionManager::GetInstance();
   cid_t last_cid = txn_manager.GetLastCommitId();
-  for (oid_t tuple_slot_id = START_OID; tuple_slot_id < num_tuple_slots;
-       tuple_slot_id++) {
-    if (IsVisible(tuple_slot_id, txn_id, last_cid)) {
-      active_tuple_slots++;
-    }
+
+  std::vector<uint64_t> visibility;
+  ComputeVisibility(txn_id, last_cid, START_OID, GetNextTupleSlot(),
+                    visibility);
+
+  oid_t active_tuple_slots = 0;
+  for (auto word : visibility) {
+    active_tuple_slots += __builtin_popcountll(word);
   }
   return active_tuple_slots;
 }
 
+void TileGroupHeader::ComputeVisibility(txn_id_t txn_id, cid_t at_lcid,
+                                        oid_t begin_slot, oid_t end_slot,
+                                        std::vector<uint64_t> &bitmap) const {
+  assert(begin_slot <= end_slot && end_slot <= num_tuple_slots);
+  oid_t slot_count = end_slot - begin_slot;
+  bitmap.assign((slot_count + 63) / 64, 0);
+
+  // The commit flags only count with peloton logging
+  auto &log_manager = logging::LogManager::GetInstance();
+  bool check_commit_flags =
+      (log_manager.HasPelotonFrontendLogger() == LOGGING_TYPE_NVM_NVM);
+
+  oid_t slot_itr = 0;
+
+#ifdef __SSE4_2__
+  if (TILE_GROUP_HEADER_COLUMNAR && check_commit_flags == false) {
+    const txn_id_t *txn_ids = (const txn_id_t *)GetFieldLocation(
+        begin_slot, txn_id_offset, sizeof(txn_id_t));
+    const cid_t *begin_cids = (const cid_t *)GetFieldLocation(
+        begin_slot, begin_cid_offset, sizeof(cid_t));
+    const cid_t *end_cids = (const cid_t *)GetFieldLocation(
+        begin_slot, end_cid_offset, sizeof(cid_t));
+
+    // SSE only compares signed 64 bit integers, flipping the sign bit keeps
+    // the order of the unsigned commit ids
+    const __m128i sign_bit = _mm_set1_epi64x(INT64_MIN);
+    const __m128i own_txn_id = _mm_set1_epi64x(txn_id);
+    const __m128i invalid_txn_id = _mm_set1_epi64x(INVALID_TXN_ID);
+    const __m128i lcid = _mm_xor_si128(_mm_set1_epi64x(at_lcid), sign_bit);
+
+    // Two slots at a time, the pair never straddles two bitmap words
+    for (; slot_itr + 2 <= slot_count; slot_itr += 2) {
+      __m128i tuple_txn_id =
+          _mm_loadu_si128((const __m128i *)(txn_ids + slot_itr));
+      __m128i tuple_begin_cid = _mm_xor_si128(
+          _mm_loadu_si128((const __m128i *)(begin_cids + slot_itr)), sign_bit);
+      __m128i tuple_end_cid = _mm_xor_si128(
+          _mm_loadu_si128((const __m128i *)(end_cids + slot_itr)), sign_bit);
+
+      __m128i own = _mm_cmpeq_epi64(tuple_txn_id, own_txn_id);
+      __m128i invalid = _mm_cmpeq_epi64(tuple_txn_id, invalid_txn_id);
+      __m128i not_activated = _mm_cmpgt_epi64(tuple_begin_cid, lcid);
+      __m128i not_invalidated = _mm_cmpgt_epi64(tuple_end_cid, lcid);
+
+      // Visible iff valid, not invalidated and own insert xor activated
+      __m128i visible = _mm_andnot_si128(_mm_xor_si128(own, not_activated),
+                                         not_invalidated);
+      visible = _mm_andnot_si128(invalid, visible);
+
+      uint64_t mask = _mm_movemask_pd(_mm_castsi128_pd(visible));
+      bitmap[slot_itr / 64] |= mask << (slot_itr % 64);
+    }
+  }
+#endif
+
+  for (; slot_itr < slot_count; slot_itr++) {
+    oid_t tuple_slot_id = begin_slot + slot_itr;
+    txn_id_t tuple_txn_id = GetTransactionId(tuple_slot_id);
+    bool activated = (at_lcid >= GetBeginCommitId(tuple_slot_id));
+    bool invalidated = (at_lcid >= GetEndCommitId(tuple_slot_id));
+
+    if (check_commit_flags) {
+      activated = activated && GetInsertCommit(tuple_slot_id);
+      invalidated = invalidated && GetDeleteCommit(tuple_slot_id);
+    }
+
+    bool visible = (tuple_txn_id != INVALID_TXN_ID) && !invalidated &&
+                   ((tuple_txn_id == txn_id) != activated);
+    bitmap[slot_itr / 64] |= uint64_t(visible) << (slot_itr % 64);
+  }
+}
+
+//===--------------------------------------------------------------------===//
+// Slot reuse
+//===--------------------------------------------------------------------===//
+
+void TileGroupHeader::ReclaimTupleSlot(const oid_t tuple_slot_id) {
+  assert(GetTransactionId(tuple_slot_id) == INVALID_TXN_ID);
+
+  SetBeginCommitId(tuple_slot_id, MAX_CID);
+  SetEndCommitId(tuple_slot_id, MAX_CID);
+  SetInsertCommit(tuple_slot_id, false);
+  SetDeleteCommit(tuple_slot_id, false);
+
+  free_tuple_slot_lock.Lock();
+
+  free_tuple_slots.push_back(tuple_slot_id);
+
+  // Every slot is free, so fill the tile group from the start again and
+  // let scans stop at the first slot
+  if (free_tuple_slots.size() == num_tuple_slots) {
+    free_tuple_slots.clear();
+    next_tuple_slot = 0;
+  }
+  free_tuple_slot_count = free_tuple_slots.size();
+
+  free_tuple_slot_lock.Unlock();
+}
+
+oid_t TileGroupHeader::PopFreeTupleSlot() {
+  oid_t tuple_slot_id = INVALID_OID;
+
+  free_tuple_slot_lock.Lock();
+
+  if (free_tuple_slots.empty() == false) {
+    tuple_slot_id = free_tuple_slots.back();
+    free_tuple_slots.pop_back();
+    free_tuple_slot_count = free_tuple_slots.size();
+  }
+
+  free_tuple_slot_lock.Unlock();
+
+  return tuple_slot_id;
+}
+
 }  // End storage namespace
 }  // End peloton namespace
@@ -17,13 +17,18 @@
 #include "backend/common/printable.h"
 #include "backend/logging/log_manager.h"
 
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 #include <iostream>
 #include <cassert>
 #include <queue>
+#include <vector>
 #include <cstring>
 
+// keep every MVCC field of the header in its own array
+#define TILE_GROUP_HEADER_COLUMNAR true
+
 namespace peloton {
 namespace storage {
 
@@ -45,6 +50,10 @@ namespace storage {
  *|
  * 	-----------------------------------------------------------------------------
  *
+ * With TILE_GROUP_HEADER_COLUMNAR, each of the fields is kept in an array of
+ * its own instead, so that visibility checks can scan the txn ids and
+ * timestamps of many slots at once.
+ *
  */
 
 class TileGroupHeader : public Printable {
@@ -63,27 +72,59 @@ class TileGroupHeader : public Printable {
     memcpy(data, other.data, header_size);
 
     num_tuple_slots = other.num_tuple_slots;
-    unsigned long long val = other.next_tuple_slot;
+    oid_t val = other.next_tuple_slot;
     next_tuple_slot = val;
 
+    free_tuple_slots = other.free_tuple_slots;
+    free_tuple_slot_count = free_tuple_slots.size();
+
     return *this;
   }
 
   ~TileGroupHeader();
 
+  /**
+   * Reserves the next slot with a fetch-add. Threads that race past the end
+   * push next_tuple_slot beyond num_tuple_slots, so whoever gets a slot id
+   * that is out of range has found the tile group full. Slots freed up by
+   * the vacuum are handed out first.
+   */
   oid_t GetNextEmptyTupleSlot() {
-    oid_t tuple_slot_id = INVALID_OID;
+    if (free_tuple_slot_count.load(std::memory_order_relaxed) > 0) {
+      oid_t tuple_slot_id = PopFreeTupleSlot();
+      if (tuple_slot_id != INVALID_OID) return tuple_slot_id;
+    }
 
-    {
-      std::lock_guard<std::mutex> tile_header_lock(tile_header_mutex);
+    // Don't keep bumping the counter once the tile group is full
+    if (next_tuple_slot.load(std::memory_order_relaxed) >= num_tuple_slots) {
+      return INVALID_OID;
+    }
 
-      // check tile group capacity
-      if (next_tuple_slot < num_tuple_slots) {
-        tuple_slot_id = next_tuple_slot;
-        next_tuple_slot++;
-      }
+    oid_t tuple_slot_id = next_tuple_slot.fetch_add(1);
+    if (tuple_slot_id >= num_tuple_slots) {
+      return INVALID_OID;
+    }
+
+    return tuple_slot_id;
+  }
+
+  /**
+   * Reserves up to count contiguous slots with one fetch-add. Returns the
+   * first of them and sets reserved_count to how many fit before the end of
+   * the tile group, or INVALID_OID if the tile group is full.
+   */
+  oid_t GetNextEmptyTupleSlots(oid_t count, oid_t &reserved_count) {
+    reserved_count = 0;
+    if (next_tuple_slot.load(std::memory_order_relaxed) >= num_tuple_slots) {
+      return INVALID_OID;
+    }
+
+    oid_t tuple_slot_id = next_tuple_slot.fetch_add(count);
+    if (tuple_slot_id >= num_tuple_slots) {
+      return INVALID_OID;
     }
 
+    reserved_count = std::min(count, oid_t(num_tuple_slots - tuple_slot_id));
     return tuple_slot_id;
   }
 
@@ -91,24 +132,50 @@ class TileGroupHeader : public Printable {
    * Used by logging
    */
   bool GetEmptyTupleSlot(oid_t tuple_slot_id) {
-    {
-      std::lock_guard<std::mutex> tile_header_lock(tile_header_mutex);
-
-      if (tuple_slot_id < num_tuple_slots) {
-        if (next_tuple_slot <= tuple_slot_id) {
-          next_tuple_slot = tuple_slot_id + 1;
-        }
-        return true;
-      } else {
-        return false;
-      }
+    if (tuple_slot_id >= num_tuple_slots) {
+      return false;
     }
+
+    // Move next_tuple_slot past the slot unless it already is
+    oid_t next_slot = next_tuple_slot;
+    while (next_slot <= tuple_slot_id &&
+           !next_tuple_slot.compare_exchange_weak(next_slot,
+                                                  tuple_slot_id + 1)) {
+    }
+    return true;
   }
 
-  oid_t GetNextTupleSlot() const { return next_tuple_slot; }
+  // Slots handed out so far, overshooting reservations don't count
+  oid_t GetNextTupleSlot() const {
+    oid_t next_slot = next_tuple_slot;
+    return (next_slot < num_tuple_slots) ? next_slot : num_tuple_slots;
+  }
 
   oid_t GetActiveTupleCount(txn_id_t txn_id);
 
+  //===--------------------------------------------------------------------===//
+  // Slot reuse
+  //===--------------------------------------------------------------------===//
+
+  /**
+   * Takes over the slot of a version that was deleted at or before
+   * oldest_cid, so no running or future transaction can see it. Fails if
+   * the version isn't dead yet or somebody holds the slot.
+   */
+  bool ClaimDeadTupleSlot(const oid_t tuple_slot_id, cid_t oldest_cid) {
+    cid_t tuple_end_cid = GetEndCommitId(tuple_slot_id);
+    if (tuple_end_cid == MAX_CID || tuple_end_cid > oldest_cid) return false;
+
+    txn_id_t *txn_id = GetTransactionIdLocation(tuple_slot_id);
+    return atomic_cas(txn_id, INITIAL_TXN_ID, INVALID_TXN_ID);
+  }
+
+  // Resets a claimed slot and puts it on the free list. Once every slot of
+  // the tile group is free, the tile group is rewound to empty instead.
+  void ReclaimTupleSlot(const oid_t tuple_slot_id);
+
+  oid_t GetFreeTupleSlotCount() const { return free_tuple_slot_count; }
+
   //===--------------------------------------------------------------------===//
   // MVCC utilities
   //===--------------------------------------------------------------------===//
@@ -116,45 +183,46 @@ class TileGroupHeader : public Printable {
   // Getters
 
   inline txn_id_t GetTransactionId(const oid_t tuple_slot_id) const {
-    return *((txn_id_t *)(data + (tuple_slot_id * header_entry_size)));
+    return *((txn_id_t *)GetFieldLocation(tuple_slot_id, txn_id_offset,
+                                          sizeof(txn_id_t)));
   }
 
   inline cid_t GetBeginCommitId(const oid_t tuple_slot_id) const {
-    return *((cid_t *)(data + (tuple_slot_id * header_entry_size) +
-                       sizeof(txn_id_t)));
+    return *((cid_t *)GetFieldLocation(tuple_slot_id, begin_cid_offset,
+                                       sizeof(cid_t)));
   }
 
   inline cid_t GetEndCommitId(const oid_t tuple_slot_id) const {
-    return *((cid_t *)(data + (tuple_slot_id * header_entry_size) +
-                       sizeof(txn_id_t) + sizeof(cid_t)));
+    return *((cid_t *)GetFieldLocation(tuple_slot_id, end_cid_offset,
+                                       sizeof(cid_t)));
   }
 
   // Setters
   inline bool GetInsertCommit(const oid_t tuple_slot_id) const {
-    return *((bool *)(data + (tuple_slot_id * header_entry_size) +
-                      sizeof(txn_id_t) + 2 * sizeof(cid_t)));
+    return *((bool *)GetFieldLocation(tuple_slot_id, insert_commit_offset,
+                                      sizeof(bool)));
   }
 
   inline bool GetDeleteCommit(const oid_t tuple_slot_id) const {
-    return *((bool *)(data + (tuple_slot_id * header_entry_size) +
-                      sizeof(txn_id_t) + 2 * sizeof(cid_t) + sizeof(bool)));
+    return *((bool *)GetFieldLocation(tuple_slot_id, delete_commit_offset,
+                                      sizeof(bool)));
   }
 
   inline ItemPointer GetPrevItemPointer(const oid_t tuple_slot_id) const {
-    return *((ItemPointer *)(data + (tuple_slot_id * header_entry_size) +
-                             sizeof(txn_id_t) + 2 * sizeof(cid_t) +
-                             2 * sizeof(bool)));
+    return *((ItemPointer *)GetFieldLocation(
+        tuple_slot_id, prev_item_pointer_offset, sizeof(ItemPointer)));
   }
 
   // Getters for addresses
 
   inline txn_id_t *GetTransactionIdLocation(const oid_t tuple_slot_id) const {
-    return ((txn_id_t *)(data + (tuple_slot_id * header_entry_size)));
+    return ((txn_id_t *)GetFieldLocation(tuple_slot_id, txn_id_offset,
+                                         sizeof(txn_id_t)));
   }
 
   inline bool LatchTupleSlot(const oid_t tuple_slot_id,
                              txn_id_t transaction_id) {
-    txn_id_t *txn_id = (txn_id_t *)(data + (tuple_slot_id * header_entry_size));
+    txn_id_t *txn_id = GetTransactionIdLocation(tuple_slot_id);
     if (atomic_cas(txn_id, INITIAL_TXN_ID, transaction_id)) {
       return true;
     } else {
@@ -164,7 +232,7 @@ class TileGroupHeader : public Printable {
 
   inline bool ReleaseTupleSlot(const oid_t tuple_slot_id,
                                txn_id_t transaction_id) {
-    txn_id_t *txn_id = (txn_id_t *)(data + (tuple_slot_id * header_entry_size));
+    txn_id_t *txn_id = GetTransactionIdLocation(tuple_slot_id);
     if (!atomic_cas(txn_id, transaction_id, INITIAL_TXN_ID)) {
       LOG_INFO("Release failed, expecting a deleted own insert: %lu",
                GetTransactionId(tuple_slot_id));
@@ -176,35 +244,47 @@ class TileGroupHeader : public Printable {
 
   inline void SetTransactionId(const oid_t tuple_slot_id,
                                txn_id_t transaction_id) {
-    *((txn_id_t *)(data + (tuple_slot_id * header_entry_size))) =
-        transaction_id;
+    *GetTransactionIdLocation(tuple_slot_id) = transaction_id;
   }
 
   inline void SetBeginCommitId(const oid_t tuple_slot_id, cid_t begin_cid) {
-    *((cid_t *)(data + (tuple_slot_id * header_entry_size) +
-                sizeof(txn_id_t))) = begin_cid;
+    *((cid_t *)GetFieldLocation(tuple_slot_id, begin_cid_offset,
+                                sizeof(cid_t))) = begin_cid;
   }
 
   inline void SetEndCommitId(const oid_t tuple_slot_id, cid_t end_cid) const {
-    *((cid_t *)(data + (tuple_slot_id * header_entry_size) + sizeof(txn_id_t) +
-                sizeof(cid_t))) = end_cid;
+    *((cid_t *)GetFieldLocation(tuple_slot_id, end_cid_offset,
+                                sizeof(cid_t))) = end_cid;
   }
 
   inline void SetInsertCommit(const oid_t tuple_slot_id, bool commit) const {
-    *((bool *)(data + (tuple_slot_id * header_entry_size) + sizeof(txn_id_t) +
-               2 * sizeof(cid_t))) = commit;
+    *((bool *)GetFieldLocation(tuple_slot_id, insert_commit_offset,
+                               sizeof(bool))) = commit;
   }
 
   inline void SetDeleteCommit(const oid_t tuple_slot_id, bool commit) const {
-    *((bool *)(data + (tuple_slot_id * header_entry_size) + sizeof(txn_id_t) +
-               2 * sizeof(cid_t) + sizeof(bool))) = commit;
+    *((bool *)GetFieldLocation(tuple_slot_id, delete_commit_offset,
+                               sizeof(bool))) = commit;
   }
 
   inline void SetPrevItemPointer(const oid_t tuple_slot_id,
                                  ItemPointer item) const {
-    *((ItemPointer *)(data + (tuple_slot_id * header_entry_size) +
-                      sizeof(txn_id_t) + 2 * sizeof(cid_t) +
-                      2 * sizeof(bool))) = item;
+    *((ItemPointer *)GetFieldLocation(tuple_slot_id, prev_item_pointer_offset,
+                                      sizeof(ItemPointer))) = item;
+  }
+
+  /**
+   * Sets a bit in the bitmap for every slot in [begin_slot, end_slot) that
+   * the transaction can see, bit i for slot begin_slot + i. Gives the same
+   * answers as IsVisible, but for a whole range at once and, with the
+   * columnar layout, two slots per SSE instruction.
+   */
+  void ComputeVisibility(txn_id_t txn_id, cid_t at_lcid, oid_t begin_slot,
+                         oid_t end_slot, std::vector<uint64_t> &bitmap) const;
+
+  static inline bool IsVisibleInBitmap(const std::vector<uint64_t> &bitmap,
+                                       oid_t offset) {
+    return (bitmap[offset / 64] >> (offset % 64)) & 1;
   }
 
   // Visibility check
@@ -303,6 +383,29 @@ class TileGroupHeader : public Printable {
                                           sizeof(ItemPointer) +
                                           2 * sizeof(bool);
 
+  // offsets of the fields within an entry
+  static const size_t txn_id_offset = 0;
+  static const size_t begin_cid_offset = sizeof(txn_id_t);
+  static const size_t end_cid_offset = begin_cid_offset + sizeof(cid_t);
+  static const size_t insert_commit_offset = end_cid_offset + sizeof(cid_t);
+  static const size_t delete_commit_offset =
+      insert_commit_offset + sizeof(bool);
+  static const size_t prev_item_pointer_offset =
+      delete_commit_offset + sizeof(bool);
+
+  // With the columnar layout, a field's array takes up as many bytes per slot
+  // as the fields before it in an entry, so it starts at num_tuple_slots
+  // times the field offset
+  inline char *GetFieldLocation(const oid_t tuple_slot_id,
+                                const size_t field_offset,
+                                const size_t field_size) const {
+    if (TILE_GROUP_HEADER_COLUMNAR) {
+      return data + field_offset * num_tuple_slots +
+             tuple_slot_id * field_size;
+    }
+    return data + tuple_slot_id * header_entry_size + field_offset;
+  }
+
   //===--------------------------------------------------------------------===//
   // Data members
   //===--------------------------------------------------------------------===//
@@ -318,11 +421,18 @@ class TileGroupHeader : public Printable {
   // number of tuple slots allocated
   oid_t num_tuple_slots;
 
-  // next free tuple slot
-  oid_t next_tuple_slot;
+  // next free tuple slot, may be larger than num_tuple_slots once the tile
+  // group is full
+  std::atomic<oid_t> next_tuple_slot;
+
+  // slots below next_tuple_slot that were reclaimed by the vacuum
+  std::vector<oid_t> free_tuple_slots;
+
+  std::atomic<oid_t> free_tuple_slot_count;
+
+  Spinlock free_tuple_slot_lock;
 
-  // synch helpers
-  std::mutex tile_header_mutex;
+  oid_t PopFreeTupleSlot();
 };
 
 }  // End storage namespace
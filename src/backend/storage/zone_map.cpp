@@ -0,0 +1,255 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// zone_map.cpp
+//
+// Identification: src/backend/storage/zone_map.cpp
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "backend/storage/zone_map.h"
+
+#include <cmath>
+
+#include "backend/common/logger.h"
+#include "backend/common/value_factory.h"
+#include "backend/common/value_peeker.h"
+#include "backend/storage/tile.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_header.h"
+#include "backend/storage/tuple.h"
+
+namespace peloton {
+namespace storage {
+
+namespace {
+
+bool IsTrackedType(ValueType type) {
+  switch (type) {
+    case VALUE_TYPE_TINYINT:
+    case VALUE_TYPE_SMALLINT:
+    case VALUE_TYPE_INTEGER:
+    case VALUE_TYPE_BIGINT:
+    case VALUE_TYPE_TIMESTAMP:
+    case VALUE_TYPE_DOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Whether Value compares the two types without throwing
+bool IsComparableType(ValueType column_type, ValueType value_type) {
+  if (column_type == VALUE_TYPE_TIMESTAMP ||
+      value_type == VALUE_TYPE_TIMESTAMP) {
+    return column_type == value_type;
+  }
+
+  return IsTrackedType(value_type);
+}
+
+// Orders NaN below everything else like Value does
+inline bool DoubleLessThan(double lhs, double rhs) {
+  if (std::isnan(lhs)) return !std::isnan(rhs);
+  return lhs < rhs;
+}
+
+}  // End anonymous namespace
+
+ZoneMap::ZoneMap(const std::vector<ValueType> &column_types) : stale(false) {
+  oid_t column_count = column_types.size();
+  zones.resize(column_count);
+
+  for (oid_t column_itr = 0; column_itr < column_count; column_itr++) {
+    zones[column_itr].type = column_types[column_itr];
+    if (IsTrackedType(column_types[column_itr]))
+      tracked_columns.push_back(column_itr);
+  }
+
+  Reset();
+}
+
+//===--------------------------------------------------------------------===//
+// Maintenance
+//===--------------------------------------------------------------------===//
+
+void ZoneMap::Insert(const Tuple *tuple) {
+  std::lock_guard<std::mutex> lock(zone_map_mutex);
+
+  for (auto column_id : tracked_columns)
+    Add(column_id, tuple->GetValue(column_id));
+  tuple_count++;
+}
+
+void ZoneMap::Insert(const std::vector<const Tuple *> &tuples,
+                     oid_t tuple_offset, oid_t count) {
+  std::lock_guard<std::mutex> lock(zone_map_mutex);
+
+  for (auto column_id : tracked_columns) {
+    for (oid_t tuple_itr = tuple_offset; tuple_itr < tuple_offset + count;
+         tuple_itr++) {
+      Add(column_id, tuples[tuple_itr]->GetValue(column_id));
+    }
+  }
+  tuple_count += count;
+}
+
+/**
+ * Slots of aborted inserts and of versions the vacuum took back have no
+ * transaction id, everything else might still be seen by somebody. Inserts
+ * widen the ranges under the same lock after they have set the transaction
+ * id, so an insert racing with the rebuild is either seen here or applied
+ * afterwards.
+ */
+void ZoneMap::Rebuild(TileGroup *tile_group) {
+  std::lock_guard<std::mutex> lock(zone_map_mutex);
+  stale = false;
+  Reset();
+
+  auto header = tile_group->GetHeader();
+  oid_t slot_count = header->GetNextTupleSlot();
+
+  std::vector<oid_t> tuple_ids;
+  for (oid_t tuple_itr = 0; tuple_itr < slot_count; tuple_itr++) {
+    if (header->GetTransactionId(tuple_itr) != INVALID_TXN_ID)
+      tuple_ids.push_back(tuple_itr);
+  }
+
+  for (auto column_id : tracked_columns) {
+    oid_t tile_offset, tile_column_id;
+    tile_group->LocateTileAndColumn(column_id, tile_offset, tile_column_id);
+    Tile *tile = tile_group->GetTile(tile_offset);
+
+    for (auto tuple_id : tuple_ids)
+      Add(column_id, tile->GetValue(tuple_id, tile_column_id));
+  }
+  tuple_count = tuple_ids.size();
+
+  LOG_TRACE("Rebuilt zone map of tile group %lu over %lu tuples",
+            tile_group->GetTileGroupId(), tuple_count);
+}
+
+void ZoneMap::Reset() {
+  for (auto &zone : zones) {
+    zone.has_values = false;
+    zone.min_integer = 0;
+    zone.max_integer = 0;
+    zone.min_double = 0;
+    zone.max_double = 0;
+    zone.null_count = 0;
+  }
+  tuple_count = 0;
+}
+
+void ZoneMap::Add(oid_t column_id, const Value &value) {
+  ColumnZone &zone = zones[column_id];
+
+  if (value.IsNull()) {
+    zone.null_count++;
+    return;
+  }
+
+  if (value.GetValueType() != zone.type) {
+    Add(column_id, value.CastAs(zone.type));
+    return;
+  }
+
+  if (zone.type == VALUE_TYPE_DOUBLE) {
+    double double_value = ValuePeeker::PeekDouble(value);
+    if (!zone.has_values || DoubleLessThan(double_value, zone.min_double))
+      zone.min_double = double_value;
+    if (!zone.has_values || DoubleLessThan(zone.max_double, double_value))
+      zone.max_double = double_value;
+  } else {
+    int64_t integer_value = ValuePeeker::PeekAsRawInt64(value);
+    if (!zone.has_values || integer_value < zone.min_integer)
+      zone.min_integer = integer_value;
+    if (!zone.has_values || integer_value > zone.max_integer)
+      zone.max_integer = integer_value;
+  }
+
+  zone.has_values = true;
+}
+
+//===--------------------------------------------------------------------===//
+// Lookup
+//===--------------------------------------------------------------------===//
+
+bool ZoneMap::MayMatch(oid_t column_id, ExpressionType compare_type,
+                       const Value &value) {
+  if (column_id >= zones.size()) return true;
+
+  std::lock_guard<std::mutex> lock(zone_map_mutex);
+  const ColumnZone &zone = zones[column_id];
+  if (IsTrackedType(zone.type) == false) return true;
+
+  // Comparisons with null are never true, neither are comparisons on a
+  // column that holds nothing but nulls
+  if (value.IsNull() || zone.has_values == false) return false;
+
+  if (IsComparableType(zone.type, value.GetValueType()) == false) return true;
+
+  int min_compare = GetMinValue(zone).Compare(value);
+  int max_compare = GetMaxValue(zone).Compare(value);
+
+  switch (compare_type) {
+    case EXPRESSION_TYPE_COMPARE_EQUAL:
+      return min_compare <= 0 && max_compare >= 0;
+    case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+      return min_compare != 0 || max_compare != 0;
+    case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+      return min_compare < 0;
+    case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+      return min_compare <= 0;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+      return max_compare > 0;
+    case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+      return max_compare >= 0;
+    default:
+      return true;
+  }
+}
+
+bool ZoneMap::GetRange(oid_t column_id, Value &min_value, Value &max_value) {
+  std::lock_guard<std::mutex> lock(zone_map_mutex);
+  const ColumnZone &zone = zones[column_id];
+  if (IsTrackedType(zone.type) == false || zone.has_values == false)
+    return false;
+
+  min_value = GetMinValue(zone);
+  max_value = GetMaxValue(zone);
+  return true;
+}
+
+oid_t ZoneMap::GetNullCount(oid_t column_id) {
+  std::lock_guard<std::mutex> lock(zone_map_mutex);
+  return zones[column_id].null_count;
+}
+
+Value ZoneMap::GetMinValue(const ColumnZone &zone) const {
+  switch (zone.type) {
+    case VALUE_TYPE_DOUBLE:
+      return ValueFactory::GetDoubleValue(zone.min_double);
+    case VALUE_TYPE_TIMESTAMP:
+      return ValueFactory::GetTimestampValue(zone.min_integer);
+    default:
+      return ValueFactory::GetBigIntValue(zone.min_integer);
+  }
+}
+
+Value ZoneMap::GetMaxValue(const ColumnZone &zone) const {
+  switch (zone.type) {
+    case VALUE_TYPE_DOUBLE:
+      return ValueFactory::GetDoubleValue(zone.max_double);
+    case VALUE_TYPE_TIMESTAMP:
+      return ValueFactory::GetTimestampValue(zone.max_integer);
+    default:
+      return ValueFactory::GetBigIntValue(zone.max_integer);
+  }
+}
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         PelotonDB
+//
+// zone_map.h
+//
+// Identification: src/backend/storage/zone_map.h
+//
+// Copyright (c) 2015, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "backend/common/types.h"
+#include "backend/common/value.h"
+
+namespace peloton {
+namespace storage {
+
+//===--------------------------------------------------------------------===//
+// Zone Map
+//===--------------------------------------------------------------------===//
+
+class Tuple;
+class TileGroup;
+
+/**
+ * Min, max and null count of every fixed-width numeric column of a tile
+ * group, so that scans can skip tile groups none of whose tuples can satisfy
+ * a comparison with a constant.
+ *
+ * The ranges only ever widen as tuples are inserted. Freeing slots leaves
+ * them too wide, so the vacuum marks the zone map stale and the next scan
+ * that looks at it rebuilds it from the tuples still in the tile group.
+ */
+class ZoneMap {
+  ZoneMap() = delete;
+  ZoneMap(ZoneMap const &) = delete;
+
+ public:
+  // column_types holds the type of every column of the tile group
+  explicit ZoneMap(const std::vector<ValueType> &column_types);
+
+  // Widens the ranges by the values of the tuple
+  void Insert(const Tuple *tuple);
+
+  // Widens the ranges by the values of count tuples from tuple_offset on
+  void Insert(const std::vector<const Tuple *> &tuples, oid_t tuple_offset,
+              oid_t count);
+
+  // Recomputes the ranges from the tuples the tile group still holds
+  void Rebuild(TileGroup *tile_group);
+
+  void Invalidate() { stale = true; }
+
+  bool IsStale() const { return stale; }
+
+  /**
+   * Returns false if no tuple of the tile group can satisfy
+   * "column <compare_type> value", true if some might.
+   */
+  bool MayMatch(oid_t column_id, ExpressionType compare_type,
+                const Value &value);
+
+  // Returns false if the column is not tracked or there are no values yet
+  bool GetRange(oid_t column_id, Value &min_value, Value &max_value);
+
+  oid_t GetNullCount(oid_t column_id);
+
+ private:
+  // Range of a single column
+  struct ColumnZone {
+    ValueType type;
+    bool has_values;
+    int64_t min_integer;
+    int64_t max_integer;
+    double min_double;
+    double max_double;
+    oid_t null_count;
+  };
+
+  void Reset();
+
+  void Add(oid_t column_id, const Value &value);
+
+  Value GetMinValue(const ColumnZone &zone) const;
+
+  Value GetMaxValue(const ColumnZone &zone) const;
+
+  //===--------------------------------------------------------------------===//
+  // Data members
+  //===--------------------------------------------------------------------===//
+
+  // one entry per column, only the tracked ones are looked at
+  std::vector<ColumnZone> zones;
+
+  // ids of the tracked columns
+  std::vector<oid_t> tracked_columns;
+
+  // number of tuples the ranges cover
+  oid_t tuple_count = 0;
+
+  // set when the ranges may be too wide
+  std::atomic<bool> stale;
+
+  // inserts, rebuilds and lookups can come from different threads
+  std::mutex zone_map_mutex;
+};
+
+}  // End storage namespace
+}  // End peloton namespace
@@ -50,5 +50,53 @@ TEST(TransactionTests, TransactionTest) {
   std::cout << "Last Commit Id :: " << txn_manager.GetLastCommitId() << "\n";
 }
 
+TEST(TransactionTests, CommitIdTest) {
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  cid_t start_cid = txn_manager.GetLastCommitId();
+
+  // 8 threads, each committing 980 and aborting 20 transactions
+  LaunchParallelTest(8, TransactionTest, &txn_manager);
+
+  // Every commit id got published, and no transaction is left running
+  EXPECT_EQ(txn_manager.GetLastCommitId(), start_cid + 8 * 980);
+  EXPECT_EQ(txn_manager.GetCurrentTransactions().size(), 0);
+  EXPECT_EQ(txn_manager.GetOldestActiveCommitId(),
+            txn_manager.GetLastCommitId());
+
+  // A running transaction holds back the oldest snapshot
+  auto txn = txn_manager.BeginTransaction();
+  EXPECT_EQ(txn_manager.GetTransaction(txn->GetTransactionId()), txn);
+
+  std::thread other_thread([&txn_manager] {
+    txn_manager.BeginTransaction();
+    txn_manager.CommitTransaction();
+  });
+  other_thread.join();
+
+  EXPECT_LT(txn->GetLastCommitId(), txn_manager.GetLastCommitId());
+  EXPECT_EQ(txn_manager.GetOldestActiveCommitId(), txn->GetLastCommitId());
+
+  txn_manager.CommitTransaction();
+}
+
+void CommitStressTest(concurrency::TransactionManager *txn_manager) {
+  for (oid_t txn_itr = 0; txn_itr < 5000; txn_itr++) {
+    txn_manager->BeginTransaction();
+    txn_manager->CommitTransaction();
+  }
+}
+
+TEST(TransactionTests, CommitStressTest) {
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  cid_t start_cid = txn_manager.GetLastCommitId();
+
+  // Committers racing to publish, many times around the commit queue. A
+  // commit id that is never published stalls all later ones.
+  LaunchParallelTest(16, CommitStressTest, &txn_manager);
+
+  EXPECT_EQ(txn_manager.GetLastCommitId(), txn_manager.GetNextCommitId() - 1);
+  EXPECT_EQ(txn_manager.GetLastCommitId(), start_cid + 16 * 5000);
+}
+
 }  // End test namespace
 }  // End peloton namespace
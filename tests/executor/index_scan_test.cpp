@@ -21,6 +21,8 @@
 #include "backend/executor/logical_tile.h"
 #include "backend/executor/logical_tile_factory.h"
 #include "backend/executor/index_scan_executor.h"
+#include "backend/executor/limit_executor.h"
+#include "backend/planner/limit_plan.h"
 #include "backend/storage/data_table.h"
 #include "backend/common/value_factory.h"
 
@@ -160,5 +162,127 @@ TEST(IndexScanTests, MultiColumnPredicateTest) {
   txn_manager.CommitTransaction();
 }
 
+// Index scan whose output columns are all in the index key.
+TEST(IndexScanTests, IndexOnlyScanTest) {
+  // First, generate the table with index
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateAndPopulateTable());
+
+  // Both columns are in the key of the secondary index.
+  std::vector<oid_t> column_ids({1, 0});
+
+  //===--------------------------------------------------------------------===//
+  // ATTR 1 > 50 & ATTR 0 < 70
+  //===--------------------------------------------------------------------===//
+
+  auto index = data_table->GetIndex(1);
+  std::vector<oid_t> key_column_ids({1, 0});
+  std::vector<ExpressionType> expr_types(
+      {ExpressionType::EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+       ExpressionType::EXPRESSION_TYPE_COMPARE_LESSTHAN});
+  std::vector<Value> values({ValueFactory::GetIntegerValue(50),
+                             ValueFactory::GetIntegerValue(70)});
+  std::vector<expression::AbstractExpression *> runtime_keys;
+
+  planner::IndexScanPlan::IndexScanDesc index_scan_desc(
+      index, key_column_ids, expr_types, values, runtime_keys);
+
+  expression::AbstractExpression *predicate = nullptr;
+
+  // Create plan node.
+  planner::IndexScanPlan node(data_table.get(), predicate, column_ids,
+                              index_scan_desc);
+  EXPECT_TRUE(node.IsIndexOnlyScan());
+
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  // Run the executor
+  executor::IndexScanExecutor executor(&node, context.get());
+
+  EXPECT_TRUE(executor.Init());
+  EXPECT_TRUE(executor.Execute());
+  std::unique_ptr<executor::LogicalTile> result_tile(executor.GetOutput());
+  EXPECT_THAT(result_tile, NotNull());
+  EXPECT_FALSE(executor.Execute());
+
+  // The columns come from the keys, in the order asked for
+  EXPECT_EQ(result_tile->GetColumnCount(), 2);
+  EXPECT_EQ(result_tile->GetTupleCount(), 2);
+  for (oid_t tuple_itr = 0; tuple_itr < 2; tuple_itr++) {
+    EXPECT_EQ(result_tile->GetValue(tuple_itr, 0),
+              ValueFactory::GetIntegerValue(
+                  ExecutorTestsUtil::PopulatedValue(5 + tuple_itr, 1)));
+    EXPECT_EQ(result_tile->GetValue(tuple_itr, 1),
+              ValueFactory::GetIntegerValue(
+                  ExecutorTestsUtil::PopulatedValue(5 + tuple_itr, 0)));
+  }
+
+  txn_manager.CommitTransaction();
+
+  // Columns outside of the key still need the table
+  planner::IndexScanPlan::IndexScanDesc uncovered_scan_desc(
+      index, key_column_ids, expr_types, values, runtime_keys);
+  planner::IndexScanPlan uncovered_node(data_table.get(), nullptr, {0, 3},
+                                        uncovered_scan_desc);
+  EXPECT_FALSE(uncovered_node.IsIndexOnlyScan());
+}
+
+// Index scan over more entries than fit into one batch.
+TEST(IndexScanTests, BatchedScanTest) {
+  const int tuple_count = 2 * INDEX_SCAN_BATCH_SIZE + 500;
+
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(DEFAULT_TUPLES_PER_TILEGROUP));
+  ExecutorTestsUtil::PopulateTable(txn, data_table.get(), tuple_count, false,
+                                   false, false);
+  txn_manager.CommitTransaction();
+
+  // Scan the whole primary index
+  planner::IndexScanPlan::IndexScanDesc index_scan_desc(
+      data_table->GetIndex(0), {}, {}, {}, {});
+  planner::IndexScanPlan node(data_table.get(), nullptr, {0, 3},
+                              index_scan_desc);
+
+  txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  // The tiles come out batch by batch
+  executor::IndexScanExecutor executor(&node, context.get());
+  EXPECT_TRUE(executor.Init());
+
+  int result_tuple_count = 0;
+  while (executor.Execute()) {
+    std::unique_ptr<executor::LogicalTile> result_tile(executor.GetOutput());
+    EXPECT_THAT(result_tile, NotNull());
+    EXPECT_LE(result_tile->GetTupleCount(), INDEX_SCAN_BATCH_SIZE);
+    result_tuple_count += result_tile->GetTupleCount();
+  }
+  EXPECT_EQ(result_tuple_count, tuple_count);
+
+  // A limit on top stops pulling batches once it has enough tuples
+  planner::LimitPlan limit_node(10, 0);
+  executor::LimitExecutor limit_executor(&limit_node, context.get());
+  executor::IndexScanExecutor child_executor(&node, context.get());
+  limit_executor.AddChild(&child_executor);
+  EXPECT_TRUE(limit_executor.Init());
+
+  result_tuple_count = 0;
+  while (limit_executor.Execute()) {
+    std::unique_ptr<executor::LogicalTile> result_tile(
+        limit_executor.GetOutput());
+    EXPECT_THAT(result_tile, NotNull());
+    result_tuple_count += result_tile->GetTupleCount();
+  }
+  EXPECT_EQ(result_tuple_count, 10);
+
+  txn_manager.CommitTransaction();
+}
+
 }  // namespace test
 }  // namespace peloton
@@ -259,6 +259,69 @@ TEST(SeqScanTests, TwoTileGroupsWithPredicateTest) {
   txn_manager.CommitTransaction();
 }
 
+// Sequential scan of table with a range predicate on the first column.
+// Only the second tile group holds matching tuples, so the zone maps rule
+// out all the others.
+TEST(SeqScanTests, ZoneMapPredicateTest) {
+  // Create table.
+  std::unique_ptr<storage::DataTable> table(
+      ExecutorTestsUtil::CreateAndPopulateTable());
+  const oid_t first_tuple_id = TESTS_TUPLES_PER_TILEGROUP;
+
+  // first_tuple_id <= tuple id < first_tuple_id + 2, the second bound with
+  // the constant on the left
+  Value lower_bound = ValueFactory::GetIntegerValue(
+      ExecutorTestsUtil::PopulatedValue(first_tuple_id, 0));
+  Value upper_bound = ValueFactory::GetIntegerValue(
+      ExecutorTestsUtil::PopulatedValue(first_tuple_id + 2, 0));
+
+  expression::AbstractExpression *predicate =
+      expression::ExpressionUtil::ConjunctionFactory(
+          EXPRESSION_TYPE_CONJUNCTION_AND,
+          expression::ExpressionUtil::ComparisonFactory(
+              EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+              expression::ExpressionUtil::TupleValueFactory(0, 0),
+              expression::ExpressionUtil::ConstantValueFactory(lower_bound)),
+          expression::ExpressionUtil::ComparisonFactory(
+              EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+              expression::ExpressionUtil::ConstantValueFactory(upper_bound),
+              expression::ExpressionUtil::TupleValueFactory(0, 0)));
+
+  EXPECT_FALSE(table->GetTileGroup(0)->GetZoneMap().MayMatch(
+      0, EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO, lower_bound));
+  EXPECT_TRUE(table->GetTileGroup(1)->GetZoneMap().MayMatch(
+      0, EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO, lower_bound));
+  EXPECT_FALSE(table->GetTileGroup(2)->GetZoneMap().MayMatch(
+      0, EXPRESSION_TYPE_COMPARE_LESSTHAN, upper_bound));
+
+  // Column ids to be added to logical tile after scan.
+  std::vector<oid_t> column_ids({0, 1});
+
+  // Create plan node.
+  planner::SeqScanPlan node(table.get(), predicate, column_ids);
+
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  std::unique_ptr<executor::ExecutorContext> context(
+      new executor::ExecutorContext(txn));
+
+  executor::SeqScanExecutor executor(&node, context.get());
+  EXPECT_TRUE(executor.Init());
+
+  std::unique_ptr<executor::LogicalTile> result_tile(GetNextTile(executor));
+  EXPECT_FALSE(executor.Execute());
+
+  EXPECT_EQ(2, result_tile->GetTupleCount());
+  oid_t tuple_id = first_tuple_id;
+  for (oid_t new_tuple_id : *result_tile) {
+    EXPECT_EQ(ExecutorTestsUtil::PopulatedValue(tuple_id, 1),
+              result_tile->GetValue(new_tuple_id, 1).GetIntegerForTestsOnly());
+    tuple_id++;
+  }
+
+  txn_manager.CommitTransaction();
+}
+
 // Sequential scan of logical tile with predicate.
 TEST(SeqScanTests, NonLeafNodePredicateTest) {
   // No table for this case as seq scan is not a leaf node.
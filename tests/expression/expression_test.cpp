@@ -25,7 +25,11 @@
 #include "backend/expression/tuple_value_expression.h"
 #include "backend/expression/comparison_expression.h"
 #include "backend/expression/conjunction_expression.h"
+#include "backend/expression/container_batch.h"
+#include "backend/expression/operator_expression.h"
 #include "backend/expression/vector_expression.h"
+#include "backend/storage/tile_group.h"
+#include "backend/storage/tile_group_factory.h"
 
 namespace peloton {
 namespace test {
@@ -402,5 +406,163 @@ TEST(ExpressionTest, SimpleInFilter) {
   delete tuple;
 }
 
+
+// Checks FilterBatch against evaluating the predicate row by row
+void CheckFilterBatch(storage::TileGroup *tile_group,
+                      expression::AbstractExpression *predicate) {
+  expression::SelectionVector all_rows;
+  for (oid_t tuple_id = 0; tuple_id < tile_group->GetNextTupleSlot();
+       tuple_id++) {
+    all_rows.push_back(tuple_id);
+  }
+
+  for (bool keep_nulls : {false, true}) {
+    expression::SelectionVector expected_rows;
+    for (oid_t tuple_id : all_rows) {
+      expression::ContainerTuple<storage::TileGroup> tuple(tile_group,
+                                                           tuple_id);
+      Value result = predicate->Evaluate(&tuple, nullptr, nullptr);
+      if (keep_nulls ? !result.IsFalse() : result.IsTrue()) {
+        expected_rows.push_back(tuple_id);
+      }
+    }
+
+    expression::SelectionVector rows(all_rows);
+    expression::ContainerBatch<storage::TileGroup> batch(tile_group);
+    predicate->FilterBatch(batch, rows, nullptr, keep_nulls);
+    EXPECT_EQ(expected_rows, rows);
+  }
+
+  delete predicate;
+}
+
+TEST(ExpressionTest, BatchFilterTest) {
+  std::vector<catalog::Column> columns;
+  std::vector<catalog::Schema> schemas;
+
+  // SCHEMA
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  catalog::Column column2(VALUE_TYPE_DOUBLE, GetTypeSize(VALUE_TYPE_DOUBLE),
+                          "B", true);
+  catalog::Column column3(VALUE_TYPE_TINYINT, GetTypeSize(VALUE_TYPE_TINYINT),
+                          "C", true);
+  catalog::Column column4(VALUE_TYPE_VARCHAR, 50, "D", false);
+
+  columns.push_back(column1);
+  columns.push_back(column2);
+  catalog::Schema *schema1 = new catalog::Schema(columns);
+  schemas.push_back(*schema1);
+
+  columns.clear();
+  columns.push_back(column3);
+  columns.push_back(column4);
+  catalog::Schema *schema2 = new catalog::Schema(columns);
+  schemas.push_back(*schema2);
+
+  catalog::Schema *schema = catalog::Schema::AppendSchema(schema1, schema2);
+
+  // TILE GROUP
+  std::map<oid_t, std::pair<oid_t, oid_t>> column_map;
+  column_map[0] = std::make_pair(0, 0);
+  column_map[1] = std::make_pair(0, 1);
+  column_map[2] = std::make_pair(1, 0);
+  column_map[3] = std::make_pair(1, 1);
+
+  const int tuple_count = 300;
+  storage::TileGroup *tile_group = storage::TileGroupFactory::GetTileGroup(
+      INVALID_OID, INVALID_OID, INVALID_OID, nullptr, schemas, column_map,
+      tuple_count);
+
+  // Every column gets some nulls
+  storage::Tuple *tuple = new storage::Tuple(schema, true);
+  auto pool = tile_group->GetTilePool(1);
+  for (int tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    tuple->SetValue(0, (tuple_itr % 11 == 0)
+                           ? ValueFactory::GetNullValueByType(VALUE_TYPE_INTEGER)
+                           : ValueFactory::GetIntegerValue(tuple_itr % 17 - 8),
+                    pool);
+    tuple->SetValue(1, (tuple_itr % 13 == 0)
+                           ? ValueFactory::GetNullValueByType(VALUE_TYPE_DOUBLE)
+                           : ValueFactory::GetDoubleValue(tuple_itr * 0.5),
+                    pool);
+    tuple->SetValue(2, (tuple_itr % 19 == 0)
+                           ? ValueFactory::GetNullValueByType(VALUE_TYPE_TINYINT)
+                           : ValueFactory::GetTinyIntValue(tuple_itr % 7),
+                    pool);
+    tuple->SetValue(3, ValueFactory::GetStringValue(
+                           "s" + std::to_string(tuple_itr % 3)),
+                    pool);
+    tile_group->InsertTuple(1, tuple);
+  }
+
+  auto column = [](int column_id) {
+    return new expression::TupleValueExpression(0, column_id);
+  };
+  auto constant = [](Value value) {
+    return new expression::ConstantValueExpression(value);
+  };
+
+  // A > 0 AND B <= 50.0
+  CheckFilterBatch(
+      tile_group,
+      new expression::ConjunctionExpression<expression::ConjunctionAnd>(
+          EXPRESSION_TYPE_CONJUNCTION_AND,
+          new expression::ComparisonExpression<expression::CmpGt>(
+              EXPRESSION_TYPE_COMPARE_GREATERTHAN, column(0),
+              constant(ValueFactory::GetIntegerValue(0))),
+          new expression::ComparisonExpression<expression::CmpLte>(
+              EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO, column(1),
+              constant(ValueFactory::GetDoubleValue(50.0)))));
+
+  // A + C = 3 OR NOT (B IS NULL)
+  CheckFilterBatch(
+      tile_group,
+      new expression::ConjunctionExpression<expression::ConjunctionOr>(
+          EXPRESSION_TYPE_CONJUNCTION_OR,
+          new expression::ComparisonExpression<expression::CmpEq>(
+              EXPRESSION_TYPE_COMPARE_EQUAL,
+              new expression::OperatorExpression<expression::OpPlus>(
+                  EXPRESSION_TYPE_OPERATOR_PLUS, column(0), column(2)),
+              constant(ValueFactory::GetIntegerValue(3))),
+          new expression::OperatorNotExpression(
+              new expression::OperatorIsNullExpression(column(1)))));
+
+  // D = 's1' AND A * B < 20, strings are compared row by row
+  CheckFilterBatch(
+      tile_group,
+      new expression::ConjunctionExpression<expression::ConjunctionAnd>(
+          EXPRESSION_TYPE_CONJUNCTION_AND,
+          new expression::ComparisonExpression<expression::CmpEq>(
+              EXPRESSION_TYPE_COMPARE_EQUAL, column(3),
+              constant(ValueFactory::GetStringValue("s1"))),
+          new expression::ComparisonExpression<expression::CmpLt>(
+              EXPRESSION_TYPE_COMPARE_LESSTHAN,
+              new expression::OperatorExpression<expression::OpMultiply>(
+                  EXPRESSION_TYPE_OPERATOR_MULTIPLY, column(0), column(1)),
+              constant(ValueFactory::GetDoubleValue(20.0)))));
+
+  // C <> 0 AND A / C > 1, the division only sees rows the left side lets
+  // through
+  CheckFilterBatch(
+      tile_group,
+      new expression::ConjunctionExpression<expression::ConjunctionAnd>(
+          EXPRESSION_TYPE_CONJUNCTION_AND,
+          new expression::ComparisonExpression<expression::CmpNe>(
+              EXPRESSION_TYPE_COMPARE_NOTEQUAL, column(2),
+              constant(ValueFactory::GetTinyIntValue(0))),
+          new expression::ComparisonExpression<expression::CmpGt>(
+              EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+              new expression::OperatorExpression<expression::OpDivide>(
+                  EXPRESSION_TYPE_OPERATOR_DIVIDE, column(0), column(2)),
+              constant(ValueFactory::GetIntegerValue(1)))));
+
+  delete tuple;
+  delete tile_group;
+  delete schema;
+  delete schema1;
+  delete schema2;
+}
+
 }  // End test namespace
 }  // End peloton namespace
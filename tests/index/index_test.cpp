@@ -10,11 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <random>
+
 #include "gtest/gtest.h"
 #include "harness.h"
 
 #include "backend/common/logger.h"
+#include "backend/index/bwtree_index.h"
 #include "backend/index/index_factory.h"
+#include "backend/index/index_key.h"
 #include "backend/storage/tuple.h"
 
 namespace peloton {
@@ -31,14 +37,12 @@ ItemPointer item0(120, 5);
 ItemPointer item1(120, 7);
 ItemPointer item2(123, 19);
 
-index::Index *BuildIndex() {
+index::Index *BuildIndex(const bool unique_keys = false,
+                         const IndexType index_type = INDEX_TYPE_BWTREE) {
   // Build tuple and key schema
   std::vector<std::vector<std::string>> column_names;
   std::vector<catalog::Column> columns;
   std::vector<catalog::Schema *> schemas;
-  IndexType index_type = INDEX_TYPE_BTREE;
-  // TODO: Uncomment the line below
-  index_type = INDEX_TYPE_BWTREE;
 
   catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
                           "A", true);
@@ -62,8 +66,6 @@ index::Index *BuildIndex() {
   tuple_schema = new catalog::Schema(columns);
 
   // Build index metadata
-  const bool unique_keys = false;
-
   index::IndexMetadata *index_metadata = new index::IndexMetadata(
       "test_index", 125, index_type, INDEX_CONSTRAINT_TYPE_DEFAULT,
       tuple_schema, key_schema, unique_keys);
@@ -537,6 +539,249 @@ TEST(IndexTests, ScanTest) {
   delete tuple_schema;
 }
 
+TEST(IndexTests, RangeScanTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex());
+
+  // Enough distinct keys to split the leaves a few times
+  const oid_t key_count = 200;
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  for (oid_t key_itr = 1; key_itr <= key_count; key_itr++) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+
+  std::vector<oid_t> key_column_ids = {0, 0};
+  std::vector<ExpressionType> expr_types;
+  std::vector<peloton::Value> values;
+
+  // 50 <= A < 100
+  expr_types = {EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                EXPRESSION_TYPE_COMPARE_LESSTHAN};
+  values = {ValueFactory::GetIntegerValue(50),
+            ValueFactory::GetIntegerValue(100)};
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_FORWARD);
+  EXPECT_EQ(locations.size(), 50);
+  for (oid_t location_itr = 0; location_itr < locations.size();
+       location_itr++) {
+    EXPECT_EQ(locations[location_itr].block, 50 + location_itr);
+  }
+
+  // 50 < A <= 100, largest key first
+  expr_types = {EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO};
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_BACKWARD);
+  EXPECT_EQ(locations.size(), 50);
+  for (oid_t location_itr = 0; location_itr < locations.size();
+       location_itr++) {
+    EXPECT_EQ(locations[location_itr].block, 100 - location_itr);
+  }
+
+  // Remove the even keys
+  for (oid_t key_itr = 2; key_itr <= key_count; key_itr += 2) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    index->DeleteEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_FORWARD);
+  EXPECT_EQ(locations.size(), 25);
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_BACKWARD);
+  EXPECT_EQ(locations.size(), 25);
+  EXPECT_EQ(locations[0].block, 99);
+
+  delete tuple_schema;
+}
+
+TEST(IndexTests, ManyKeysTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex());
+  size_t empty_footprint = index->GetMemoryFootprint();
+
+  // Enough keys for a couple of levels of inner nodes
+  const oid_t key_count = 10000;
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+  EXPECT_GT(index->GetMemoryFootprint(), empty_footprint);
+
+  // Remove most keys and add them back
+  for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+    if (key_itr % 10 == 0) continue;
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    index->DeleteEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+  index->Cleanup();
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count / 10);
+
+  for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+    if (key_itr % 10 == 0) continue;
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+
+  key->SetValue(0, ValueFactory::GetIntegerValue(key_count - 1), pool);
+  key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 1);
+
+  delete tuple_schema;
+}
+
+TEST(IndexTests, RandomOrderTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex());
+
+  // Splits all over the tree, so inner nodes are consolidated and split too
+  const oid_t key_count = 10000;
+  std::vector<oid_t> key_order;
+  for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+    key_order.push_back(key_itr);
+  }
+  std::shuffle(key_order.begin(), key_order.end(), std::mt19937(7));
+
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  for (auto key_itr : key_order) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+
+  // Keys come back in order
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+  for (oid_t key_itr = 0; key_itr < locations.size(); key_itr++) {
+    EXPECT_EQ(locations[key_itr].block, key_itr);
+  }
+
+  for (auto key_itr : key_order) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    locations = index->ScanKey(key.get());
+    EXPECT_EQ(locations.size(), 1);
+    ASSERT_FALSE(locations.empty());
+    EXPECT_EQ(locations[0].block, key_itr);
+  }
+
+  delete tuple_schema;
+}
+
+TEST(IndexTests, HotKeyTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex());
+
+  const oid_t key_count = 1000;
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+
+  std::unique_ptr<storage::Tuple> hot_key(new storage::Tuple(key_schema, true));
+  hot_key->SetValue(0, ValueFactory::GetIntegerValue(key_count / 2), pool);
+  hot_key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+  std::unique_ptr<storage::Tuple> last_key(
+      new storage::Tuple(key_schema, true));
+  last_key->SetValue(0, ValueFactory::GetIntegerValue(key_count - 1), pool);
+  last_key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+
+  // Keep moving the hot key to a new location
+  ItemPointer hot_location(key_count / 2, 0);
+  for (oid_t update_itr = 1; update_itr <= 500; update_itr++) {
+    index->DeleteEntry(hot_key.get(), hot_location);
+    hot_location = ItemPointer(key_count / 2, update_itr);
+    index->InsertEntry(hot_key.get(), hot_location);
+
+    locations = index->ScanKey(hot_key.get());
+    EXPECT_EQ(locations.size(), 1);
+    EXPECT_EQ(locations[0].offset, update_itr);
+
+    locations = index->ScanKey(last_key.get());
+    EXPECT_EQ(locations.size(), 1);
+  }
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+
+  delete tuple_schema;
+}
+
+TEST(IndexTests, UniqueKeyTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex(true));
+
+  std::unique_ptr<storage::Tuple> key0(new storage::Tuple(key_schema, true));
+  key0->SetValue(0, ValueFactory::GetIntegerValue(100), pool);
+  key0->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+
+  EXPECT_TRUE(index->InsertEntry(key0.get(), item0));
+  EXPECT_FALSE(index->InsertEntry(key0.get(), item1));
+
+  // The existing entry conflicts
+  auto any_entry = [](const ItemPointer &) { return true; };
+  EXPECT_FALSE(index->CondInsertEntry(key0.get(), item1, any_entry));
+
+  // The existing entry is stale, so another version can go in
+  auto no_entry = [](const ItemPointer &) { return false; };
+  EXPECT_TRUE(index->CondInsertEntry(key0.get(), item1, no_entry));
+
+  locations = index->ScanKey(key0.get());
+  EXPECT_EQ(locations.size(), 2);
+
+  // Only the given version goes away
+  EXPECT_TRUE(index->DeleteEntry(key0.get(), item0));
+  locations = index->ScanKey(key0.get());
+  EXPECT_EQ(locations.size(), 1);
+  EXPECT_EQ(locations[0].block, item1.block);
+  EXPECT_EQ(locations[0].offset, item1.offset);
+
+  EXPECT_FALSE(index->DeleteEntry(key0.get(), item2));
+  EXPECT_TRUE(index->DeleteEntry(key0.get(), item1));
+  EXPECT_TRUE(index->InsertEntry(key0.get(), item2));
+
+  delete tuple_schema;
+}
+
 TEST(IndexTests, MultiThreadedInsertTest) {
   auto pool = TestingHarness::GetInstance().GetTestingPool();
   std::vector<ItemPointer> locations;
@@ -840,5 +1085,787 @@ TEST(IndexTests, AnotherDamnTest) {
   LOG_DEBUG("Finish another damn test!");
 }
 
+TEST(IndexTests, BulkLoadTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex());
+
+  // Unsorted input with two versions of every key
+  const oid_t key_count = 1000;
+  std::vector<std::unique_ptr<storage::Tuple>> keys;
+  std::vector<std::pair<const storage::Tuple *, ItemPointer>> entries;
+  for (oid_t key_itr = key_count; key_itr > 0; key_itr--) {
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    entries.push_back(std::make_pair(key.get(), ItemPointer(key_itr, 0)));
+    entries.push_back(std::make_pair(key.get(), ItemPointer(key_itr, 1)));
+    keys.push_back(std::move(key));
+  }
+
+  EXPECT_TRUE(index->BulkLoad(entries));
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), 2 * key_count);
+
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  key->SetValue(0, ValueFactory::GetIntegerValue(500), pool);
+  key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 2);
+
+  // The loaded tree takes regular updates
+  EXPECT_TRUE(index->DeleteEntry(key.get(), ItemPointer(500, 0)));
+  key->SetValue(0, ValueFactory::GetIntegerValue(key_count + 1), pool);
+  EXPECT_TRUE(index->InsertEntry(key.get(), item0));
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), 2 * key_count);
+
+  // Only an empty index can be bulk loaded
+  EXPECT_THROW(index->BulkLoad(entries), IndexException);
+
+  delete tuple_schema;
+
+  // A unique index does not take two versions of a key, and stays empty
+  index.reset(BuildIndex(true));
+  EXPECT_FALSE(index->BulkLoad(entries));
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), 0);
+
+  // One version of each key is fine
+  std::vector<std::pair<const storage::Tuple *, ItemPointer>> unique_entries;
+  for (size_t entry_itr = 0; entry_itr < entries.size(); entry_itr += 2)
+    unique_entries.push_back(entries[entry_itr]);
+  EXPECT_TRUE(index->BulkLoad(unique_entries));
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+
+  delete tuple_schema;
+}
+
+TEST(IndexTests, GenericKeyComparatorTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+
+  std::vector<catalog::Column> columns;
+  columns.push_back(catalog::Column(
+      VALUE_TYPE_BIGINT, GetTypeSize(VALUE_TYPE_BIGINT), "A", true));
+  columns.push_back(catalog::Column(
+      VALUE_TYPE_DOUBLE, GetTypeSize(VALUE_TYPE_DOUBLE), "B", true));
+  columns.push_back(catalog::Column(
+      VALUE_TYPE_VARCHAR, 16, "C", true));
+  auto generic_key_schema = new catalog::Schema(columns);
+  generic_key_schema->SetIndexedColumns({0, 1, 2});
+
+  index::IndexMetadata metadata("generic_key_index", 126, INDEX_TYPE_BWTREE,
+                                INDEX_CONSTRAINT_TYPE_DEFAULT,
+                                generic_key_schema, generic_key_schema, false);
+  index::GenericComparator<32> comparator(&metadata);
+  index::GenericEqualityChecker<32> equals(&metadata);
+
+  std::vector<Value> bigint_values = {
+      ValueFactory::GetNullValueByType(VALUE_TYPE_BIGINT),
+      ValueFactory::GetBigIntValue(-7), ValueFactory::GetBigIntValue(0),
+      ValueFactory::GetBigIntValue(1L << 40)};
+  std::vector<Value> double_values = {
+      ValueFactory::GetNullValueByType(VALUE_TYPE_DOUBLE),
+      ValueFactory::GetDoubleValue(-2.5), ValueFactory::GetDoubleValue(0.5)};
+  std::vector<Value> varchar_values = {ValueFactory::GetStringValue("a"),
+                                       ValueFactory::GetStringValue("ab"),
+                                       ValueFactory::GetStringValue("b")};
+
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  for (auto &bigint_value : bigint_values) {
+    for (auto &double_value : double_values) {
+      for (auto &varchar_value : varchar_values) {
+        std::unique_ptr<storage::Tuple> tuple(
+            new storage::Tuple(generic_key_schema, true));
+        tuple->SetValue(0, bigint_value, pool);
+        tuple->SetValue(1, double_value, pool);
+        tuple->SetValue(2, varchar_value, pool);
+        tuples.push_back(std::move(tuple));
+      }
+    }
+  }
+
+  // The comparators agree with comparing the columns as values
+  for (auto &lhs : tuples) {
+    index::GenericKey<32> lhs_key;
+    lhs_key.SetFromKey(lhs.get());
+    for (auto &rhs : tuples) {
+      index::GenericKey<32> rhs_key;
+      rhs_key.SetFromKey(rhs.get());
+      int diff = lhs->Compare(*rhs);
+      EXPECT_EQ(comparator(lhs_key, rhs_key), diff < 0);
+      EXPECT_EQ(equals(lhs_key, rhs_key), diff == 0);
+    }
+  }
+}
+
+TEST(IndexTests, HashIndexTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex(false, INDEX_TYPE_HASH));
+  EXPECT_EQ(index->GetTypeName(), "Hash");
+
+  // Enough keys for the segments to grow a few times
+  const oid_t key_count = 10000;
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    EXPECT_TRUE(index->InsertEntry(key.get(), ItemPointer(key_itr, 0)));
+  }
+
+  key->SetValue(0, ValueFactory::GetIntegerValue(100), pool);
+  EXPECT_TRUE(index->InsertEntry(key.get(), item1));
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count + 1);
+
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 2);
+
+  // Equality on every key column
+  std::vector<oid_t> key_column_ids = {0, 1};
+  std::vector<ExpressionType> expr_types = {EXPRESSION_TYPE_COMPARE_EQUAL,
+                                            EXPRESSION_TYPE_COMPARE_EQUAL};
+  std::vector<Value> values = {ValueFactory::GetIntegerValue(100),
+                               ValueFactory::GetStringValue("a")};
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_FORWARD);
+  EXPECT_EQ(locations.size(), 2);
+
+  values[1] = ValueFactory::GetStringValue("b");
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_FORWARD);
+  EXPECT_EQ(locations.size(), 0);
+
+  // Ranges can not be answered
+  expr_types[0] = EXPRESSION_TYPE_COMPARE_GREATERTHAN;
+  EXPECT_THROW(index->Scan(values, key_column_ids, expr_types,
+                           SCAN_DIRECTION_TYPE_FORWARD),
+               IndexException);
+
+  // Neither can equality on only some of the key columns
+  key_column_ids = {0};
+  expr_types = {EXPRESSION_TYPE_COMPARE_EQUAL};
+  values = {ValueFactory::GetIntegerValue(100)};
+  EXPECT_THROW(index->Scan(values, key_column_ids, expr_types,
+                           SCAN_DIRECTION_TYPE_FORWARD),
+               IndexException);
+
+  EXPECT_TRUE(index->DeleteEntry(key.get(), item1));
+  EXPECT_FALSE(index->DeleteEntry(key.get(), item1));
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 1);
+
+  delete tuple_schema;
+
+  // Unique hash index
+  key.reset();
+  index.reset(BuildIndex(true, INDEX_TYPE_HASH));
+  key.reset(new storage::Tuple(key_schema, true));
+  key->SetValue(0, ValueFactory::GetIntegerValue(100), pool);
+  key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+
+  EXPECT_TRUE(index->InsertEntry(key.get(), item0));
+  EXPECT_FALSE(index->InsertEntry(key.get(), item1));
+
+  auto any_entry = [](const ItemPointer &) { return true; };
+  EXPECT_FALSE(index->CondInsertEntry(key.get(), item1, any_entry));
+  auto no_entry = [](const ItemPointer &) { return false; };
+  EXPECT_TRUE(index->CondInsertEntry(key.get(), item1, no_entry));
+
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 2);
+
+  delete tuple_schema;
+}
+
+// Each thread takes the next key until all are inserted
+void OLCBTreeInsertTest(index::Index *index, VarlenPool *pool,
+                        std::atomic<oid_t> *next_key, oid_t key_count) {
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  for (oid_t key_itr = (*next_key)++; key_itr < key_count;
+       key_itr = (*next_key)++) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+    EXPECT_TRUE(index->InsertEntry(key.get(), ItemPointer(key_itr, 0)));
+  }
+}
+
+TEST(IndexTests, OLCBTreeTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // INDEX
+  std::unique_ptr<index::Index> index(BuildIndex(false, INDEX_TYPE_OLC_BTREE));
+  EXPECT_EQ(index->GetTypeName(), "OLCBTree");
+
+  // Multi threaded inserts
+  const oid_t key_count = 10000;
+  std::atomic<oid_t> next_key(0);
+  LaunchParallelTest(4, OLCBTreeInsertTest, index.get(), pool, &next_key,
+                     key_count);
+
+  // The values of a key span several leaves
+  const oid_t value_count = 200;
+  const oid_t hot_key = key_count / 2;
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  key->SetValue(0, ValueFactory::GetIntegerValue(hot_key), pool);
+  key->SetValue(1, ValueFactory::GetStringValue("b"), pool);
+  for (oid_t value_itr = 1; value_itr <= value_count; value_itr++) {
+    EXPECT_TRUE(index->InsertEntry(key.get(), ItemPointer(hot_key, value_itr)));
+  }
+  EXPECT_FALSE(index->InsertEntry(key.get(), ItemPointer(hot_key, 1)));
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count + value_count);
+  for (oid_t location_itr = 1; location_itr < locations.size();
+       location_itr++) {
+    EXPECT_LE(locations[location_itr - 1].block, locations[location_itr].block);
+  }
+
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), value_count);
+
+  // Range on the leading column in both directions
+  std::vector<oid_t> key_column_ids = {0, 0};
+  std::vector<ExpressionType> expr_types = {
+      EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+      EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO};
+  std::vector<Value> values = {ValueFactory::GetIntegerValue(hot_key - 10),
+                               ValueFactory::GetIntegerValue(hot_key)};
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_FORWARD);
+  EXPECT_EQ(locations.size(), 11 + value_count);
+  EXPECT_EQ(locations.front().block, hot_key - 10);
+  EXPECT_EQ(locations.back().offset, value_count);
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_BACKWARD);
+  EXPECT_EQ(locations.size(), 11 + value_count);
+  EXPECT_EQ(locations.front().offset, value_count);
+  EXPECT_EQ(locations[value_count].block, hot_key);
+  EXPECT_EQ(locations[value_count].offset, 0);
+  EXPECT_EQ(locations.back().block, hot_key - 10);
+
+  for (oid_t value_itr = 1; value_itr <= value_count; value_itr++) {
+    EXPECT_TRUE(index->DeleteEntry(key.get(), ItemPointer(hot_key, value_itr)));
+  }
+  EXPECT_FALSE(index->DeleteEntry(key.get(), ItemPointer(hot_key, 1)));
+
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 0);
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+
+  EXPECT_TRUE(index->Cleanup());
+  EXPECT_GT(index->GetMemoryFootprint(), 0);
+
+  delete tuple_schema;
+}
+
+// Scans in small batches have to add up to the whole scan, also when the
+// values of a key are split over several batches
+TEST(IndexTests, ScanBatchTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<IndexType> index_types = {INDEX_TYPE_BTREE, INDEX_TYPE_BWTREE,
+                                        INDEX_TYPE_OLC_BTREE};
+
+  for (auto index_type : index_types) {
+    std::unique_ptr<index::Index> index(BuildIndex(false, index_type));
+
+    const oid_t key_count = 100;
+    const oid_t value_count = 50;
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+      key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+      key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+      index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+    }
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_count / 2), pool);
+    for (oid_t value_itr = 1; value_itr <= value_count; value_itr++) {
+      index->InsertEntry(key.get(), ItemPointer(key_count / 2, value_itr));
+    }
+
+    std::vector<oid_t> key_column_ids = {0, 0};
+    std::vector<ExpressionType> expr_types = {
+        EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+        EXPRESSION_TYPE_COMPARE_LESSTHAN};
+    std::vector<Value> values = {ValueFactory::GetIntegerValue(10),
+                                 ValueFactory::GetIntegerValue(90)};
+
+    for (auto scan_direction :
+         {SCAN_DIRECTION_TYPE_FORWARD, SCAN_DIRECTION_TYPE_BACKWARD}) {
+      auto expected =
+          index->Scan(values, key_column_ids, expr_types, scan_direction);
+      EXPECT_EQ(expected.size(), 80 + value_count);
+
+      const size_t batch_size = 7;
+      std::vector<ItemPointer> locations;
+      index::Index::ScanCursor cursor;
+      size_t batch_count = 0;
+      while (!cursor.done) {
+        auto batch = index->ScanBatch(values, key_column_ids, expr_types,
+                                      scan_direction, batch_size, cursor);
+        EXPECT_LE(batch.size(), batch_size);
+        locations.insert(locations.end(), batch.begin(), batch.end());
+        batch_count++;
+      }
+      EXPECT_GE(batch_count, expected.size() / batch_size);
+
+      EXPECT_EQ(locations.size(), expected.size());
+      for (oid_t location_itr = 0; location_itr < locations.size();
+           location_itr++) {
+        EXPECT_EQ(locations[location_itr].block, expected[location_itr].block);
+        EXPECT_EQ(locations[location_itr].offset,
+                  expected[location_itr].offset);
+      }
+    }
+
+    delete tuple_schema;
+  }
+}
+
+// A batch of key lookups has to find the same entries as looking up each
+// key on its own, whatever order the keys come in
+TEST(IndexTests, ScanKeysTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<IndexType> index_types = {INDEX_TYPE_BTREE, INDEX_TYPE_BWTREE,
+                                        INDEX_TYPE_OLC_BTREE};
+
+  for (auto index_type : index_types) {
+    std::unique_ptr<index::Index> index(BuildIndex(false, index_type));
+
+    // Every third key is missing, the others have one or two entries
+    const oid_t key_count = 300;
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+      if (key_itr % 3 == 0) continue;
+      key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+      key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+      index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+      if (key_itr % 2 == 0)
+        index->InsertEntry(key.get(), ItemPointer(key_itr, 1));
+    }
+
+    // Probe keys out of order, with repeats and some past the last key
+    std::vector<std::unique_ptr<storage::Tuple>> probe_tuples;
+    std::vector<const storage::Tuple *> probes;
+    for (oid_t probe_itr = 0; probe_itr < 200; probe_itr++) {
+      oid_t probe_key = (probe_itr * 37) % (key_count + 20);
+      std::unique_ptr<storage::Tuple> probe(
+          new storage::Tuple(key_schema, true));
+      probe->SetValue(0, ValueFactory::GetIntegerValue(probe_key), pool);
+      probe->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+      probes.push_back(probe.get());
+      probe_tuples.push_back(std::move(probe));
+    }
+
+    auto results = index->ScanKeys(probes);
+    EXPECT_EQ(results.size(), probes.size());
+
+    for (oid_t probe_itr = 0; probe_itr < probes.size(); probe_itr++) {
+      auto expected = index->ScanKey(probes[probe_itr]);
+      auto &locations = results[probe_itr];
+      EXPECT_EQ(locations.size(), expected.size());
+
+      // Entries of a key may come in any order
+      auto by_offset = [](const ItemPointer &a, const ItemPointer &b) {
+        return a.offset < b.offset;
+      };
+      std::sort(expected.begin(), expected.end(), by_offset);
+      std::sort(locations.begin(), locations.end(), by_offset);
+      for (oid_t location_itr = 0;
+           location_itr < std::min(locations.size(), expected.size());
+           location_itr++) {
+        EXPECT_EQ(locations[location_itr].block, expected[location_itr].block);
+        EXPECT_EQ(locations[location_itr].offset,
+                  expected[location_itr].offset);
+      }
+    }
+
+    delete tuple_schema;
+  }
+}
+
+// Keys of two integer columns, so that the index can use IntsKey
+TEST(IndexTests, ARTIndexTest) {
+  std::vector<ItemPointer> locations;
+
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  catalog::Column column2(VALUE_TYPE_BIGINT, GetTypeSize(VALUE_TYPE_BIGINT),
+                          "B", true);
+  std::vector<catalog::Column> columns = {column1, column2};
+
+  key_schema = new catalog::Schema(columns);
+  key_schema->SetIndexedColumns({0, 1});
+  tuple_schema = new catalog::Schema(columns);
+
+  index::IndexMetadata *index_metadata = new index::IndexMetadata(
+      "art_index", 126, INDEX_TYPE_ART, INDEX_CONSTRAINT_TYPE_DEFAULT,
+      tuple_schema, key_schema, false);
+  std::unique_ptr<index::Index> index(
+      index::IndexFactory::GetInstance(index_metadata));
+  EXPECT_EQ(index->GetTypeName(), "ART");
+
+  // Dense keys around zero, so that the nodes fill up and grow. Every
+  // leading value has a few second values.
+  const int32_t key_count = 5000;
+  const int64_t group_size = 4;
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+  for (int32_t key_itr = -key_count / 2; key_itr < key_count / 2; key_itr++) {
+    for (int64_t group_itr = 0; group_itr < group_size; group_itr++) {
+      key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), nullptr);
+      key->SetValue(1, ValueFactory::GetBigIntValue(group_itr << 40), nullptr);
+      EXPECT_TRUE(index->InsertEntry(
+          key.get(), ItemPointer(key_itr + key_count, group_itr)));
+    }
+  }
+  EXPECT_FALSE(index->InsertEntry(key.get(), ItemPointer(key_count * 3 / 2 - 1,
+                                                         group_size - 1)));
+  EXPECT_TRUE(index->InsertEntry(key.get(), item0));
+
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 2);
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count * group_size + 1);
+  for (oid_t location_itr = 1; location_itr < locations.size() - 1;
+       location_itr++) {
+    EXPECT_LE(locations[location_itr - 1].block, locations[location_itr].block);
+  }
+
+  // Range on the leading column in both directions
+  std::vector<oid_t> key_column_ids = {0, 0};
+  std::vector<ExpressionType> expr_types = {
+      EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+      EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO};
+  std::vector<Value> values = {ValueFactory::GetIntegerValue(-10),
+                               ValueFactory::GetIntegerValue(10)};
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_FORWARD);
+  EXPECT_EQ(locations.size(), 21 * group_size);
+  EXPECT_EQ(locations.front().block, key_count - 10);
+  EXPECT_EQ(locations.back().block, key_count + 10);
+
+  locations = index->Scan(values, key_column_ids, expr_types,
+                          SCAN_DIRECTION_TYPE_BACKWARD);
+  EXPECT_EQ(locations.size(), 21 * group_size);
+  EXPECT_EQ(locations.front().block, key_count + 10);
+  EXPECT_EQ(locations.front().offset, group_size - 1);
+  EXPECT_EQ(locations.back().block, key_count - 10);
+  EXPECT_EQ(locations.back().offset, 0);
+
+  // Batches have to add up to the whole scan
+  index::Index::ScanCursor cursor;
+  oid_t batch_total = 0;
+  while (!cursor.done) {
+    batch_total += index->ScanBatch(values, key_column_ids, expr_types,
+                                    SCAN_DIRECTION_TYPE_FORWARD, 7,
+                                    cursor).size();
+  }
+  EXPECT_EQ(batch_total, 21 * group_size);
+
+  // Deleting most keys shrinks the nodes again
+  size_t full_footprint = index->GetMemoryFootprint();
+  for (int32_t key_itr = -key_count / 2; key_itr < key_count / 2; key_itr++) {
+    if (key_itr % 100 == 0) continue;
+    for (int64_t group_itr = 0; group_itr < group_size; group_itr++) {
+      key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), nullptr);
+      key->SetValue(1, ValueFactory::GetBigIntValue(group_itr << 40), nullptr);
+      EXPECT_TRUE(index->DeleteEntry(
+          key.get(), ItemPointer(key_itr + key_count, group_itr)));
+    }
+  }
+  EXPECT_FALSE(index->DeleteEntry(key.get(), ItemPointer(0, 0)));
+  EXPECT_TRUE(index->DeleteEntry(key.get(), item0));
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), (key_count / 100) * group_size);
+
+  EXPECT_TRUE(index->Cleanup());
+  EXPECT_LT(index->GetMemoryFootprint(), full_footprint);
+
+  delete tuple_schema;
+
+  // Other key types are not supported
+  EXPECT_THROW(BuildIndex(false, INDEX_TYPE_ART), IndexException);
+  delete tuple_schema;
+}
+
+TEST(IndexTests, BackgroundMaintenanceTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // Integer keys, so the tree can be built directly
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  std::unique_ptr<catalog::Schema> int_tuple_schema(
+      new catalog::Schema({column1}));
+  catalog::Schema *int_key_schema = new catalog::Schema({column1});
+  int_key_schema->SetIndexedColumns({0});
+  index::IndexMetadata *index_metadata = new index::IndexMetadata(
+      "maintenance_index", 126, INDEX_TYPE_BWTREE,
+      INDEX_CONSTRAINT_TYPE_DEFAULT, int_tuple_schema.get(), int_key_schema,
+      false);
+
+  typedef index::BWTreeIndex<index::IntsKey<1>, ItemPointer,
+                             index::IntsComparator<1>,
+                             index::IntsEqualityChecker<1>> IntsBWTreeIndex;
+  std::unique_ptr<IntsBWTreeIndex> index(new IntsBWTreeIndex(index_metadata));
+
+  // Thresholds are checked against each other
+  EXPECT_THROW(index->SetConsolidateThreshold(0), IndexException);
+  EXPECT_THROW(index->SetMergeSize(SPLIT_SIZE), IndexException);
+  index->SetSplitSize(16);
+  index->SetMergeSize(6);
+  index->SetConsolidateThreshold(4);
+  index->SetBackgroundMaintenance(true);
+
+  // Writes from several threads only post hints
+  const int thread_count = 4;
+  const int keys_per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.push_back(std::thread([&, thread_itr] {
+      std::unique_ptr<storage::Tuple> key(
+          new storage::Tuple(int_key_schema, true));
+      for (int key_itr = thread_itr; key_itr < thread_count * keys_per_thread;
+           key_itr += thread_count) {
+        key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+        index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+      }
+    }));
+  }
+  for (auto &thread : threads) thread.join();
+  index->WaitForMaintenance();
+
+  // The maintenance thread did the structural work
+  EXPECT_GT(index->GetConsolidationCount(), 0);
+  EXPECT_GT(index->GetSplitCount(), 0);
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), thread_count * keys_per_thread);
+  for (size_t location_itr = 0; location_itr < locations.size();
+       location_itr++) {
+    EXPECT_EQ(locations[location_itr].block, location_itr);
+  }
+
+  // Deleting most keys leaves merges to the maintenance thread
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(int_key_schema, true));
+  for (int key_itr = 0; key_itr < thread_count * keys_per_thread; key_itr++) {
+    if (key_itr % 10 == 0) continue;
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    index->DeleteEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+  index->WaitForMaintenance();
+  EXPECT_GT(index->GetMergeCount(), 0);
+
+  // Back to inline structure modifications
+  index->SetBackgroundMaintenance(false);
+  key->SetValue(0, ValueFactory::GetIntegerValue(1), pool);
+  EXPECT_TRUE(index->InsertEntry(key.get(), ItemPointer(1, 0)));
+
+  locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), thread_count * keys_per_thread / 10 + 1);
+
+  locations = index->ScanKey(key.get());
+  EXPECT_EQ(locations.size(), 1);
+}
+
+TEST(IndexTests, StatisticsTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+
+  // Power of two buckets
+  index::StatisticsHistogram histogram;
+  for (uint64_t value = 0; value < 100; value++) histogram.Add(value);
+  EXPECT_EQ(histogram.GetCount(), 100);
+  EXPECT_EQ(histogram.GetMax(), 99);
+  EXPECT_EQ(histogram.GetBucketCount(0), 1);
+  EXPECT_EQ(histogram.GetBucketCount(3), 4);
+  EXPECT_EQ(histogram.GetPercentile(0.5), 63);
+  EXPECT_EQ(histogram.GetPercentile(1.0), 99);
+
+  for (auto index_type : {INDEX_TYPE_BWTREE, INDEX_TYPE_BTREE}) {
+    std::unique_ptr<index::Index> index(BuildIndex(false, index_type));
+
+    const oid_t key_count = 1000;
+    std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+      key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+      key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+      index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+    }
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr += 2) {
+      key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+      key->SetValue(1, ValueFactory::GetStringValue("a"), pool);
+      index->DeleteEntry(key.get(), ItemPointer(key_itr, 0));
+      index->ScanKey(key.get());
+    }
+
+    auto statistics = index->GetStatistics();
+    LOG_INFO("%s statistics :\n%s", index->GetTypeName().c_str(),
+             statistics.GetInfo().c_str());
+
+    EXPECT_GT(statistics.GetCounter("memory_footprint"), 0);
+    EXPECT_EQ(statistics.GetCounter("inserts"), key_count);
+    EXPECT_EQ(statistics.GetCounter("deletes"), key_count / 2);
+    EXPECT_EQ(statistics.GetCounter("lookups"), key_count / 2);
+
+    if (index_type == INDEX_TYPE_BWTREE) {
+      EXPECT_GT(statistics.GetCounter("consolidations"), 0);
+      EXPECT_GT(statistics.GetCounter("splits"), 0);
+      EXPECT_GT(statistics.GetCounter("nodes"), 0);
+      EXPECT_TRUE(statistics.HasCounter("epoch_lag"));
+      EXPECT_TRUE(statistics.HasCounter("garbage_pages"));
+
+      // Every insert but the first and every delete installed a delta
+      auto chain_length = statistics.GetHistogram("modify_chain_length");
+      EXPECT_EQ(chain_length.GetCount(), key_count - 1 + key_count / 2);
+      EXPECT_GT(chain_length.GetMax(), 1);
+    } else {
+      EXPECT_EQ(statistics.GetCounter("entries"), key_count / 2);
+      EXPECT_GT(statistics.GetCounter("leaves"), 0);
+    }
+
+    delete tuple_schema;
+  }
+}
+
+TEST(IndexTests, PIDRecyclingTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  std::unique_ptr<catalog::Schema> int_tuple_schema(
+      new catalog::Schema({column1}));
+  catalog::Schema *int_key_schema = new catalog::Schema({column1});
+  int_key_schema->SetIndexedColumns({0});
+  index::IndexMetadata *index_metadata = new index::IndexMetadata(
+      "recycling_index", 127, INDEX_TYPE_BWTREE,
+      INDEX_CONSTRAINT_TYPE_DEFAULT, int_tuple_schema.get(), int_key_schema,
+      false);
+
+  typedef index::BWTreeIndex<index::IntsKey<1>, ItemPointer,
+                             index::IntsComparator<1>,
+                             index::IntsEqualityChecker<1>> IntsBWTreeIndex;
+  std::unique_ptr<IntsBWTreeIndex> index(new IntsBWTreeIndex(index_metadata));
+  index->SetSplitSize(16);
+  index->SetMergeSize(6);
+  index->SetConsolidateThreshold(4);
+
+  const int key_count = 4000;
+  std::unique_ptr<storage::Tuple> key(new storage::Tuple(int_key_schema, true));
+  for (int key_itr = 0; key_itr < key_count; key_itr++) {
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+
+  // Emptied leaves are merged into their left siblings
+  for (int key_itr = 0; key_itr < key_count; key_itr++) {
+    if (key_itr % 10 == 0) continue;
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    index->DeleteEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+  EXPECT_GT(index->GetMergeCount(), 0);
+
+  // Their PIDs are freed once nobody can be on the way to them
+  std::this_thread::sleep_for(std::chrono::milliseconds(EPOCH_INTERVAL_MS * 3));
+  EXPECT_TRUE(index->Cleanup());
+  auto statistics = index->GetStatistics();
+  EXPECT_EQ(statistics.GetCounter("garbage_pids"), 0);
+  uint64_t free_pids = statistics.GetCounter("free_pids");
+  uint64_t pids = statistics.GetCounter("pids");
+  uint64_t splits = index->GetSplitCount();
+  EXPECT_GT(free_pids, 0);
+
+  // New nodes take the freed PIDs before the mapping table grows
+  for (int key_itr = 0; key_itr < key_count; key_itr++) {
+    if (key_itr % 10 == 0) continue;
+    key->SetValue(0, ValueFactory::GetIntegerValue(key_itr), pool);
+    index->InsertEntry(key.get(), ItemPointer(key_itr, 0));
+  }
+  statistics = index->GetStatistics();
+  EXPECT_GT(index->GetSplitCount(), splits);
+  EXPECT_LT(statistics.GetCounter("free_pids"), free_pids);
+  EXPECT_LT(statistics.GetCounter("pids") - pids,
+            index->GetSplitCount() - splits);
+
+  auto locations = index->ScanAllKeys();
+  EXPECT_EQ(locations.size(), key_count);
+  for (size_t location_itr = 0; location_itr < locations.size();
+       location_itr++) {
+    EXPECT_EQ(locations[location_itr].block, location_itr);
+  }
+}
+
+TEST(IndexTests, SeparatorTest) {
+  auto pool = TestingHarness::GetInstance().GetTestingPool();
+  std::vector<ItemPointer> locations;
+
+  // Neighbouring keys differ in the first column, or only in the last one
+  const oid_t key_count = 1000;
+  std::vector<std::unique_ptr<storage::Tuple>> keys;
+  std::vector<std::pair<const storage::Tuple *, ItemPointer>> entries;
+
+  for (bool bulk_load : {false, true}) {
+    std::unique_ptr<index::Index> index(BuildIndex());
+    keys.clear();
+    entries.clear();
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+      std::unique_ptr<storage::Tuple> key(new storage::Tuple(key_schema, true));
+      key->SetValue(0, ValueFactory::GetIntegerValue(key_itr / 4), pool);
+      key->SetValue(1, ValueFactory::GetStringValue(std::to_string(key_itr)),
+                    pool);
+      entries.push_back(std::make_pair(key.get(), ItemPointer(key_itr, 0)));
+      keys.push_back(std::move(key));
+    }
+
+    if (bulk_load) {
+      EXPECT_TRUE(index->BulkLoad(entries));
+    } else {
+      for (auto &entry : entries) index->InsertEntry(entry.first, entry.second);
+    }
+
+    // Inner nodes only keep the first column of most separators
+    auto statistics = index->GetStatistics();
+    EXPECT_GT(statistics.GetCounter("separator_bytes"), 0);
+    EXPECT_GT(statistics.GetCounter("separator_bytes_saved"), 0);
+
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+      locations = index->ScanKey(keys[key_itr].get());
+      ASSERT_EQ(locations.size(), 1);
+      EXPECT_EQ(locations[0].block, key_itr);
+    }
+    locations = index->ScanAllKeys();
+    EXPECT_EQ(locations.size(), key_count);
+
+    // Nodes merged on the way keep finding their neighbours
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+      if (key_itr % 4 == 0) continue;
+      EXPECT_TRUE(index->DeleteEntry(keys[key_itr].get(),
+                                     ItemPointer(key_itr, 0)));
+    }
+    for (oid_t key_itr = 0; key_itr < key_count; key_itr++) {
+      locations = index->ScanKey(keys[key_itr].get());
+      EXPECT_EQ(locations.size(), (key_itr % 4 == 0) ? 1 : 0);
+    }
+    locations = index->ScanAllKeys();
+    EXPECT_EQ(locations.size(), key_count / 4);
+
+    delete tuple_schema;
+  }
+}
+
 }  // End test namespace
 }  // End peloton namespace
@@ -10,10 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <set>
+
 #include "gtest/gtest.h"
+#include "harness.h"
 
+#include "backend/concurrency/transaction_manager.h"
+#include "backend/index/index.h"
+#include "backend/index/index_factory.h"
 #include "backend/storage/data_table.h"
 #include "backend/storage/tile_group.h"
+#include "backend/storage/tuple.h"
 #include "executor/executor_tests_util.h"
 
 namespace peloton {
@@ -67,5 +74,293 @@ TEST(DataTableTests, TransformTileGroupTest) {
   data_table->TransformTileGroup(0, theta);
 }
 
+void InsertTuples(storage::DataTable *table, const storage::Tuple *tuple,
+                  std::vector<ItemPointer> *locations) {
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+
+  for (int insert_itr = 0; insert_itr < 1000; insert_itr++) {
+    ItemPointer location = table->InsertTuple(txn, tuple);
+    EXPECT_TRUE(location.block != INVALID_OID);
+    txn->RecordInsert(location);
+    locations->push_back(location);
+  }
+
+  txn_manager.CommitTransaction();
+}
+
+TEST(DataTableTests, ConcurrentInsertTest) {
+  const size_t thread_count = 4;
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+
+  // Small tile groups, so threads keep moving on to new ones
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(100, false));
+  std::unique_ptr<storage::Tuple> tuple(
+      ExecutorTestsUtil::GetTuple(data_table.get(), 1, testing_pool));
+
+  std::vector<std::vector<ItemPointer>> locations(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.push_back(std::thread(InsertTuples, data_table.get(), tuple.get(),
+                                  &locations[thread_itr]));
+  }
+  for (auto &thread : threads) thread.join();
+
+  // Every slot was handed out once
+  std::set<std::pair<oid_t, oid_t>> slots;
+  for (auto &thread_locations : locations) {
+    for (auto &location : thread_locations) {
+      slots.insert(std::make_pair(location.block, location.offset));
+    }
+  }
+  EXPECT_EQ(slots.size(), thread_count * 1000);
+
+  // Slot counters stop at the capacity even if threads raced past it
+  size_t used_slot_count = 0;
+  for (oid_t tile_group_itr = 0;
+       tile_group_itr < data_table->GetTileGroupCount(); tile_group_itr++) {
+    auto tile_group = data_table->GetTileGroup(tile_group_itr);
+    EXPECT_LE(tile_group->GetNextTupleSlot(),
+              tile_group->GetAllocatedTupleCount());
+    used_slot_count += tile_group->GetNextTupleSlot();
+  }
+  EXPECT_EQ(used_slot_count, thread_count * 1000);
+}
+
+TEST(DataTableTests, BatchInsertTest) {
+  const oid_t tuple_count = 12;
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+
+  // Tile groups of five tuples, with a primary and a secondary index
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(5, true));
+
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  std::vector<const storage::Tuple *> batch;
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    tuples.emplace_back(
+        ExecutorTestsUtil::GetTuple(data_table.get(), tuple_itr, testing_pool));
+    batch.push_back(tuples.back().get());
+  }
+
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+
+  auto locations = data_table->InsertTuples(txn, batch);
+  EXPECT_EQ(locations.size(), tuple_count);
+  for (auto location : locations) txn->RecordInsert(location);
+
+  // The batch fills the tile groups in order, in contiguous slots
+  for (oid_t tuple_itr = 0; tuple_itr < locations.size(); tuple_itr++) {
+    auto location = locations[tuple_itr];
+    if (tuple_itr > 0 && location.block == locations[tuple_itr - 1].block) {
+      EXPECT_EQ(location.offset, locations[tuple_itr - 1].offset + 1);
+    }
+
+    auto tile_group = data_table->GetTileGroupById(location.block);
+    EXPECT_TRUE(tile_group->GetValue(location.offset, 0)
+                    .OpEquals(batch[tuple_itr]->GetValue(0))
+                    .IsTrue());
+  }
+
+  for (oid_t index_itr = 0; index_itr < data_table->GetIndexCount();
+       index_itr++) {
+    EXPECT_EQ(data_table->GetIndex(index_itr)->ScanAllKeys().size(),
+              tuple_count);
+  }
+
+  // A batch with a key that is already there fails as a whole
+  std::vector<const storage::Tuple *> duplicate_batch = {batch[0]};
+  EXPECT_TRUE(data_table->InsertTuples(txn, duplicate_batch).empty());
+
+  txn_manager.CommitTransaction();
+}
+
+TEST(DataTableTests, BatchInsertConflictTest) {
+  const oid_t tuple_count = 5;
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(tuple_count, true));
+
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    tuples.emplace_back(
+        ExecutorTestsUtil::GetTuple(data_table.get(), tuple_itr, testing_pool));
+  }
+
+  // The second copy of a key in the middle of the batch is rejected
+  std::vector<const storage::Tuple *> batch = {
+      tuples[0].get(), tuples[1].get(), tuples[2].get(), tuples[1].get(),
+      tuples[3].get()};
+
+  auto txn = txn_manager.BeginTransaction();
+  EXPECT_TRUE(data_table->InsertTuples(txn, batch).empty());
+  txn_manager.CommitTransaction();
+  auto tile_group_count = data_table->GetTileGroupCount();
+
+  // Neither index entries nor slots of the batch are left behind
+  for (oid_t index_itr = 0; index_itr < data_table->GetIndexCount();
+       index_itr++) {
+    EXPECT_EQ(data_table->GetIndex(index_itr)->ScanAllKeys().size(), 0);
+  }
+
+  // So the same keys can go in again, into the freed slots
+  txn = txn_manager.BeginTransaction();
+  for (auto &tuple : tuples) {
+    ItemPointer location = data_table->InsertTuple(txn, tuple.get());
+    EXPECT_TRUE(location.block != INVALID_OID);
+    txn->RecordInsert(location);
+  }
+  txn_manager.CommitTransaction();
+
+  EXPECT_EQ(data_table->GetTileGroupCount(), tile_group_count);
+  for (oid_t index_itr = 0; index_itr < data_table->GetIndexCount();
+       index_itr++) {
+    EXPECT_EQ(data_table->GetIndex(index_itr)->ScanAllKeys().size(),
+              tuple_count);
+  }
+}
+
+TEST(DataTableTests, VacuumTest) {
+  const oid_t tuple_count = 10;
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+
+  // Two tile groups worth of tuples
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(5, true));
+
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    tuples.emplace_back(
+        ExecutorTestsUtil::GetTuple(data_table.get(), tuple_itr, testing_pool));
+  }
+
+  auto txn = txn_manager.BeginTransaction();
+  std::set<std::pair<oid_t, oid_t>> slots;
+  for (auto &tuple : tuples) {
+    ItemPointer location = data_table->InsertTuple(txn, tuple.get());
+    txn->RecordInsert(location);
+    slots.insert(std::make_pair(location.block, location.offset));
+  }
+  txn_manager.CommitTransaction();
+  auto tile_group_count = data_table->GetTileGroupCount();
+
+  txn = txn_manager.BeginTransaction();
+  for (auto slot : slots) {
+    ItemPointer location(slot.first, slot.second);
+    EXPECT_TRUE(data_table->DeleteTuple(txn, location));
+    txn->RecordDelete(location);
+  }
+  txn_manager.CommitTransaction();
+  cid_t delete_cid = txn_manager.GetLastCommitId();
+
+  // Transactions that began before the delete still see the tuples
+  EXPECT_EQ(data_table->Vacuum(delete_cid - 1), 0);
+  EXPECT_GE(txn_manager.GetOldestActiveCommitId(), delete_cid);
+  EXPECT_EQ(data_table->Vacuum(delete_cid), tuple_count);
+  EXPECT_EQ(data_table->Vacuum(delete_cid), 0);
+
+  for (oid_t index_itr = 0; index_itr < data_table->GetIndexCount();
+       index_itr++) {
+    EXPECT_EQ(data_table->GetIndex(index_itr)->ScanAllKeys().size(), 0);
+  }
+
+  // The same keys go into the reclaimed slots again
+  txn = txn_manager.BeginTransaction();
+  for (auto &tuple : tuples) {
+    ItemPointer location = data_table->InsertTuple(txn, tuple.get());
+    EXPECT_TRUE(location.block != INVALID_OID);
+    txn->RecordInsert(location);
+    EXPECT_EQ(slots.count(std::make_pair(location.block, location.offset)),
+              1);
+  }
+  txn_manager.CommitTransaction();
+
+  EXPECT_EQ(data_table->GetTileGroupCount(), tile_group_count);
+}
+
+TEST(DataTableTests, PopulateIndexTest) {
+  const oid_t key_count = 5;
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(5, false));
+
+  // Every key twice
+  std::vector<std::unique_ptr<storage::Tuple>> tuples;
+  auto txn = txn_manager.BeginTransaction();
+  for (oid_t tuple_itr = 0; tuple_itr < 2 * key_count; tuple_itr++) {
+    tuples.emplace_back(ExecutorTestsUtil::GetTuple(
+        data_table.get(), tuple_itr % key_count, testing_pool));
+    ItemPointer location = data_table->InsertTuple(txn, tuples.back().get());
+    txn->RecordInsert(location);
+  }
+  txn_manager.CommitTransaction();
+
+  auto tuple_schema = data_table->GetSchema();
+  std::vector<oid_t> key_attrs = {0};
+  for (bool unique : {true, false}) {
+    auto key_schema = catalog::Schema::CopySchema(tuple_schema, key_attrs);
+    key_schema->SetIndexedColumns(key_attrs);
+    auto index_metadata = new index::IndexMetadata(
+        "populated_index", 125, INDEX_TYPE_BWTREE,
+        unique ? INDEX_CONSTRAINT_TYPE_UNIQUE : INDEX_CONSTRAINT_TYPE_DEFAULT,
+        tuple_schema, key_schema, unique);
+    std::unique_ptr<index::Index> index(
+        index::IndexFactory::GetInstance(index_metadata));
+
+    // A unique index cannot be built over the table
+    if (unique) {
+      EXPECT_FALSE(data_table->PopulateIndex(index.get()));
+      continue;
+    }
+
+    // The table takes the index over
+    EXPECT_TRUE(data_table->PopulateIndex(index.get()));
+    EXPECT_EQ(index->ScanAllKeys().size(), 2 * key_count);
+    EXPECT_EQ(data_table->GetIndexCount(), 1);
+    EXPECT_EQ(data_table->GetIndex(0), index.release());
+  }
+}
+
+TEST(DataTableTests, PopulateIndexConcurrentInsertTest) {
+  const size_t thread_count = 4;
+  auto testing_pool = TestingHarness::GetInstance().GetTestingPool();
+
+  std::unique_ptr<storage::DataTable> data_table(
+      ExecutorTestsUtil::CreateTable(100, false));
+  std::unique_ptr<storage::Tuple> tuple(
+      ExecutorTestsUtil::GetTuple(data_table.get(), 1, testing_pool));
+
+  std::vector<std::vector<ItemPointer>> locations(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+    threads.push_back(std::thread(InsertTuples, data_table.get(), tuple.get(),
+                                  &locations[thread_itr]));
+  }
+
+  // Built while the inserts are going on
+  while (data_table->GetTileGroupCount() < 4) std::this_thread::yield();
+  auto tuple_schema = data_table->GetSchema();
+  std::vector<oid_t> key_attrs = {0};
+  auto key_schema = catalog::Schema::CopySchema(tuple_schema, key_attrs);
+  key_schema->SetIndexedColumns(key_attrs);
+  auto index_metadata = new index::IndexMetadata(
+      "populated_index", 125, INDEX_TYPE_BWTREE, INDEX_CONSTRAINT_TYPE_DEFAULT,
+      tuple_schema, key_schema, false);
+  auto index = index::IndexFactory::GetInstance(index_metadata);
+  EXPECT_TRUE(data_table->PopulateIndex(index));
+
+  for (auto &thread : threads) thread.join();
+
+  // Each tuple got its entry, in the scan of the table or on insert
+  EXPECT_EQ(index->ScanAllKeys().size(), thread_count * 1000);
+}
+
 }  // End test namespace
 }  // End peloton namespace
@@ -327,6 +327,174 @@ TEST(TileGroupTests, MVCCInsert) {
   delete schema2;
 }
 
+TEST(TileGroupTests, VisibilityBitmapTest) {
+  const oid_t tuple_count = 150;
+  storage::TileGroupHeader header(BACKEND_TYPE_MM, tuple_count);
+
+  // Put the slots into every mix of own / committed / deleted versions
+  for (oid_t tuple_itr = 0; tuple_itr < tuple_count; tuple_itr++) {
+    switch (tuple_itr % 5) {
+      case 0:  // inserted by txn 7, not committed
+        header.SetTransactionId(tuple_itr, 7);
+        header.SetBeginCommitId(tuple_itr, MAX_CID);
+        header.SetEndCommitId(tuple_itr, MAX_CID);
+        break;
+      case 1:  // committed insert
+        header.SetTransactionId(tuple_itr, INITIAL_TXN_ID);
+        header.SetBeginCommitId(tuple_itr, tuple_itr);
+        header.SetEndCommitId(tuple_itr, MAX_CID);
+        break;
+      case 2:  // committed delete
+        header.SetTransactionId(tuple_itr, INITIAL_TXN_ID);
+        header.SetBeginCommitId(tuple_itr, tuple_itr / 2);
+        header.SetEndCommitId(tuple_itr, tuple_itr);
+        break;
+      case 3:  // deleted by txn 7, not committed
+        header.SetTransactionId(tuple_itr, 7);
+        header.SetBeginCommitId(tuple_itr, tuple_itr / 3);
+        header.SetEndCommitId(tuple_itr, MAX_CID);
+        break;
+      default:  // empty slot
+        header.SetTransactionId(tuple_itr, INVALID_TXN_ID);
+        header.SetBeginCommitId(tuple_itr, MAX_CID);
+        header.SetEndCommitId(tuple_itr, MAX_CID);
+        break;
+    }
+  }
+
+  std::vector<uint64_t> bitmap;
+  for (txn_id_t txn_id : {txn_id_t(7), txn_id_t(8)}) {
+    for (cid_t lcid : {cid_t(0), cid_t(40), cid_t(75), cid_t(200)}) {
+      // Odd bounds leave a scalar tail on both sides
+      for (oid_t begin_slot : {oid_t(0), oid_t(1), oid_t(63)}) {
+        for (oid_t end_slot : {oid_t(64), oid_t(129), tuple_count}) {
+          header.ComputeVisibility(txn_id, lcid, begin_slot, end_slot, bitmap);
+          EXPECT_EQ((end_slot - begin_slot + 63) / 64, bitmap.size());
+
+          for (oid_t slot = begin_slot; slot < end_slot; slot++) {
+            EXPECT_EQ(header.IsVisible(slot, txn_id, lcid),
+                      storage::TileGroupHeader::IsVisibleInBitmap(
+                          bitmap, slot - begin_slot));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(TileGroupTests, ZoneMapTest) {
+  std::vector<catalog::Column> columns;
+  std::vector<catalog::Schema> schemas;
+
+  catalog::Column column1(VALUE_TYPE_INTEGER, GetTypeSize(VALUE_TYPE_INTEGER),
+                          "A", true);
+  catalog::Column column2(VALUE_TYPE_DOUBLE, GetTypeSize(VALUE_TYPE_DOUBLE),
+                          "B", true);
+  catalog::Column column3(VALUE_TYPE_VARCHAR, 25, "C", false);
+
+  columns.push_back(column1);
+  columns.push_back(column2);
+  columns.push_back(column3);
+
+  catalog::Schema *schema = new catalog::Schema(columns);
+  schemas.push_back(*schema);
+
+  std::map<oid_t, std::pair<oid_t, oid_t>> column_map;
+  column_map[0] = std::make_pair(0, 0);
+  column_map[1] = std::make_pair(0, 1);
+  column_map[2] = std::make_pair(0, 2);
+
+  storage::TileGroup *tile_group = storage::TileGroupFactory::GetTileGroup(
+      INVALID_OID, INVALID_OID, INVALID_OID, nullptr, schemas, column_map, 10);
+  auto pool = tile_group->GetTilePool(0);
+
+  auto &txn_manager = concurrency::TransactionManager::GetInstance();
+  auto txn = txn_manager.BeginTransaction();
+  const txn_id_t txn_id = txn->GetTransactionId();
+  const cid_t commit_id = txn->GetCommitId();
+
+  // A is 10, 20, .., 50 and B is null in the second tuple
+  std::vector<oid_t> tuple_slots;
+  for (int tuple_itr = 1; tuple_itr <= 5; tuple_itr++) {
+    storage::Tuple tuple(schema, true);
+    tuple.SetValue(0, ValueFactory::GetIntegerValue(tuple_itr * 10), pool);
+    if (tuple_itr == 2) {
+      tuple.SetValue(1, ValueFactory::GetNullValueByType(VALUE_TYPE_DOUBLE),
+                     pool);
+    } else {
+      tuple.SetValue(1, ValueFactory::GetDoubleValue(tuple_itr * 1.5), pool);
+    }
+    tuple.SetValue(2, ValueFactory::GetStringValue("tuple"), pool);
+
+    tuple_slots.push_back(tile_group->InsertTuple(txn_id, &tuple));
+  }
+
+  auto &zone_map = tile_group->GetZoneMap();
+
+  Value min_value, max_value;
+  EXPECT_TRUE(zone_map.GetRange(0, min_value, max_value));
+  EXPECT_EQ(0, min_value.Compare(ValueFactory::GetIntegerValue(10)));
+  EXPECT_EQ(0, max_value.Compare(ValueFactory::GetIntegerValue(50)));
+  EXPECT_TRUE(zone_map.GetRange(1, min_value, max_value));
+  EXPECT_EQ(0, min_value.Compare(ValueFactory::GetDoubleValue(1.5)));
+  EXPECT_EQ(0, max_value.Compare(ValueFactory::GetDoubleValue(7.5)));
+  EXPECT_FALSE(zone_map.GetRange(2, min_value, max_value));
+
+  EXPECT_EQ(0, zone_map.GetNullCount(0));
+  EXPECT_EQ(1, zone_map.GetNullCount(1));
+
+  auto integer_value = ValueFactory::GetIntegerValue;
+  EXPECT_TRUE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_EQUAL,
+                                integer_value(25)));
+  EXPECT_FALSE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_EQUAL,
+                                 integer_value(60)));
+  EXPECT_FALSE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                 integer_value(10)));
+  EXPECT_TRUE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                integer_value(10)));
+  EXPECT_FALSE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                 integer_value(50)));
+  EXPECT_TRUE(zone_map.MayMatch(
+      0, EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO, integer_value(50)));
+  EXPECT_TRUE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                                integer_value(10)));
+
+  // Constants of another numeric type and nulls
+  EXPECT_TRUE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                ValueFactory::GetDoubleValue(49.5)));
+  EXPECT_FALSE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                 ValueFactory::GetDoubleValue(50.5)));
+  EXPECT_FALSE(zone_map.MayMatch(1, EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                 ValueFactory::GetBigIntValue(1)));
+  EXPECT_FALSE(zone_map.MayMatch(
+      0, EXPRESSION_TYPE_COMPARE_EQUAL,
+      ValueFactory::GetNullValueByType(VALUE_TYPE_INTEGER)));
+
+  // Strings are not tracked
+  EXPECT_TRUE(zone_map.MayMatch(2, EXPRESSION_TYPE_COMPARE_EQUAL,
+                                ValueFactory::GetStringValue("other")));
+
+  // The ranges only shrink once the zone map is rebuilt
+  for (oid_t tuple_itr = 0; tuple_itr < 4; tuple_itr++) {
+    tile_group->CommitInsertedTuple(tuple_slots[tuple_itr], txn_id, commit_id);
+  }
+  tile_group->AbortInsertedTuple(tuple_slots[4]);
+
+  EXPECT_TRUE(zone_map.MayMatch(0, EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                integer_value(45)));
+  tile_group->InvalidateZoneMap();
+  EXPECT_FALSE(tile_group->GetZoneMap().MayMatch(
+      0, EXPRESSION_TYPE_COMPARE_GREATERTHAN, integer_value(45)));
+  EXPECT_TRUE(zone_map.GetRange(0, min_value, max_value));
+  EXPECT_EQ(0, max_value.Compare(ValueFactory::GetIntegerValue(40)));
+  EXPECT_EQ(1, zone_map.GetNullCount(1));
+
+  txn_manager.CommitTransaction();
+
+  delete tile_group;
+  delete schema;
+}
+
 TEST(TileGroupTests, TileCopyTest) {
   std::vector<catalog::Column> columns;
   std::vector<std::string> tile_column_names;